@@ -14,6 +14,10 @@ extern "C" {
 #define DNS_SERVER_MAX_ITEMS 1
 #endif
 
+/* The task answering the queries */
+#define DNS_SERVER_TASK_NAME    "dns_server"
+#define DNS_SERVER_TASK_STACK   (4096)
+
 #define DNS_SERVER_CONFIG_SINGLE(queried_name, netif_key)  {        \
         .num_of_entries = 1,                                        \
         .item = { { .name = queried_name, .if_key = netif_key } }   \
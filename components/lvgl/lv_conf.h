@@ -46,7 +46,7 @@
  *=========================*/
 
 /*1: use custom malloc/free, 0: use the built-in `lv_mem_alloc()` and `lv_mem_free()`*/
-#define LV_MEM_CUSTOM 1
+#define LV_MEM_CUSTOM 0
 #if LV_MEM_CUSTOM == 0
     /*Size of the memory available for `lv_mem_alloc()` in bytes (>= 2kB)*/
     #define LV_MEM_SIZE (48U * 1024U)          /*[bytes]*/
@@ -55,10 +55,17 @@
     #define LV_MEM_ADR 0     /*0: unused*/
     /*Instead of an address give a memory allocator that will be called to get a memory pool for LVGL. E.g. my_malloc*/
     #if LV_MEM_ADR == 0
-        #undef LV_MEM_POOL_INCLUDE
-        #undef LV_MEM_POOL_ALLOC
+        /*Own pools, so LVGL's objects don't fragment the heap Wi-Fi and Bluetooth allocate from*/
+        #define LV_MEM_POOL_INCLUDE "esp_heap_caps.h"
+        #define LV_MEM_POOL_ALLOC(size) heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
     #endif
 
+    /*Allocations of LV_MEM_LARGE_MIN bytes or more (layers, decoded images) from a second pool
+     *in PSRAM, the small objects stay in the internal one. 0: one pool only (see lv_mem.h)*/
+    #define LV_MEM_LARGE_SIZE (64U * 1024U)    /*[bytes]*/
+    #define LV_MEM_LARGE_MIN  (4U * 1024U)     /*[bytes]*/
+    #define LV_MEM_LARGE_POOL_ALLOC(size) heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+
 #else       /*LV_MEM_CUSTOM*/
     #define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
     #define LV_MEM_CUSTOM_ALLOC   malloc
@@ -85,13 +92,11 @@
 
 /*Use a custom tick source that tells the elapsed time in milliseconds.
  *It removes the need to manually update the tick with `lv_tick_inc()`)*/
-#define LV_TICK_CUSTOM 0
+#define LV_TICK_CUSTOM 1
 #if LV_TICK_CUSTOM
-    #define LV_TICK_CUSTOM_INCLUDE "Arduino.h"         /*Header for the system time function*/
-    #define LV_TICK_CUSTOM_SYS_TIME_EXPR (millis())    /*Expression evaluating to current system time in ms*/
     /*If using lvgl as ESP32 component*/
-    // #define LV_TICK_CUSTOM_INCLUDE "esp_timer.h"
-    // #define LV_TICK_CUSTOM_SYS_TIME_EXPR ((esp_timer_get_time() / 1000LL))
+    #define LV_TICK_CUSTOM_INCLUDE "esp_timer.h"
+    #define LV_TICK_CUSTOM_SYS_TIME_EXPR ((esp_timer_get_time() / 1000LL))
 #endif   /*LV_TICK_CUSTOM*/
 
 /*Default Dot Per Inch. Used to initialize default sizes such as widgets sized, style paddings.
@@ -172,6 +177,24 @@
  *Only used if software rotation is enabled in the display driver.*/
 #define LV_DISP_ROT_MAX_BUF (10*1024)
 
+/*Blend RGB565 (opaque fill, fill with opacity through an A8 mask, opaque copy) with the word-at-a-time
+ *kernels of draw/sw/lv_draw_sw_blend_rgb565.c. The generic loops they replace stay as the reference.*/
+#ifndef LV_DRAW_SW_RGB565_SWAR
+    #define LV_DRAW_SW_RGB565_SWAR 1
+#endif
+
+/*Keep glyphs expanded to A8 masks, ready to blend, up to this many bytes (0: off).
+ *See draw/sw/lv_draw_sw_glyph_cache.h. PSRAM keeps internal RAM free for the draw buffer;
+ *MALLOC_CAP_INTERNAL is faster to read if there is room.*/
+#ifndef LV_DRAW_SW_GLYPH_CACHE_SIZE
+    #define LV_DRAW_SW_GLYPH_CACHE_SIZE (48U * 1024U)
+#endif
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE
+    #define LV_DRAW_SW_GLYPH_CACHE_INCLUDE "esp_heap_caps.h"
+    #define LV_DRAW_SW_GLYPH_CACHE_ALLOC(size) heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+    #define LV_DRAW_SW_GLYPH_CACHE_FREE(p) heap_caps_free(p)
+#endif
+
 /*-------------
  * GPU
  *-----------*/
@@ -360,28 +383,30 @@
  *===================*/
 
 /*Montserrat fonts with ASCII range and some symbols using bpp = 4
- *https://fonts.google.com/specimen/Montserrat*/
-#define LV_FONT_MONTSERRAT_8  1
-#define LV_FONT_MONTSERRAT_10 1
-#define LV_FONT_MONTSERRAT_12 1
+ *https://fonts.google.com/specimen/Montserrat
+ *Only 14 (theme, keyboard) is built in full. The sizes the UI uses are subset to the code
+ *points it shows at build time, see `ui_font_montserrat_*` in main/CMakeLists.txt*/
+#define LV_FONT_MONTSERRAT_8  0
+#define LV_FONT_MONTSERRAT_10 0
+#define LV_FONT_MONTSERRAT_12 0
 #define LV_FONT_MONTSERRAT_14 1
-#define LV_FONT_MONTSERRAT_16 1
-#define LV_FONT_MONTSERRAT_18 1
-#define LV_FONT_MONTSERRAT_20 1
-#define LV_FONT_MONTSERRAT_22 1
-#define LV_FONT_MONTSERRAT_24 1
-#define LV_FONT_MONTSERRAT_26 1
-#define LV_FONT_MONTSERRAT_28 1
-#define LV_FONT_MONTSERRAT_30 1
-#define LV_FONT_MONTSERRAT_32 1
-#define LV_FONT_MONTSERRAT_34 1
-#define LV_FONT_MONTSERRAT_36 1
-#define LV_FONT_MONTSERRAT_38 1
-#define LV_FONT_MONTSERRAT_40 1
-#define LV_FONT_MONTSERRAT_42 1
-#define LV_FONT_MONTSERRAT_44 1
-#define LV_FONT_MONTSERRAT_46 1
-#define LV_FONT_MONTSERRAT_48 1
+#define LV_FONT_MONTSERRAT_16 0
+#define LV_FONT_MONTSERRAT_18 0
+#define LV_FONT_MONTSERRAT_20 0
+#define LV_FONT_MONTSERRAT_22 0
+#define LV_FONT_MONTSERRAT_24 0
+#define LV_FONT_MONTSERRAT_26 0
+#define LV_FONT_MONTSERRAT_28 0
+#define LV_FONT_MONTSERRAT_30 0
+#define LV_FONT_MONTSERRAT_32 0
+#define LV_FONT_MONTSERRAT_34 0
+#define LV_FONT_MONTSERRAT_36 0
+#define LV_FONT_MONTSERRAT_38 0
+#define LV_FONT_MONTSERRAT_40 0
+#define LV_FONT_MONTSERRAT_42 0
+#define LV_FONT_MONTSERRAT_44 0
+#define LV_FONT_MONTSERRAT_46 0
+#define LV_FONT_MONTSERRAT_48 0
 
 /*Demonstrate special features*/
 #define LV_FONT_MONTSERRAT_12_SUBPX      0
@@ -449,6 +474,14 @@
 /*The control character to use for signalling text recoloring.*/
 #define LV_TXT_COLOR_CMD "#"
 
+/*Keep the sizes of this many short texts measured by `lv_txt_get_size` (0: off). Labels measure
+ *their text on every change and centered or right aligned labels on every draw too.*/
+#define LV_TXT_SIZE_CACHE_ENTRIES 32
+#if LV_TXT_SIZE_CACHE_ENTRIES
+    #define LV_TXT_SIZE_CACHE_INCLUDE "esp_heap_caps.h"
+    #define LV_TXT_SIZE_CACHE_ALLOC(size) heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+
 /*Support bidirectional texts. Allows mixing Left-to-Right and Right-to-Left texts.
  *The direction will be processed according to the Unicode Bidirectional Algorithm:
  *https://www.w3.org/International/articles/inline-bidi-markup/uba-basics*/
@@ -753,8 +786,8 @@
 /*Stress test for LVGL*/
 #define LV_USE_DEMO_STRESS 1
 
-/*Music player demo*/
-#define LV_USE_DEMO_MUSIC 1
+/*Music player demo (needs Montserrat 12 and 16, which are not built)*/
+#define LV_USE_DEMO_MUSIC 0
 #if LV_USE_DEMO_MUSIC
     #define LV_DEMO_MUSIC_SQUARE    0
     #define LV_DEMO_MUSIC_LANDSCAPE 0
@@ -7,6 +7,7 @@
  *      INCLUDES
  *********************/
 #include "lv_draw_sw.h"
+#include "lv_draw_sw_blend_rgb565.h"
 #include "../../misc/lv_math.h"
 #include "../../hal/lv_hal_disp.h"
 #include "../../core/lv_refr.h"
@@ -249,6 +250,19 @@ static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_ar
     int32_t x;
     int32_t y;
 
+#if LV_DRAW_SW_RGB565_SWAR
+    /*Word-at-a-time kernels, checked against the loops below. Fills with opacity and opaque
+     *fills through a mask stay on the loops.*/
+    if(mask == NULL && opa >= LV_OPA_MAX) {
+        lv_draw_sw_rgb565_fill(dest_buf, dest_stride, w, h, color);
+        return;
+    }
+    if(mask != NULL && opa < LV_OPA_MAX) {
+        lv_draw_sw_rgb565_fill_mask_opa(dest_buf, dest_stride, w, h, color, opa, mask, mask_stride);
+        return;
+    }
+#endif
+
     /*No mask*/
     if(mask == NULL) {
         if(opa >= LV_OPA_MAX) {
@@ -653,11 +667,15 @@ static void LV_ATTRIBUTE_FAST_MEM map_normal(lv_color_t * dest_buf, const lv_are
     /*Simple fill (maybe with opacity), no masking*/
     if(mask == NULL) {
         if(opa >= LV_OPA_MAX) {
+#if LV_DRAW_SW_RGB565_SWAR
+            lv_draw_sw_rgb565_copy(dest_buf, dest_stride, src_buf, src_stride, w, h);
+#else
             for(y = 0; y < h; y++) {
                 lv_memcpy(dest_buf, src_buf, w * sizeof(lv_color_t));
                 dest_buf += dest_stride;
                 src_buf += src_stride;
             }
+#endif
         }
         else {
             for(y = 0; y < h; y++) {
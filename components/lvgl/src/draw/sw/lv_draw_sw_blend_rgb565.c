@@ -0,0 +1,158 @@
+/**
+ * @file lv_draw_sw_blend_rgb565.c
+ *
+ * Every kernel must give exactly the pixels of the matching branch of `fill_normal()` or
+ * `map_normal()` in lv_draw_sw_blend.c; tools/ui_bench/blend_check.c compares them.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_draw_sw_blend_rgb565.h"
+
+#if LV_DRAW_SW_RGB565_SWAR
+
+#include "../../misc/lv_math.h"
+#include "../../misc/lv_mem.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*The fields of an RGB565 pixel spread over 32 bits with room to multiply by a 5 bit factor:
+ *green in the upper half, red and blue in the lower (as in `lv_color_mix()`)*/
+#define SPREAD_MASK 0x07E0F81FU
+
+/**********************
+ *      MACROS
+ **********************/
+#if LV_COLOR_16_SWAP
+#define PX_NATIVE(c)     ((uint16_t)((c) << 8 | (c) >> 8))
+#define PX2_NATIVE(c32)  ((((c32) >> 8) & 0x00FF00FFU) | (((c32) << 8) & 0xFF00FF00U))
+#else
+#define PX_NATIVE(c)     ((uint16_t)(c))
+#define PX2_NATIVE(c32)  (c32)
+#endif
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static inline uint32_t spread(uint32_t c);
+static inline uint32_t mix_spread(uint32_t fg, uint32_t bg, uint32_t mix);
+static inline uint32_t mask_mix(lv_opa_t mask, lv_opa_t opa);
+static inline void fill_mask_px(lv_color_t * dest, uint32_t fg, uint32_t mix);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_fill(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w,
+                                                  int32_t h, lv_color_t color)
+{
+    /*Contiguous lines are filled in one go*/
+    if(dest_stride == w) {
+        w *= h;
+        h = 1;
+    }
+
+    /*Black, white and the other colors with two equal bytes are a memset*/
+    bool bytes_equal = (color.full >> 8) == (color.full & 0xFF);
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        if(bytes_equal) lv_memset(dest_buf, color.full & 0xFF, w * sizeof(lv_color_t));
+        else lv_color_fill(dest_buf, color, w);
+        dest_buf += dest_stride;
+    }
+}
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_fill_mask_opa(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w,
+                                                           int32_t h, lv_color_t color, lv_opa_t opa,
+                                                           const lv_opa_t * mask, lv_coord_t mask_stride)
+{
+    uint32_t fg = spread(PX_NATIVE(color.full));
+
+    int32_t x;
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        /*Four mask values per word from here on*/
+        for(x = 0; x < w && ((lv_uintptr_t)&mask[x] & 0x3); x++) {
+            fill_mask_px(&dest_buf[x], fg, mask_mix(mask[x], opa));
+        }
+
+        for(; x < w - 3; x += 4) {
+            if(*((const uint32_t *)&mask[x]) == 0) continue;
+
+            fill_mask_px(&dest_buf[x], fg, mask_mix(mask[x], opa));
+            fill_mask_px(&dest_buf[x + 1], fg, mask_mix(mask[x + 1], opa));
+            fill_mask_px(&dest_buf[x + 2], fg, mask_mix(mask[x + 2], opa));
+            fill_mask_px(&dest_buf[x + 3], fg, mask_mix(mask[x + 3], opa));
+        }
+
+        for(; x < w; x++) {
+            fill_mask_px(&dest_buf[x], fg, mask_mix(mask[x], opa));
+        }
+
+        dest_buf += dest_stride;
+        mask += mask_stride;
+    }
+}
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_copy(lv_color_t * dest_buf, lv_coord_t dest_stride,
+                                                  const lv_color_t * src_buf, lv_coord_t src_stride, int32_t w, int32_t h)
+{
+    /*Contiguous lines are copied in one go*/
+    if(dest_stride == w && src_stride == w) {
+        w *= h;
+        h = 1;
+    }
+
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        lv_memcpy(dest_buf, src_buf, w * sizeof(lv_color_t));
+        dest_buf += dest_stride;
+        src_buf += src_stride;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Spread a native RGB565 pixel like `lv_color_mix()` does.
+ */
+static inline uint32_t spread(uint32_t c)
+{
+    return (c | (c << 16)) & SPREAD_MASK;
+}
+
+/**
+ * `lv_color_mix()` with the foreground already spread and the factor already reduced to 0..32.
+ * @param bg    native RGB565 background pixel
+ * @return      native RGB565 result
+ */
+static inline uint32_t mix_spread(uint32_t fg, uint32_t bg, uint32_t mix)
+{
+    bg = spread(bg);
+    uint32_t res = ((((fg - bg) * mix) >> 5) + bg) & SPREAD_MASK;
+    return (res >> 16 | res) & 0xFFFF;
+}
+
+/**
+ * The 0..32 factor `lv_color_mix()` uses for a mask value and the opacity. 0 leaves the pixel
+ * as it is and 32 gives the foreground color (the mix is exact at both ends).
+ */
+static inline uint32_t mask_mix(lv_opa_t mask, lv_opa_t opa)
+{
+    mask = mask == LV_OPA_COVER ? opa : (uint32_t)((uint32_t)mask * opa) >> 8;
+    return (uint32_t)((uint32_t)mask + 4) >> 3;
+}
+
+/**
+ * Mix one pixel with the spread foreground. Cheaper than testing for the ends of `mix`.
+ */
+static inline void fill_mask_px(lv_color_t * dest, uint32_t fg, uint32_t mix)
+{
+    dest->full = PX_NATIVE(mix_spread(fg, PX_NATIVE(dest->full), mix));
+}
+
+#endif /*LV_DRAW_SW_RGB565_SWAR*/
@@ -0,0 +1,74 @@
+/**
+ * @file lv_draw_sw_blend_rgb565.h
+ *
+ * Word-at-a-time kernels for the common cases of `LV_BLEND_MODE_NORMAL` on RGB565
+ * (byte-swapped or not). They give the same pixels as the generic loops of lv_draw_sw_blend.c,
+ * which are kept as the reference and used when `LV_DRAW_SW_RGB565_SWAR` is 0. Fills with
+ * opacity and opaque fills through a mask have no kernel, one showed no clear gain on the host.
+ */
+
+#ifndef LV_DRAW_SW_BLEND_RGB565_H
+#define LV_DRAW_SW_BLEND_RGB565_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../misc/lv_color.h"
+#include "../../misc/lv_area.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#ifndef LV_DRAW_SW_RGB565_SWAR
+#define LV_DRAW_SW_RGB565_SWAR 0
+#endif
+
+#if LV_DRAW_SW_RGB565_SWAR && (LV_COLOR_DEPTH != 16 || LV_COLOR_MIX_ROUND_OFS != 0)
+#error "LV_DRAW_SW_RGB565_SWAR needs LV_COLOR_DEPTH 16 and LV_COLOR_MIX_ROUND_OFS 0"
+#endif
+
+#if LV_DRAW_SW_RGB565_SWAR
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Fill an area with a color.
+ * @param dest_buf      first pixel of the area
+ * @param dest_stride   pixels per line of the destination buffer
+ * @param w             width of the area
+ * @param h             height of the area
+ * @param color         fill color
+ */
+void lv_draw_sw_rgb565_fill(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h, lv_color_t color);
+
+/**
+ * Fill an area with a color of opacity `opa` (`LV_OPA_MIN` < `opa` < `LV_OPA_MAX`) through an A8 mask.
+ * @param mask          mask value of the first pixel
+ * @param mask_stride   bytes per line of the mask
+ * The other parameters are the same as `lv_draw_sw_rgb565_fill`.
+ */
+void lv_draw_sw_rgb565_fill_mask_opa(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h,
+                                     lv_color_t color, lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stride);
+
+/**
+ * Copy an area of opaque pixels.
+ * @param src_buf       first pixel to copy
+ * @param src_stride    pixels per line of the source buffer
+ * The other parameters are the same as `lv_draw_sw_rgb565_fill`.
+ */
+void lv_draw_sw_rgb565_copy(lv_color_t * dest_buf, lv_coord_t dest_stride, const lv_color_t * src_buf,
+                            lv_coord_t src_stride, int32_t w, int32_t h);
+
+#endif /*LV_DRAW_SW_RGB565_SWAR*/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_DRAW_SW_BLEND_RGB565_H*/
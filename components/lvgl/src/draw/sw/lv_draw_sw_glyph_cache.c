@@ -0,0 +1,221 @@
+/**
+ * @file lv_draw_sw_glyph_cache.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_draw_sw_glyph_cache.h"
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE
+
+#include "../../misc/lv_mem.h"
+#include "../../misc/lv_log.h"
+#ifdef LV_DRAW_SW_GLYPH_CACHE_INCLUDE
+    #include LV_DRAW_SW_GLYPH_CACHE_INCLUDE
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BUCKET_BITS 6
+#define BUCKET_CNT  (1 << BUCKET_BITS)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/*An entry is followed by its mask in the same allocation*/
+typedef struct _glyph_entry_t {
+    struct _glyph_entry_t * hash_next;
+    struct _glyph_entry_t * lru_prev;   /*more recently used*/
+    struct _glyph_entry_t * lru_next;   /*less recently used*/
+    const lv_font_t * font;
+    uint32_t letter;
+    uint32_t size;
+    lv_draw_sw_glyph_t glyph;
+} glyph_entry_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint32_t bucket_of(const lv_font_t * font, uint32_t letter);
+static void lru_unlink(glyph_entry_t * e);
+static void lru_push_front(glyph_entry_t * e);
+static void evict_last(void);
+static bool decode(lv_opa_t * mask, const uint8_t * map_p, uint32_t px, uint32_t bpp);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static glyph_entry_t * buckets[BUCKET_CNT];
+static glyph_entry_t * lru_first;
+static glyph_entry_t * lru_last;
+static lv_draw_sw_glyph_cache_stats_t stats;
+
+/**********************
+ *  GLOBAL VARIABLES
+ **********************/
+extern const uint8_t _lv_bpp1_opa_table[2];
+extern const uint8_t _lv_bpp2_opa_table[4];
+extern const uint8_t _lv_bpp4_opa_table[16];
+extern const uint8_t _lv_bpp8_opa_table[256];
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+const lv_draw_sw_glyph_t * lv_draw_sw_glyph_cache_get(const lv_font_t * font, uint32_t letter)
+{
+    uint32_t b = bucket_of(font, letter);
+    glyph_entry_t * e;
+    for(e = buckets[b]; e != NULL; e = e->hash_next) {
+        if(e->letter == letter && e->font == font) {
+            if(e != lru_first) {
+                lru_unlink(e);
+                lru_push_front(e);
+            }
+            stats.hits++;
+            return &e->glyph;
+        }
+    }
+
+    lv_font_glyph_dsc_t g;
+    if(!lv_font_get_glyph_dsc(font, &g, letter, '\0')) return NULL;
+
+    uint32_t px = (uint32_t)g.box_w * g.box_h;
+    uint32_t size = sizeof(glyph_entry_t) + px;
+    if(g.resolved_font->subpx || px > LV_DRAW_SW_GLYPH_CACHE_MAX_PX || size > LV_DRAW_SW_GLYPH_CACHE_SIZE) {
+        stats.bypass++;
+        return NULL;
+    }
+
+    const uint8_t * map_p = NULL;
+    if(px) {
+        map_p = lv_font_get_glyph_bitmap(g.resolved_font, letter);
+        if(map_p == NULL) return NULL;
+    }
+
+    while(stats.bytes + size > LV_DRAW_SW_GLYPH_CACHE_SIZE) evict_last();
+
+    e = LV_DRAW_SW_GLYPH_CACHE_ALLOC(size);
+    if(e == NULL) {
+        LV_LOG_WARN("lv_draw_sw_glyph_cache: out of memory");
+        return NULL;
+    }
+
+    lv_opa_t * mask = px ? (lv_opa_t *)(e + 1) : NULL;
+    if(px && !decode(mask, map_p, px, g.bpp)) {
+        /*Image font or invalid bpp, left to lv_draw_sw_letter*/
+        LV_DRAW_SW_GLYPH_CACHE_FREE(e);
+        stats.bypass++;
+        return NULL;
+    }
+
+    e->font = font;
+    e->letter = letter;
+    e->size = size;
+    e->glyph.dsc = g;
+    e->glyph.mask = mask;
+    e->hash_next = buckets[b];
+    buckets[b] = e;
+    lru_push_front(e);
+
+    stats.misses++;
+    stats.entries++;
+    stats.bytes += size;
+    return &e->glyph;
+}
+
+void lv_draw_sw_glyph_cache_clear(void)
+{
+    while(lru_last != NULL) evict_last();
+}
+
+void lv_draw_sw_glyph_cache_get_stats(lv_draw_sw_glyph_cache_stats_t * stats_res)
+{
+    *stats_res = stats;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static uint32_t bucket_of(const lv_font_t * font, uint32_t letter)
+{
+    uint32_t h = (letter ^ (uint32_t)((uintptr_t)font >> 2)) * 2654435761U;
+    return h >> (32 - BUCKET_BITS);
+}
+
+static void lru_unlink(glyph_entry_t * e)
+{
+    if(e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+    else lru_first = e->lru_next;
+    if(e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+    else lru_last = e->lru_prev;
+}
+
+static void lru_push_front(glyph_entry_t * e)
+{
+    e->lru_prev = NULL;
+    e->lru_next = lru_first;
+    if(lru_first) lru_first->lru_prev = e;
+    else lru_last = e;
+    lru_first = e;
+}
+
+static void evict_last(void)
+{
+    glyph_entry_t * e = lru_last;
+    glyph_entry_t ** p = &buckets[bucket_of(e->font, e->letter)];
+    while(*p != e) p = &(*p)->hash_next;
+    *p = e->hash_next;
+    lru_unlink(e);
+
+    stats.evictions++;
+    stats.entries--;
+    stats.bytes -= e->size;
+    LV_DRAW_SW_GLYPH_CACHE_FREE(e);
+}
+
+/**
+ * Expand a glyph bitmap to one opacity per pixel, the same values `draw_letter_normal` of
+ * lv_draw_sw_letter.c puts into its mask. The rows of the bitmap are not byte aligned.
+ */
+static bool decode(lv_opa_t * mask, const uint8_t * map_p, uint32_t px, uint32_t bpp)
+{
+    const uint8_t * bpp_opa_table_p;
+    if(bpp == 3) bpp = 4;
+    switch(bpp) {
+        case 1:
+            bpp_opa_table_p = _lv_bpp1_opa_table;
+            break;
+        case 2:
+            bpp_opa_table_p = _lv_bpp2_opa_table;
+            break;
+        case 4:
+            bpp_opa_table_p = _lv_bpp4_opa_table;
+            break;
+        case 8:
+            bpp_opa_table_p = _lv_bpp8_opa_table;
+            break;
+        default:
+            return false;
+    }
+
+    uint32_t px_mask = (1U << bpp) - 1;
+    uint32_t bit = 0;
+    uint32_t i;
+    for(i = 0; i < px; i++) {
+        uint32_t letter_px = (map_p[bit >> 3] >> (8 - bpp - (bit & 0x7))) & px_mask;
+        mask[i] = bpp_opa_table_p[letter_px];
+        bit += bpp;
+    }
+    return true;
+}
+
+#endif /*LV_DRAW_SW_GLYPH_CACHE_SIZE*/
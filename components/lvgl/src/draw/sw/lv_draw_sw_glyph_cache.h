@@ -0,0 +1,95 @@
+/**
+ * @file lv_draw_sw_glyph_cache.h
+ *
+ * Glyphs of the software renderer, ready to blend: the glyph descriptor and the bitmap expanded
+ * to one opacity byte per pixel, so a letter drawn again is one blend of a stored A8 mask
+ * instead of a font lookup and a bit-by-bit decode. Least recently used glyphs are dropped
+ * when the masks exceed `LV_DRAW_SW_GLYPH_CACHE_SIZE` bytes.
+ *
+ * Glyphs are keyed on the font and the code point. The color and opacity are applied by the
+ * blender, so one mask serves every color of a glyph. Sub-pixel and image fonts are not cached.
+ * Fonts are identified by address: call `lv_draw_sw_glyph_cache_clear` before a font is freed.
+ */
+
+#ifndef LV_DRAW_SW_GLYPH_CACHE_H
+#define LV_DRAW_SW_GLYPH_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../misc/lv_color.h"
+#include "../../font/lv_font.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#ifndef LV_DRAW_SW_GLYPH_CACHE_SIZE
+#define LV_DRAW_SW_GLYPH_CACHE_SIZE 0
+#endif
+
+/*Larger glyphs (width x height) are drawn from the font every time*/
+#ifndef LV_DRAW_SW_GLYPH_CACHE_MAX_PX
+#define LV_DRAW_SW_GLYPH_CACHE_MAX_PX (64 * 64)
+#endif
+
+/*Where the glyphs are kept. `LV_DRAW_SW_GLYPH_CACHE_INCLUDE` may name the header of the allocator.*/
+#ifndef LV_DRAW_SW_GLYPH_CACHE_ALLOC
+#define LV_DRAW_SW_GLYPH_CACHE_ALLOC(size) lv_mem_alloc(size)
+#define LV_DRAW_SW_GLYPH_CACHE_FREE(p)     lv_mem_free(p)
+#endif
+
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    lv_font_glyph_dsc_t dsc;    /*`resolved_font` is the font the glyph came from*/
+    const lv_opa_t * mask;      /*`dsc.box_w` x `dsc.box_h` opacities, NULL for an empty glyph*/
+} lv_draw_sw_glyph_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;            /*glyphs decoded and added*/
+    uint32_t evictions;
+    uint32_t bypass;            /*glyphs not cacheable (too large, sub-pixel, image font)*/
+    uint32_t entries;
+    uint32_t bytes;             /*masks and their entries*/
+} lv_draw_sw_glyph_cache_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Get a glyph from the cache, decoding and adding it on a miss.
+ * @param font      font of the label
+ * @param letter    code point
+ * @return          the glyph, valid until the next call; NULL if the font has no such glyph or it
+ *                  isn't cacheable, it is drawn from the font then
+ */
+const lv_draw_sw_glyph_t * lv_draw_sw_glyph_cache_get(const lv_font_t * font, uint32_t letter);
+
+/**
+ * Drop all glyphs. The statistics are kept.
+ */
+void lv_draw_sw_glyph_cache_clear(void);
+
+/**
+ * Get the statistics of the cache since start.
+ * @param stats     filled with the counters
+ */
+void lv_draw_sw_glyph_cache_get_stats(lv_draw_sw_glyph_cache_stats_t * stats);
+
+#endif /*LV_DRAW_SW_GLYPH_CACHE_SIZE*/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_DRAW_SW_GLYPH_CACHE_H*/
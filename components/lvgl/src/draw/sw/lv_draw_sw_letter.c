@@ -7,6 +7,7 @@
  *      INCLUDES
  *********************/
 #include "lv_draw_sw.h"
+#include "lv_draw_sw_glyph_cache.h"
 #include "../../hal/lv_hal_disp.h"
 #include "../../misc/lv_math.h"
 #include "../../misc/lv_assert.h"
@@ -35,6 +36,11 @@ static void draw_letter_subpx(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_
                               lv_font_glyph_dsc_t * g, const uint8_t * map_p);
 #endif /*LV_DRAW_COMPLEX && LV_USE_FONT_SUBPX*/
 
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE
+static void LV_ATTRIBUTE_FAST_MEM draw_letter_cached(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc,
+                                                     const lv_point_t * pos_p, const lv_draw_sw_glyph_t * glyph);
+#endif /*LV_DRAW_SW_GLYPH_CACHE_SIZE*/
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -94,6 +100,14 @@ const uint8_t _lv_bpp8_opa_table[256] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 1
 void lv_draw_sw_letter(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc,  const lv_point_t * pos_p,
                        uint32_t letter)
 {
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE
+    const lv_draw_sw_glyph_t * glyph = lv_draw_sw_glyph_cache_get(dsc->font, letter);
+    if(glyph) {
+        draw_letter_cached(draw_ctx, dsc, pos_p, glyph);
+        return;
+    }
+#endif
+
     lv_font_glyph_dsc_t g;
     bool g_ret = lv_font_get_glyph_dsc(dsc->font, &g, letter, '\0');
     if(g_ret == false) {
@@ -350,6 +364,104 @@ static void LV_ATTRIBUTE_FAST_MEM draw_letter_normal(lv_draw_ctx_t * draw_ctx, c
     lv_mem_buf_release(mask_buf);
 }
 
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE
+/**
+ * Draw a glyph of lv_draw_sw_glyph_cache.h. Gives the same pixels as `draw_letter_normal`.
+ * Without masks and opacity the stored mask is blended as it is, in one call.
+ */
+static void LV_ATTRIBUTE_FAST_MEM draw_letter_cached(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc,
+                                                     const lv_point_t * pos_p, const lv_draw_sw_glyph_t * glyph)
+{
+    const lv_font_glyph_dsc_t * g = &glyph->dsc;
+
+    /*Don't draw anything if the character is empty. E.g. space*/
+    if((g->box_h == 0) || (g->box_w == 0)) return;
+
+    lv_area_t letter_area;
+    letter_area.x1 = pos_p->x + g->ofs_x;
+    letter_area.y1 = pos_p->y + (dsc->font->line_height - dsc->font->base_line) - g->box_h - g->ofs_y;
+    letter_area.x2 = letter_area.x1 + g->box_w - 1;
+    letter_area.y2 = letter_area.y1 + g->box_h - 1;
+
+    lv_area_t fill_area;
+    if(!_lv_area_intersect(&fill_area, &letter_area, draw_ctx->clip_area)) return;
+
+    lv_draw_sw_blend_dsc_t blend_dsc;
+    lv_memset_00(&blend_dsc, sizeof(blend_dsc));
+    blend_dsc.color = dsc->color;
+    blend_dsc.opa = dsc->opa;
+    blend_dsc.blend_mode = dsc->blend_mode;
+    blend_dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+
+#if LV_DRAW_COMPLEX
+    /*The same area as `draw_letter_normal` checks, so both apply masks alike*/
+    lv_area_t mask_area = fill_area;
+    mask_area.y2 = mask_area.y1 + (fill_area.y2 - letter_area.y1 + 1);
+    bool mask_any = lv_draw_mask_is_any(&mask_area);
+#else
+    bool mask_any = false;
+#endif
+
+    /*The blender rounds the mask in place without anti-aliasing, so it gets a copy then*/
+    lv_disp_t * disp = _lv_refr_get_disp_refreshing();
+    if(!mask_any && dsc->opa >= LV_OPA_MAX && disp->driver->antialiasing) {
+        blend_dsc.blend_area = &fill_area;
+        blend_dsc.mask_area = &letter_area;
+        blend_dsc.mask_buf = (lv_opa_t *)glyph->mask;
+        lv_draw_sw_blend(draw_ctx, &blend_dsc);
+        return;
+    }
+
+    lv_coord_t fill_w = lv_area_get_width(&fill_area);
+    uint32_t mask_buf_size = LV_MIN(lv_area_get_size(&fill_area), (uint32_t)lv_disp_get_hor_res(disp));
+    mask_buf_size = LV_MAX(mask_buf_size, (uint32_t)fill_w);
+    lv_opa_t * mask_buf = lv_mem_buf_get(mask_buf_size);
+    const lv_opa_t * map_p = glyph->mask + (fill_area.y1 - letter_area.y1) * g->box_w + (fill_area.x1 - letter_area.x1);
+    lv_opa_t opa = dsc->opa;
+
+    lv_area_t blend_area = fill_area;
+    blend_dsc.blend_area = &blend_area;
+    blend_dsc.mask_area = &blend_area;
+    blend_dsc.mask_buf = mask_buf;
+    uint32_t mask_p = 0;
+
+    lv_coord_t y;
+    for(y = fill_area.y1; y <= fill_area.y2; y++) {
+        lv_opa_t * row = mask_buf + mask_p;
+        if(opa < LV_OPA_MAX) {
+            lv_coord_t x;
+            for(x = 0; x < fill_w; x++) {
+                row[x] = map_p[x] == LV_OPA_COVER ? opa : ((map_p[x] * opa) >> 8);
+            }
+        }
+        else {
+            lv_memcpy(row, map_p, fill_w);
+        }
+
+#if LV_DRAW_COMPLEX
+        /*Apply masks if any*/
+        if(mask_any) {
+            lv_draw_mask_res_t mask_res = lv_draw_mask_apply(row, fill_area.x1, y, fill_w);
+            if(mask_res == LV_DRAW_MASK_RES_TRANSP) {
+                lv_memset_00(row, fill_w);
+            }
+        }
+#endif
+
+        map_p += g->box_w;
+        mask_p += fill_w;
+        if(mask_p + fill_w > mask_buf_size || y == fill_area.y2) {
+            blend_area.y2 = y;
+            lv_draw_sw_blend(draw_ctx, &blend_dsc);
+            blend_area.y1 = y + 1;
+            mask_p = 0;
+        }
+    }
+
+    lv_mem_buf_release(mask_buf);
+}
+#endif /*LV_DRAW_SW_GLYPH_CACHE_SIZE*/
+
 #if LV_DRAW_COMPLEX && LV_USE_FONT_SUBPX
 static void draw_letter_subpx(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc, const lv_point_t * pos,
                               lv_font_glyph_dsc_t * g, const uint8_t * map_p)
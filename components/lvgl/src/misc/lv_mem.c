@@ -42,11 +42,27 @@
 /**********************
  *      TYPEDEFS
  **********************/
+#if LV_MEM_CUSTOM == 0
+typedef struct {
+    lv_tlsf_t tlsf;
+    uint8_t * start;        /*the pool, to tell which one a pointer belongs to*/
+    uint32_t size;
+    uint32_t cur_used;      /*blocks with their headers and the control structure, as the pool walk sees it*/
+    uint32_t max_used;
+    uint32_t alloc_cnt;
+    uint32_t fail_cnt;
+} mem_pool_t;
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 #if LV_MEM_CUSTOM == 0
+    static void pool_init(mem_pool_t * pool, void * mem, uint32_t size);
+    static void * pool_alloc(mem_pool_t * pool, size_t size);
+    static mem_pool_t * pool_of(void * p);
+    static mem_pool_t * pool_for(size_t size);
+    static void pool_monitor(mem_pool_t * pool, lv_mem_monitor_t * mon_p);
     static void lv_mem_walker(void * ptr, size_t size, int used, void * user);
 #endif
 
@@ -54,9 +70,10 @@
  *  STATIC VARIABLES
  **********************/
 #if LV_MEM_CUSTOM == 0
-    static lv_tlsf_t tlsf;
-    static uint32_t cur_used;
-    static uint32_t max_used;
+    static mem_pool_t pool_small;
+    #if LV_MEM_LARGE_SIZE
+        static mem_pool_t pool_large;
+    #endif
 #endif
 
 static uint32_t zero_mem = ZERO_MEM_SENTINEL; /*Give the address of this variable if 0 byte should be allocated*/
@@ -89,14 +106,18 @@ void lv_mem_init(void)
 
 #if LV_MEM_ADR == 0
 #ifdef LV_MEM_POOL_ALLOC
-    tlsf = lv_tlsf_create_with_pool((void *)LV_MEM_POOL_ALLOC(LV_MEM_SIZE), LV_MEM_SIZE);
+    pool_init(&pool_small, (void *)LV_MEM_POOL_ALLOC(LV_MEM_SIZE), LV_MEM_SIZE);
 #else
     /*Allocate a large array to store the dynamically allocated data*/
     static LV_ATTRIBUTE_LARGE_RAM_ARRAY MEM_UNIT work_mem_int[LV_MEM_SIZE / sizeof(MEM_UNIT)];
-    tlsf = lv_tlsf_create_with_pool((void *)work_mem_int, LV_MEM_SIZE);
+    pool_init(&pool_small, (void *)work_mem_int, LV_MEM_SIZE);
 #endif
 #else
-    tlsf = lv_tlsf_create_with_pool((void *)LV_MEM_ADR, LV_MEM_SIZE);
+    pool_init(&pool_small, (void *)LV_MEM_ADR, LV_MEM_SIZE);
+#endif
+
+#if LV_MEM_LARGE_SIZE
+    pool_init(&pool_large, (void *)LV_MEM_LARGE_POOL_ALLOC(LV_MEM_LARGE_SIZE), LV_MEM_LARGE_SIZE);
 #endif
 #endif
 
@@ -112,7 +133,10 @@ void lv_mem_init(void)
 void lv_mem_deinit(void)
 {
 #if LV_MEM_CUSTOM == 0
-    lv_tlsf_destroy(tlsf);
+    lv_tlsf_destroy(pool_small.tlsf);
+#if LV_MEM_LARGE_SIZE
+    lv_tlsf_destroy(pool_large.tlsf);
+#endif
     lv_mem_init();
 #endif
 }
@@ -131,7 +155,12 @@ void * lv_mem_alloc(size_t size)
     }
 
 #if LV_MEM_CUSTOM == 0
-    void * alloc = lv_tlsf_malloc(tlsf, size);
+    mem_pool_t * pool = pool_for(size);
+    void * alloc = pool_alloc(pool, size);
+#if LV_MEM_LARGE_SIZE
+    /*Better in the other pool than not at all*/
+    if(alloc == NULL) alloc = pool_alloc(pool == &pool_small ? &pool_large : &pool_small, size);
+#endif
 #else
     void * alloc = LV_MEM_CUSTOM_ALLOC(size);
 #endif
@@ -153,10 +182,6 @@ void * lv_mem_alloc(size_t size)
 #endif
 
     if(alloc) {
-#if LV_MEM_CUSTOM == 0
-        cur_used += size;
-        max_used = LV_MAX(cur_used, max_used);
-#endif
         MEM_TRACE("allocated at %p", alloc);
     }
     return alloc;
@@ -176,9 +201,9 @@ void lv_mem_free(void * data)
 #  if LV_MEM_ADD_JUNK
     lv_memset(data, 0xbb, lv_tlsf_block_size(data));
 #  endif
-    size_t size = lv_tlsf_free(tlsf, data);
-    if(cur_used > size) cur_used -= size;
-    else cur_used = 0;
+    mem_pool_t * pool = pool_of(data);
+    pool->cur_used -= lv_tlsf_block_size(data) + lv_tlsf_alloc_overhead();
+    lv_tlsf_free(pool->tlsf, data);
 #else
     LV_MEM_CUSTOM_FREE(data);
 #endif
@@ -203,7 +228,30 @@ void * lv_mem_realloc(void * data_p, size_t new_size)
     if(data_p == &zero_mem) return lv_mem_alloc(new_size);
 
 #if LV_MEM_CUSTOM == 0
-    void * new_p = lv_tlsf_realloc(tlsf, data_p, new_size);
+    if(data_p == NULL) return lv_mem_alloc(new_size);
+
+    mem_pool_t * pool = pool_of(data_p);
+    size_t old_size = lv_tlsf_block_size(data_p);
+    void * new_p = NULL;
+    /*In place if the new size still belongs to this pool, else moved to the other one*/
+    if(pool == pool_for(new_size)) {
+        new_p = lv_tlsf_realloc(pool->tlsf, data_p, new_size);
+        if(new_p) {
+            pool->cur_used = pool->cur_used + lv_tlsf_block_size(new_p) - old_size;
+            pool->max_used = LV_MAX(pool->cur_used, pool->max_used);
+            pool->alloc_cnt++;
+        }
+        else {
+            pool->fail_cnt++;
+        }
+    }
+    if(new_p == NULL) {
+        new_p = lv_mem_alloc(new_size);
+        if(new_p) {
+            lv_memcpy(new_p, data_p, LV_MIN(old_size, new_size));
+            lv_mem_free(data_p);
+        }
+    }
 #else
     void * new_p = LV_MEM_CUSTOM_REALLOC(data_p, new_size);
 #endif
@@ -224,15 +272,21 @@ lv_res_t lv_mem_test(void)
     }
 
 #if LV_MEM_CUSTOM == 0
-    if(lv_tlsf_check(tlsf)) {
+    if(lv_tlsf_check(pool_small.tlsf)) {
         LV_LOG_WARN("failed");
         return LV_RES_INV;
     }
 
-    if(lv_tlsf_check_pool(lv_tlsf_get_pool(tlsf))) {
+    if(lv_tlsf_check_pool(lv_tlsf_get_pool(pool_small.tlsf))) {
         LV_LOG_WARN("pool failed");
         return LV_RES_INV;
     }
+#if LV_MEM_LARGE_SIZE
+    if(lv_tlsf_check(pool_large.tlsf) || lv_tlsf_check_pool(lv_tlsf_get_pool(pool_large.tlsf))) {
+        LV_LOG_WARN("large pool failed");
+        return LV_RES_INV;
+    }
+#endif
 #endif
     MEM_TRACE("passed");
     return LV_RES_OK;
@@ -248,23 +302,20 @@ void lv_mem_monitor(lv_mem_monitor_t * mon_p)
     /*Init the data*/
     lv_memset(mon_p, 0, sizeof(lv_mem_monitor_t));
 #if LV_MEM_CUSTOM == 0
-    MEM_TRACE("begin");
-
-    lv_tlsf_walk_pool(lv_tlsf_get_pool(tlsf), lv_mem_walker, mon_p);
-
-    mon_p->total_size = LV_MEM_SIZE;
-    mon_p->used_pct = 100 - (100U * mon_p->free_size) / mon_p->total_size;
-    if(mon_p->free_size > 0) {
-        mon_p->frag_pct = mon_p->free_biggest_size * 100U / mon_p->free_size;
-        mon_p->frag_pct = 100 - mon_p->frag_pct;
-    }
-    else {
-        mon_p->frag_pct = 0; /*no fragmentation if all the RAM is used*/
-    }
-
-    mon_p->max_used = max_used;
+    pool_monitor(&pool_small, mon_p);
+#endif
+}
 
-    MEM_TRACE("finished");
+/**
+ * Give information about the pool of large allocations (`LV_MEM_LARGE_SIZE`),
+ * the same way as `lv_mem_monitor` does about the `LV_MEM_SIZE` pool
+ * @param mon_p pointer to a lv_mem_monitor_t variable, all 0 without such a pool
+ */
+void lv_mem_monitor_large(lv_mem_monitor_t * mon_p)
+{
+    lv_memset(mon_p, 0, sizeof(lv_mem_monitor_t));
+#if LV_MEM_CUSTOM == 0 && LV_MEM_LARGE_SIZE
+    pool_monitor(&pool_large, mon_p);
 #endif
 }
 
@@ -547,6 +598,73 @@ void LV_ATTRIBUTE_FAST_MEM lv_memset_ff(void * dst, size_t len)
  **********************/
 
 #if LV_MEM_CUSTOM == 0
+static void pool_init(mem_pool_t * pool, void * mem, uint32_t size)
+{
+    lv_memset(pool, 0, sizeof(mem_pool_t));
+    LV_ASSERT_MALLOC(mem);
+    pool->tlsf = lv_tlsf_create_with_pool(mem, size);
+    pool->start = mem;
+    pool->size = size;
+    pool->cur_used = lv_tlsf_size() + lv_tlsf_pool_overhead();
+    pool->max_used = pool->cur_used;
+}
+
+static void * pool_alloc(mem_pool_t * pool, size_t size)
+{
+    void * alloc = lv_tlsf_malloc(pool->tlsf, size);
+    if(alloc == NULL) {
+        pool->fail_cnt++;
+        return NULL;
+    }
+    pool->cur_used += lv_tlsf_block_size(alloc) + lv_tlsf_alloc_overhead();
+    pool->max_used = LV_MAX(pool->cur_used, pool->max_used);
+    pool->alloc_cnt++;
+    return alloc;
+}
+
+static mem_pool_t * pool_of(void * p)
+{
+#if LV_MEM_LARGE_SIZE
+    if((uint8_t *)p >= pool_large.start && (uint8_t *)p < pool_large.start + pool_large.size) return &pool_large;
+#else
+    LV_UNUSED(p);
+#endif
+    return &pool_small;
+}
+
+static mem_pool_t * pool_for(size_t size)
+{
+#if LV_MEM_LARGE_SIZE
+    if(size >= LV_MEM_LARGE_MIN) return &pool_large;
+#else
+    LV_UNUSED(size);
+#endif
+    return &pool_small;
+}
+
+static void pool_monitor(mem_pool_t * pool, lv_mem_monitor_t * mon_p)
+{
+    MEM_TRACE("begin");
+
+    lv_tlsf_walk_pool(lv_tlsf_get_pool(pool->tlsf), lv_mem_walker, mon_p);
+
+    mon_p->total_size = pool->size;
+    mon_p->used_pct = 100 - (100U * mon_p->free_size) / mon_p->total_size;
+    if(mon_p->free_size > 0) {
+        mon_p->frag_pct = mon_p->free_biggest_size * 100U / mon_p->free_size;
+        mon_p->frag_pct = 100 - mon_p->frag_pct;
+    }
+    else {
+        mon_p->frag_pct = 0; /*no fragmentation if all the RAM is used*/
+    }
+
+    mon_p->max_used = pool->max_used;
+    mon_p->alloc_cnt = pool->alloc_cnt;
+    mon_p->fail_cnt = pool->fail_cnt;
+
+    MEM_TRACE("finished");
+}
+
 static void lv_mem_walker(void * ptr, size_t size, int used, void * user)
 {
     LV_UNUSED(ptr);
@@ -25,6 +25,18 @@ extern "C" {
  *      DEFINES
  *********************/
 
+/*With `LV_MEM_CUSTOM == 0`: a second pool of `LV_MEM_LARGE_SIZE` bytes (0: none) for allocations of
+ *`LV_MEM_LARGE_MIN` bytes or more, so large buffers can live in a different (slower, bigger) memory than
+ *the small objects in the `LV_MEM_SIZE` pool. Each pool takes the other one's allocations when full.
+ *`LV_MEM_LARGE_POOL_ALLOC(size)` gives the memory, from `LV_MEM_POOL_INCLUDE` if set.*/
+#ifndef LV_MEM_LARGE_SIZE
+#define LV_MEM_LARGE_SIZE 0
+#endif
+
+#ifndef LV_MEM_LARGE_MIN
+#define LV_MEM_LARGE_MIN (4U * 1024U)
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -39,6 +51,8 @@ typedef struct {
     uint32_t free_biggest_size;
     uint32_t used_cnt;
     uint32_t max_used; /**< Max size of Heap memory used*/
+    uint32_t alloc_cnt; /**< Allocations and reallocations served since `lv_mem_init`, for the allocation rate*/
+    uint32_t fail_cnt; /**< Allocations that didn't fit, handed to the other pool if there is one*/
     uint8_t used_pct; /**< Percentage used*/
     uint8_t frag_pct; /**< Amount of fragmentation*/
 } lv_mem_monitor_t;
@@ -101,6 +115,13 @@ lv_res_t lv_mem_test(void);
  */
 void lv_mem_monitor(lv_mem_monitor_t * mon_p);
 
+/**
+ * Give information about the pool of large allocations (`LV_MEM_LARGE_SIZE`),
+ * the same way as `lv_mem_monitor` does about the `LV_MEM_SIZE` pool
+ * @param mon_p pointer to a lv_mem_monitor_t variable, all 0 without such a pool
+ */
+void lv_mem_monitor_large(lv_mem_monitor_t * mon_p);
+
 /**
  * Get a temporal buffer with the given size.
  * @param size the required size
@@ -6,11 +6,13 @@
 #include "lv_mem.h"
 #include "lv_log.h"
 #include "lv_assert.h"
+#include "lv_math.h"
 
 #undef  printf
 #define printf LV_LOG_ERROR
 
-#define TLSF_MAX_POOL_SIZE LV_MEM_SIZE
+/*Both pools of lv_mem.c*/
+#define TLSF_MAX_POOL_SIZE LV_MAX(LV_MEM_SIZE, LV_MEM_LARGE_SIZE)
 
 #if !defined(_DEBUG)
     #define _DEBUG 0
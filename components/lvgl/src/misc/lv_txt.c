@@ -13,6 +13,9 @@
 #include "lv_log.h"
 #include "lv_mem.h"
 #include "lv_assert.h"
+#if LV_TXT_SIZE_CACHE_ENTRIES && defined(LV_TXT_SIZE_CACHE_INCLUDE)
+    #include LV_TXT_SIZE_CACHE_INCLUDE
+#endif
 
 /*********************
  *      DEFINES
@@ -22,10 +25,25 @@
 /**********************
  *      TYPEDEFS
  **********************/
+#if LV_TXT_SIZE_CACHE_ENTRIES
+typedef struct {
+    const lv_font_t * font;         /*NULL: unused*/
+    uint32_t last_use;
+    lv_point_t size;
+    lv_coord_t letter_space;
+    lv_coord_t line_space;
+    lv_coord_t max_width;
+    lv_text_flag_t flag;
+    uint16_t len;
+    char text[LV_TXT_SIZE_CACHE_TEXT_LEN];
+} txt_size_entry_t;
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void txt_get_size(lv_point_t * size_res, const char * text, const lv_font_t * font, lv_coord_t letter_space,
+                         lv_coord_t line_space, lv_coord_t max_width, lv_text_flag_t flag);
 
 #if LV_TXT_ENC == LV_TXT_ENC_UTF8
     static uint8_t lv_txt_utf8_size(const char * str);
@@ -49,6 +67,11 @@
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if LV_TXT_SIZE_CACHE_ENTRIES
+    static txt_size_entry_t * size_cache;
+    static uint32_t size_cache_clock;
+    static lv_txt_size_cache_stats_t size_cache_stats;
+#endif
 
 /**********************
  *  GLOBAL VARIABLES
@@ -91,50 +114,79 @@
 void lv_txt_get_size(lv_point_t * size_res, const char * text, const lv_font_t * font, lv_coord_t letter_space,
                      lv_coord_t line_space, lv_coord_t max_width, lv_text_flag_t flag)
 {
-    size_res->x = 0;
-    size_res->y = 0;
-
-    if(text == NULL) return;
-    if(font == NULL) return;
-
-    if(flag & LV_TEXT_FLAG_EXPAND) max_width = LV_COORD_MAX;
-
-    uint32_t line_start     = 0;
-    uint32_t new_line_start = 0;
-    uint16_t letter_height = lv_font_get_line_height(font);
+#if LV_TXT_SIZE_CACHE_ENTRIES
+    if(text == NULL || font == NULL) {
+        txt_get_size(size_res, text, font, letter_space, line_space, max_width, flag);
+        return;
+    }
 
-    /*Calc. the height and longest line*/
-    while(text[line_start] != '\0') {
-        new_line_start += _lv_txt_get_next_line(&text[line_start], font, letter_space, max_width, NULL, flag);
+    uint32_t len = 0;
+    while(len < LV_TXT_SIZE_CACHE_TEXT_LEN && text[len] != '\0') len++;
+    if(len == LV_TXT_SIZE_CACHE_TEXT_LEN) {
+        size_cache_stats.bypass++;
+        txt_get_size(size_res, text, font, letter_space, line_space, max_width, flag);
+        return;
+    }
 
-        if((unsigned long)size_res->y + (unsigned long)letter_height + (unsigned long)line_space > LV_MAX_OF(lv_coord_t)) {
-            LV_LOG_WARN("lv_txt_get_size: integer overflow while calculating text height");
+    if(size_cache == NULL) {
+        size_cache = LV_TXT_SIZE_CACHE_ALLOC(sizeof(txt_size_entry_t) * LV_TXT_SIZE_CACHE_ENTRIES);
+        if(size_cache == NULL) {
+            txt_get_size(size_res, text, font, letter_space, line_space, max_width, flag);
             return;
         }
-        else {
-            size_res->y += letter_height;
-            size_res->y += line_space;
-        }
+        lv_memset_00(size_cache, sizeof(txt_size_entry_t) * LV_TXT_SIZE_CACHE_ENTRIES);
+    }
 
-        /*Calculate the longest line*/
-        lv_coord_t act_line_length = lv_txt_get_width(&text[line_start], new_line_start - line_start, font, letter_space,
-                                                      flag);
+    /*One entry for all widths when they are ignored*/
+    if(flag & LV_TEXT_FLAG_EXPAND) max_width = LV_COORD_MAX;
 
-        size_res->x = LV_MAX(act_line_length, size_res->x);
-        line_start  = new_line_start;
+    size_cache_clock++;
+    txt_size_entry_t * oldest = &size_cache[0];
+    uint32_t i;
+    for(i = 0; i < LV_TXT_SIZE_CACHE_ENTRIES; i++) {
+        txt_size_entry_t * e = &size_cache[i];
+        if(e->font == font && e->len == len && e->max_width == max_width && e->flag == flag &&
+           e->letter_space == letter_space && e->line_space == line_space && memcmp(e->text, text, len) == 0) {
+            e->last_use = size_cache_clock;
+            *size_res = e->size;
+            size_cache_stats.hits++;
+            return;
+        }
+        if(e->last_use < oldest->last_use) oldest = e;
     }
 
-    /*Make the text one line taller if the last character is '\n' or '\r'*/
-    if((line_start != 0) && (text[line_start - 1] == '\n' || text[line_start - 1] == '\r')) {
-        size_res->y += letter_height + line_space;
-    }
+    txt_get_size(size_res, text, font, letter_space, line_space, max_width, flag);
+
+    size_cache_stats.misses++;
+    if(oldest->font) size_cache_stats.evictions++;
+    else size_cache_stats.entries++;
+    oldest->font = font;
+    oldest->last_use = size_cache_clock;
+    oldest->size = *size_res;
+    oldest->letter_space = letter_space;
+    oldest->line_space = line_space;
+    oldest->max_width = max_width;
+    oldest->flag = flag;
+    oldest->len = (uint16_t)len;
+    lv_memcpy(oldest->text, text, len);
+#else
+    txt_get_size(size_res, text, font, letter_space, line_space, max_width, flag);
+#endif
+}
 
-    /*Correction with the last line space or set the height manually if the text is empty*/
-    if(size_res->y == 0)
-        size_res->y = letter_height;
-    else
-        size_res->y -= line_space;
+#if LV_TXT_SIZE_CACHE_ENTRIES
+void lv_txt_size_cache_clear(void)
+{
+    if(size_cache == NULL) return;
+    lv_memset_00(size_cache, sizeof(txt_size_entry_t) * LV_TXT_SIZE_CACHE_ENTRIES);
+    size_cache_stats.entries = 0;
+}
+
+void lv_txt_size_cache_get_stats(lv_txt_size_cache_stats_t * stats)
+{
+    *stats = size_cache_stats;
 }
+#endif
 
 /**
  * Get the next word of text. A word is delimited by break characters.
@@ -496,6 +548,58 @@ void _lv_txt_encoded_letter_next_2(const char * txt, uint32_t * letter, uint32_t
     *letter_next = *letter != '\0' ? _lv_txt_encoded_next(&txt[*ofs], NULL) : 0;
 }
 
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void txt_get_size(lv_point_t * size_res, const char * text, const lv_font_t * font, lv_coord_t letter_space,
+                         lv_coord_t line_space, lv_coord_t max_width, lv_text_flag_t flag)
+{
+    size_res->x = 0;
+    size_res->y = 0;
+
+    if(text == NULL) return;
+    if(font == NULL) return;
+
+    if(flag & LV_TEXT_FLAG_EXPAND) max_width = LV_COORD_MAX;
+
+    uint32_t line_start     = 0;
+    uint32_t new_line_start = 0;
+    uint16_t letter_height = lv_font_get_line_height(font);
+
+    /*Calc. the height and longest line*/
+    while(text[line_start] != '\0') {
+        new_line_start += _lv_txt_get_next_line(&text[line_start], font, letter_space, max_width, NULL, flag);
+
+        if((unsigned long)size_res->y + (unsigned long)letter_height + (unsigned long)line_space > LV_MAX_OF(lv_coord_t)) {
+            LV_LOG_WARN("lv_txt_get_size: integer overflow while calculating text height");
+            return;
+        }
+        else {
+            size_res->y += letter_height;
+            size_res->y += line_space;
+        }
+
+        /*Calculate the longest line*/
+        lv_coord_t act_line_length = lv_txt_get_width(&text[line_start], new_line_start - line_start, font, letter_space,
+                                                      flag);
+
+        size_res->x = LV_MAX(act_line_length, size_res->x);
+        line_start  = new_line_start;
+    }
+
+    /*Make the text one line taller if the last character is '\n' or '\r'*/
+    if((line_start != 0) && (text[line_start - 1] == '\n' || text[line_start - 1] == '\r')) {
+        size_res->y += letter_height + line_space;
+    }
+
+    /*Correction with the last line space or set the height manually if the text is empty*/
+    if(size_res->y == 0)
+        size_res->y = letter_height;
+    else
+        size_res->y -= line_space;
+}
+
 #if LV_TXT_ENC == LV_TXT_ENC_UTF8
 /*******************************
  *   UTF-8 ENCODER/DECODER
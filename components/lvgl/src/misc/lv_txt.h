@@ -32,6 +32,21 @@ extern "C" {
 #define LV_TXT_ENC_UTF8 1
 #define LV_TXT_ENC_ASCII 2
 
+/*Sizes measured by `lv_txt_get_size` of texts shorter than `LV_TXT_SIZE_CACHE_TEXT_LEN` bytes are
+ *kept in a cache of this many entries, the least recently used is replaced. 0: off*/
+#ifndef LV_TXT_SIZE_CACHE_ENTRIES
+#define LV_TXT_SIZE_CACHE_ENTRIES 0
+#endif
+
+#ifndef LV_TXT_SIZE_CACHE_TEXT_LEN
+#define LV_TXT_SIZE_CACHE_TEXT_LEN 48
+#endif
+
+/*Where the cache is kept, allocated on first use. `LV_TXT_SIZE_CACHE_INCLUDE` may name the header of the allocator.*/
+#ifndef LV_TXT_SIZE_CACHE_ALLOC
+#define LV_TXT_SIZE_CACHE_ALLOC(size) lv_mem_alloc(size)
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -65,6 +80,16 @@ enum {
 };
 typedef uint8_t lv_text_align_t;
 
+#if LV_TXT_SIZE_CACHE_ENTRIES
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;        /**< texts measured and added*/
+    uint32_t evictions;
+    uint32_t bypass;        /**< texts too long for the cache*/
+    uint32_t entries;
+} lv_txt_size_cache_stats_t;
+#endif
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -83,6 +108,19 @@ typedef uint8_t lv_text_align_t;
 void lv_txt_get_size(lv_point_t * size_res, const char * text, const lv_font_t * font, lv_coord_t letter_space,
                      lv_coord_t line_space, lv_coord_t max_width, lv_text_flag_t flag);
 
+#if LV_TXT_SIZE_CACHE_ENTRIES
+/**
+ * Drop the sizes cached by `lv_txt_get_size`, e.g. before a font is freed. The statistics are kept.
+ */
+void lv_txt_size_cache_clear(void);
+
+/**
+ * Get the statistics of the text size cache since start.
+ * @param stats filled with the counters
+ */
+void lv_txt_size_cache_get_stats(lv_txt_size_cache_stats_t * stats);
+#endif
+
 /**
  * Get the next line of text. Check line length and break chars too.
  * @param txt a '\0' terminated string
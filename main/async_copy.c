@@ -0,0 +1,167 @@
+/* async_copy.c */
+#include "async_copy.h"
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_async_memcpy.h"
+#include "esp_cache.h"
+#include "esp_memory_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "ASYNC_COPY";
+
+// Cache line of the PSRAM data cache at its largest (16, 32 or 64 bytes on the S3)
+#define ASYNC_COPY_PSRAM_ALIGN  ASYNC_COPY_ALIGN_MAX
+// Bursts of the GDMA into internal RAM
+#define ASYNC_COPY_SRAM_ALIGN   (16)
+
+typedef struct {
+    void *dst;
+    size_t n;
+} async_copy_job_t;
+
+struct async_copy_s {
+    async_memcpy_handle_t mcp;
+    SemaphoreHandle_t done_sem;     // given from the ISR after each copy
+    size_t backlog;
+    uint32_t started;
+    volatile uint32_t done;         // copies finished by the DMA
+    uint32_t reaped;                // copies whose destination was invalidated in the cache since
+    async_copy_job_t *jobs;         // destination of copy `seq` at [seq % backlog]
+};
+
+static inline bool seq_done(uint32_t done, uint32_t seq)
+{
+    return (int32_t)(done - seq) >= 0;
+}
+
+static bool async_copy_done_isr(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *cb_args)
+{
+    async_copy_t *ac = cb_args;
+    BaseType_t woken = pdFALSE;
+    ac->done++;
+    xSemaphoreGiveFromISR(ac->done_sem, &woken);
+    return woken == pdTRUE;
+}
+
+// Drop what the cache may hold of destinations written since, before the CPU reads them
+static void async_copy_reap(async_copy_t *ac)
+{
+    const uint32_t done = ac->done;
+    while (ac->reaped != done) {
+        ac->reaped++;
+        const async_copy_job_t *job = &ac->jobs[ac->reaped % ac->backlog];
+        if (esp_ptr_external_ram(job->dst)) {
+            esp_cache_msync(job->dst, job->n, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+        }
+    }
+}
+
+esp_err_t async_copy_new(size_t backlog, async_copy_t **ret)
+{
+    esp_err_t err = ESP_OK;
+    ESP_RETURN_ON_FALSE(backlog > 0 && ret, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    async_copy_t *ac = calloc(1, sizeof(async_copy_t));
+    ESP_RETURN_ON_FALSE(ac, ESP_ERR_NO_MEM, TAG, "no memory for the engine");
+    ac->backlog = backlog;
+    ac->jobs = calloc(backlog, sizeof(async_copy_job_t));
+    ac->done_sem = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(ac->jobs && ac->done_sem, ESP_ERR_NO_MEM, fail, TAG, "no memory for the engine");
+
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog = backlog;
+    ESP_GOTO_ON_ERROR(esp_async_memcpy_install(&config, &ac->mcp), fail, TAG, "no DMA channel");
+
+    *ret = ac;
+    return ESP_OK;
+
+fail:
+    if (ac->done_sem) {
+        vSemaphoreDelete(ac->done_sem);
+    }
+    free(ac->jobs);
+    free(ac);
+    return err;
+}
+
+void async_copy_del(async_copy_t *ac)
+{
+    if (ac == NULL) {
+        return;
+    }
+    async_copy_wait(ac, ac->started);
+    esp_async_memcpy_uninstall(ac->mcp);
+    vSemaphoreDelete(ac->done_sem);
+    free(ac->jobs);
+    free(ac);
+}
+
+size_t async_copy_align(const void *ptr)
+{
+    return esp_ptr_external_ram(ptr) ? ASYNC_COPY_PSRAM_ALIGN : ASYNC_COPY_SRAM_ALIGN;
+}
+
+static bool async_copy_reachable(const void *ptr, size_t n)
+{
+    const size_t align = async_copy_align(ptr);
+    return (esp_ptr_external_ram(ptr) || esp_ptr_dma_capable(ptr)) &&
+           ((uintptr_t)ptr % align) == 0 && (n % align) == 0;
+}
+
+bool async_copy_can(const void *dst, const void *src, size_t n)
+{
+    return n > 0 && async_copy_reachable(dst, n) && async_copy_reachable(src, n);
+}
+
+esp_err_t async_copy_start(async_copy_t *ac, void *dst, const void *src, size_t n, uint32_t *seq)
+{
+    ESP_RETURN_ON_FALSE(async_copy_can(dst, src, n), ESP_ERR_INVALID_ARG, TAG, "can't copy %p -> %p (%u)",
+                        src, dst, (unsigned)n);
+
+    // Room in the queue of the driver
+    if (ac->started - ac->done >= ac->backlog) {
+        async_copy_wait(ac, ac->started - ac->backlog + 1);
+    }
+    // The slot of the new copy is free once the copy that had it is reaped
+    async_copy_reap(ac);
+
+    // What the CPU wrote to the source must be in memory, and no dirty line of the destination may
+    // be written back over the copy later on
+    if (esp_ptr_external_ram(src)) {
+        esp_cache_msync((void *)src, n, ESP_CACHE_MSYNC_FLAG_DIR_C2M);
+    }
+    if (esp_ptr_external_ram(dst)) {
+        esp_cache_msync(dst, n, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_INVALIDATE);
+    }
+
+    const uint32_t next = ac->started + 1;
+    ac->jobs[next % ac->backlog] = (async_copy_job_t) { .dst = dst, .n = n };
+    ESP_RETURN_ON_ERROR(esp_async_memcpy(ac->mcp, dst, (void *)src, n, async_copy_done_isr, ac), TAG, "queue copy");
+    ac->started = next;
+    *seq = next;
+    return ESP_OK;
+}
+
+bool async_copy_is_done(async_copy_t *ac, uint32_t seq)
+{
+    if (!seq_done(ac->done, seq)) {
+        return false;
+    }
+    async_copy_reap(ac);
+    return true;
+}
+
+void async_copy_wait(async_copy_t *ac, uint32_t seq)
+{
+    while (!seq_done(ac->done, seq)) {
+        xSemaphoreTake(ac->done_sem, portMAX_DELAY);
+    }
+    async_copy_reap(ac);
+}
+
+uint32_t async_copy_last(const async_copy_t *ac)
+{
+    return ac->started;
+}
@@ -0,0 +1,85 @@
+/* async_copy.h */
+
+/**
+ * @file
+ * @brief Memory copies done by the GDMA memcpy engine while the CPU goes on
+ *
+ * Copies are queued and run one after the other in the order they were started, so a copy may
+ * read what an earlier one wrote. Each gets a sequence number; async_copy_wait() blocks until that
+ * copy and all before it are done. The CPU must neither read the destination nor write the source
+ * or destination of a copy until it is done.
+ *
+ * Addresses and lengths must be multiples of async_copy_align() for the memory they are in: the
+ * data cache is written back and invalidated around copies to and from PSRAM, which only works on
+ * whole cache lines. Memory the DMA can't reach (flash) is refused by async_copy_can().
+ *
+ * tools/ui_bench/async_copy_host.c is a stand-in with the same API for the host. It copies only
+ * when a copy is waited for, so anything that touches memory of a copy too early shows up there.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/* Largest alignment async_copy_align() asks for; buffers meant for the engine are allocated with it */
+#define ASYNC_COPY_ALIGN_MAX    (64)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct async_copy_s async_copy_t;
+
+/**
+ * @brief Set up the engine
+ *
+ * @param backlog Copies queued at most; async_copy_start() waits for the oldest beyond that
+ * @param ret     The engine
+ * @return ESP_ERR_NO_MEM or the error of the DMA driver
+ */
+esp_err_t async_copy_new(size_t backlog, async_copy_t **ret);
+
+/**
+ * @brief Wait for all copies and release the engine
+ */
+void async_copy_del(async_copy_t *ac);
+
+/**
+ * @brief Alignment in bytes of addresses and lengths of copies in the memory at `ptr`
+ */
+size_t async_copy_align(const void *ptr);
+
+/**
+ * @brief Whether the engine can copy `n` bytes from `src` to `dst` (memory and alignment)
+ */
+bool async_copy_can(const void *dst, const void *src, size_t n);
+
+/**
+ * @brief Queue a copy of `n` bytes from `src` to `dst`
+ *
+ * @param seq Sequence number of the copy, for async_copy_wait()
+ * @return ESP_ERR_INVALID_ARG if async_copy_can() is false, or the error of the DMA driver
+ */
+esp_err_t async_copy_start(async_copy_t *ac, void *dst, const void *src, size_t n, uint32_t *seq);
+
+/**
+ * @brief Whether copy `seq` is done, without waiting
+ */
+bool async_copy_is_done(async_copy_t *ac, uint32_t seq);
+
+/**
+ * @brief Wait until copy `seq` and all copies started before it are done
+ */
+void async_copy_wait(async_copy_t *ac, uint32_t seq);
+
+/**
+ * @brief Sequence number of the last copy started, 0 before the first
+ */
+uint32_t async_copy_last(const async_copy_t *ac);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+/* blend_bench.c */
+#include "blend_bench.h"
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+static const char *TAG = "BLEND_BENCH";
+
+#define BLEND_BENCH_PX      (BLEND_BENCH_W * BLEND_BENCH_H)
+#define BLEND_BENCH_REPS    10
+
+typedef struct {
+    const char *name;
+    bool src;           // copy the source image instead of filling
+    bool mask;          // through the anti-aliased mask
+    lv_opa_t opa;
+} blend_case_t;
+
+static const blend_case_t cases[BLEND_BENCH_CASES] = {
+    { "fill",          false, false, LV_OPA_COVER },
+    { "fill opa",      false, false, LV_OPA_60 },
+    { "fill mask",     false, true,  LV_OPA_COVER },
+    { "fill mask opa", false, true,  LV_OPA_60 },
+    { "copy",          true,  false, LV_OPA_COVER },
+};
+
+esp_err_t blend_bench_run(blend_bench_fn_t blend, lv_color_t *dest, blend_bench_result_t *res) {
+    lv_color_t *src = heap_caps_malloc(BLEND_BENCH_PX * sizeof(lv_color_t), MALLOC_CAP_DEFAULT);
+    lv_opa_t *mask = heap_caps_malloc(BLEND_BENCH_PX, MALLOC_CAP_DEFAULT);
+    if (src == NULL || mask == NULL) {
+        heap_caps_free(src);
+        heap_caps_free(mask);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // A background with few equal neighbours, so no case gets away with reusing the last result,
+    // and a mask that is a third transparent, a third edge ramps and a third opaque like glyphs
+    for (uint32_t i = 0; i < BLEND_BENCH_PX; i++) {
+        uint32_t x = i % BLEND_BENCH_W, y = i / BLEND_BENCH_W;
+        src[i] = lv_color_make((uint8_t)(x * 2), (uint8_t)(y * 3), (uint8_t)(x + y));
+        uint32_t m = (x + 2 * y) % 96;
+        mask[i] = m < 32 ? LV_OPA_TRANSP : m < 64 ? (m - 32) * 8 : LV_OPA_COVER;
+    }
+
+    lv_area_t area = { 0, 0, BLEND_BENCH_W - 1, BLEND_BENCH_H - 1 };
+    lv_draw_ctx_t draw_ctx = {
+        .buf = dest,
+        .buf_area = &area,
+        .clip_area = &area,
+    };
+
+    // The blender reads the driver settings of the display being refreshed
+    lv_disp_t *refreshing = _lv_refr_get_disp_refreshing();
+    _lv_refr_set_disp_refreshing(lv_disp_get_default());
+
+    for (int c = 0; c < BLEND_BENCH_CASES; c++) {
+        lv_draw_sw_blend_dsc_t dsc = {
+            .blend_area = &area,
+            .src_buf = cases[c].src ? src : NULL,
+            .color = lv_color_make(0x21, 0x96, 0xF3),
+            .mask_buf = cases[c].mask ? mask : NULL,
+            .mask_res = cases[c].mask ? LV_DRAW_MASK_RES_CHANGED : LV_DRAW_MASK_RES_FULL_COVER,
+            .mask_area = &area,
+            .opa = cases[c].opa,
+            .blend_mode = LV_BLEND_MODE_NORMAL,
+        };
+
+        lv_memcpy(dest, src, BLEND_BENCH_PX * sizeof(lv_color_t));
+        int64_t start = esp_timer_get_time();
+        for (int r = 0; r < BLEND_BENCH_REPS; r++) {
+            blend(&draw_ctx, &dsc);
+        }
+        res[c].name = cases[c].name;
+        res[c].px = BLEND_BENCH_PX * BLEND_BENCH_REPS;
+        res[c].us = esp_timer_get_time() - start;
+    }
+
+    _lv_refr_set_disp_refreshing(refreshing);
+    heap_caps_free(src);
+    heap_caps_free(mask);
+    return ESP_OK;
+}
+
+void blend_bench_log(void) {
+    static const struct {
+        const char *name;
+        uint32_t caps;
+    } mem[] = {
+        { "internal RAM", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT },
+        { "PSRAM",        MALLOC_CAP_SPIRAM },
+    };
+
+    for (size_t m = 0; m < sizeof(mem) / sizeof(mem[0]); m++) {
+        blend_bench_result_t res[BLEND_BENCH_CASES];
+        lv_color_t *dest = heap_caps_malloc(BLEND_BENCH_PX * sizeof(lv_color_t), mem[m].caps);
+        esp_err_t err = dest != NULL ? blend_bench_run(lv_draw_sw_blend_basic, dest, res) : ESP_ERR_NO_MEM;
+        heap_caps_free(dest);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "%s: no memory for %dx%d px", mem[m].name, BLEND_BENCH_W, BLEND_BENCH_H);
+            continue;
+        }
+        for (int c = 0; c < BLEND_BENCH_CASES; c++) {
+            ESP_LOGI(TAG, "%-12s %-13s %6.1f Mpx/s (%" PRIu32 " px in %" PRId64 " us)", mem[m].name, res[c].name,
+                     res[c].us > 0 ? (double)res[c].px / (double)res[c].us : 0.0, res[c].px, res[c].us);
+        }
+    }
+}
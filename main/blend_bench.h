@@ -0,0 +1,59 @@
+/* blend_bench.h */
+
+/**
+ * @file
+ * @brief Throughput of the LVGL software blender
+ *
+ * Times the blend cases the UI draws most (solid fill, fill with opacity, fill through an
+ * anti-aliased A8 mask with and without opacity, opaque copy) on a 480x80 area and reports
+ * Mpixel/s. On the device it runs once at startup when BLEND_BENCH is 1
+ * (`idf.py -DBLEND_BENCH=1 build`, see main/CMakeLists.txt); tools/ui_bench/blend_check runs the
+ * same cases on the host. Call with the LVGL mutex held and a display registered.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "lvgl.h"
+#include "src/draw/sw/lv_draw_sw.h"
+
+#ifndef BLEND_BENCH
+#define BLEND_BENCH 0
+#endif
+
+#define BLEND_BENCH_W       480
+#define BLEND_BENCH_H       80
+#define BLEND_BENCH_CASES   5
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Blend function under test, `lv_draw_sw_blend_basic` or a build of it */
+typedef void (*blend_bench_fn_t)(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc);
+
+typedef struct {
+    const char *name;
+    uint32_t px;        // pixels blended
+    int64_t us;         // time taken
+} blend_bench_result_t;
+
+/**
+ * Run every case on `dest`, BLEND_BENCH_W x BLEND_BENCH_H pixels.
+ * @param blend  Blend function to time
+ * @param res    BLEND_BENCH_CASES results
+ * @return ESP_ERR_NO_MEM if the source and mask buffers could not be allocated
+ */
+esp_err_t blend_bench_run(blend_bench_fn_t blend, lv_color_t *dest, blend_bench_result_t *res);
+
+/**
+ * Run the cases into a buffer of internal RAM and one of PSRAM (where the port keeps its frame
+ * buffer) and log the results.
+ */
+void blend_bench_log(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -12,6 +12,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <stdio.h>
+#include <inttypes.h>
 #include <string.h>
 #include <stdlib.h>
 #include <dirent.h>
@@ -20,6 +21,11 @@
 #include "dns_server.h" 
 #include <lwip/inet.h>
 #include "lvgl.h"
+#include "lv_port.h"
+#include "lv_port_profile.h"
+#include "display.h"
+#include "esp_bsp.h"
+#include "mem_budget.h"
 
 static const char *TAG = "cfg_srv";
 
@@ -63,15 +69,8 @@ esp_err_t wifi_ap_init(void)
 
     // 1) One-time subsystems init
     if (!subsystems_inited) {
-        // NVS
-        err = nvs_flash_init();
-        if (err == ESP_ERR_NVS_NO_FREE_PAGES ||
-            err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-            ESP_LOGW(TAG, "Erasing NVS and retrying");
-            ESP_ERROR_CHECK(nvs_flash_erase());
-            err = nvs_flash_init();
-        }
-        ESP_ERROR_CHECK(err);
+        // NVS, usually already up: the display reads its bus tuning before
+        ESP_ERROR_CHECK(config_storage_init());
 
         // TCP/IP stack + default event loop
         ESP_ERROR_CHECK(esp_netif_init());
@@ -298,13 +297,82 @@ static esp_err_t handle_screenshot(httpd_req_t *req) {
     return ESP_OK;
 }
 
+#if LVGL_PORT_PROFILE
+// Render profile of the last window as text; ?on=0|1 switches profiling, ?overlay=0|1 the dirty area outlines
+static esp_err_t handle_profile(httpd_req_t *req) {
+    char query[32], val[4];
+    bool on = true, overlay = false, set = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "on", val, sizeof(val)) == ESP_OK) {
+            on = (val[0] == '1');
+            set = true;
+        }
+        if (httpd_query_key_value(query, "overlay", val, sizeof(val)) == ESP_OK) {
+            overlay = (val[0] == '1');
+            set = true;
+        }
+    }
+
+    static char report[1152];
+    lvgl_port_lock(0);
+    if (set) {
+        lvgl_port_profile_enable(on, overlay);
+    }
+    size_t len = lvgl_port_profile_report(report, sizeof(report));
+    lvgl_port_unlock();
+
+    // Panel transfer queue: how full it runs and how long LVGL waits on the bus
+    bsp_display_trans_stats_t trans;
+    if (bsp_display_get_trans_stats(&trans) == ESP_OK && len < sizeof(report)) {
+        int n = snprintf(report + len, sizeof(report) - len,
+                         "panel queue %" PRIu32 " deep: %" PRIu32 " queued, %" PRIu32 " failed, occupancy %" PRIu32
+                         ".%02" PRIu32 " max %" PRIu32 ", %" PRIu32 " stalls %" PRIu64 " us (max %" PRIu32
+                         " us), bus busy %" PRIu64 " ms, LVGL waits %" PRIu32 " us/frame\n",
+                         trans.queue_depth, trans.queued, trans.failed, trans.occupancy_pct / 100,
+                         trans.occupancy_pct % 100, trans.occupancy_max, trans.stalls, trans.stall_us,
+                         trans.stall_max_us, trans.busy_us / 1000, trans.frame_wait_us);
+        if (n > 0) {
+            len = (len + n < sizeof(report)) ? len + n : sizeof(report) - 1;
+        }
+    }
+
+#ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
+    // Touch: controller reads, readings queued to LVGL and how old they are when LVGL takes them
+    lvgl_port_touch_stats_t touch;
+    if (lvgl_port_get_touch_stats(bsp_display_get_input_dev(), &touch) == ESP_OK && len < sizeof(report)) {
+        int n = snprintf(report + len, sizeof(report) - len,
+                         "touch %" PRIu32 " reads, %" PRIu32 " queued, %" PRIu32 " merged, latency %" PRIu32 " us\n",
+                         touch.reads, touch.events, touch.merged, touch.latency_us);
+        if (n > 0) {
+            len = (len + n < sizeof(report)) ? len + n : sizeof(report) - 1;
+        }
+    }
+#endif
+
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_send(req, report, len);
+    return ESP_OK;
+}
+#endif
+
+// Memory budget: heaps, LVGL's pools, large buffers and task stacks as text
+static esp_err_t handle_memory(httpd_req_t *req) {
+    static char report[1536];
+    size_t len = mem_budget_report(report, sizeof(report));
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_send(req, report, len);
+    return ESP_OK;
+}
+
 // Start the HTTP configuration server
 esp_err_t config_server_start(void) {
     mount_spiffs();
     httpd_handle_t server = NULL;
     httpd_config_t cfg = HTTPD_DEFAULT_CONFIG();
     cfg.uri_match_fn = httpd_uri_match_wildcard;
+    cfg.task_caps = mem_budget_caps(MEM_BUDGET_HTTPD_STACK);
     ESP_ERROR_CHECK(httpd_start(&server, &cfg));
+    mem_budget_add_task("httpd", cfg.stack_size);
 
     httpd_uri_t uri_root = { .uri = "/",    .method = HTTP_GET,  .handler = handle_root };
     httpd_register_uri_handler(server, &uri_root);
@@ -326,6 +394,14 @@ esp_err_t config_server_start(void) {
     httpd_uri_t uri_screenshot = { .uri = "/screenshot", .method = HTTP_GET, .handler = handle_screenshot };
     httpd_register_uri_handler(server, &uri_screenshot);
 
+    httpd_uri_t uri_memory = { .uri = "/memory", .method = HTTP_GET, .handler = handle_memory };
+    httpd_register_uri_handler(server, &uri_memory);
+
+#if LVGL_PORT_PROFILE
+    httpd_uri_t uri_profile = { .uri = "/profile", .method = HTTP_GET, .handler = handle_profile };
+    httpd_register_uri_handler(server, &uri_profile);
+#endif
+
     httpd_uri_t uri_static = { .uri = "/*",  .method = HTTP_GET,  .handler = handle_static };
     httpd_register_uri_handler(server, &uri_static);
 
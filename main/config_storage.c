@@ -1,6 +1,8 @@
 // config_storage.c
 #include "config_storage.h"
 #include "nvs.h"
+#include "nvs_flash.h"
+#include "esp_log.h"
 #include <string.h>
 
 #define AES_NAMESPACE  "victron"
@@ -12,6 +14,22 @@
 #define SS_ENABLED_KEY        "enabled"
 #define SS_BRIGHT_KEY         "brightness"
 #define SS_TIMEOUT_KEY        "timeout"
+#define BUS_PCLK_KEY          "bus_pclk"
+#define BUS_XFER_KEY          "bus_xfer"
+#define BUS_TRANS_KEY         "bus_trans"
+
+static const char *TAG = "config_storage";
+
+esp_err_t config_storage_init(void) {
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES ||
+        err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_LOGW(TAG, "Erasing NVS and retrying");
+        err = nvs_flash_erase();
+        if (err == ESP_OK) err = nvs_flash_init();
+    }
+    return err;
+}
 
 esp_err_t load_brightness(uint8_t *brightness_out) {
     nvs_handle_t h;
@@ -146,3 +164,26 @@ esp_err_t save_screensaver_settings(bool enabled, uint8_t brightness, uint16_t t
     nvs_close(h);
     return err;
 }
+
+esp_err_t load_display_bus(uint32_t *pclk_hz, uint32_t *max_transfer_sz, uint32_t *trans_size) {
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(BRIGHTNESS_NAMESPACE, NVS_READONLY, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_get_u32(h, BUS_PCLK_KEY, pclk_hz);
+    if (err == ESP_OK) err = nvs_get_u32(h, BUS_XFER_KEY, max_transfer_sz);
+    if (err == ESP_OK) err = nvs_get_u32(h, BUS_TRANS_KEY, trans_size);
+    nvs_close(h);
+    return err;
+}
+
+esp_err_t save_display_bus(uint32_t pclk_hz, uint32_t max_transfer_sz, uint32_t trans_size) {
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(BRIGHTNESS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_set_u32(h, BUS_PCLK_KEY, pclk_hz);
+    if (err == ESP_OK) err = nvs_set_u32(h, BUS_XFER_KEY, max_transfer_sz);
+    if (err == ESP_OK) err = nvs_set_u32(h, BUS_TRANS_KEY, trans_size);
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
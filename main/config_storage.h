@@ -6,6 +6,9 @@
 #include <stdint.h>
 #include <stdbool.h> // <-- Add this line
 
+// Initialise NVS, erasing it when it is full or from another IDF version
+esp_err_t config_storage_init(void);
+
 // brightness settings
 esp_err_t load_brightness(uint8_t *brightness_out);
 esp_err_t save_brightness(uint8_t brightness);
@@ -29,3 +32,8 @@ esp_err_t load_wifi_config(char *ssid_out, size_t *ssid_len,
 esp_err_t save_wifi_config(const char *ssid,
                            const char *pass,
                            uint8_t enabled_out);
+
+// Display bus tuning (NVS namespace: "display"), written by the panel benchmark (panel_bench.h).
+// ESP_ERR_NVS_NOT_FOUND until it has run.
+esp_err_t load_display_bus(uint32_t *pclk_hz, uint32_t *max_transfer_sz, uint32_t *trans_size);
+esp_err_t save_display_bus(uint32_t pclk_hz, uint32_t max_transfer_sz, uint32_t trans_size);
@@ -37,17 +37,21 @@
 #define EXAMPLE_LCD_QSPI_H_RES      (320)
 #define EXAMPLE_LCD_QSPI_V_RES      (480)
 
+/* Send only the changed areas, each in its own CASET/RASET window, instead of whole frames from the first row down.
+ * Needs a controller that takes RASET over QSPI (see main/CMakeLists.txt). */
+#ifndef BSP_LCD_PARTIAL_REFRESH
+#define BSP_LCD_PARTIAL_REFRESH     (0)
+#endif
+
 /**
  * @brief Tear configuration structure
  *
  */
 #define BSP_SYNC_TASK_CONFIG(te_io, intr_type)  \
     {                                           \
-        .task_priority = 4,                     \
-        .task_stack = 2048,                     \
-        .task_affinity = -1,                    \
         .time_Tvdl = 13,                        \
         .time_Tvdh = 3,                         \
+        .max_wait_ms = 8,                       \
         .te_gpio_num = te_io,                   \
         .tear_intr_type = intr_type,            \
     }
@@ -62,12 +66,11 @@ extern "C" {
  */
 typedef struct {
     int max_transfer_sz;    /*!< Maximum transfer size, in bytes. */
+    uint32_t pclk_hz;       /*!< QSPI clock, 0 for the 40 MHz of AXS15231B_PANEL_IO_QSPI_CONFIG */
     struct {
-        int task_priority;          /*!< Tear task priority */
-        int task_stack;             /*!< Tear task stack size */
-        int task_affinity;          /*!< Tear task pinned to core (-1 is no affinity) */
         uint32_t time_Tvdl;         /*!< The display panel is updated from the Frame Memory, Reference specifications */
         uint32_t time_Tvdh;         /*!< The display panel is not updated from the Frame Memory, Reference specifications */
+        uint32_t max_wait_ms;       /*!< Longest a flush may wait for the tear-free window before the frame is dropped */
         int te_gpio_num;            /*!< Tear gpio num */
         gpio_int_type_t tear_intr_type;  /*!< Tear intr type */
     } tear_cfg;
@@ -98,6 +101,75 @@ typedef struct {
  */
 esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io);
 
+/**
+ * @brief Delete a display panel created by bsp_display_new()
+ *
+ * Removes the TE interrupt, deletes the panel and its IO and frees the SPI bus, so bsp_display_new() can be called
+ * again with another configuration.
+ *
+ * @param[in] panel esp_lcd panel handle
+ * @param[in] io    esp_lcd IO handle
+ * @return
+ *      - ESP_OK         On success
+ *      - Else           esp_lcd failure
+ */
+esp_err_t bsp_display_del(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t io);
+
+/**
+ * @brief Frame pacing counters
+ *
+ */
+typedef struct {
+    uint32_t te_edges;          /*!< TE edges seen */
+    uint32_t frames_started;    /*!< Frame transfers started */
+    uint32_t frames_dropped;    /*!< Frames dropped (merged into the next one) instead of blocking */
+    uint32_t missed_vsync;      /*!< Transfers started outside the predicted tear-free window */
+    uint32_t tears;             /*!< Transfers that crossed the panel scan-out */
+    uint32_t period_us;         /*!< Measured TE period */
+    uint32_t transfer_us;       /*!< Measured frame transfer time */
+} bsp_display_frame_stats_t;
+
+/**
+ * @brief Get frame pacing counters
+ *
+ * Display must be already initialized by calling bsp_display_new() with a TE GPIO.
+ *
+ * @param[out] stats Frame pacing counters
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE No TE synchronisation configured
+ */
+esp_err_t bsp_display_get_frame_stats(bsp_display_frame_stats_t *stats);
+
+/**
+ * @brief Panel transfer queue counters since start
+ *
+ */
+typedef struct {
+    uint32_t queue_depth;       /*!< Transfers queued or on the bus at most */
+    uint32_t queued;            /*!< Transfers queued */
+    uint32_t failed;            /*!< Transfers refused or failed */
+    uint32_t occupancy_max;     /*!< Most transfers a new one found queued or on the bus */
+    uint32_t occupancy_pct;     /*!< Mean of the transfers a new one found, in hundredths */
+    uint32_t stalls;            /*!< New transfers that waited for room in the queue */
+    uint32_t stall_max_us;      /*!< Longest such wait */
+    uint64_t stall_us;          /*!< All such waits */
+    uint64_t busy_us;           /*!< Time spent sending */
+    uint32_t frame_wait_us;     /*!< Wait of LVGL for transport buffers per frame, moving average */
+} bsp_display_trans_stats_t;
+
+/**
+ * @brief Get panel transfer queue counters
+ *
+ * Display must be already initialized by calling bsp_display_start().
+ *
+ * @param[out] stats Transfer queue counters
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Display not started
+ */
+esp_err_t bsp_display_get_trans_stats(bsp_display_trans_stats_t *stats);
+
 /**
  * @brief Set display's brightness
  *
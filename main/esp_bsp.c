@@ -5,6 +5,7 @@
  */
 
 #include <stdio.h>
+#include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
@@ -23,7 +24,10 @@
 #include "lvgl.h"
 #include "esp_rom_gpio.h"
 #include "esp_lcd_axs15231b.h"
+#include "esp_rom_sys.h"
 #include "bsp_err_check.h"
+#include "frame_pacer.h"
+#include "panel_bench.h"
 
 #include "lv_port.h"
 #include "display.h"
@@ -66,11 +70,11 @@ static const axs15231b_lcd_init_cmd_t lcd_init_cmds[] = {
     {0x2C, (uint8_t []){0x00, 0x00, 0x00, 0x00}, 4, 0},
 };
 typedef struct {
-    SemaphoreHandle_t te_v_sync_sem;    /*!< Semaphore for vertical synchronization */
-    SemaphoreHandle_t te_catch_sem;     /*!< Semaphore for tear catch */
     uint32_t time_Tvdl;                 /*!< tvdl = The display panel is updated from the Frame Memory */
     uint32_t time_Tvdh;                 /*!< tvdh = The display panel is not updated from the Frame Memory */
-    uint32_t te_timestamp;              /*!< Tear record timestamp */
+    int64_t te_timestamp;               /*!< Tear record timestamp [us] */
+    int te_gpio_num;                    /*!< Tear gpio num, for removing its interrupt */
+    frame_pacer_t pacer;                /*!< Scan-out prediction and frame scheduling */
     portMUX_TYPE lock;                  /*!< Lock for read/write */
 } bsp_lcd_tear_t;
 
@@ -84,6 +88,12 @@ static lv_indev_t *disp_indev = NULL;
 static esp_lcd_touch_handle_t tp = NULL;   // LCD touch handle
 static esp_lcd_panel_handle_t panel_handle = NULL;
 
+static int backlight_percent = 0;           // Last requested brightness, restored on wake-up
+static bool display_asleep = false;
+static bool touch_asleep = false;
+static bsp_display_wake_cb_t display_wake_cb = NULL;
+static void *display_wake_ctx = NULL;
+
 static bool i2c_initialized = false;
 
 esp_err_t bsp_i2c_init(void)
@@ -145,6 +155,14 @@ static esp_err_t bsp_display_brightness_init(void)
     return ESP_OK;
 }
 
+static esp_err_t bsp_display_backlight_duty(int brightness_percent)
+{
+    uint32_t duty_cycle = (1023 * brightness_percent) / 100; // LEDC resolution set to 10bits, thus: 100% = 1023
+    BSP_ERROR_CHECK_RETURN_ERR(ledc_set_duty(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH, duty_cycle));
+    BSP_ERROR_CHECK_RETURN_ERR(ledc_update_duty(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH));
+    return ESP_OK;
+}
+
 esp_err_t bsp_display_brightness_set(int brightness_percent)
 {
     if (brightness_percent > 100) {
@@ -154,12 +172,14 @@ esp_err_t bsp_display_brightness_set(int brightness_percent)
         brightness_percent = 0;
     }
 
-    ESP_LOGI(TAG, "Setting LCD backlight: %d%%", brightness_percent);
-    uint32_t duty_cycle = (1023 * brightness_percent) / 100; // LEDC resolution set to 10bits, thus: 100% = 1023
-    BSP_ERROR_CHECK_RETURN_ERR(ledc_set_duty(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH, duty_cycle));
-    BSP_ERROR_CHECK_RETURN_ERR(ledc_update_duty(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH));
+    backlight_percent = brightness_percent;
+    if (display_asleep) {
+        /* Applied when the panel is back on */
+        return ESP_OK;
+    }
 
-    return ESP_OK;
+    ESP_LOGI(TAG, "Setting LCD backlight: %d%%", brightness_percent);
+    return bsp_display_backlight_duty(brightness_percent);
 }
 
 esp_err_t bsp_display_backlight_off(void)
@@ -172,51 +192,107 @@ esp_err_t bsp_display_backlight_on(void)
     return bsp_display_brightness_set(100);
 }
 
+static void bsp_display_sync_delay(uint32_t wait_us)
+{
+    const int64_t target = esp_timer_get_time() + wait_us;
+    const TickType_t ticks = pdMS_TO_TICKS(wait_us / 1000);
+
+    /* Sleep whole ticks (vTaskDelay may return up to one tick early), spin the remainder */
+    if (ticks > 1) {
+        vTaskDelay(ticks - 1);
+    }
+    const int64_t left = target - esp_timer_get_time();
+    if (left > 0) {
+        esp_rom_delay_us((uint32_t)left);
+    }
+}
+
 static bool bsp_display_sync_cb(void *arg)
 {
     assert(arg);
     bsp_lcd_tear_t *tear_handle = (bsp_lcd_tear_t *)arg;
+    uint32_t wait_us = 0;
 
-    if (tear_handle->te_catch_sem) {
-        xSemaphoreGive(tear_handle->te_catch_sem);
-    }
-
-    if (tear_handle->te_v_sync_sem) {
+    portENTER_CRITICAL(&tear_handle->lock);
+    frame_pacer_action_t action = frame_pacer_schedule(&tear_handle->pacer, esp_timer_get_time(), &wait_us);
+    portEXIT_CRITICAL(&tear_handle->lock);
 
-        xSemaphoreTake(tear_handle->te_v_sync_sem, portMAX_DELAY);
+    if (action == FRAME_PACER_DROP) {
+        /* Don't block LVGL, the caller merges this frame into the next one */
+        return false;
     }
+    if (action == FRAME_PACER_WAIT) {
+        bsp_display_sync_delay(wait_us);
+    }
+
+    portENTER_CRITICAL(&tear_handle->lock);
+    frame_pacer_on_start(&tear_handle->pacer, esp_timer_get_time());
+    portEXIT_CRITICAL(&tear_handle->lock);
     return true;
 }
 
-static void bsp_display_sync_task(void *arg)
+static void bsp_display_sync_done_cb(void *arg)
 {
     assert(arg);
     bsp_lcd_tear_t *tear_handle = (bsp_lcd_tear_t *)arg;
 
-    while (true) {
-        if (pdPASS != xSemaphoreTake(tear_handle->te_catch_sem, pdMS_TO_TICKS(tear_handle->time_Tvdl))) {
-            xSemaphoreTake(tear_handle->te_v_sync_sem, 0);
-        }
-    }
-    vTaskDelete(NULL);
+    /* From the panel driver's transfer task */
+    portENTER_CRITICAL_SAFE(&tear_handle->lock);
+    frame_pacer_on_done(&tear_handle->pacer, esp_timer_get_time());
+    portEXIT_CRITICAL_SAFE(&tear_handle->lock);
 }
 
 static void bsp_display_tear_interrupt(void *arg)
 {
     assert(arg);
     bsp_lcd_tear_t *tear_handle = (bsp_lcd_tear_t *)arg;
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    const int64_t now = esp_timer_get_time();
 
-    if (tear_handle->te_v_sync_sem) {
-        portENTER_CRITICAL_ISR(&tear_handle->lock);
-        tear_handle->te_timestamp = esp_log_timestamp();
-        portEXIT_CRITICAL_ISR(&tear_handle->lock);
-        xSemaphoreGiveFromISR(tear_handle->te_v_sync_sem, &xHigherPriorityTaskWoken);
+    portENTER_CRITICAL_ISR(&tear_handle->lock);
+    tear_handle->te_timestamp = now;
+    frame_pacer_on_te(&tear_handle->pacer, now);
+    portEXIT_CRITICAL_ISR(&tear_handle->lock);
+}
 
-        if (xHigherPriorityTaskWoken) {
-            portYIELD_FROM_ISR();
-        }
-    }
+esp_err_t bsp_display_get_frame_stats(bsp_display_frame_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(panel_handle && panel_handle->user_data, ESP_ERR_INVALID_STATE, TAG, "no TE sync");
+    bsp_lcd_tear_t *tear_handle = (bsp_lcd_tear_t *)panel_handle->user_data;
+    frame_pacer_stats_t pacer_stats;
+
+    portENTER_CRITICAL(&tear_handle->lock);
+    frame_pacer_get_stats(&tear_handle->pacer, &pacer_stats);
+    portEXIT_CRITICAL(&tear_handle->lock);
+
+    stats->te_edges = pacer_stats.te_edges;
+    stats->frames_started = pacer_stats.frames_started;
+    stats->frames_dropped = pacer_stats.frames_dropped;
+    stats->missed_vsync = pacer_stats.missed_vsync;
+    stats->tears = pacer_stats.tears;
+    stats->period_us = pacer_stats.period_us;
+    stats->transfer_us = pacer_stats.transfer_us;
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_get_trans_stats(bsp_display_trans_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(disp && panel_handle, ESP_ERR_INVALID_STATE, TAG, "display not started");
+    axs15231b_trans_stats_t trans;
+    ESP_RETURN_ON_ERROR(esp_lcd_axs15231b_get_trans_stats(panel_handle, &trans), TAG, "no transfer stats");
+
+    stats->queue_depth = trans.queue_depth;
+    stats->queued = trans.queued;
+    stats->failed = trans.failed;
+    stats->occupancy_max = trans.occupancy_max;
+    stats->occupancy_pct = trans.queued ? (uint32_t)(trans.occupancy_sum * 100 / trans.queued) : 0;
+    stats->stalls = trans.stalls;
+    stats->stall_max_us = trans.stall_max_us;
+    stats->stall_us = trans.stall_us;
+    stats->busy_us = trans.busy_us;
+    stats->frame_wait_us = lvgl_port_get_trans_wait_us(disp);
+    return ESP_OK;
 }
 
 esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io)
@@ -224,8 +300,6 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
     esp_err_t ret = ESP_OK;
     assert(config != NULL && config->max_transfer_sz > 0);
 
-    SemaphoreHandle_t te_catch_sem = NULL;
-    SemaphoreHandle_t te_v_sync_sem = NULL;
     bsp_lcd_tear_t *tear_ctx = NULL;
 
     ESP_LOGI(TAG, "Initialize SPI bus");
@@ -239,7 +313,10 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
     ESP_ERROR_CHECK(spi_bus_initialize(EXAMPLE_LCD_QSPI_HOST, &buscfg, SPI_DMA_CH_AUTO));
 
     ESP_LOGI(TAG, "Install panel IO");
-    const esp_lcd_panel_io_spi_config_t io_config = AXS15231B_PANEL_IO_QSPI_CONFIG(EXAMPLE_PIN_NUM_QSPI_CS, NULL, NULL);
+    esp_lcd_panel_io_spi_config_t io_config = AXS15231B_PANEL_IO_QSPI_CONFIG(EXAMPLE_PIN_NUM_QSPI_CS, NULL, NULL);
+    if (config->pclk_hz) {
+        io_config.pclk_hz = config->pclk_hz;
+    }
     // Attach the LCD to the SPI bus
     ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)EXAMPLE_LCD_QSPI_HOST, &io_config, ret_io));
 
@@ -249,6 +326,7 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .init_cmds_size = sizeof(lcd_init_cmds) / sizeof(lcd_init_cmds[0]),
         .flags = {
             .use_qspi_interface = 1,
+            .no_raset = !BSP_LCD_PARTIAL_REFRESH,
         },
     };
     const esp_lcd_panel_dev_config_t panel_config = {
@@ -268,16 +346,17 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         tear_ctx = malloc(sizeof(bsp_lcd_tear_t));
         ESP_GOTO_ON_FALSE(tear_ctx, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for tear_ctx allocation!");
 
-        te_v_sync_sem = xSemaphoreCreateCounting(1, 0);
-        ESP_GOTO_ON_FALSE(te_v_sync_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create te_v_sync_sem Semaphore");
-        tear_ctx->te_v_sync_sem = te_v_sync_sem;
-
-        te_catch_sem = xSemaphoreCreateCounting(1, 0);
-        ESP_GOTO_ON_FALSE(te_catch_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create te_catch_sem Semaphore");
-        tear_ctx->te_catch_sem = te_catch_sem;
-
         tear_ctx->time_Tvdl = config->tear_cfg.time_Tvdl;
         tear_ctx->time_Tvdh = config->tear_cfg.time_Tvdh;
+        tear_ctx->te_timestamp = 0;
+        tear_ctx->te_gpio_num = config->tear_cfg.te_gpio_num;
+
+        const frame_pacer_config_t pacer_cfg = {
+            .period_us = (config->tear_cfg.time_Tvdl + config->tear_cfg.time_Tvdh) * 1000,
+            .scan_us = config->tear_cfg.time_Tvdl * 1000,
+            .max_wait_us = config->tear_cfg.max_wait_ms * 1000,
+        };
+        frame_pacer_init(&tear_ctx->pacer, &pacer_cfg);
 
         tear_ctx->lock.owner = portMUX_FREE_VAL;
         tear_ctx->lock.count = 0;
@@ -293,14 +372,6 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         ESP_ERROR_CHECK(gpio_config(&te_detect_cfg));
         gpio_install_isr_service(0);
         ESP_ERROR_CHECK(gpio_isr_handler_add(config->tear_cfg.te_gpio_num, bsp_display_tear_interrupt, tear_ctx));
-
-        BaseType_t res;
-        if (config->tear_cfg.task_affinity < 0) {
-            res = xTaskCreate(bsp_display_sync_task, "Tear task", config->tear_cfg.task_stack, tear_ctx, config->tear_cfg.task_priority, NULL);
-        } else {
-            res = xTaskCreatePinnedToCore(bsp_display_sync_task, "Tear task", config->tear_cfg.task_stack, tear_ctx, config->tear_cfg.task_priority, NULL, config->tear_cfg.task_affinity);
-        }
-        ESP_GOTO_ON_FALSE(res == pdPASS, ESP_FAIL, err, TAG, "Create Sync task fail!");
     }
 
     (*ret_panel)->user_data = (void *)tear_ctx;
@@ -308,12 +379,6 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
     return ret;
 
 err:
-    if (te_v_sync_sem) {
-        vSemaphoreDelete(te_v_sync_sem);
-    }
-    if (te_catch_sem) {
-        vSemaphoreDelete(te_catch_sem);
-    }
     if (tear_ctx) {
         free(tear_ctx);
     }
@@ -327,6 +392,21 @@ err:
     return ret;
 }
 
+esp_err_t bsp_display_del(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t io)
+{
+    ESP_RETURN_ON_FALSE(panel && io, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    bsp_lcd_tear_t *tear_ctx = (bsp_lcd_tear_t *)panel->user_data;
+
+    if (tear_ctx) {
+        gpio_isr_handler_remove(tear_ctx->te_gpio_num);
+        free(tear_ctx);
+        panel->user_data = NULL;
+    }
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_del(panel), TAG, "delete panel failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_del(io), TAG, "delete panel IO failed");
+    return spi_bus_free(EXAMPLE_LCD_QSPI_HOST);
+}
+
 static lv_disp_t *bsp_display_lcd_init(const bsp_display_cfg_t *cfg)
 {
     assert(cfg != NULL);
@@ -336,13 +416,31 @@ static lv_disp_t *bsp_display_lcd_init(const bsp_display_cfg_t *cfg)
     uint32_t vres;
 
     /**
-    * If the transmission time exceeds the refresh period (time_Tvdl), adopt a 2x period,
-    * and start data transmission at the falling edge.
+    * Transfers are started at the phase after the TE falling edge where the write pointer can't
+    * cross the scan-out (see frame_pacer.h). If that phase is more than max_wait_ms away the frame
+    * is dropped and merged into the next one instead of blocking LVGL.
     */
     hres = EXAMPLE_LCD_QSPI_H_RES;
     vres = EXAMPLE_LCD_QSPI_V_RES;
-    const bsp_display_config_t bsp_disp_cfg = {
+
+    /**
+    * Bus settings: the IO's 40 MHz, whole frames per SPI transaction and transport buffers of a tenth
+    * of the screen, unless the panel benchmark (panel_bench.h) found better ones on an earlier boot.
+    */
+    panel_bench_config_t bus = {
+        .pclk_hz = 40 * 1000 * 1000,
         .max_transfer_sz = hres * vres * sizeof(uint16_t),
+        .trans_size = hres * vres / 10,
+    };
+#if PANEL_BENCH
+    panel_bench_run(&bus);
+#else
+    panel_bench_load(&bus);
+#endif
+
+    const bsp_display_config_t bsp_disp_cfg = {
+        .max_transfer_sz = bus.max_transfer_sz,
+        .pclk_hz = bus.pclk_hz,
         .tear_cfg = BSP_SYNC_TASK_CONFIG(EXAMPLE_PIN_NUM_QSPI_TE, GPIO_INTR_NEGEDGE),
     };
     bsp_display_new(&bsp_disp_cfg, &panel_handle, &io_handle);
@@ -356,11 +454,15 @@ static lv_disp_t *bsp_display_lcd_init(const bsp_display_cfg_t *cfg)
         .sw_rotate = cfg->rotate,
         .hres = hres,
         .vres = vres,
-        .trans_size = hres * vres / 10,
+        .trans_size = bus.trans_size,
         .draw_wait_cb = bsp_display_sync_cb,
+        .draw_done_cb = bsp_display_sync_done_cb,
+        /* Transport buffers are queued to the driver's task, LVGL renders the next one while one is sent */
+        .submit_cb = esp_lcd_axs15231b_draw_bitmap_async,
         .flags = {
             .buff_dma = false,
             .buff_spiram = true,
+            .partial_refresh = BSP_LCD_PARTIAL_REFRESH,
         },
     };
 
@@ -399,7 +501,7 @@ static void bsp_touch_interrupt_cb(esp_lcd_touch_handle_t tp)
 
     xSemaphoreGiveFromISR(touch_handle->tp_intr_event, &xHigherPriorityTaskWoken);
 
-    if (xHigherPriorityTaskWoken) {
+    if (lvgl_port_input_from_isr() || xHigherPriorityTaskWoken) {
         portYIELD_FROM_ISR();
     }
 }
@@ -523,6 +625,59 @@ lv_disp_t *bsp_display_start_with_config(const bsp_display_cfg_t *cfg)
     return disp;
 }
 
+static void bsp_display_wake(lv_disp_t *lv_disp, void *user_ctx)
+{
+    const int64_t start = esp_timer_get_time();
+
+    if (touch_asleep) {
+        esp_lcd_touch_exit_sleep(tp);
+        touch_asleep = false;
+    }
+    esp_lcd_panel_disp_sleep(panel_handle, false);
+
+    /* Let the application bring its widgets up to date first. Brightness it sets is only recorded */
+    if (display_wake_cb) {
+        display_wake_cb(display_wake_ctx);
+    }
+
+    /* Send a frame of the current state before the panel shows anything, its memory is minutes old */
+    lvgl_port_wake_disp(lv_disp);
+    /* The driver's disp_on_off takes `off`: false switches the panel on. Sent once the frame is out */
+    esp_lcd_panel_disp_on_off(panel_handle, false);
+
+    display_asleep = false;
+    bsp_display_backlight_duty(backlight_percent);
+
+    ESP_LOGI(TAG, "Display awake, fresh frame after %" PRId64 " us", esp_timer_get_time() - start);
+}
+
+esp_err_t bsp_display_sleep(bsp_display_wake_cb_t wake_cb, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(disp && panel_handle, ESP_ERR_INVALID_STATE, TAG, "display not started");
+    ESP_RETURN_ON_FALSE(!display_asleep, ESP_ERR_INVALID_STATE, TAG, "display already asleep");
+    ESP_RETURN_ON_ERROR(lvgl_port_sleep(disp, bsp_display_wake, NULL), TAG, "stop rendering failed");
+
+    display_wake_cb = wake_cb;
+    display_wake_ctx = user_ctx;
+    display_asleep = true;
+    bsp_display_backlight_duty(0);
+    esp_lcd_panel_disp_on_off(panel_handle, true);
+    esp_lcd_panel_disp_sleep(panel_handle, true);
+
+    /* Polled touch is the only wake-up source, it stays awake. With an interrupt line it may sleep */
+    if (tp && tp->config.int_gpio_num != GPIO_NUM_NC) {
+        touch_asleep = (esp_lcd_touch_enter_sleep(tp) == ESP_OK);
+    }
+
+    ESP_LOGI(TAG, "Display asleep (touch %s)", touch_asleep ? "asleep" : "polled");
+    return ESP_OK;
+}
+
+bool bsp_display_is_asleep(void)
+{
+    return display_asleep;
+}
+
 lv_indev_t *bsp_display_get_input_dev(void)
 {
     return disp_indev;
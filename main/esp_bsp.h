@@ -116,6 +116,39 @@ bool bsp_display_lock(uint32_t timeout_ms);
  */
 void bsp_display_unlock(void);
 
+/**
+ * @brief Called from the LVGL task (mutex held) when a touch wakes the display after bsp_display_sleep()
+ *
+ * Runs before the wake-up frame is rendered, so widgets updated here are on it. Brightness set from
+ * here is applied when the backlight is switched back on.
+ */
+typedef void (*bsp_display_wake_cb_t)(void *user_ctx);
+
+/**
+ * @brief Put the display to sleep until it is touched
+ *
+ * Backlight and panel are switched off (DISPOFF, SLPIN) and LVGL stops rendering, while its timers
+ * keep running so widgets and data stay up to date. The touch that wakes the display is not passed
+ * to the widgets. On wake-up the panel leaves sleep, a frame of the current state is sent before
+ * the panel is switched on, then the backlight returns to the last brightness set.
+ *
+ * Without a touch interrupt line, wake-up latency is bounded by the idle touch poll period.
+ *
+ * @note Call with the LVGL mutex held.
+ *
+ * @param wake_cb  Called after wake-up, may be NULL
+ * @param user_ctx Passed to `wake_cb`
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Display not started or already asleep
+ */
+esp_err_t bsp_display_sleep(bsp_display_wake_cb_t wake_cb, void *user_ctx);
+
+/**
+ * @brief Check whether the display is asleep
+ */
+bool bsp_display_is_asleep(void);
+
 #ifdef __cplusplus
 }
 #endif
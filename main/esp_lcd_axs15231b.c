@@ -5,9 +5,14 @@
  */
 
 #include <stdlib.h>
+#include <limits.h>
+#include <string.h>
 #include <sys/cdefs.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
 #include "esp_lcd_panel_interface.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
@@ -27,6 +32,15 @@
 #define LCD_OPCODE_READ_CMD                 (0x0BULL)
 #define LCD_OPCODE_WRITE_COLOR              (0x32ULL)
 
+/* Rows of the window when the controller ignores RASET: writes run on to the end of the frame memory */
+#define LCD_ROWS_UNBOUNDED                  (INT_MAX)
+
+/* Wait after SLPIN/SLPOUT before the next command, supplies stay up so the 120 ms power-on wait does not apply */
+#define LCD_SLEEP_CMD_DELAY_MS              (5)
+
+/* Longest a colour transfer may take before the transfer task gives up on it, a full frame takes ~25 ms */
+#define LCD_TRANS_TIMEOUT_MS                (1000)
+
 static const char *TAG = "lcd_panel.axs15231b";
 
 static esp_err_t panel_axs15231b_del(esp_lcd_panel_t *panel);
@@ -38,6 +52,9 @@ static esp_err_t panel_axs15231b_mirror(esp_lcd_panel_t *panel, bool mirror_x, b
 static esp_err_t panel_axs15231b_swap_xy(esp_lcd_panel_t *panel, bool swap_axes);
 static esp_err_t panel_axs15231b_set_gap(esp_lcd_panel_t *panel, int x_gap, int y_gap);
 static esp_err_t panel_axs15231b_disp_off(esp_lcd_panel_t *panel, bool off);
+static esp_err_t panel_axs15231b_sleep(esp_lcd_panel_t *panel, bool sleep);
+static bool panel_axs15231b_color_trans_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
+static void panel_axs15231b_trans_task(void *arg);
 
 static esp_err_t touch_axs15231b_read_data(esp_lcd_touch_handle_t tp);
 static bool touch_axs15231b_get_xy(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num);
@@ -47,6 +64,25 @@ static esp_err_t touch_axs15231b_reset(esp_lcd_touch_handle_t tp);
 static esp_err_t i2c_read_bytes(esp_lcd_touch_handle_t tp, int reg, uint8_t *data, uint8_t len);
 static esp_err_t i2c_write_bytes(esp_lcd_touch_handle_t tp, int reg, const uint8_t *data, uint8_t len);
 
+typedef enum {
+    LCD_TRANS_DRAW,     // send a rectangle
+    LCD_TRANS_READ,     // read a rectangle back
+    LCD_TRANS_FENCE,    // nothing, done once everything before it is
+    LCD_TRANS_STOP,     // end the transfer task
+} lcd_trans_kind_t;
+
+typedef struct {
+    lcd_trans_kind_t kind;
+    int x_start;
+    int y_start;
+    int x_end;
+    int y_end;
+    const void *color_data;
+    void *read_data;
+    axs15231b_trans_done_cb_t done_cb;
+    void *user_ctx;
+} lcd_trans_t;
+
 typedef struct {
     esp_lcd_panel_t base;
     esp_lcd_panel_io_handle_t io;
@@ -58,16 +94,39 @@ typedef struct {
     uint8_t colmod_val; // save surrent value of LCD_CMD_COLMOD register
     const axs15231b_lcd_init_cmd_t *init_cmds;
     uint16_t init_cmds_size;
+    struct {
+        int x_start;    // columns of the last CASET, end exclusive
+        int x_end;
+        int y_start;    // rows of the last RASET, end exclusive
+        int y_end;
+        int next_y;     // row the controller writes next, at x_start; -1 if it wrapped to y_start
+        bool valid;     // the controller has the window above
+    } win;
+    QueueHandle_t trans_queue;          // lcd_trans_t for the transfer task
+    SemaphoreHandle_t trans_slots;      // one per rectangle that may be queued or in transfer
+    SemaphoreHandle_t trans_sent;       // given by the IO when a colour transfer has finished
+    SemaphoreHandle_t sync_lock;        // one trans_sync() at a time
+    SemaphoreHandle_t sync_done;
+    esp_err_t sync_ret;
+    uint8_t trans_depth;
+    portMUX_TYPE stats_lock;
+    axs15231b_trans_stats_t stats;
     struct {
         unsigned int use_qspi_interface: 1;
+        unsigned int no_raset: 1;
         unsigned int reset_level: 1;
     } flags;
 } axs15231b_panel_t;
 
+static void trans_free(axs15231b_panel_t *axs15231b);
+
 esp_err_t esp_lcd_new_panel_axs15231b(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel)
 {
     esp_err_t ret = ESP_OK;
     axs15231b_panel_t *axs15231b = NULL;
+    uint8_t trans_depth = 0;
+    uint8_t trans_priority = 0;
+    bool io_cbs_registered = false;
     ESP_GOTO_ON_FALSE(io && panel_dev_config && ret_panel, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
     axs15231b = calloc(1, sizeof(axs15231b_panel_t));
     ESP_GOTO_ON_FALSE(axs15231b, ESP_ERR_NO_MEM, err, TAG, "no mem for axs15231b panel");
@@ -116,7 +175,31 @@ esp_err_t esp_lcd_new_panel_axs15231b(const esp_lcd_panel_io_handle_t io, const
         axs15231b->init_cmds = ((axs15231b_vendor_config_t *)panel_dev_config->vendor_config)->init_cmds;
         axs15231b->init_cmds_size = ((axs15231b_vendor_config_t *)panel_dev_config->vendor_config)->init_cmds_size;
         axs15231b->flags.use_qspi_interface = ((axs15231b_vendor_config_t *)panel_dev_config->vendor_config)->flags.use_qspi_interface;
+        axs15231b->flags.no_raset = ((axs15231b_vendor_config_t *)panel_dev_config->vendor_config)->flags.no_raset;
+        trans_depth = ((axs15231b_vendor_config_t *)panel_dev_config->vendor_config)->trans_queue_depth;
+        trans_priority = ((axs15231b_vendor_config_t *)panel_dev_config->vendor_config)->trans_task_priority;
     }
+    axs15231b->trans_depth = trans_depth ? trans_depth : AXS15231B_TRANS_QUEUE_DEPTH;
+    axs15231b->stats.queue_depth = axs15231b->trans_depth;
+    axs15231b->stats_lock.owner = portMUX_FREE_VAL;
+
+    // the slots bound the queue, so sending to it never waits
+    axs15231b->trans_queue = xQueueCreate(axs15231b->trans_depth, sizeof(lcd_trans_t));
+    axs15231b->trans_slots = xSemaphoreCreateCounting(axs15231b->trans_depth, axs15231b->trans_depth);
+    axs15231b->trans_sent = xSemaphoreCreateBinary();
+    axs15231b->sync_lock = xSemaphoreCreateMutex();
+    axs15231b->sync_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(axs15231b->trans_queue && axs15231b->trans_slots && axs15231b->trans_sent && axs15231b->sync_lock &&
+                      axs15231b->sync_done, ESP_ERR_NO_MEM, err, TAG, "no mem for transfer queue");
+    const esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = panel_axs15231b_color_trans_done,
+    };
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_io_register_event_callbacks(io, &cbs, axs15231b), err, TAG, "register IO callback failed");
+    io_cbs_registered = true;
+    ESP_GOTO_ON_FALSE(xTaskCreate(panel_axs15231b_trans_task, AXS15231B_TRANS_TASK_NAME, AXS15231B_TRANS_TASK_STACK, axs15231b,
+                                  trans_priority ? trans_priority : AXS15231B_TRANS_TASK_PRIORITY, NULL) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "create transfer task failed");
+
     axs15231b->base.del = panel_axs15231b_del;
     axs15231b->base.reset = panel_axs15231b_reset;
     axs15231b->base.init = panel_axs15231b_init;
@@ -126,6 +209,7 @@ esp_err_t esp_lcd_new_panel_axs15231b(const esp_lcd_panel_io_handle_t io, const
     axs15231b->base.mirror = panel_axs15231b_mirror;
     axs15231b->base.swap_xy = panel_axs15231b_swap_xy;
     axs15231b->base.disp_on_off  = panel_axs15231b_disp_off;
+    axs15231b->base.disp_sleep = panel_axs15231b_sleep;
     *ret_panel = &(axs15231b->base);
     ESP_LOGD(TAG, "new axs15231b panel @%p", axs15231b);
     ESP_LOGI(TAG, "LCD panel create success, version: %d.%d.%d", ESP_LCD_AXS15231B_VER_MAJOR, ESP_LCD_AXS15231B_VER_MINOR,
@@ -135,6 +219,10 @@ esp_err_t esp_lcd_new_panel_axs15231b(const esp_lcd_panel_io_handle_t io, const
 
 err:
     if (axs15231b) {
+        if (io_cbs_registered) {
+            esp_lcd_panel_io_register_event_callbacks(io, &(esp_lcd_panel_io_callbacks_t) { 0 }, NULL);
+        }
+        trans_free(axs15231b);
         if (panel_dev_config->reset_gpio_num >= 0) {
             gpio_reset_pin(panel_dev_config->reset_gpio_num);
         }
@@ -163,10 +251,122 @@ static esp_err_t tx_color(axs15231b_panel_t *axs15231b, esp_lcd_panel_io_handle_
     return esp_lcd_panel_io_tx_color(io, lcd_cmd, param, param_size);
 }
 
+static esp_err_t rx_param(axs15231b_panel_t *axs15231b, esp_lcd_panel_io_handle_t io, int lcd_cmd, void *param, size_t param_size)
+{
+    if (axs15231b->flags.use_qspi_interface) {
+        lcd_cmd &= 0xff;
+        lcd_cmd <<= 8;
+        lcd_cmd |= LCD_OPCODE_READ_CMD << 24;
+    }
+    return esp_lcd_panel_io_rx_param(io, lcd_cmd, param, param_size);
+}
+
+// After a reset, the init sequence, a MADCTL change or a failed transfer the window and write pointer are unknown
+static void window_forget(axs15231b_panel_t *axs15231b)
+{
+    axs15231b->win.valid = false;
+    axs15231b->win.next_y = -1;
+}
+
+static void trans_free(axs15231b_panel_t *axs15231b)
+{
+    if (axs15231b->trans_queue) {
+        vQueueDelete(axs15231b->trans_queue);
+    }
+    if (axs15231b->trans_slots) {
+        vSemaphoreDelete(axs15231b->trans_slots);
+    }
+    if (axs15231b->trans_sent) {
+        vSemaphoreDelete(axs15231b->trans_sent);
+    }
+    if (axs15231b->sync_lock) {
+        vSemaphoreDelete(axs15231b->sync_lock);
+    }
+    if (axs15231b->sync_done) {
+        vSemaphoreDelete(axs15231b->sync_done);
+    }
+}
+
+// Hand `trans` to the transfer task once a slot is free; a slot is only returned after the transfer has finished
+static esp_err_t trans_submit(axs15231b_panel_t *axs15231b, const lcd_trans_t *trans, TickType_t ticks_to_wait)
+{
+    const uint32_t pending = axs15231b->trans_depth - uxSemaphoreGetCount(axs15231b->trans_slots);
+    bool taken = xSemaphoreTake(axs15231b->trans_slots, 0) == pdTRUE;
+    const bool stalled = !taken;
+    int64_t stall_us = 0;
+    if (stalled) {
+        const int64_t start = esp_timer_get_time();
+        taken = xSemaphoreTake(axs15231b->trans_slots, ticks_to_wait) == pdTRUE;
+        stall_us = esp_timer_get_time() - start;
+    }
+
+    if (trans->kind == LCD_TRANS_DRAW) {
+        axs15231b_trans_stats_t *stats = &axs15231b->stats;
+        portENTER_CRITICAL(&axs15231b->stats_lock);
+        if (stalled) {
+            stats->stalls++;
+            stats->stall_us += stall_us;
+            if (stall_us > stats->stall_max_us) {
+                stats->stall_max_us = stall_us;
+            }
+        }
+        if (taken) {
+            stats->queued++;
+            stats->occupancy_sum += pending;
+            if (pending > stats->occupancy_max) {
+                stats->occupancy_max = pending;
+            }
+        } else {
+            stats->timeouts++;
+        }
+        portEXIT_CRITICAL(&axs15231b->stats_lock);
+    }
+    if (!taken) {
+        return ESP_ERR_TIMEOUT;
+    }
+    xQueueSend(axs15231b->trans_queue, trans, portMAX_DELAY);
+    return ESP_OK;
+}
+
+static void trans_sync_done(esp_lcd_panel_handle_t panel, esp_err_t status, void *user_ctx)
+{
+    axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
+    axs15231b->sync_ret = status;
+    xSemaphoreGive(axs15231b->sync_done);
+}
+
+// Queue `trans` behind everything submitted so far and wait until the transfer task is through with it
+static esp_err_t trans_sync(axs15231b_panel_t *axs15231b, lcd_trans_t trans)
+{
+    trans.done_cb = trans_sync_done;
+    xSemaphoreTake(axs15231b->sync_lock, portMAX_DELAY);
+    esp_err_t ret = trans_submit(axs15231b, &trans, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        xSemaphoreTake(axs15231b->sync_done, portMAX_DELAY);
+        ret = axs15231b->sync_ret;
+    }
+    xSemaphoreGive(axs15231b->sync_lock);
+    return ret;
+}
+
+// Commands other than drawing wait for the queue to be empty, the window state belongs to the transfer task
+static void trans_fence(axs15231b_panel_t *axs15231b)
+{
+    trans_sync(axs15231b, (lcd_trans_t) {
+        .kind = LCD_TRANS_FENCE,
+    });
+}
+
 static esp_err_t panel_axs15231b_del(esp_lcd_panel_t *panel)
 {
     axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
 
+    // the task sends what is queued, then ends
+    trans_sync(axs15231b, (lcd_trans_t) {
+        .kind = LCD_TRANS_STOP,
+    });
+    esp_lcd_panel_io_register_event_callbacks(axs15231b->io, &(esp_lcd_panel_io_callbacks_t) { 0 }, NULL);
+    trans_free(axs15231b);
     if (axs15231b->reset_gpio_num >= 0) {
         gpio_reset_pin(axs15231b->reset_gpio_num);
     }
@@ -179,6 +379,8 @@ static esp_err_t panel_axs15231b_reset(esp_lcd_panel_t *panel)
 {
     axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
     esp_lcd_panel_io_handle_t io = axs15231b->io;
+    trans_fence(axs15231b);
+    window_forget(axs15231b);
 
     // perform hardware reset
     if (axs15231b->reset_gpio_num >= 0) {
@@ -235,6 +437,8 @@ static esp_err_t panel_axs15231b_init(esp_lcd_panel_t *panel)
 {
     axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
     esp_lcd_panel_io_handle_t io = axs15231b->io;
+    trans_fence(axs15231b);
+    window_forget(axs15231b);
 
     // LCD goes into sleep mode and display will be turned off after power on reset, exit sleep mode first
     ESP_RETURN_ON_ERROR(tx_param(axs15231b, io, LCD_CMD_SLPOUT, NULL, 0), TAG, "send command failed");
@@ -284,42 +488,223 @@ static esp_err_t panel_axs15231b_init(esp_lcd_panel_t *panel)
     return ESP_OK;
 }
 
-static esp_err_t panel_axs15231b_draw_bitmap(esp_lcd_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+// Send the colours of a rectangle, once the IO is through with them; transfer task only
+static esp_err_t tx_color_wait(axs15231b_panel_t *axs15231b, esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t len)
+{
+    xSemaphoreTake(axs15231b->trans_sent, 0); // a stale give of a transfer that failed to queue
+    ESP_RETURN_ON_ERROR(tx_color(axs15231b, io, lcd_cmd, color, len), TAG, "send color failed");
+    ESP_RETURN_ON_FALSE(xSemaphoreTake(axs15231b->trans_sent, pdMS_TO_TICKS(LCD_TRANS_TIMEOUT_MS)) == pdTRUE, ESP_ERR_TIMEOUT,
+                        TAG, "color transfer not finished");
+    return ESP_OK;
+}
+
+// CASET and RASET for a rectangle, gaps already applied, skipping what the controller already has; the caller
+// sets win.next_y once the pixels are through
+static esp_err_t window_set(axs15231b_panel_t *axs15231b, int x_start, int y_start, int x_end, int y_end)
+{
+    esp_lcd_panel_io_handle_t io = axs15231b->io;
+    esp_err_t ret = ESP_OK;
+
+    // without RASET, RAMWR and RAMRD start at the first row
+    ESP_RETURN_ON_FALSE(!axs15231b->flags.no_raset || y_start == 0, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "rows from %d can't be addressed without RASET", y_start);
+
+    // define an area of frame memory where MCU can access, only what changed
+    const bool known = axs15231b->win.valid;
+    axs15231b->win.valid = false;
+    if (!known || x_start != axs15231b->win.x_start || x_end != axs15231b->win.x_end) {
+        ESP_GOTO_ON_ERROR(tx_param(axs15231b, io, LCD_CMD_CASET, (uint8_t[]) {
+            (x_start >> 8) & 0xFF,
+            x_start & 0xFF,
+            ((x_end - 1) >> 8) & 0xFF,
+            (x_end - 1) & 0xFF,
+        }, 4), err, TAG, "send command failed");
+        axs15231b->win.x_start = x_start;
+        axs15231b->win.x_end = x_end;
+    }
+
+    if (axs15231b->flags.no_raset) {
+        axs15231b->win.y_start = 0;
+        axs15231b->win.y_end = LCD_ROWS_UNBOUNDED;
+    } else if (!known || y_start != axs15231b->win.y_start || y_end != axs15231b->win.y_end) {
+        ESP_GOTO_ON_ERROR(tx_param(axs15231b, io, LCD_CMD_RASET, (uint8_t[]) {
+            (y_start >> 8) & 0xFF,
+            y_start & 0xFF,
+            ((y_end - 1) >> 8) & 0xFF,
+            (y_end - 1) & 0xFF,
+        }, 4), err, TAG, "send command failed");
+        axs15231b->win.y_start = y_start;
+        axs15231b->win.y_end = y_end;
+    }
+    axs15231b->win.valid = true;
+    return ESP_OK;
+
+err:
+    window_forget(axs15231b);
+    return ret;
+}
+
+static esp_err_t panel_axs15231b_send(axs15231b_panel_t *axs15231b, int x_start, int y_start, int x_end, int y_end, const void *color_data)
 {
-    axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
     assert((x_start < x_end) && (y_start < y_end) && "start position must be smaller than end position");
     esp_lcd_panel_io_handle_t io = axs15231b->io;
+    esp_err_t ret = ESP_OK;
 
     x_start += axs15231b->x_gap;
     x_end += axs15231b->x_gap;
     y_start += axs15231b->y_gap;
     y_end += axs15231b->y_gap;
 
-    // define an area of frame memory where MCU can access
-    tx_param(axs15231b, io, LCD_CMD_CASET, (uint8_t[]) {
-        (x_start >> 8) & 0xFF,
-        x_start & 0xFF,
-        ((x_end - 1) >> 8) & 0xFF,
-        (x_end - 1) & 0xFF,
-    }, 4);
+    size_t len = (x_end - x_start) * (y_end - y_start) * axs15231b->fb_bits_per_pixel / 8;
 
-    if (0 == axs15231b->flags.use_qspi_interface) {
-        tx_param(axs15231b, io, LCD_CMD_RASET, (uint8_t[]) {
-            (y_start >> 8) & 0xFF,
-            y_start & 0xFF,
-            ((y_end - 1) >> 8) & 0xFF,
-            (y_end - 1) & 0xFF,
-        }, 4);
+    // right below the last rectangle, same columns, inside the window: the write pointer is already there
+    if (axs15231b->win.valid && x_start == axs15231b->win.x_start && x_end == axs15231b->win.x_end &&
+            y_start == axs15231b->win.next_y && y_end <= axs15231b->win.y_end) {
+        ESP_GOTO_ON_ERROR(tx_color_wait(axs15231b, io, LCD_CMD_RAMWRC, color_data, len), err, TAG, "send color failed");//3C
+        axs15231b->win.next_y = (y_end < axs15231b->win.y_end) ? y_end : -1;
+        return ESP_OK;
+    }
+
+    ret = window_set(axs15231b, x_start, y_start, x_end, y_end);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
     // transfer frame buffer
+    ESP_GOTO_ON_ERROR(tx_color_wait(axs15231b, io, LCD_CMD_RAMWR, color_data, len), err, TAG, "send color failed");//2C
+    axs15231b->win.next_y = (y_end < axs15231b->win.y_end) ? y_end : -1;
+
+    return ESP_OK;
+
+err:
+    window_forget(axs15231b);
+    return ret;
+}
+
+static esp_err_t panel_axs15231b_recv(axs15231b_panel_t *axs15231b, int x_start, int y_start, int x_end, int y_end, void *color_data)
+{
+    esp_lcd_panel_io_handle_t io = axs15231b->io;
+    esp_err_t ret = ESP_OK;
+
+    x_start += axs15231b->x_gap;
+    x_end += axs15231b->x_gap;
+    y_start += axs15231b->y_gap;
+    y_end += axs15231b->y_gap;
+
     size_t len = (x_end - x_start) * (y_end - y_start) * axs15231b->fb_bits_per_pixel / 8;
-    if (y_start == 0) {
-        tx_color(axs15231b, io, LCD_CMD_RAMWR, color_data, len);//2C
-    } else {
-        tx_color(axs15231b, io, LCD_CMD_RAMWRC, color_data, len);//3C
+
+    ret = window_set(axs15231b, x_start, y_start, x_end, y_end);
+    if (ret != ESP_OK) {
+        return ret;
     }
+    ESP_GOTO_ON_ERROR(rx_param(axs15231b, io, LCD_CMD_RAMRD, color_data, len), err, TAG, "read color failed");//2E
+    // the window stays, the next rectangle starts over with RAMWR
+    axs15231b->win.next_y = -1;
+    return ESP_OK;
+
+err:
+    window_forget(axs15231b);
+    return ret;
+}
+
+static bool panel_axs15231b_color_trans_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    axs15231b_panel_t *axs15231b = (axs15231b_panel_t *)user_ctx;
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(axs15231b->trans_sent, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+static void panel_axs15231b_trans_task(void *arg)
+{
+    axs15231b_panel_t *axs15231b = (axs15231b_panel_t *)arg;
+    lcd_trans_t trans;
+
+    do {
+        xQueueReceive(axs15231b->trans_queue, &trans, portMAX_DELAY);
+        esp_err_t ret = ESP_OK;
+        if (trans.kind == LCD_TRANS_DRAW) {
+            const int64_t start = esp_timer_get_time();
+            ret = panel_axs15231b_send(axs15231b, trans.x_start, trans.y_start, trans.x_end, trans.y_end, trans.color_data);
+            const int64_t busy_us = esp_timer_get_time() - start;
+            portENTER_CRITICAL(&axs15231b->stats_lock);
+            axs15231b->stats.busy_us += busy_us;
+            if (ret == ESP_OK) {
+                axs15231b->stats.done++;
+            } else {
+                axs15231b->stats.failed++;
+            }
+            portEXIT_CRITICAL(&axs15231b->stats_lock);
+        } else if (trans.kind == LCD_TRANS_READ) {
+            ret = panel_axs15231b_recv(axs15231b, trans.x_start, trans.y_start, trans.x_end, trans.y_end, trans.read_data);
+        }
+        // the slot first, so the callback can submit the next rectangle without waiting
+        xSemaphoreGive(axs15231b->trans_slots);
+        if (trans.done_cb) {
+            trans.done_cb(&axs15231b->base, ret, trans.user_ctx);
+        }
+    } while (trans.kind != LCD_TRANS_STOP);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t panel_axs15231b_draw_bitmap(esp_lcd_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
+    return trans_sync(axs15231b, (lcd_trans_t) {
+        .kind = LCD_TRANS_DRAW,
+        .x_start = x_start,
+        .y_start = y_start,
+        .x_end = x_end,
+        .y_end = y_end,
+        .color_data = color_data,
+    });
+}
+
+esp_err_t esp_lcd_axs15231b_draw_bitmap_async(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                              const void *color_data, axs15231b_trans_done_cb_t done_cb, void *user_ctx,
+                                              TickType_t ticks_to_wait)
+{
+    ESP_RETURN_ON_FALSE(panel && color_data, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE((x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "start position must be smaller than end position");
+    axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
+    const lcd_trans_t trans = {
+        .kind = LCD_TRANS_DRAW,
+        .x_start = x_start,
+        .y_start = y_start,
+        .x_end = x_end,
+        .y_end = y_end,
+        .color_data = color_data,
+        .done_cb = done_cb,
+        .user_ctx = user_ctx,
+    };
+    return trans_submit(axs15231b, &trans, ticks_to_wait);
+}
 
+esp_err_t esp_lcd_axs15231b_read_ram(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                     void *color_data)
+{
+    ESP_RETURN_ON_FALSE(panel && color_data, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE((x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "start position must be smaller than end position");
+    axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
+    return trans_sync(axs15231b, (lcd_trans_t) {
+        .kind = LCD_TRANS_READ,
+        .x_start = x_start,
+        .y_start = y_start,
+        .x_end = x_end,
+        .y_end = y_end,
+        .read_data = color_data,
+    });
+}
+
+esp_err_t esp_lcd_axs15231b_get_trans_stats(esp_lcd_panel_handle_t panel, axs15231b_trans_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(panel && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
+    const uint32_t pending = axs15231b->trans_depth - uxSemaphoreGetCount(axs15231b->trans_slots);
+    portENTER_CRITICAL(&axs15231b->stats_lock);
+    *stats = axs15231b->stats;
+    portEXIT_CRITICAL(&axs15231b->stats_lock);
+    stats->pending = pending;
     return ESP_OK;
 }
 
@@ -327,6 +712,7 @@ static esp_err_t panel_axs15231b_invert_color(esp_lcd_panel_t *panel, bool inver
 {
     axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
     esp_lcd_panel_io_handle_t io = axs15231b->io;
+    trans_fence(axs15231b);
     int command = 0;
     if (invert_color_data) {
         command = LCD_CMD_INVON;
@@ -341,6 +727,7 @@ static esp_err_t panel_axs15231b_mirror(esp_lcd_panel_t *panel, bool mirror_x, b
 {
     axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
     esp_lcd_panel_io_handle_t io = axs15231b->io;
+    trans_fence(axs15231b);
     if (mirror_x) {
         axs15231b->madctl_val |= LCD_CMD_MX_BIT;
     } else {
@@ -351,6 +738,7 @@ static esp_err_t panel_axs15231b_mirror(esp_lcd_panel_t *panel, bool mirror_x, b
     } else {
         axs15231b->madctl_val &= ~LCD_CMD_MY_BIT;
     }
+    window_forget(axs15231b);
     tx_param(axs15231b, io, LCD_CMD_MADCTL, (uint8_t[]) {
         axs15231b->madctl_val
     }, 1);
@@ -361,11 +749,13 @@ static esp_err_t panel_axs15231b_swap_xy(esp_lcd_panel_t *panel, bool swap_axes)
 {
     axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
     esp_lcd_panel_io_handle_t io = axs15231b->io;
+    trans_fence(axs15231b);
     if (swap_axes) {
         axs15231b->madctl_val |= LCD_CMD_MV_BIT;
     } else {
         axs15231b->madctl_val &= ~LCD_CMD_MV_BIT;
     }
+    window_forget(axs15231b);
     tx_param(axs15231b, io, LCD_CMD_MADCTL, (uint8_t[]) {
         axs15231b->madctl_val
     }, 1);
@@ -375,6 +765,7 @@ static esp_err_t panel_axs15231b_swap_xy(esp_lcd_panel_t *panel, bool swap_axes)
 static esp_err_t panel_axs15231b_set_gap(esp_lcd_panel_t *panel, int x_gap, int y_gap)
 {
     axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
+    trans_fence(axs15231b);
     axs15231b->x_gap = x_gap;
     axs15231b->y_gap = y_gap;
     return ESP_OK;
@@ -384,6 +775,7 @@ static esp_err_t panel_axs15231b_disp_off(esp_lcd_panel_t *panel, bool off)
 {
     axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
     esp_lcd_panel_io_handle_t io = axs15231b->io;
+    trans_fence(axs15231b);
     int command = 0;
     if (off) {
         command = LCD_CMD_DISPOFF;
@@ -394,6 +786,22 @@ static esp_err_t panel_axs15231b_disp_off(esp_lcd_panel_t *panel, bool off)
     return ESP_OK;
 }
 
+static esp_err_t panel_axs15231b_sleep(esp_lcd_panel_t *panel, bool sleep)
+{
+    axs15231b_panel_t *axs15231b = __containerof(panel, axs15231b_panel_t, base);
+    esp_lcd_panel_io_handle_t io = axs15231b->io;
+    trans_fence(axs15231b);
+    int command = 0;
+    if (sleep) {
+        command = LCD_CMD_SLPIN;
+    } else {
+        command = LCD_CMD_SLPOUT;
+    }
+    ESP_RETURN_ON_ERROR(tx_param(axs15231b, io, command, NULL, 0), TAG, "send command failed");
+    vTaskDelay(pdMS_TO_TICKS(LCD_SLEEP_CMD_DELAY_MS));
+    return ESP_OK;
+}
+
 esp_err_t esp_lcd_touch_new_i2c_axs15231b(const esp_lcd_panel_io_handle_t io, const esp_lcd_touch_config_t *config, esp_lcd_touch_handle_t *tp)
 {
     ESP_RETURN_ON_FALSE(io, ESP_ERR_INVALID_ARG, TAG, "Invalid io");
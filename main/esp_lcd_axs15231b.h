@@ -11,13 +11,21 @@
 #pragma once
 
 #include "hal/spi_ll.h"
+#include "freertos/FreeRTOS.h"
 #include "esp_lcd_touch.h"
 #include "esp_lcd_panel_vendor.h"
 
 #define ESP_LCD_AXS15231B_VER_MAJOR    (1)
-#define ESP_LCD_AXS15231B_VER_MINOR    (0)
+#define ESP_LCD_AXS15231B_VER_MINOR    (3)
 #define ESP_LCD_AXS15231B_VER_PATCH    (0)
 
+/* Rectangles `esp_lcd_axs15231b_draw_bitmap_async()` takes before the caller has to wait, one of them in transfer */
+#define AXS15231B_TRANS_QUEUE_DEPTH    (2)
+/* The transfer task runs above the LVGL task (4), so a finished transfer is followed by the next one at once */
+#define AXS15231B_TRANS_TASK_PRIORITY  (5)
+#define AXS15231B_TRANS_TASK_STACK     (3072)
+#define AXS15231B_TRANS_TASK_NAME      "axs15231b"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -45,8 +53,14 @@ typedef struct {
                                                  *   Please refer to `vendor_specific_init_default` in source file.
                                                  */
     uint16_t init_cmds_size;                    /*<! Number of commands in above array */
+    uint8_t trans_queue_depth;                  /*<! Rectangles queued or in transfer at most, 0 for AXS15231B_TRANS_QUEUE_DEPTH */
+    uint8_t trans_task_priority;                /*<! Priority of the transfer task, 0 for AXS15231B_TRANS_TASK_PRIORITY */
     struct {
         unsigned int use_qspi_interface: 1;     /*<! Set to 1 if use QSPI interface, default is SPI interface */
+        unsigned int no_raset: 1;               /*<! Set to 1 if the controller ignores RASET (seen over QSPI): rows are then only
+                                                 *   reached by writing from the first one down, and `draw_bitmap` returns
+                                                 *   ESP_ERR_NOT_SUPPORTED for a rectangle that starts anywhere else
+                                                 */
     } flags;
 } axs15231b_vendor_config_t;
 
@@ -54,6 +68,12 @@ typedef struct {
  * @brief Create LCD panel for model AXS15231B
  *
  * @note  Vendor specific initialization can be different between manufacturers, should consult the LCD supplier for initialization sequence code.
+ * @note  `esp_lcd_panel_draw_bitmap()` takes any rectangle. CASET and RASET are only sent when the window changes, and a
+ *        rectangle right below the last one in the same columns is continued with RAMWRC (see `flags.no_raset`).
+ * @note  Rectangles are sent by a task of the driver, in the order they were submitted, see
+ *        `esp_lcd_axs15231b_draw_bitmap_async()`. `esp_lcd_panel_draw_bitmap()` queues the rectangle and returns once it
+ *        has been sent; the other panel functions wait until the queue is empty. The driver registers the
+ *        `on_color_trans_done` callback of `io` for itself, the IO must not have one of its own.
  *
  * @param[in] io LCD panel IO handle
  * @param[in] panel_dev_config general panel device configuration
@@ -65,6 +85,97 @@ typedef struct {
  */
 esp_err_t esp_lcd_new_panel_axs15231b(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel);
 
+/**
+ * @brief Called by the transfer task when a rectangle of `esp_lcd_axs15231b_draw_bitmap_async()` has been sent
+ *
+ * @note  Runs in the transfer task, not in an ISR. It may submit further rectangles but must not call other panel
+ *        functions, they wait for the task.
+ *
+ * @param[in] panel    LCD panel handle
+ * @param[in] status   ESP_OK once the pixels are out and `color_data` may be reused; else why they were not sent
+ *                     (ESP_ERR_NOT_SUPPORTED: a rectangle `flags.no_raset` can't reach, ESP_ERR_TIMEOUT: the bus never
+ *                     finished the transfer), `color_data` may be reused as well
+ * @param[in] user_ctx `user_ctx` of the submission
+ */
+typedef void (*axs15231b_trans_done_cb_t)(esp_lcd_panel_handle_t panel, esp_err_t status, void *user_ctx);
+
+/**
+ * @brief Queue a rectangle for the transfer task and return
+ *
+ * The queue holds `trans_queue_depth` rectangles, counting the one in transfer. When it is full the caller waits for
+ * a transfer to finish, up to `ticks_to_wait`: this is the back-pressure that keeps a renderer at most that many
+ * buffers ahead of the bus.
+ *
+ * @param[in] panel      LCD panel handle
+ * @param[in] x_start    Start column
+ * @param[in] y_start    Start row
+ * @param[in] x_end      End column, exclusive
+ * @param[in] y_end      End row, exclusive
+ * @param[in] color_data Pixels, left alone until `done_cb` is called
+ * @param[in] done_cb    Called when the rectangle has been sent or refused, may be NULL
+ * @param[in] user_ctx   Passed to `done_cb`
+ * @param[in] ticks_to_wait How long to wait for room in the queue
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_TIMEOUT       if the queue stayed full, `done_cb` won't be called
+ *          - ESP_OK                if queued
+ */
+esp_err_t esp_lcd_axs15231b_draw_bitmap_async(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                              const void *color_data, axs15231b_trans_done_cb_t done_cb, void *user_ctx,
+                                              TickType_t ticks_to_wait);
+
+/**
+ * @brief Read a rectangle of frame memory back with RAMRD
+ *
+ * Waits for the rectangles queued before it. The controller has to return the pixels in the format they were written
+ * in; whether it does over QSPI depends on the panel, so compare against pixels written first before relying on it.
+ * The next rectangle drawn starts over with RAMWR.
+ *
+ * @param[in] panel      LCD panel handle
+ * @param[in] x_start    Start column
+ * @param[in] y_start    Start row, 0 with `flags.no_raset`
+ * @param[in] x_end      End column, exclusive
+ * @param[in] y_end      End row, exclusive
+ * @param[out] color_data Pixels, DMA capable on SPI buses
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NOT_SUPPORTED if `flags.no_raset` and `y_start` is not 0
+ *          - ESP_OK                on success, else the error of the panel IO
+ */
+esp_err_t esp_lcd_axs15231b_read_ram(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                     void *color_data);
+
+/**
+ * @brief Transfer queue statistics since the panel was created
+ *
+ * Only rectangles count, not the waits of the other panel functions. The mean occupancy is `occupancy_sum / queued`.
+ */
+typedef struct {
+    uint32_t queue_depth;       /*<! Rectangles queued or in transfer at most */
+    uint32_t pending;           /*<! Rectangles queued or in transfer now */
+    uint32_t queued;            /*<! Rectangles accepted */
+    uint32_t done;              /*<! Rectangles sent */
+    uint32_t failed;            /*<! Rectangles refused or whose transfer failed */
+    uint32_t occupancy_max;     /*<! Most rectangles a submission found queued or in transfer */
+    uint64_t occupancy_sum;     /*<! Rectangles each submission found queued or in transfer, summed */
+    uint32_t stalls;            /*<! Submissions that found the queue full and had to wait */
+    uint32_t timeouts;          /*<! Submissions that gave up waiting */
+    uint64_t stall_us;          /*<! Time submissions waited for room */
+    uint32_t stall_max_us;      /*<! Longest wait for room */
+    uint64_t busy_us;           /*<! Time the transfer task spent sending, the bus is idle for the rest */
+} axs15231b_trans_stats_t;
+
+/**
+ * @brief Read the transfer queue statistics
+ *
+ * @param[in] panel  LCD panel handle
+ * @param[out] stats Statistics
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_axs15231b_get_trans_stats(esp_lcd_panel_handle_t panel, axs15231b_trans_stats_t *stats);
+
 /**
  * @brief LCD panel bus configuration structure
  *
@@ -0,0 +1,159 @@
+/* frame_pacer.c */
+
+#include <stdlib.h>
+#include <string.h>
+#include "frame_pacer.h"
+
+/* TE is considered lost after this many periods without an edge; transfers then free-run */
+#define FRAME_PACER_TE_LOST_PERIODS   (4)
+/* Edge jitter tolerated when checking the window and judging tears */
+#define FRAME_PACER_JITTER_US         (100)
+/* Estimates follow measurements with a weight of 1/2^shift */
+#define FRAME_PACER_PERIOD_EMA_SHIFT  (3)
+#define FRAME_PACER_XFER_EMA_SHIFT    (2)
+/* The window keeps this many mean deviations of the transfer time from its edges */
+#define FRAME_PACER_XFER_DEV_MARGIN   (2)
+
+static int32_t frame_pacer_ema(int32_t est, int32_t sample, int shift)
+{
+    return est + ((sample - est) >> shift);
+}
+
+/*
+ * Tear-free start window [lo, hi] as a phase after the TE edge. A transfer shorter than estimated
+ * and started at lo ends ahead of the sweep, a longer one started at hi runs into the next: both
+ * edges keep a margin for the jitter and the spread of the transfer time.
+ */
+static void frame_pacer_window(const frame_pacer_t *pacer, int32_t *lo, int32_t *hi)
+{
+    const int32_t period = pacer->period_us;
+    const int32_t scan = pacer->cfg.scan_us;
+    const int32_t xfer = pacer->transfer_us;
+    const int32_t margin = FRAME_PACER_JITTER_US + FRAME_PACER_XFER_DEV_MARGIN * (int32_t)pacer->transfer_dev_us;
+
+    *lo = (scan - xfer + margin > 0) ? (scan - xfer + margin) : 0;
+    *hi = period + scan - xfer - margin;
+    if (*hi < *lo) {
+        /* Transfer is slower than two read sweeps: no phase is tear-free, start on the edge */
+        *lo = 0;
+        *hi = 0;
+    } else if (*hi >= period) {
+        *hi = period - 1;
+    }
+}
+
+static bool frame_pacer_te_alive(const frame_pacer_t *pacer, int64_t now_us)
+{
+    return pacer->last_te_us != 0 &&
+           (now_us - pacer->last_te_us) < (int64_t)pacer->period_us * FRAME_PACER_TE_LOST_PERIODS;
+}
+
+static int32_t frame_pacer_phase(const frame_pacer_t *pacer, int64_t now_us)
+{
+    return (int32_t)((now_us - pacer->last_te_us) % pacer->period_us);
+}
+
+void frame_pacer_init(frame_pacer_t *pacer, const frame_pacer_config_t *cfg)
+{
+    memset(pacer, 0, sizeof(frame_pacer_t));
+    pacer->cfg = *cfg;
+    pacer->period_us = cfg->period_us;
+    /* Until the first transfer has been measured */
+    pacer->transfer_us = cfg->period_us;
+}
+
+void frame_pacer_on_te(frame_pacer_t *pacer, int64_t now_us)
+{
+    if (pacer->last_te_us != 0) {
+        const int64_t dt = now_us - pacer->last_te_us;
+        /* Only plausible intervals refine the estimate, a gap means edges were lost */
+        if (dt > pacer->period_us / 2 && dt < (pacer->period_us * 3) / 2) {
+            pacer->period_us = frame_pacer_ema(pacer->period_us, (int32_t)dt, FRAME_PACER_PERIOD_EMA_SHIFT);
+        }
+    }
+    pacer->last_te_us = now_us;
+    pacer->stats.te_edges++;
+}
+
+frame_pacer_action_t frame_pacer_schedule(frame_pacer_t *pacer, int64_t now_us, uint32_t *wait_us)
+{
+    *wait_us = 0;
+    if (!frame_pacer_te_alive(pacer, now_us)) {
+        return FRAME_PACER_START;
+    }
+
+    int32_t lo, hi;
+    frame_pacer_window(pacer, &lo, &hi);
+    const int32_t phase = frame_pacer_phase(pacer, now_us);
+    if (phase >= lo && phase <= hi) {
+        return FRAME_PACER_START;
+    }
+
+    const int32_t period = (int32_t)pacer->period_us;
+    const uint32_t wait = (uint32_t)((phase < lo) ? (lo - phase) : (period - phase + lo));
+    if (wait > pacer->cfg.max_wait_us) {
+        pacer->stats.frames_dropped++;
+        return FRAME_PACER_DROP;
+    }
+    *wait_us = wait;
+    return FRAME_PACER_WAIT;
+}
+
+void frame_pacer_on_start(frame_pacer_t *pacer, int64_t now_us)
+{
+    pacer->stats.frames_started++;
+    pacer->start_us = now_us;
+
+    if (!frame_pacer_te_alive(pacer, now_us)) {
+        pacer->start_phase_us = -1;
+        pacer->stats.missed_vsync++;
+        return;
+    }
+
+    int32_t lo, hi;
+    frame_pacer_window(pacer, &lo, &hi);
+    pacer->start_phase_us = frame_pacer_phase(pacer, now_us);
+    if (pacer->start_phase_us < lo - FRAME_PACER_JITTER_US || pacer->start_phase_us > hi + FRAME_PACER_JITTER_US) {
+        pacer->stats.missed_vsync++;
+    }
+}
+
+void frame_pacer_on_done(frame_pacer_t *pacer, int64_t now_us)
+{
+    if (pacer->start_us == 0) {
+        return;
+    }
+    const int32_t xfer = (int32_t)(now_us - pacer->start_us);
+    pacer->start_us = 0;
+    if (pacer->stats.frames_started == 1) {
+        /* The first measurement replaces the guess, easing in from it would open the window too early */
+        pacer->transfer_us = xfer;
+    } else {
+        const int32_t dev = abs(xfer - (int32_t)pacer->transfer_us);
+        pacer->transfer_dev_us = (uint32_t)frame_pacer_ema((int32_t)pacer->transfer_dev_us, dev, FRAME_PACER_XFER_EMA_SHIFT);
+        pacer->transfer_us = frame_pacer_ema(pacer->transfer_us, xfer, FRAME_PACER_XFER_EMA_SHIFT);
+    }
+
+    /* Unsynchronised transfers were already counted as missed */
+    if (pacer->start_phase_us < 0) {
+        return;
+    }
+
+    const int32_t phase = pacer->start_phase_us;
+    const int32_t scan = pacer->cfg.scan_us;
+    const int32_t end = phase + xfer;
+    /* Either the whole write lands ahead of the next sweep, or it stays behind the current one */
+    const bool ahead = (phase <= FRAME_PACER_JITTER_US) && (end <= scan + FRAME_PACER_JITTER_US);
+    const bool behind = (end + FRAME_PACER_JITTER_US >= scan) &&
+                        (end <= (int32_t)pacer->period_us + scan + FRAME_PACER_JITTER_US);
+    if (!ahead && !behind) {
+        pacer->stats.tears++;
+    }
+}
+
+void frame_pacer_get_stats(const frame_pacer_t *pacer, frame_pacer_stats_t *stats)
+{
+    *stats = pacer->stats;
+    stats->period_us = pacer->period_us;
+    stats->transfer_us = pacer->transfer_us;
+}
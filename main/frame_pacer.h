@@ -0,0 +1,132 @@
+/* frame_pacer.h */
+
+/**
+ * @file
+ * @brief TE-synchronised frame pacing
+ *
+ * The panel raises TE once per scan-out. The scan-out reads the frame memory top to bottom during
+ * `scan_us` (Tvdl), then idles until the next edge (Tvdh). A frame transfer of `transfer_us` that
+ * also writes top to bottom is tear-free when it stays between two consecutive read sweeps, which
+ * gives a start window (phase after the TE edge) of:
+ *
+ *     max(0, scan_us - transfer_us) <= phase <= period_us + scan_us - transfer_us
+ *
+ * The pacer keeps a margin from both ends for TE jitter and for transfers that take longer or
+ * shorter than the estimate.
+ *
+ * The pacer keeps no OS state: timestamps are passed in by the caller, so the same code runs in
+ * the TE ISR / LVGL flush path and on a host against a synthetic TE signal.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief What the caller should do with the frame it is about to send
+ */
+typedef enum {
+    FRAME_PACER_START = 0,  /*!< Phase is inside the tear-free window, start the transfer now */
+    FRAME_PACER_WAIT,       /*!< Wait `wait_us`, then start the transfer */
+    FRAME_PACER_DROP,       /*!< Window is too far away, skip this frame and merge it into the next one */
+} frame_pacer_action_t;
+
+/**
+ * @brief Frame pacer configuration
+ */
+typedef struct {
+    uint32_t period_us;     /*!< Nominal TE period (Tvdl + Tvdh), refined from measured edges */
+    uint32_t scan_us;       /*!< Time the panel spends reading the frame memory (Tvdl) */
+    uint32_t max_wait_us;   /*!< Longest the caller may block for the window before the frame is dropped */
+} frame_pacer_config_t;
+
+/**
+ * @brief Frame pacer counters
+ */
+typedef struct {
+    uint32_t te_edges;          /*!< TE edges seen */
+    uint32_t frames_started;    /*!< Transfers started */
+    uint32_t frames_dropped;    /*!< Frames skipped because the window could not be reached in time */
+    uint32_t missed_vsync;      /*!< Transfers started outside the predicted window (late wake-up, no TE) */
+    uint32_t tears;             /*!< Transfers whose measured start/duration crossed the scan-out */
+    uint32_t period_us;         /*!< Current TE period estimate */
+    uint32_t transfer_us;       /*!< Current transfer duration estimate */
+} frame_pacer_stats_t;
+
+/**
+ * @brief Frame pacer state, owned by the caller
+ */
+typedef struct {
+    frame_pacer_config_t cfg;
+    int64_t last_te_us;         /* Timestamp of the latest TE edge, 0 if none yet */
+    int64_t start_us;           /* Start of the transfer in flight, 0 if idle */
+    int32_t start_phase_us;     /* Phase of `start_us` after the preceding (predicted) edge */
+    uint32_t period_us;         /* Period estimate */
+    uint32_t transfer_us;       /* Transfer duration estimate */
+    uint32_t transfer_dev_us;   /* Mean deviation of transfers from the estimate */
+    frame_pacer_stats_t stats;
+} frame_pacer_t;
+
+/**
+ * @brief Initialize pacer state
+ *
+ * @param[out] pacer Pacer state
+ * @param[in]  cfg   Configuration
+ */
+void frame_pacer_init(frame_pacer_t *pacer, const frame_pacer_config_t *cfg);
+
+/**
+ * @brief Record a TE edge
+ *
+ * @note Safe to call from ISR context (no blocking, no allocation).
+ *
+ * @param pacer  Pacer state
+ * @param now_us Edge timestamp in microseconds
+ */
+void frame_pacer_on_te(frame_pacer_t *pacer, int64_t now_us);
+
+/**
+ * @brief Decide when the next frame transfer should start
+ *
+ * @param[in]  pacer   Pacer state
+ * @param[in]  now_us  Current time in microseconds
+ * @param[out] wait_us Delay before starting, valid for FRAME_PACER_WAIT
+ *
+ * @return Action to take for this frame
+ */
+frame_pacer_action_t frame_pacer_schedule(frame_pacer_t *pacer, int64_t now_us, uint32_t *wait_us);
+
+/**
+ * @brief Record that a transfer has been started
+ *
+ * @param pacer  Pacer state
+ * @param now_us Start timestamp in microseconds
+ */
+void frame_pacer_on_start(frame_pacer_t *pacer, int64_t now_us);
+
+/**
+ * @brief Record that the last chunk of the transfer has completed
+ *
+ * @note Safe to call from ISR context.
+ *
+ * @param pacer  Pacer state
+ * @param now_us Completion timestamp in microseconds
+ */
+void frame_pacer_on_done(frame_pacer_t *pacer, int64_t now_us);
+
+/**
+ * @brief Copy current counters and estimates
+ *
+ * @param[in]  pacer Pacer state
+ * @param[out] stats Counters
+ */
+void frame_pacer_get_stats(const frame_pacer_t *pacer, frame_pacer_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
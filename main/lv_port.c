@@ -17,10 +17,15 @@
 #include "esp_lcd_panel_interface.h"
 
 #include "lv_port.h"
+#include "lv_port_profile.h"
+#include "lv_port_draw_async.h"
+#include "lv_port_frame.h"
+#include "mem_budget.h"
 #include "lvgl.h"
 
 #ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
 #include "esp_lcd_touch.h"
+#include "lv_port_touch_queue.h"
 #endif
 
 #if (ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(4, 4, 4)) || (ESP_IDF_VERSION == ESP_IDF_VERSION_VAL(5, 0, 0))
@@ -31,15 +36,49 @@
 
 static const char *TAG = "LVGL";
 
+/* LVGL task notification bits */
+#define LVGL_PORT_NOTIFY_WAKE   (1UL << 0)  /* Something may have been invalidated, run timers */
+#define LVGL_PORT_NOTIFY_INPUT  (1UL << 1)  /* Input device signalled, resume its read timer */
+
+/* Touch task notification bits */
+#define LVGL_PORT_TOUCH_NOTIFY_IRQ  (1UL << 0)  /* Interrupt of the touch controller */
+#define LVGL_PORT_TOUCH_NOTIFY_STOP (1UL << 1)  /* Touch removed, end the task */
+
+/* A frame dropped by the pacer on wake-up is retried this often before the panel is switched on anyway */
+#define LVGL_PORT_WAKE_FRAME_TRIES      (3)
+
+/* Animations run at full rate this long after the last input, so scrolling and tab slides stay smooth */
+#define LVGL_PORT_ANIM_INPUT_MS         (2000)
+/* Slowest animation step under the budget, beyond that an animation stops reading as motion */
+#define LVGL_PORT_ANIM_MAX_PERIOD_MS    (250)
+
+/* Transport buffers, each queued to the panel or free */
+#define LVGL_PORT_TRANS_BUFS            (2)
+
+/* Touch without interrupt is polled slower once it has been released for a while */
+#define LVGL_PORT_TOUCH_IDLE_MS         (2000)
+#define LVGL_PORT_TOUCH_IDLE_PERIOD_MS  (100)
+
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
 
 typedef struct lvgl_port_ctx_s {
     SemaphoreHandle_t   lvgl_mux;
-    esp_timer_handle_t  tick_timer;
+    TaskHandle_t        task;
+    bool                task_with_caps;     /* Stack from task_stack_caps, deleted with vTaskDeleteWithCaps() */
     bool                running;
+    bool                paused;
     int                 task_max_sleep_ms;
+    int                 anim_budget_pct;
+    uint32_t            wakeups;            /* Task wakeups in the current window */
+    int64_t             wakeups_since;      /* Start of the current window [us] */
+    uint32_t            wakeups_per_sec;    /* Rate over the last finished window */
+    lv_disp_t           *dropped_disp;   /* Display whose last frame was dropped and must be repainted */
+    lv_disp_t           *sleep_disp;        /* Display that is not rendered until the next touch */
+    lvgl_port_wake_cb   wake_cb;            /* Called from the task once a touch ends the sleep */
+    void                *wake_ctx;
+    bool                wake_pending;       /* Touch seen while sleeping, wake_cb not called yet */
 } lvgl_port_ctx_t;
 
 typedef struct {
@@ -51,17 +90,42 @@ typedef struct {
     lv_color_t                *trans_buf_1;     /* Buffer send to driver */
     lv_color_t                *trans_buf_2;     /* Buffer send to driver */
     lv_color_t                *trans_act;       /* Active buffer for sending to driver */
-    SemaphoreHandle_t         trans_done_sem;   /* Semaphore for signaling idle transfer */
+    SemaphoreHandle_t         trans_done_sem;   /* Counts the transport buffers not queued to the panel */
     lv_disp_rot_t             sw_rotate;        /* Panel software rotation mask */
 
     lvgl_port_wait_cb         draw_wait_cb;     /* Callback function for drawing */
+    lvgl_port_done_cb         draw_done_cb;     /* Callback function for finished frame */
+    lvgl_port_submit_cb       submit_cb;        /* Queues a transfer to the panel driver, NULL to draw and wait */
+    volatile uint32_t         trans_queued;     /* Transfers handed to the driver */
+    volatile uint32_t         trans_done;       /* Transfers completed */
+    volatile uint32_t         trans_frame_end;  /* Value of trans_done once the current frame is sent */
+    volatile uint32_t         trans_failed;     /* Queued transfers the driver reported failed, from its task */
+    uint32_t                  trans_failed_seen; /* Value of trans_failed the LVGL task has repainted for */
+    volatile bool             trans_refused;    /* The driver refused a queued area, full frames from now on */
+    lvgl_port_frame_t         frame;            /* Pacing of the refresh being flushed */
+    int64_t                   render_start_us;  /* Start of the frame being rendered */
+    uint32_t                  draw_time_us;     /* Averaged time LVGL spends rendering a frame */
+    uint32_t                  frame_wait_us;    /* Time the current frame waited for transport buffers */
+    uint32_t                  trans_wait_us;    /* Averaged time per frame waiting for transport buffers */
+    int64_t                   first_frame_us;   /* Time since boot when the first frame was rendered */
 } lvgl_port_display_ctx_t;
 
 #ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
-typedef struct {
+typedef struct lvgl_port_touch_ctx_s {
     esp_lcd_touch_handle_t  handle;        /* LCD touch IO handle */
     lv_indev_drv_t          indev_drv;     /* LVGL input device driver */
     lvgl_port_wait_cb       touch_wait_cb;  /* Callback function for touch */
+    bool                    irq;           /* Touch has an interrupt line, read only when signalled */
+    bool                    swallow;       /* Press that woke the display, hidden from LVGL until released */
+    TaskHandle_t            task;          /* Reads the controller into `queue` */
+    SemaphoreHandle_t       task_done;     /* Given by the task when it ends */
+    struct lvgl_port_touch_ctx_s *next;    /* Next touch woken by lvgl_port_input_from_isr() */
+    lvgl_port_touch_queue_t queue;         /* Readings from the task to the LVGL task */
+    lvgl_port_touch_event_t last;          /* Last reading LVGL took */
+    volatile uint32_t       reads;         /* Reads of the controller, by the task */
+    volatile uint32_t       events;        /* Readings queued, by the task */
+    volatile uint32_t       merged;        /* Readings replaced before they were queued, by the task */
+    uint32_t                latency_us;    /* Averaged time from a read to LVGL taking it */
 } lvgl_port_touch_ctx_t;
 #endif
 
@@ -69,22 +133,28 @@ typedef struct {
 * Local variables
 *******************************************************************************/
 static lvgl_port_ctx_t lvgl_port_ctx;
-static int lvgl_port_timer_period_ms = 5;
+#ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
+/* Touches with their tasks, for lvgl_port_input_from_isr() */
+static lvgl_port_touch_ctx_t *lvgl_port_touches;
+static portMUX_TYPE lvgl_port_touch_lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
 static void lvgl_port_task(void *arg);
-static esp_err_t lvgl_port_tick_init(void);
 static void lvgl_port_task_deinit(void);
 
 // LVGL callbacks
 #if LVGL_PORT_HANDLE_FLUSH_READY
 static bool lvgl_port_flush_ready_callback(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
 #endif
+static void lvgl_port_trans_done_callback(esp_lcd_panel_handle_t panel, esp_err_t status, void *user_ctx);
 static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
+static void lvgl_port_render_start_callback(lv_disp_drv_t *drv);
 #ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
 static void lvgl_port_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
+static void lvgl_port_touch_task(void *arg);
 #endif
 /*******************************************************************************
 * Public API functions
@@ -98,24 +168,28 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
 
     memset(&lvgl_port_ctx, 0, sizeof(lvgl_port_ctx));
 
-    /* LVGL init */
+    /* LVGL init, tick is read from esp_timer (LV_TICK_CUSTOM) */
     lv_init();
-    /* Tick init */
-    lvgl_port_timer_period_ms = cfg->timer_period_ms;
-    ESP_RETURN_ON_ERROR(lvgl_port_tick_init(), TAG, "");
     /* Create task */
     lvgl_port_ctx.task_max_sleep_ms = cfg->task_max_sleep_ms;
     if (lvgl_port_ctx.task_max_sleep_ms == 0) {
         lvgl_port_ctx.task_max_sleep_ms = 500;
     }
+    lvgl_port_ctx.anim_budget_pct = cfg->anim_budget_pct;
     lvgl_port_ctx.lvgl_mux = xSemaphoreCreateRecursiveMutex();
     ESP_GOTO_ON_FALSE(lvgl_port_ctx.lvgl_mux, ESP_ERR_NO_MEM, err, TAG, "Create LVGL mutex fail!");
 
     BaseType_t res;
-    if (cfg->task_affinity < 0) {
-        res = xTaskCreate(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority, NULL);
+    if (cfg->task_stack_caps) {
+        lvgl_port_ctx.task_with_caps = true;
+        res = xTaskCreatePinnedToCoreWithCaps(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority,
+                                              &lvgl_port_ctx.task,
+                                              cfg->task_affinity < 0 ? tskNO_AFFINITY : cfg->task_affinity,
+                                              cfg->task_stack_caps);
+    } else if (cfg->task_affinity < 0) {
+        res = xTaskCreate(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority, &lvgl_port_ctx.task);
     } else {
-        res = xTaskCreatePinnedToCore(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority, NULL, cfg->task_affinity);
+        res = xTaskCreatePinnedToCore(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority, &lvgl_port_ctx.task, cfg->task_affinity);
     }
     ESP_GOTO_ON_FALSE(res == pdPASS, ESP_FAIL, err, TAG, "Create LVGL task fail!");
 
@@ -131,9 +205,11 @@ esp_err_t lvgl_port_resume(void)
 {
     esp_err_t ret = ESP_ERR_INVALID_STATE;
 
-    if (lvgl_port_ctx.tick_timer != NULL) {
+    if (lvgl_port_ctx.task != NULL) {
         lv_timer_enable(true);
-        ret = esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_timer_period_ms * 1000);
+        lvgl_port_ctx.paused = false;
+        lvgl_port_wake();
+        ret = ESP_OK;
     }
 
     return ret;
@@ -143,9 +219,10 @@ esp_err_t lvgl_port_stop(void)
 {
     esp_err_t ret = ESP_ERR_INVALID_STATE;
 
-    if (lvgl_port_ctx.tick_timer != NULL) {
+    if (lvgl_port_ctx.task != NULL) {
         lv_timer_enable(false);
-        ret = esp_timer_stop(lvgl_port_ctx.tick_timer);
+        lvgl_port_ctx.paused = true;
+        ret = ESP_OK;
     }
 
     return ret;
@@ -153,16 +230,10 @@ esp_err_t lvgl_port_stop(void)
 
 esp_err_t lvgl_port_deinit(void)
 {
-    /* Stop and delete timer */
-    if (lvgl_port_ctx.tick_timer != NULL) {
-        esp_timer_stop(lvgl_port_ctx.tick_timer);
-        esp_timer_delete(lvgl_port_ctx.tick_timer);
-        lvgl_port_ctx.tick_timer = NULL;
-    }
-
     /* Stop running task */
     if (lvgl_port_ctx.running) {
         lvgl_port_ctx.running = false;
+        lvgl_port_wake();
     } else {
         lvgl_port_task_deinit();
     }
@@ -194,6 +265,21 @@ lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
     disp_ctx->trans_size = disp_cfg->trans_size;
     disp_ctx->sw_rotate = disp_cfg->sw_rotate;
     disp_ctx->draw_wait_cb = disp_cfg->draw_wait_cb;
+    disp_ctx->draw_done_cb = disp_cfg->draw_done_cb;
+    disp_ctx->submit_cb = disp_cfg->submit_cb;
+    disp_ctx->trans_done_sem = NULL;
+    disp_ctx->trans_queued = 0;
+    disp_ctx->trans_done = 0;
+    disp_ctx->trans_frame_end = 0;
+    disp_ctx->trans_failed = 0;
+    disp_ctx->trans_failed_seen = 0;
+    disp_ctx->trans_refused = false;
+    lvgl_port_frame_begin(&disp_ctx->frame);
+    disp_ctx->render_start_us = 0;
+    disp_ctx->draw_time_us = 0;
+    disp_ctx->frame_wait_us = 0;
+    disp_ctx->trans_wait_us = 0;
+    disp_ctx->first_frame_us = 0;
 
     uint32_t buff_caps = MALLOC_CAP_DEFAULT;
     if (disp_cfg->flags.buff_dma) {
@@ -204,7 +290,12 @@ lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
 
     /* alloc draw buffers used by LVGL */
     /* it's recommended to choose the size of the draw buffer(s) to be at least 1/10 screen sized */
+#if LVGL_PORT_DRAW_ASYNC
+    /* On whole cache lines, so the memcpy engine gets whole rows of the frame */
+    buf1 = heap_caps_aligned_alloc(ASYNC_COPY_ALIGN_MAX, disp_cfg->buffer_size * sizeof(lv_color_t), buff_caps);
+#else
     buf1 = heap_caps_malloc(disp_cfg->buffer_size * sizeof(lv_color_t), buff_caps);
+#endif
     ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf1) allocation!");
 
     if (disp_ctx->trans_size) {
@@ -219,14 +310,21 @@ lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
         ESP_GOTO_ON_FALSE(buf3, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffer(transport) allocation!");
         disp_ctx->trans_buf_2 = buf3;
 
-        trans_done_sem = xSemaphoreCreateCounting(1, 0);
+        /* Taken before a transport buffer is filled, given back once it is sent: both are free */
+        trans_done_sem = xSemaphoreCreateCounting(LVGL_PORT_TRANS_BUFS, LVGL_PORT_TRANS_BUFS);
         ESP_GOTO_ON_FALSE(trans_done_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create transport counting Semaphore");
         disp_ctx->trans_done_sem = trans_done_sem;
+        disp_ctx->trans_act = disp_ctx->trans_buf_1;
     }
 
     lv_disp_draw_buf_t *disp_buf = malloc(sizeof(lv_disp_draw_buf_t));
     ESP_GOTO_ON_FALSE(disp_buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL display buffer allocation!");
 
+    /* Nothing is freed from here on, report the buffers */
+    mem_budget_add("draw buffer", buf1, disp_cfg->buffer_size * sizeof(lv_color_t));
+    mem_budget_add("transport 1", buf2, disp_ctx->trans_size * sizeof(lv_color_t));
+    mem_budget_add("transport 2", buf3, disp_ctx->trans_size * sizeof(lv_color_t));
+
     /* initialize LVGL draw buffers */
     lv_disp_draw_buf_init(disp_buf, buf1, NULL, disp_cfg->buffer_size);
 
@@ -235,21 +333,35 @@ lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
     disp_ctx->disp_drv.hor_res = disp_cfg->hres;
     disp_ctx->disp_drv.ver_res = disp_cfg->vres;
     disp_ctx->disp_drv.flush_cb = lvgl_port_flush_callback;
+    disp_ctx->disp_drv.render_start_cb = lvgl_port_render_start_callback;
+#if LVGL_PORT_DRAW_ASYNC
+    /* Large opaque fills and copies go to the GDMA memcpy engine */
+    disp_ctx->disp_drv.draw_ctx_init = lvgl_port_draw_async_init_ctx;
+    disp_ctx->disp_drv.draw_ctx_deinit = lvgl_port_draw_async_deinit_ctx;
+    disp_ctx->disp_drv.draw_ctx_size = sizeof(lvgl_port_draw_async_ctx_t);
+#endif
 
     disp_ctx->disp_drv.draw_buf = disp_buf;
     disp_ctx->disp_drv.user_data = disp_ctx;
-    /* Force full_fresh */
-    disp_ctx->disp_drv.full_refresh = 1;
+    /* Whole frames from the first row down, unless the panel takes any window */
+    disp_ctx->disp_drv.full_refresh = !disp_cfg->flags.partial_refresh;
 
 #if LVGL_PORT_HANDLE_FLUSH_READY
-    /* Register done callback */
-    const esp_lcd_panel_io_callbacks_t cbs = {
-        .on_color_trans_done = lvgl_port_flush_ready_callback,
-    };
-    esp_lcd_panel_io_register_event_callbacks(disp_ctx->io_handle, &cbs, &disp_ctx->disp_drv);
+    /* Register done callback; a driver taking queued transfers reports them itself and may own the IO callback */
+    if (disp_ctx->submit_cb == NULL) {
+        const esp_lcd_panel_io_callbacks_t cbs = {
+            .on_color_trans_done = lvgl_port_flush_ready_callback,
+        };
+        esp_lcd_panel_io_register_event_callbacks(disp_ctx->io_handle, &cbs, &disp_ctx->disp_drv);
+    }
 #endif
 
     disp = lv_disp_drv_register(&disp_ctx->disp_drv);
+#if LVGL_PORT_PROFILE
+    if (disp) {
+        lvgl_port_profile_attach(disp);
+    }
+#endif
 
 err:
     if (ret != ESP_OK) {
@@ -282,8 +394,27 @@ esp_err_t lvgl_port_remove_disp(lv_disp_t *disp)
 
     lv_disp_remove(disp);
 
+    /* Transfers still queued report back into the context */
+    if (disp_ctx->trans_done_sem) {
+        for (int i = 0; i < LVGL_PORT_TRANS_BUFS; i++) {
+            xSemaphoreTake(disp_ctx->trans_done_sem, portMAX_DELAY);
+        }
+        vSemaphoreDelete(disp_ctx->trans_done_sem);
+    }
+    if (disp_ctx->trans_buf_1) {
+        mem_budget_remove(disp_ctx->trans_buf_1);
+        free(disp_ctx->trans_buf_1);
+        disp_ctx->trans_buf_1 = NULL;
+    }
+    if (disp_ctx->trans_buf_2) {
+        mem_budget_remove(disp_ctx->trans_buf_2);
+        free(disp_ctx->trans_buf_2);
+        disp_ctx->trans_buf_2 = NULL;
+    }
+
     if (disp_drv) {
         if (disp_drv->draw_buf && disp_drv->draw_buf->buf1) {
+            mem_budget_remove(disp_drv->draw_buf->buf1);
             free(disp_drv->draw_buf->buf1);
             disp_drv->draw_buf->buf1 = NULL;
         }
@@ -317,6 +448,22 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg)
     }
     touch_ctx->handle = touch_cfg->handle;
     touch_ctx->touch_wait_cb = touch_cfg->touch_wait_cb;
+    touch_ctx->irq = (touch_cfg->handle->config.int_gpio_num != GPIO_NUM_NC);
+    touch_ctx->swallow = false;
+    touch_ctx->task = NULL;
+    touch_ctx->next = NULL;
+    lvgl_port_touch_queue_init(&touch_ctx->queue);
+    memset(&touch_ctx->last, 0, sizeof(touch_ctx->last));
+    touch_ctx->reads = 0;
+    touch_ctx->events = 0;
+    touch_ctx->merged = 0;
+    touch_ctx->latency_us = 0;
+    touch_ctx->task_done = xSemaphoreCreateBinary();
+    if (touch_ctx->task_done == NULL) {
+        ESP_LOGE(TAG, "Not enough memory for touch task semaphore allocation!");
+        free(touch_ctx);
+        return NULL;
+    }
 
     /* Register a touchpad input device */
     lv_indev_drv_init(&touch_ctx->indev_drv);
@@ -324,7 +471,22 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg)
     touch_ctx->indev_drv.disp = touch_cfg->disp;
     touch_ctx->indev_drv.read_cb = lvgl_port_touchpad_read;
     touch_ctx->indev_drv.user_data = touch_ctx;
-    return lv_indev_drv_register(&touch_ctx->indev_drv);
+    lv_indev_t *indev = lv_indev_drv_register(&touch_ctx->indev_drv);
+
+    if (xTaskCreate(lvgl_port_touch_task, LVGL_PORT_TOUCH_TASK_NAME, LVGL_PORT_TOUCH_TASK_STACK, touch_ctx,
+                    LVGL_PORT_TOUCH_TASK_PRIORITY, &touch_ctx->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create touch task");
+        lv_indev_delete(indev);
+        vSemaphoreDelete(touch_ctx->task_done);
+        free(touch_ctx);
+        return NULL;
+    }
+    portENTER_CRITICAL(&lvgl_port_touch_lock);
+    touch_ctx->next = lvgl_port_touches;
+    lvgl_port_touches = touch_ctx;
+    portEXIT_CRITICAL(&lvgl_port_touch_lock);
+
+    return indev;
 }
 
 esp_err_t lvgl_port_remove_touch(lv_indev_t *touch)
@@ -334,6 +496,21 @@ esp_err_t lvgl_port_remove_touch(lv_indev_t *touch)
     assert(indev_drv);
     lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)indev_drv->user_data;
 
+    if (touch_ctx) {
+        /* No more interrupts for the task, then end it; it may be reading the controller */
+        portENTER_CRITICAL(&lvgl_port_touch_lock);
+        for (lvgl_port_touch_ctx_t **link = &lvgl_port_touches; *link != NULL; link = &(*link)->next) {
+            if (*link == touch_ctx) {
+                *link = touch_ctx->next;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&lvgl_port_touch_lock);
+        xTaskNotify(touch_ctx->task, LVGL_PORT_TOUCH_NOTIFY_STOP, eSetBits);
+        xSemaphoreTake(touch_ctx->task_done, portMAX_DELAY);
+        vSemaphoreDelete(touch_ctx->task_done);
+    }
+
     /* Remove input device driver */
     lv_indev_delete(touch);
 
@@ -343,6 +520,20 @@ esp_err_t lvgl_port_remove_touch(lv_indev_t *touch)
 
     return ESP_OK;
 }
+
+esp_err_t lvgl_port_get_touch_stats(lv_indev_t *touch, lvgl_port_touch_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(touch && stats && touch->driver->read_cb == lvgl_port_touchpad_read, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+    const lvgl_port_touch_ctx_t *touch_ctx = (const lvgl_port_touch_ctx_t *)touch->driver->user_data;
+
+    stats->reads = touch_ctx->reads;
+    stats->events = touch_ctx->events;
+    stats->merged = touch_ctx->merged;
+    stats->latency_us = touch_ctx->latency_us;
+
+    return ESP_OK;
+}
 #endif
 
 bool lvgl_port_lock(uint32_t timeout_ms)
@@ -357,6 +548,114 @@ void lvgl_port_unlock(void)
 {
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
     xSemaphoreGiveRecursive(lvgl_port_ctx.lvgl_mux);
+
+    /* Other tasks only lock LVGL to change it, let the LVGL task pick that up */
+    if (lvgl_port_ctx.task && xTaskGetCurrentTaskHandle() != lvgl_port_ctx.task) {
+        lvgl_port_wake();
+    }
+}
+
+void lvgl_port_wake(void)
+{
+    if (lvgl_port_ctx.task) {
+        xTaskNotify(lvgl_port_ctx.task, LVGL_PORT_NOTIFY_WAKE, eSetBits);
+    }
+}
+
+bool lvgl_port_input_from_isr(void)
+{
+    BaseType_t taskAwake = pdFALSE;
+    bool touch = false;
+
+#ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
+    /* Touch tasks read the controller and wake the LVGL task once there is something for it */
+    portENTER_CRITICAL_ISR(&lvgl_port_touch_lock);
+    for (lvgl_port_touch_ctx_t *touch_ctx = lvgl_port_touches; touch_ctx != NULL; touch_ctx = touch_ctx->next) {
+        xTaskNotifyFromISR(touch_ctx->task, LVGL_PORT_TOUCH_NOTIFY_IRQ, eSetBits, &taskAwake);
+        touch = true;
+    }
+    portEXIT_CRITICAL_ISR(&lvgl_port_touch_lock);
+#endif
+
+    if (!touch && lvgl_port_ctx.task) {
+        xTaskNotifyFromISR(lvgl_port_ctx.task, LVGL_PORT_NOTIFY_INPUT, eSetBits, &taskAwake);
+    }
+
+    return taskAwake == pdTRUE;
+}
+
+esp_err_t lvgl_port_sleep(lv_disp_t *disp, lvgl_port_wake_cb wake_cb, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(disp, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.sleep_disp == NULL, ESP_ERR_INVALID_STATE, TAG, "already sleeping");
+
+    /* Drop what is pending and ignore further changes, the refresh timer pauses itself with nothing to draw */
+    _lv_inv_area(disp, NULL);
+    lv_disp_enable_invalidation(disp, false);
+    lvgl_port_ctx.wake_cb = wake_cb;
+    lvgl_port_ctx.wake_ctx = user_ctx;
+    lvgl_port_ctx.wake_pending = false;
+    lvgl_port_ctx.sleep_disp = disp;
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_wake_disp(lv_disp_t *disp)
+{
+    ESP_RETURN_ON_FALSE(disp, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.sleep_disp == disp, ESP_ERR_INVALID_STATE, TAG, "not sleeping");
+
+    lvgl_port_ctx.sleep_disp = NULL;
+    lvgl_port_ctx.wake_pending = false;
+    lv_disp_enable_invalidation(disp, true);
+
+    /* Everything changed while asleep, render the whole screen now instead of on the next timer run */
+    for (int i = 0; i < LVGL_PORT_WAKE_FRAME_TRIES; i++) {
+        lv_obj_invalidate(lv_disp_get_scr_act(disp));
+        lv_refr_now(disp);
+        if (lvgl_port_ctx.dropped_disp != disp) {
+            return ESP_OK;
+        }
+        lvgl_port_ctx.dropped_disp = NULL;
+    }
+    ESP_LOGW(TAG, "Wake frame dropped %d times", LVGL_PORT_WAKE_FRAME_TRIES);
+    lv_obj_invalidate(lv_disp_get_scr_act(disp));
+
+    return ESP_ERR_TIMEOUT;
+}
+
+bool lvgl_port_is_sleeping(void)
+{
+    return lvgl_port_ctx.sleep_disp != NULL;
+}
+
+int64_t lvgl_port_get_first_frame_us(lv_disp_t *disp)
+{
+    assert(disp);
+    assert(disp->driver);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)disp->driver->user_data;
+    return disp_ctx->first_frame_us;
+}
+
+uint32_t lvgl_port_get_wakeups_per_sec(void)
+{
+    return lvgl_port_ctx.wakeups_per_sec;
+}
+
+uint32_t lvgl_port_get_draw_time_us(lv_disp_t *disp)
+{
+    assert(disp);
+    assert(disp->driver);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)disp->driver->user_data;
+    return disp_ctx->draw_time_us;
+}
+
+uint32_t lvgl_port_get_trans_wait_us(lv_disp_t *disp)
+{
+    assert(disp);
+    assert(disp->driver);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)disp->driver->user_data;
+    return disp_ctx->trans_wait_us;
 }
 
 void lvgl_port_flush_ready(lv_disp_t *disp)
@@ -370,29 +669,135 @@ void lvgl_port_flush_ready(lv_disp_t *disp)
 * Private functions
 *******************************************************************************/
 
+static void lvgl_port_resume_input(void)
+{
+    /* Read timers of touch are paused while released with nothing queued */
+    for (lv_indev_t *indev = lv_indev_get_next(NULL); indev != NULL; indev = lv_indev_get_next(indev)) {
+        if (indev->driver->read_timer) {
+            lv_timer_resume(indev->driver->read_timer);
+            lv_timer_ready(indev->driver->read_timer);
+        }
+    }
+}
+
+/*
+ * Every animation step ends in a frame. Without recent input, space the steps so frames driven only
+ * by animations take at most anim_budget_pct of the time; a decorative animation then can't keep
+ * the task rendering back to back.
+ */
+static void lvgl_port_anim_budget(void)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+    if (lvgl_port_ctx.anim_budget_pct <= 0 || disp == NULL) {
+        return;
+    }
+
+    uint32_t period_ms = LV_DISP_DEF_REFR_PERIOD;
+    if (lv_disp_get_inactive_time(disp) >= LVGL_PORT_ANIM_INPUT_MS) {
+        const lvgl_port_display_ctx_t *disp_ctx = (const lvgl_port_display_ctx_t *)disp->driver->user_data;
+        period_ms = disp_ctx->draw_time_us / (10 * lvgl_port_ctx.anim_budget_pct);
+        if (period_ms < LV_DISP_DEF_REFR_PERIOD) {
+            period_ms = LV_DISP_DEF_REFR_PERIOD;
+        } else if (period_ms > LVGL_PORT_ANIM_MAX_PERIOD_MS) {
+            period_ms = LVGL_PORT_ANIM_MAX_PERIOD_MS;
+        }
+    }
+
+    lv_timer_t *anim_timer = lv_anim_get_timer();
+    if (anim_timer->period != period_ms) {
+        lv_timer_set_period(anim_timer, period_ms);
+    }
+}
+
+/* Queued transfers fail after their flush has returned: repaint, in full frames if the panel refused an area */
+static void lvgl_port_trans_failures(void)
+{
+    for (lv_disp_t *disp = lv_disp_get_next(NULL); disp != NULL; disp = lv_disp_get_next(disp)) {
+        lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)disp->driver->user_data;
+        const uint32_t failed = disp_ctx->trans_failed;
+        if (failed == disp_ctx->trans_failed_seen) {
+            continue;
+        }
+        disp_ctx->trans_failed_seen = failed;
+        if (disp_ctx->trans_refused && !disp->driver->full_refresh) {
+            ESP_LOGW(TAG, "Panel refused an area, sending full frames from now on");
+            disp->driver->full_refresh = 1;
+        }
+        lv_obj_invalidate(lv_disp_get_scr_act(disp));
+    }
+}
+
+static void lvgl_port_count_wakeup(void)
+{
+    const int64_t now = esp_timer_get_time();
+    const int64_t elapsed = now - lvgl_port_ctx.wakeups_since;
+
+    lvgl_port_ctx.wakeups++;
+    if (elapsed >= 1000000) {
+        lvgl_port_ctx.wakeups_per_sec = (uint32_t)((lvgl_port_ctx.wakeups * 1000000LL) / elapsed);
+        lvgl_port_ctx.wakeups = 0;
+        lvgl_port_ctx.wakeups_since = now;
+    }
+}
+
 static void lvgl_port_task(void *arg)
 {
     uint32_t task_delay_ms = lvgl_port_ctx.task_max_sleep_ms;
+    uint32_t notify = 0;
 
     ESP_LOGI(TAG, "Starting LVGL task");
     lvgl_port_ctx.running = true;
+    lvgl_port_ctx.wakeups_since = esp_timer_get_time();
     while (lvgl_port_ctx.running) {
         if (lvgl_port_lock(0)) {
+            if (notify & LVGL_PORT_NOTIFY_INPUT) {
+                lvgl_port_resume_input();
+            }
+            lvgl_port_anim_budget();
             task_delay_ms = lv_timer_handler();
+            if (lvgl_port_ctx.dropped_disp) {
+                /* Dropped frame can't be invalidated while rendering, merge it into the next one */
+                lv_obj_invalidate(lv_disp_get_scr_act(lvgl_port_ctx.dropped_disp));
+                lvgl_port_ctx.dropped_disp = NULL;
+            }
+            lvgl_port_trans_failures();
+            if (lvgl_port_ctx.wake_pending) {
+                lvgl_port_ctx.wake_pending = false;
+                if (lvgl_port_ctx.wake_cb) {
+                    lvgl_port_ctx.wake_cb(lvgl_port_ctx.sleep_disp, lvgl_port_ctx.wake_ctx);
+                } else {
+                    lvgl_port_wake_disp(lvgl_port_ctx.sleep_disp);
+                }
+                task_delay_ms = 0;
+            }
             lvgl_port_unlock();
         }
-        if ((task_delay_ms > lvgl_port_ctx.task_max_sleep_ms) || (1 == task_delay_ms)) {
-            task_delay_ms = lvgl_port_ctx.task_max_sleep_ms;
-        } else if (task_delay_ms < 1) {
-            task_delay_ms = 1;
+
+        /* Sleep until the next LVGL timer is due or somebody has something for us */
+        TickType_t wait_ticks = portMAX_DELAY;
+        if (!lvgl_port_ctx.paused && task_delay_ms != LV_NO_TIMER_READY) {
+            if (task_delay_ms > lvgl_port_ctx.task_max_sleep_ms) {
+                task_delay_ms = lvgl_port_ctx.task_max_sleep_ms;
+            }
+            wait_ticks = pdMS_TO_TICKS(task_delay_ms);
+            if (wait_ticks < 1) {
+                wait_ticks = 1;
+            }
         }
-        vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
+        notify = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &notify, wait_ticks);
+        lvgl_port_count_wakeup();
     }
 
+    const bool with_caps = lvgl_port_ctx.task_with_caps;
     lvgl_port_task_deinit();
 
     /* Close task */
-    vTaskDelete(NULL);
+    if (with_caps) {
+        vTaskDeleteWithCaps(NULL);
+    } else {
+        vTaskDelete(NULL);
+    }
 }
 
 static void lvgl_port_task_deinit(void)
@@ -421,16 +826,70 @@ static bool lvgl_port_flush_ready_callback(esp_lcd_panel_io_handle_t panel_io, e
         xSemaphoreGiveFromISR(disp_ctx->trans_done_sem, &taskAwake);
     }
 
+    if (++disp_ctx->trans_done == disp_ctx->trans_frame_end && disp_ctx->draw_done_cb) {
+        disp_ctx->draw_done_cb(disp_ctx->panel_handle->user_data);
+    }
+
     return false;
 }
 #endif
 
+static void lvgl_port_trans_done_callback(esp_lcd_panel_handle_t panel, esp_err_t status, void *user_ctx)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)user_ctx;
+    assert(disp_ctx != NULL);
+
+    if (status != ESP_OK) {
+        if (status == ESP_ERR_NOT_SUPPORTED) {
+            disp_ctx->trans_refused = true;
+        }
+        disp_ctx->trans_failed++;
+        lvgl_port_wake();
+    }
+
+    /* Frame end first: the LVGL task may be waiting for this buffer to pace the next frame */
+    if (++disp_ctx->trans_done == disp_ctx->trans_frame_end && disp_ctx->draw_done_cb) {
+        disp_ctx->draw_done_cb(disp_ctx->panel_handle->user_data);
+    }
+    xSemaphoreGive(disp_ctx->trans_done_sem);
+}
+
+static void lvgl_port_render_start_callback(lv_disp_drv_t *drv)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)drv->user_data;
+    disp_ctx->render_start_us = esp_timer_get_time();
+    lvgl_port_frame_begin(&disp_ctx->frame);
+#if LVGL_PORT_PROFILE
+    lvgl_port_profile_frame_begin(drv);
+#endif
+}
+
 static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
     assert(drv != NULL);
     lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)drv->user_data;
     assert(disp_ctx != NULL);
 
+#if LVGL_PORT_DRAW_ASYNC
+    /* Copies of the memcpy engine still queued for this area */
+    lvgl_port_draw_async_finish(drv->draw_ctx);
+#endif
+
+    /* Rendering of the frame ends where its last area is flushed */
+    if (disp_ctx->render_start_us && lv_disp_flush_is_last(drv)) {
+        const int64_t now = esp_timer_get_time();
+        const int32_t sample = (int32_t)(now - disp_ctx->render_start_us);
+        const int32_t avg = (int32_t)disp_ctx->draw_time_us;
+        disp_ctx->draw_time_us = avg ? (uint32_t)(avg + ((sample - avg) >> 3)) : (uint32_t)sample;
+        disp_ctx->render_start_us = 0;
+        if (disp_ctx->first_frame_us == 0) {
+            disp_ctx->first_frame_us = now;
+        }
+#if LVGL_PORT_PROFILE
+        lvgl_port_profile_frame_end(drv, color_map, (uint32_t)sample);
+#endif
+    }
+
     const int x_start = area->x1;
     const int x_end = area->x2;
     const int y_start = area->y1;
@@ -441,7 +900,12 @@ static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area,
     lv_color_t *from = color_map;
     lv_color_t *to = NULL;
 
-    if (disp_ctx->trans_size) {
+    /* With partial refresh only the first area of a refresh is paced, the others follow it */
+    const lvgl_port_area_action_t action = lvgl_port_frame_area(&disp_ctx->frame);
+
+    if (action == LVGL_PORT_AREA_SKIP) {
+        /* Part of a dropped refresh, the whole screen is repainted with the next one */
+    } else if (disp_ctx->trans_size) {
         assert(disp_ctx->trans_buf_1 != NULL);
 
         int x_draw_start = 0;
@@ -450,7 +914,6 @@ static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area,
         int y_draw_end = 0;
         int trans_count = 0;
 
-        disp_ctx->trans_act = disp_ctx->trans_buf_1;
         int rotate = disp_ctx->sw_rotate;
 
         int x_start_tmp = 0;
@@ -493,8 +956,16 @@ static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area,
                 y_start_tmp = (y_end_tmp - y_start + 1) > max_height ? (y_end_tmp - max_height + 1) : y_start;
             }
 
-            disp_ctx->trans_act = (disp_ctx->trans_act == disp_ctx->trans_buf_1) ? (disp_ctx->trans_buf_2) : (disp_ctx->trans_buf_1);
-            to = disp_ctx->trans_act;
+            /* A free transport buffer. Transfers finish in order, so it is the one not sent last */
+            const int64_t wait_start = esp_timer_get_time();
+            xSemaphoreTake(disp_ctx->trans_done_sem, portMAX_DELAY);
+            if (0 == i && action == LVGL_PORT_AREA_PACE && (disp_ctx->draw_wait_cb || disp_ctx->draw_done_cb)) {
+                /* Frames are paced from the end of the previous one, let it go out completely */
+                xSemaphoreTake(disp_ctx->trans_done_sem, portMAX_DELAY);
+                xSemaphoreGive(disp_ctx->trans_done_sem);
+            }
+            disp_ctx->frame_wait_us += (uint32_t)(esp_timer_get_time() - wait_start);
+            to = (disp_ctx->trans_act == disp_ctx->trans_buf_1) ? (disp_ctx->trans_buf_2) : (disp_ctx->trans_buf_1);
 
             switch (rotate) {
             case LV_DISP_ROT_90:
@@ -546,14 +1017,42 @@ static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area,
             }
 
             if (0 == i) {
-                if (disp_ctx->draw_wait_cb) {
-                    disp_ctx->draw_wait_cb(disp_ctx->panel_handle->user_data);
+                if (action == LVGL_PORT_AREA_PACE) {
+                    const bool send = !disp_ctx->draw_wait_cb || disp_ctx->draw_wait_cb(disp_ctx->panel_handle->user_data);
+                    lvgl_port_frame_paced(&disp_ctx->frame, send);
+                    if (!send) {
+                        xSemaphoreGive(disp_ctx->trans_done_sem);
+                        lvgl_port_ctx.dropped_disp = _lv_refr_get_disp_refreshing();
+                        break;
+                    }
+                }
+                if (lv_disp_flush_is_last(drv)) {
+                    /* The frame ends with its last area. The previous end has passed, the first area drained it */
+                    disp_ctx->trans_frame_end = disp_ctx->trans_queued + trans_count;
                 }
-                xSemaphoreGive(disp_ctx->trans_done_sem);
             }
 
-            xSemaphoreTake(disp_ctx->trans_done_sem, portMAX_DELAY);
-            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_draw_start, y_draw_start, x_draw_end + 1, y_draw_end + 1, to);
+            esp_err_t err;
+            if (disp_ctx->submit_cb) {
+                /* Queued, the driver calls back once it is sent; the LVGL task renders on meanwhile */
+                err = disp_ctx->submit_cb(disp_ctx->panel_handle, x_draw_start, y_draw_start, x_draw_end + 1, y_draw_end + 1, to,
+                                          lvgl_port_trans_done_callback, disp_ctx, portMAX_DELAY);
+            } else {
+                err = esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_draw_start, y_draw_start, x_draw_end + 1, y_draw_end + 1, to);
+            }
+            if (err != ESP_OK) {
+                /* Nothing was queued, so nothing gives the semaphore back */
+                xSemaphoreGive(disp_ctx->trans_done_sem);
+                if (err == ESP_ERR_NOT_SUPPORTED && !drv->full_refresh) {
+                    ESP_LOGW(TAG, "Panel refused area %d,%d %dx%d, sending full frames from now on",
+                             x_draw_start, y_draw_start, x_draw_end - x_draw_start + 1, y_draw_end - y_draw_start + 1);
+                    drv->full_refresh = 1;
+                }
+                lvgl_port_ctx.dropped_disp = _lv_refr_get_disp_refreshing();
+                break;
+            }
+            disp_ctx->trans_act = to;
+            disp_ctx->trans_queued++;
 
             if (LV_DISP_ROT_90 == rotate) {
                 x_start_tmp += max_width;
@@ -568,55 +1067,122 @@ static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area,
     } else {
         esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_start, y_start, x_end + 1, y_end + 1, color_map);
     }
+
+    if (lv_disp_flush_is_last(drv)) {
+        const int32_t sample = (int32_t)disp_ctx->frame_wait_us;
+        const int32_t avg = (int32_t)disp_ctx->trans_wait_us;
+        disp_ctx->trans_wait_us = avg ? (uint32_t)(avg + ((sample - avg) >> 3)) : (uint32_t)sample;
+        disp_ctx->frame_wait_us = 0;
+    }
     lv_disp_flush_ready(drv);
 }
 
 #ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
-static void lvgl_port_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
+/*
+ * Reads the controller and queues what LVGL has to see: presses, moves and the release. A released
+ * touch is read after its interrupt (confirmed by touch_wait_cb) or, without an interrupt line,
+ * polled. A pressed one is read every input period, the release may come without an interrupt.
+ */
+static void lvgl_port_touch_task(void *arg)
 {
-    assert(indev_drv);
-    lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)indev_drv->user_data;
-    assert(touch_ctx->handle);
-
-    uint16_t touchpad_x[1] = {0};
-    uint16_t touchpad_y[1] = {0};
-    uint8_t touchpad_cnt = 0;
-
-    /* Read data from touch controller into memory */
-    bool touch_int = false;
-    if (touch_ctx->touch_wait_cb) {
-        touch_int = touch_ctx->touch_wait_cb(touch_ctx->handle->config.user_data);
-    }
-    if (touch_int) {
-        esp_lcd_touch_read_data(touch_ctx->handle);
-        /* Read data from touch controller */
-        bool touchpad_pressed = esp_lcd_touch_get_coordinates(touch_ctx->handle, touchpad_x, touchpad_y, NULL, &touchpad_cnt, 1);
-
-        if (touchpad_pressed && touchpad_cnt > 0) {
-            data->point.x = touchpad_x[0];
-            data->point.y = touchpad_y[0];
-            data->state = LV_INDEV_STATE_PRESSED;
-            esp_rom_printf("Touchpad pressed: x=%d, y=%d\n", data->point.x, data->point.y);
-        } else {
-            data->state = LV_INDEV_STATE_RELEASED;
+    lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)arg;
+    lvgl_port_touch_event_t reading = { 0 };
+    bool pending = false;   /* `reading` not queued yet, the queue was full */
+    bool pressed = false;
+    int64_t last_press_us = esp_timer_get_time();
+
+    for (;;) {
+        TickType_t wait_ticks = pdMS_TO_TICKS(LV_INDEV_DEF_READ_PERIOD);
+        if (!pressed && !pending) {
+            if (touch_ctx->irq) {
+                wait_ticks = portMAX_DELAY;
+            } else if (esp_timer_get_time() - last_press_us > LVGL_PORT_TOUCH_IDLE_MS * 1000LL) {
+                wait_ticks = pdMS_TO_TICKS(LVGL_PORT_TOUCH_IDLE_PERIOD_MS);
+            }
+        }
+        uint32_t notify = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &notify, wait_ticks);
+        if (notify & LVGL_PORT_TOUCH_NOTIFY_STOP) {
+            break;
+        }
+
+        /* Called while pressed too, to clear an interrupt the read below answers */
+        bool signalled = true;
+        if (touch_ctx->touch_wait_cb) {
+            signalled = touch_ctx->touch_wait_cb(touch_ctx->handle->config.user_data);
+        }
+        if (signalled || pressed) {
+            uint16_t touchpad_x[1] = {0};
+            uint16_t touchpad_y[1] = {0};
+            uint8_t touchpad_cnt = 0;
+
+            esp_lcd_touch_read_data(touch_ctx->handle);
+            const bool now_pressed = esp_lcd_touch_get_coordinates(touch_ctx->handle, touchpad_x, touchpad_y, NULL,
+                                                                   &touchpad_cnt, 1) && touchpad_cnt > 0;
+            touch_ctx->reads++;
+
+            /* A touch that stays released is not queued. A release keeps the point of the last press */
+            if (now_pressed || pressed) {
+                if (pending) {
+                    /* LVGL is behind, it gets the latest state */
+                    touch_ctx->merged++;
+                }
+                reading.time_us = esp_timer_get_time();
+                reading.pressed = now_pressed;
+                if (now_pressed) {
+                    reading.x = touchpad_x[0];
+                    reading.y = touchpad_y[0];
+                    last_press_us = reading.time_us;
+                }
+                pressed = now_pressed;
+                pending = true;
+            }
+        }
+
+        if (pending && lvgl_port_touch_queue_push(&touch_ctx->queue, &reading)) {
+            pending = false;
+            touch_ctx->events++;
+            if (lvgl_port_ctx.task) {
+                xTaskNotify(lvgl_port_ctx.task, LVGL_PORT_NOTIFY_INPUT, eSetBits);
+            }
         }
     }
-}
-#endif
 
-static void lvgl_port_tick_increment(void *arg)
-{
-    /* Tell LVGL how many milliseconds have elapsed */
-    lv_tick_inc(lvgl_port_timer_period_ms);
+    xSemaphoreGive(touch_ctx->task_done);
+    vTaskDelete(NULL);
 }
 
-static esp_err_t lvgl_port_tick_init(void)
+static void lvgl_port_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
 {
-    // Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = &lvgl_port_tick_increment,
-        .name = "LVGL tick",
-    };
-    ESP_RETURN_ON_ERROR(esp_timer_create(&lvgl_tick_timer_args, &lvgl_port_ctx.tick_timer), TAG, "Creating LVGL timer filed!");
-    return esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_timer_period_ms * 1000);
+    assert(indev_drv);
+    lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)indev_drv->user_data;
+
+    /* One reading per call; LVGL calls again right away while more are queued, so it sees every move */
+    lvgl_port_touch_event_t event;
+    if (lvgl_port_touch_queue_pop(&touch_ctx->queue, &event)) {
+        const int32_t sample = (int32_t)(esp_timer_get_time() - event.time_us);
+        const int32_t avg = (int32_t)touch_ctx->latency_us;
+        touch_ctx->latency_us = avg ? (uint32_t)(avg + ((sample - avg) >> 3)) : (uint32_t)sample;
+        touch_ctx->last = event;
+        data->continue_reading = !lvgl_port_touch_queue_empty(&touch_ctx->queue);
+    }
+    /* Without a new reading the last one still holds */
+    const bool pressed = touch_ctx->last.pressed;
+    data->point.x = touch_ctx->last.x;
+    data->point.y = touch_ctx->last.y;
+
+    /* A touch on a sleeping display only wakes it, it must not reach the widgets under the finger */
+    if (pressed && lvgl_port_ctx.sleep_disp == indev_drv->disp && !touch_ctx->swallow) {
+        touch_ctx->swallow = true;
+        lvgl_port_ctx.wake_pending = true;
+    } else if (!pressed) {
+        touch_ctx->swallow = false;
+    }
+    data->state = (pressed && !touch_ctx->swallow) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    /* Held presses are reported every period for long presses; released, the touch task resumes the timer */
+    if (!pressed && lvgl_port_touch_queue_empty(&touch_ctx->queue)) {
+        lv_timer_pause(indev_drv->read_timer);
+    }
 }
+#endif
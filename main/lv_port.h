@@ -11,6 +11,7 @@
 #include "driver/gpio.h"
 #include "esp_err.h"
 #include "esp_lcd_types.h"
+#include "freertos/FreeRTOS.h"
 #include "lvgl.h"
 
 #if __has_include ("esp_lcd_touch.h")
@@ -24,6 +25,38 @@ extern "C" {
 
 typedef bool (*lvgl_port_wait_cb)(void *handle);
 
+/**
+ * @brief Called when the last transfer of a frame has completed: from ISR context, or from the panel driver's task
+ *        with `submit_cb`
+ */
+typedef void (*lvgl_port_done_cb)(void *handle);
+
+/**
+ * @brief Called by the panel driver, from its own task, once a transfer of `lvgl_port_submit_cb` is done
+ *
+ * @param panel    LCD panel handle
+ * @param status   ESP_OK if sent; ESP_ERR_NOT_SUPPORTED if the panel can't take the area, else the transfer failed
+ * @param user_ctx `user_ctx` of the submission
+ */
+typedef void (*lvgl_port_trans_done_cb)(esp_lcd_panel_handle_t panel, esp_err_t status, void *user_ctx);
+
+/**
+ * @brief Queue a transfer to the panel driver and return; waits up to `ticks_to_wait` while the driver's queue is full
+ *
+ * @note  Same as esp_lcd_panel_draw_bitmap(), with `done_cb` called once `color_data` may be reused.
+ *        `esp_lcd_axs15231b_draw_bitmap_async()` is one.
+ *
+ * @return ESP_OK if queued, `done_cb` follows; else nothing was queued
+ */
+typedef esp_err_t (*lvgl_port_submit_cb)(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                         const void *color_data, lvgl_port_trans_done_cb done_cb, void *user_ctx,
+                                         TickType_t ticks_to_wait);
+
+/**
+ * @brief Called from the LVGL task (mutex held) when a touch ends the sleep started by lvgl_port_sleep()
+ */
+typedef void (*lvgl_port_wake_cb)(lv_disp_t *disp, void *user_ctx);
+
 /**
  * @brief Init configuration structure
  */
@@ -31,14 +64,18 @@ typedef struct {
     int task_priority;      /*!< LVGL task priority */
     int task_stack;         /*!< LVGL task stack size */
     int task_affinity;      /*!< LVGL task pinned to core (-1 is no affinity) */
-    int task_max_sleep_ms;  /*!< Maximum sleep in LVGL task */
-    int timer_period_ms;    /*!< LVGL timer tick period in ms */
+    uint32_t task_stack_caps; /*!< Heap caps of the LVGL task stack, 0 for the default (internal RAM) */
+    int task_max_sleep_ms;  /*!< Maximum sleep in LVGL task while an LVGL timer is pending */
+    int anim_budget_pct;    /*!< Share of time animations may keep LVGL rendering without user input, 0 for no limit */
 } lvgl_port_cfg_t;
 
 typedef struct {
     esp_lcd_panel_io_handle_t io_handle;    /*!< LCD panel IO handle */
     esp_lcd_panel_handle_t panel_handle;    /*!< LCD panel handle */
-    lvgl_port_wait_cb draw_wait_cb;
+    lvgl_port_wait_cb draw_wait_cb;         /*!< Called before a frame is sent, returning false drops the frame */
+    lvgl_port_done_cb draw_done_cb;         /*!< Called from ISR, or the driver's task with submit_cb, when the frame has been sent */
+    lvgl_port_submit_cb submit_cb;          /*!< Queues transfers so LVGL renders on while they are sent, NULL to draw and
+                                                 wait. Without it the port registers the IO's on_color_trans_done */
 
     uint32_t    buffer_size;    /*!< Size of the buffer for the screen in pixels */
     uint32_t    trans_size;     /*!< Allocated buffer will be in SRAM to move framebuf */
@@ -48,6 +85,7 @@ typedef struct {
     struct {
         unsigned int buff_dma: 1;    /*!< Allocated LVGL buffer will be DMA capable */
         unsigned int buff_spiram: 1; /*!< Allocated LVGL buffer will be in PSRAM */
+        unsigned int partial_refresh: 1; /*!< Render and send only the changed areas; full frames once the panel refuses one */
     } flags;
 } lvgl_port_display_cfg_t;
 
@@ -59,10 +97,26 @@ typedef struct {
     lv_disp_t *disp;    /*!< LVGL display handle (returned from lvgl_port_add_disp) */
     esp_lcd_touch_handle_t   handle;   /*!< LCD touch IO handle */
 
-    lvgl_port_wait_cb touch_wait_cb;
+    lvgl_port_wait_cb touch_wait_cb;    /*!< Called by the touch task before it reads a released touch, false if
+                                             there is nothing new (no interrupt since the last read). May be NULL */
 } lvgl_port_touch_cfg_t;
+
+/**
+ * @brief Touch readings of lvgl_port_get_touch_stats()
+ */
+typedef struct {
+    uint32_t reads;         /*!< Reads of the controller */
+    uint32_t events;        /*!< Readings queued to LVGL: presses, moves and releases */
+    uint32_t merged;        /*!< Readings replaced by a newer one while LVGL had not taken the queue */
+    uint32_t latency_us;    /*!< Moving average from the read of the controller to LVGL taking it */
+} lvgl_port_touch_stats_t;
 #endif
 
+/* Task of each touch added with lvgl_port_add_touch(), reading the controller; above the LVGL task (4) */
+#define LVGL_PORT_TOUCH_TASK_PRIORITY   (5)
+#define LVGL_PORT_TOUCH_TASK_STACK      (3072)
+#define LVGL_PORT_TOUCH_TASK_NAME       "LVGL touch"
+
 /**
  * @brief LVGL port configuration structure
  *
@@ -73,7 +127,7 @@ typedef struct {
         .task_stack = 4096,       \
         .task_affinity = -1,      \
         .task_max_sleep_ms = 500, \
-        .timer_period_ms = 5,     \
+        .anim_budget_pct = 25,    \
     }
 
 /**
@@ -124,6 +178,11 @@ esp_err_t lvgl_port_remove_disp(lv_disp_t *disp);
 /**
  * @brief Add LCD touch as an input device
  *
+ * The controller is read by a task of its own (LVGL_PORT_TOUCH_TASK_NAME), which queues timestamped readings
+ * for LVGL. With an interrupt line it reads a released touch only after lvgl_port_input_from_isr(), without
+ * one it polls, slower once the touch has been released for a while. While pressed it reads every LVGL input
+ * period to follow the finger and see the release. LVGL's read callback only takes the queue.
+ *
  * @note Allocated memory in this function is not free in deinit. You must call lvgl_port_remove_touch for free all memory!
  *
  * @param touch_cfg Touch configuration structure
@@ -140,6 +199,18 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg);
  *      - ESP_OK                    on success
  */
 esp_err_t lvgl_port_remove_touch(lv_indev_t *touch);
+
+/**
+ * @brief Get the counters of a touch added with lvgl_port_add_touch()
+ *
+ * @param touch      LVGL input device (returned from lvgl_port_add_touch)
+ * @param[out] stats Counters since the touch was added
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       `touch` is not a touch of the port
+ */
+esp_err_t lvgl_port_get_touch_stats(lv_indev_t *touch, lvgl_port_touch_stats_t *stats);
 #endif
 
 /**
@@ -156,9 +227,102 @@ bool lvgl_port_lock(uint32_t timeout_ms);
 /**
  * @brief Give LVGL mutex
  *
+ * @note When called from a task other than the LVGL task, the LVGL task is woken up to process the changes.
  */
 void lvgl_port_unlock(void);
 
+/**
+ * @brief Wake up the LVGL task
+ *
+ * @note The LVGL task sleeps until the next LVGL timer is due. Use this after changing LVGL state without
+ * lvgl_port_lock()/lvgl_port_unlock().
+ */
+void lvgl_port_wake(void);
+
+/**
+ * @brief Signal an input device interrupt
+ *
+ * @note Wakes the touch tasks of lvgl_port_add_touch(), which read the controller and pass the reading on to
+ *       LVGL. Without a touch it wakes the LVGL task, which resumes read timers of input devices that are
+ *       paused while idle.
+ *
+ * @return true if a higher priority task was woken and the ISR should yield
+ */
+bool lvgl_port_input_from_isr(void);
+
+/**
+ * @brief Stop rendering a display until it is touched
+ *
+ * Invalidation of the display is disabled, so widgets keep being updated but nothing is drawn or
+ * sent to the panel. LVGL timers and touch reading go on. The first press is not passed to LVGL,
+ * instead `wake_cb` is called, which must end the sleep with lvgl_port_wake_disp().
+ * Without `wake_cb` the display is woken directly.
+ *
+ * @note Call with the LVGL mutex held.
+ *
+ * @param disp     LVGL display handle (returned from lvgl_port_add_disp)
+ * @param wake_cb  Called when a touch requests a wake-up, may be NULL
+ * @param user_ctx Passed to `wake_cb`
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     a display is already sleeping
+ */
+esp_err_t lvgl_port_sleep(lv_disp_t *disp, lvgl_port_wake_cb wake_cb, void *user_ctx);
+
+/**
+ * @brief End the sleep of a display and render a full frame right away
+ *
+ * @note Call with the LVGL mutex held. When this returns, the frame has been queued to the panel.
+ *
+ * @param disp LVGL display handle passed to lvgl_port_sleep()
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     display is not sleeping
+ *      - ESP_ERR_TIMEOUT           frame pacing dropped every attempt, the frame follows on the next refresh
+ */
+esp_err_t lvgl_port_wake_disp(lv_disp_t *disp);
+
+/**
+ * @brief Check whether a display is sleeping
+ */
+bool lvgl_port_is_sleeping(void);
+
+/**
+ * @brief Get the time LVGL spends rendering a frame, from render start to the last flush
+ *
+ * @param disp LVGL display handle (returned from lvgl_port_add_disp)
+ *
+ * @return Moving average in microseconds, 0 before the first frame
+ */
+uint32_t lvgl_port_get_draw_time_us(lv_disp_t *disp);
+
+/**
+ * @brief Get the time a frame waits for free transport buffers, the part of the flushes spent on the panel bus
+ *
+ * @param disp LVGL display handle (returned from lvgl_port_add_disp)
+ *
+ * @return Moving average in microseconds per frame, 0 before the first frame
+ */
+uint32_t lvgl_port_get_trans_wait_us(lv_disp_t *disp);
+
+/**
+ * @brief Get when the first frame was rendered and handed to the panel
+ *
+ * @param disp LVGL display handle (returned from lvgl_port_add_disp)
+ *
+ * @return Time since boot in microseconds, 0 before the first frame
+ */
+int64_t lvgl_port_get_first_frame_us(lv_disp_t *disp);
+
+/**
+ * @brief Get how often the LVGL task woke up during the last measured window
+ *
+ * @return Wakeups per second
+ */
+uint32_t lvgl_port_get_wakeups_per_sec(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,349 @@
+/* lv_port_draw_async.c */
+
+#include "lv_port_draw_async.h"
+
+#if LVGL_PORT_DRAW_ASYNC
+
+#include "esp_log.h"
+
+static const char *TAG = "LVGL_ASYNC";
+
+#define ALIGN_UP(v, a)      (((v) + (a) - 1) / (a) * (a))
+#define ALIGN_DOWN(v, a)    ((v) / (a) * (a))
+
+typedef lvgl_port_draw_async_ctx_t async_ctx_t;
+typedef lvgl_port_draw_async_region_t region_t;
+
+/* One engine for every context; lv_snapshot sets up a context of its own for each snapshot */
+static async_copy_t *shared_engine;
+static int shared_engine_users;
+
+/*******************************************************************************
+* Queued areas
+*******************************************************************************/
+
+static void region_bytes(const region_t *r, uintptr_t *lo, uintptr_t *hi)
+{
+    *lo = (uintptr_t)r->buf + ((uintptr_t)r->area.y1 * r->stride + r->area.x1) * sizeof(lv_color_t);
+    *hi = (uintptr_t)r->buf + ((uintptr_t)r->area.y2 * r->stride + r->area.x2 + 1) * sizeof(lv_color_t);
+}
+
+/* Areas of the same buffer overlap as rectangles, others where their bytes do */
+static bool region_overlap(const region_t *a, const region_t *b)
+{
+    if (a->buf == b->buf && a->stride == b->stride) {
+        return _lv_area_is_on(&a->area, &b->area);
+    }
+    uintptr_t a_lo, a_hi, b_lo, b_hi;
+    region_bytes(a, &a_lo, &a_hi);
+    region_bytes(b, &b_lo, &b_hi);
+    return a_lo < b_hi && b_lo < a_hi;
+}
+
+/* Forget the areas whose copies are done; they are oldest first like the copies */
+static void draw_async_prune(async_ctx_t *ctx)
+{
+    int done = 0;
+    while (done < ctx->region_cnt && async_copy_is_done(ctx->engine, ctx->regions[done].seq)) {
+        done++;
+    }
+    if (done > 0) {
+        ctx->region_cnt -= done;
+        lv_memcpy(ctx->regions, &ctx->regions[done], ctx->region_cnt * sizeof(region_t));
+    }
+}
+
+static void draw_async_wait(async_ctx_t *ctx, uint32_t seq)
+{
+    if (!async_copy_is_done(ctx->engine, seq)) {
+        ctx->stats.waits++;
+        async_copy_wait(ctx->engine, seq);
+    }
+    draw_async_prune(ctx);
+}
+
+/* Wait for the copies the CPU would race with when it writes (or only reads) `r` */
+static void draw_async_sync(async_ctx_t *ctx, const region_t *r)
+{
+    bool found = false;
+    uint32_t seq = 0;
+    for (int i = 0; i < ctx->region_cnt; i++) {
+        const region_t *q = &ctx->regions[i];
+        if ((q->write || r->write) && region_overlap(q, r)) {
+            found = true;
+            seq = q->seq;
+        }
+    }
+    if (found) {
+        draw_async_wait(ctx, seq);
+    }
+}
+
+static void draw_async_track(async_ctx_t *ctx, const region_t *r)
+{
+    if (ctx->region_cnt == LVGL_PORT_DRAW_ASYNC_REGIONS) {
+        draw_async_prune(ctx);
+    }
+    if (ctx->region_cnt == LVGL_PORT_DRAW_ASYNC_REGIONS) {
+        draw_async_wait(ctx, ctx->regions[0].seq);
+    }
+    ctx->regions[ctx->region_cnt++] = *r;
+}
+
+/*******************************************************************************
+* Copies
+*******************************************************************************/
+
+/* Copy a row: the aligned middle by the engine, the edges by the CPU. False if the CPU did it all. */
+static bool draw_async_copy_row(async_ctx_t *ctx, uint8_t *dst, const uint8_t *src, size_t len)
+{
+    const size_t align = LV_MAX(async_copy_align(dst), async_copy_align(src));
+    const uintptr_t start = ALIGN_UP((uintptr_t)dst, align);
+    const uintptr_t end = ALIGN_DOWN((uintptr_t)dst + len, align);
+    const size_t head = start - (uintptr_t)dst;
+    uint32_t seq;
+
+    if (end <= start || !async_copy_can((void *)start, src + head, end - start) ||
+            async_copy_start(ctx->engine, (void *)start, src + head, end - start, &seq) != ESP_OK) {
+        lv_memcpy(dst, src, len);
+        return false;
+    }
+    lv_memcpy(dst, src, head);
+    lv_memcpy((void *)end, src + (end - (uintptr_t)dst), (uintptr_t)dst + len - end);
+    ctx->stats.copies++;
+    ctx->stats.bytes += end - start;
+    return true;
+}
+
+/* Fill contiguous pixels: the CPU writes a seed, the engine copies what is there over the rest */
+static bool draw_async_fill_span(async_ctx_t *ctx, lv_color_t *dst, uint32_t px, lv_color_t color)
+{
+    const size_t seed = LVGL_PORT_DRAW_ASYNC_FILL_SEED;
+    const size_t align = async_copy_align(dst);
+    const uintptr_t first = (uintptr_t)dst;
+    const uintptr_t last = first + px * sizeof(lv_color_t);
+    const uintptr_t start = ALIGN_UP(first, align);
+    const uintptr_t end = ALIGN_DOWN(last, align);
+
+    if (end < start + 2 * seed || !async_copy_can((void *)(start + seed), (void *)start, seed)) {
+        lv_color_fill(dst, color, px);
+        return false;
+    }
+
+    lv_color_fill(dst, color, (start + seed - first) / sizeof(lv_color_t));
+    lv_color_fill((lv_color_t *)end, color, (last - end) / sizeof(lv_color_t));
+
+    size_t filled = seed;
+    const size_t size = end - start;
+    while (filled < size) {
+        const size_t n = LV_MIN(filled, size - filled);
+        uint32_t seq;
+        if (async_copy_start(ctx->engine, (void *)(start + filled), (void *)start, n, &seq) != ESP_OK) {
+            lv_color_fill((lv_color_t *)(start + filled), color, (size - filled) / sizeof(lv_color_t));
+            break;
+        }
+        ctx->stats.copies++;
+        ctx->stats.bytes += n;
+        filled += n;
+    }
+    return true;
+}
+
+/* Opaque fills and copies large enough to be worth queueing; false leaves the blend to the CPU */
+static bool draw_async_offload(async_ctx_t *ctx, const lv_draw_sw_blend_dsc_t *dsc, const lv_area_t *area)
+{
+    lv_draw_ctx_t *draw_ctx = &ctx->base_draw.base_draw;
+    const lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+
+    if (dsc->blend_mode != LV_BLEND_MODE_NORMAL || dsc->opa < LV_OPA_MAX ||
+            (dsc->mask_buf != NULL && dsc->mask_res != LV_DRAW_MASK_RES_FULL_COVER) ||
+            disp->driver->set_px_cb != NULL || disp->driver->screen_transp) {
+        return false;
+    }
+
+    const lv_coord_t w = lv_area_get_width(area);
+    const lv_coord_t h = lv_area_get_height(area);
+    const lv_coord_t dest_stride = lv_area_get_width(draw_ctx->buf_area);
+    const lv_coord_t src_stride = lv_area_get_width(dsc->blend_area);
+    const bool contiguous = dest_stride == w && (dsc->src_buf == NULL || src_stride == w);
+    if ((uint32_t)w * h * sizeof(lv_color_t) < LVGL_PORT_DRAW_ASYNC_MIN_BYTES ||
+            (!contiguous && w * sizeof(lv_color_t) < LVGL_PORT_DRAW_ASYNC_MIN_ROW)) {
+        return false;
+    }
+
+    lv_color_t *dest = (lv_color_t *)draw_ctx->buf + (uint32_t)dest_stride * (area->y1 - draw_ctx->buf_area->y1) +
+                       (area->x1 - draw_ctx->buf_area->x1);
+    bool queued = false;
+
+    if (dsc->src_buf == NULL) {
+        if (contiguous) {
+            queued = draw_async_fill_span(ctx, dest, (uint32_t)w * h, dsc->color);
+        } else {
+            /* The first row is the source of the others */
+            lv_color_fill(dest, dsc->color, w);
+            for (lv_coord_t y = 1; y < h; y++) {
+                queued |= draw_async_copy_row(ctx, (uint8_t *)(dest + (uint32_t)dest_stride * y), (const uint8_t *)dest,
+                                              w * sizeof(lv_color_t));
+            }
+        }
+    } else {
+        const lv_color_t *src = dsc->src_buf + (uint32_t)src_stride * (area->y1 - dsc->blend_area->y1) +
+                                (area->x1 - dsc->blend_area->x1);
+        const lv_coord_t rows = contiguous ? 1 : h;
+        const size_t len = (contiguous ? (size_t)w * h : (size_t)w) * sizeof(lv_color_t);
+        for (lv_coord_t y = 0; y < rows; y++) {
+            queued |= draw_async_copy_row(ctx, (uint8_t *)(dest + (uint32_t)dest_stride * y),
+                                          (const uint8_t *)(src + (uint32_t)src_stride * y), len);
+        }
+    }
+
+    if (queued) {
+        ctx->stats.blends++;
+    } else {
+        ctx->stats.cpu_blends++;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Draw context callbacks
+*******************************************************************************/
+
+static void draw_async_blend(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc)
+{
+    async_ctx_t *ctx = (async_ctx_t *)draw_ctx;
+
+    lv_area_t area;
+    if (!_lv_area_intersect(&area, dsc->blend_area, draw_ctx->clip_area)) {
+        return;
+    }
+
+    /* The CPU may write the destination and read the source either way */
+    region_t dest = {
+        .buf = (const uint8_t *)draw_ctx->buf,
+        .stride = lv_area_get_width(draw_ctx->buf_area),
+        .area = area,
+        .write = true,
+    };
+    lv_area_move(&dest.area, -draw_ctx->buf_area->x1, -draw_ctx->buf_area->y1);
+    draw_async_sync(ctx, &dest);
+
+    region_t src = {
+        .buf = (const uint8_t *)dsc->src_buf,
+        .stride = lv_area_get_width(dsc->blend_area),
+        .area = area,
+        .write = false,
+    };
+    lv_area_move(&src.area, -dsc->blend_area->x1, -dsc->blend_area->y1);
+    if (dsc->src_buf != NULL) {
+        draw_async_sync(ctx, &src);
+    }
+
+    const uint32_t last = async_copy_last(ctx->engine);
+    if (!draw_async_offload(ctx, dsc, &area)) {
+        ctx->stats.cpu_blends++;
+        lv_draw_sw_blend_basic(draw_ctx, dsc);
+        return;
+    }
+
+    if (async_copy_last(ctx->engine) != last) {
+        dest.seq = async_copy_last(ctx->engine);
+        draw_async_track(ctx, &dest);
+        if (dsc->src_buf != NULL) {
+            src.seq = dest.seq;
+            draw_async_track(ctx, &src);
+        }
+    }
+}
+
+static void draw_async_buffer_copy(lv_draw_ctx_t *draw_ctx, void *dest_buf, lv_coord_t dest_stride,
+                                   const lv_area_t *dest_area, void *src_buf, lv_coord_t src_stride,
+                                   const lv_area_t *src_area)
+{
+    lvgl_port_draw_async_finish(draw_ctx);
+    lv_draw_sw_buffer_copy(draw_ctx, dest_buf, dest_stride, dest_area, src_buf, src_stride, src_area);
+}
+
+/* Layers clear, read and free their buffers without blending */
+static void draw_async_layer_adjust(lv_draw_ctx_t *draw_ctx, lv_draw_layer_ctx_t *layer_ctx,
+                                    lv_draw_layer_flags_t flags)
+{
+    lvgl_port_draw_async_finish(draw_ctx);
+    lv_draw_sw_layer_adjust(draw_ctx, layer_ctx, flags);
+}
+
+static void draw_async_layer_blend(lv_draw_ctx_t *draw_ctx, lv_draw_layer_ctx_t *layer_ctx,
+                                   const lv_draw_img_dsc_t *draw_dsc)
+{
+    lvgl_port_draw_async_finish(draw_ctx);
+    lv_draw_sw_layer_blend(draw_ctx, layer_ctx, draw_dsc);
+}
+
+static void draw_async_layer_destroy(lv_draw_ctx_t *draw_ctx, lv_draw_layer_ctx_t *layer_ctx)
+{
+    lvgl_port_draw_async_finish(draw_ctx);
+    lv_draw_sw_layer_destroy(draw_ctx, layer_ctx);
+}
+
+/*******************************************************************************
+* Public API
+*******************************************************************************/
+
+void lvgl_port_draw_async_init_ctx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx)
+{
+    async_ctx_t *ctx = (async_ctx_t *)draw_ctx;
+    lv_memset_00(ctx, sizeof(async_ctx_t));
+    lv_draw_sw_init_ctx(drv, draw_ctx);
+
+    if (shared_engine == NULL) {
+        static bool warned;
+        const esp_err_t err = async_copy_new(LVGL_PORT_DRAW_ASYNC_BACKLOG, &shared_engine);
+        if (err != ESP_OK) {
+            if (!warned) {
+                ESP_LOGW(TAG, "No memcpy engine (%s), drawing on the CPU only", esp_err_to_name(err));
+                warned = true;
+            }
+            shared_engine = NULL;
+            return;
+        }
+    }
+    shared_engine_users++;
+    ctx->engine = shared_engine;
+
+    /* LVGL waits for the draw context before every blend; see lvgl_port_draw_async_finish() */
+    draw_ctx->wait_for_finish = NULL;
+    draw_ctx->buffer_copy = draw_async_buffer_copy;
+    draw_ctx->layer_adjust = draw_async_layer_adjust;
+    draw_ctx->layer_blend = draw_async_layer_blend;
+    draw_ctx->layer_destroy = draw_async_layer_destroy;
+    ctx->base_draw.blend = draw_async_blend;
+}
+
+void lvgl_port_draw_async_deinit_ctx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx)
+{
+    async_ctx_t *ctx = (async_ctx_t *)draw_ctx;
+    if (ctx->engine != NULL) {
+        lvgl_port_draw_async_finish(draw_ctx);
+        if (--shared_engine_users == 0) {
+            async_copy_del(shared_engine);
+            shared_engine = NULL;
+        }
+        ctx->engine = NULL;
+    }
+    lv_draw_sw_deinit_ctx(drv, draw_ctx);
+}
+
+void lvgl_port_draw_async_finish(lv_draw_ctx_t *draw_ctx)
+{
+    async_ctx_t *ctx = (async_ctx_t *)draw_ctx;
+    if (ctx->engine != NULL && ctx->region_cnt > 0) {
+        draw_async_wait(ctx, async_copy_last(ctx->engine));
+    }
+}
+
+const lvgl_port_draw_async_stats_t *lvgl_port_draw_async_stats(const lv_draw_ctx_t *draw_ctx)
+{
+    return &((const async_ctx_t *)draw_ctx)->stats;
+}
+
+#endif /* LVGL_PORT_DRAW_ASYNC */
@@ -0,0 +1,102 @@
+/* lv_port_draw_async.h */
+
+/**
+ * @file
+ * @brief LVGL draw context that hands large fills and copies to the GDMA memcpy engine
+ *
+ * Extends the software draw context of LVGL. Opaque, unmasked fills and image copies of at least
+ * LVGL_PORT_DRAW_ASYNC_MIN_BYTES are queued on the memcpy engine (async_copy.h) and the CPU moves
+ * on to the next draw call, typically text. A fill is seeded by the CPU and doubled by the engine.
+ * The context remembers the areas queued copies still write or read; a later blend only waits when
+ * it touches one of them, everything else stays on the CPU as before. Edges of rows that are not
+ * aligned for the engine are done by the CPU too.
+ *
+ * LVGL calls `wait_for_finish` before every blend, so the context leaves it unset and the display
+ * must call lvgl_port_draw_async_finish() before it reads a rendered buffer (in its flush_cb).
+ * Layers wait for all copies before they are adjusted, blended or freed.
+ *
+ * Install it before the display is registered:
+ * `drv.draw_ctx_init = lvgl_port_draw_async_init_ctx`, `drv.draw_ctx_deinit = lvgl_port_draw_async_deinit_ctx`,
+ * `drv.draw_ctx_size = sizeof(lvgl_port_draw_async_ctx_t)`. Without a DMA channel it draws like the
+ * software context. Compiled out unless LVGL_PORT_DRAW_ASYNC is 1 (the default, see main/CMakeLists.txt).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+#include "src/draw/sw/lv_draw_sw.h"
+#include "async_copy.h"
+
+#ifndef LVGL_PORT_DRAW_ASYNC
+#define LVGL_PORT_DRAW_ASYNC 1
+#endif
+
+/* Fills and copies smaller than this stay on the CPU, queueing costs more than it saves */
+#define LVGL_PORT_DRAW_ASYNC_MIN_BYTES  (16 * 1024)
+/* Same for the rows of an area narrower than its buffer, each row is a copy of its own */
+#define LVGL_PORT_DRAW_ASYNC_MIN_ROW    (512)
+/* Bytes of a fill written by the CPU, the engine copies them over the rest, doubling each time */
+#define LVGL_PORT_DRAW_ASYNC_FILL_SEED  (1024)
+/* Copies queued at most */
+#define LVGL_PORT_DRAW_ASYNC_BACKLOG    (16)
+/* Areas of queued copies tracked; beyond that the oldest is waited for */
+#define LVGL_PORT_DRAW_ASYNC_REGIONS    (8)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t blends;        // blends queued on the engine
+    uint32_t copies;        // copies queued for them
+    uint64_t bytes;         // bytes written by the engine
+    uint32_t cpu_blends;    // blends done by the CPU
+    uint32_t waits;         // blends, layers and frames that had to wait for the engine
+} lvgl_port_draw_async_stats_t;
+
+/* An area of a buffer a queued copy writes or reads */
+typedef struct {
+    const uint8_t *buf;
+    lv_coord_t stride;      // pixels per row of `buf`
+    lv_area_t area;         // in pixels of `buf`
+    bool write;
+    uint32_t seq;           // last copy of the area
+} lvgl_port_draw_async_region_t;
+
+typedef struct {
+    lv_draw_sw_ctx_t base_draw;
+    async_copy_t *engine;   // NULL: everything is drawn by the CPU
+    lvgl_port_draw_async_region_t regions[LVGL_PORT_DRAW_ASYNC_REGIONS];    // oldest first
+    int region_cnt;
+    lvgl_port_draw_async_stats_t stats;
+} lvgl_port_draw_async_ctx_t;
+
+#if LVGL_PORT_DRAW_ASYNC
+
+/**
+ * @brief `draw_ctx_init` of the display driver
+ */
+void lvgl_port_draw_async_init_ctx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx);
+
+/**
+ * @brief `draw_ctx_deinit` of the display driver
+ */
+void lvgl_port_draw_async_deinit_ctx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx);
+
+/**
+ * @brief Wait for all queued copies; call before a rendered buffer is read
+ */
+void lvgl_port_draw_async_finish(lv_draw_ctx_t *draw_ctx);
+
+/**
+ * @brief What the engine and the CPU drew so far
+ */
+const lvgl_port_draw_async_stats_t *lvgl_port_draw_async_stats(const lv_draw_ctx_t *draw_ctx);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,62 @@
+/* lv_port_frame.h */
+
+/**
+ * @file
+ * @brief Pacing of the areas the LVGL port flushes for one refresh
+ *
+ * With partial refresh LVGL flushes a refresh as several areas. Only the first of them waits for
+ * the previous frame and goes through the display's draw_wait_cb, which starts the refresh at a
+ * tear-free phase or drops it; the other areas follow right away. Once a refresh is dropped none
+ * of its remaining areas is sent either, so the panel never shows part of it, and the port
+ * repaints the whole screen with the next refresh.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Where the refresh being flushed stands */
+typedef enum {
+    LVGL_PORT_FRAME_NEW,        /* Rendering started, no area flushed yet */
+    LVGL_PORT_FRAME_SENDING,    /* First area paced, the others are sent right away */
+    LVGL_PORT_FRAME_DROPPED,    /* First area dropped, the others are not sent */
+} lvgl_port_frame_t;
+
+/* What to do with a flushed area */
+typedef enum {
+    LVGL_PORT_AREA_PACE,        /* First of its refresh: wait for the previous frame, then draw_wait_cb */
+    LVGL_PORT_AREA_SEND,        /* Send it right away */
+    LVGL_PORT_AREA_SKIP,        /* Part of a dropped refresh, only report it flushed */
+} lvgl_port_area_action_t;
+
+/* From render_start_cb, before the first area of a refresh */
+static inline void lvgl_port_frame_begin(lvgl_port_frame_t *frame)
+{
+    *frame = LVGL_PORT_FRAME_NEW;
+}
+
+static inline lvgl_port_area_action_t lvgl_port_frame_area(const lvgl_port_frame_t *frame)
+{
+    switch (*frame) {
+    case LVGL_PORT_FRAME_NEW:
+        return LVGL_PORT_AREA_PACE;
+    case LVGL_PORT_FRAME_SENDING:
+        return LVGL_PORT_AREA_SEND;
+    default:
+        return LVGL_PORT_AREA_SKIP;
+    }
+}
+
+/* After LVGL_PORT_AREA_PACE: whether draw_wait_cb let the refresh start */
+static inline void lvgl_port_frame_paced(lvgl_port_frame_t *frame, bool send)
+{
+    *frame = send ? LVGL_PORT_FRAME_SENDING : LVGL_PORT_FRAME_DROPPED;
+}
+
+#ifdef __cplusplus
+}
+#endif
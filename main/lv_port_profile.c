@@ -0,0 +1,547 @@
+/* lv_port_profile.c */
+
+#include "lv_port_profile.h"
+
+#if LVGL_PORT_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "src/draw/sw/lv_draw_sw_glyph_cache.h"
+
+static const char *TAG = "LVGL_PROF";
+
+/* Object classes told apart in one window; further classes are summed as "other" */
+#define PROFILE_CLASSES         (16)
+/* Nesting of objects being drawn; deeper objects are charged to the deepest tracked one */
+#define PROFILE_STACK           (16)
+/* Dirty areas outlined by the overlay, further ones are only counted */
+#define PROFILE_OVERLAY_AREAS   (8)
+#define PROFILE_OVERLAY_WIDTH   (2)
+#define PROFILE_REPORT_SIZE     (768)
+
+typedef enum {
+    PRIM_RECT = 0,
+    PRIM_LABEL,
+    PRIM_ARC,
+    PRIM_IMG,
+    PRIM_LINE,
+    PRIM_POLYGON,
+    PRIM_BG,
+    PRIM_COUNT,
+} profile_prim_t;
+
+static const char *const prim_names[PRIM_COUNT] = {
+    "rect", "label", "arc", "img", "line", "polygon", "bg",
+};
+
+typedef struct {
+    uint32_t us;
+    uint32_t calls;
+} profile_cost_t;
+
+typedef struct {
+    int64_t since_us;
+    int64_t until_us;                               /* 0 while the window is open */
+    uint32_t frames;
+    uint64_t render_us;
+    uint32_t dirty_areas;
+    uint64_t dirty_px;
+    profile_cost_t prim[PRIM_COUNT];
+    const lv_obj_class_t *cls[PROFILE_CLASSES];   /* NULL entry: unused, last entry: "other" */
+    profile_cost_t cls_cost[PROFILE_CLASSES];
+    uint32_t mem_allocs_since;                      /* lv_mem allocation count when the window opened */
+    uint32_t mem_allocs_until;                      /* and when it closed */
+} profile_window_t;
+
+typedef struct {
+    const lv_obj_class_t *cls;
+    const char *name;
+} profile_class_name_t;
+
+static struct {
+    lv_disp_t *disp;
+    bool enabled;
+    bool overlay;
+    bool full_refresh;                  /* Setting of the port, back once profiling stops */
+    lv_draw_ctx_t orig;                 /* Draw callbacks of the wrapped context */
+
+    profile_window_t cur;
+    profile_window_t last;              /* frames == 0 until the first window closed */
+
+    int prim_depth;                     /* Primitives call each other (rect -> img), time the outer one */
+    int64_t prim_start_us;
+
+    lv_obj_t *stack[PROFILE_STACK];     /* Objects being drawn, innermost last */
+    int stack_cnt;
+    int64_t mark_us;                    /* Time up to here is charged to the innermost object */
+
+    lv_area_t dirty[PROFILE_OVERLAY_AREAS];
+    int dirty_cnt;
+
+    profile_class_name_t names[4];      /* Custom classes named by the application */
+} prof;
+
+static const profile_class_name_t builtin_names[] = {
+    { &lv_obj_class, "obj" },
+    { &lv_label_class, "label" },
+    { &lv_btn_class, "btn" },
+    { &lv_img_class, "img" },
+    { &lv_bar_class, "bar" },
+    { &lv_slider_class, "slider" },
+    { &lv_arc_class, "arc" },
+    { &lv_checkbox_class, "checkbox" },
+    { &lv_btnmatrix_class, "btnmatrix" },
+    { &lv_textarea_class, "textarea" },
+    { &lv_chart_class, "chart" },
+    { &lv_keyboard_class, "keyboard" },
+    { &lv_spinbox_class, "spinbox" },
+    { &lv_spinner_class, "spinner" },
+    { &lv_tabview_class, "tabview" },
+};
+
+static const char *profile_class_name(const lv_obj_class_t *class_p)
+{
+    if (class_p == NULL) {
+        return "other";
+    }
+    for (size_t i = 0; i < sizeof(prof.names) / sizeof(prof.names[0]); i++) {
+        if (prof.names[i].cls == class_p) {
+            return prof.names[i].name;
+        }
+    }
+    for (size_t i = 0; i < sizeof(builtin_names) / sizeof(builtin_names[0]); i++) {
+        if (builtin_names[i].cls == class_p) {
+            return builtin_names[i].name;
+        }
+    }
+    return "?";
+}
+
+static profile_cost_t *profile_class_cost(const lv_obj_class_t *class_p)
+{
+    for (int i = 0; i < PROFILE_CLASSES - 1; i++) {
+        if (prof.cur.cls[i] == class_p) {
+            return &prof.cur.cls_cost[i];
+        }
+        if (prof.cur.cls[i] == NULL) {
+            prof.cur.cls[i] = class_p;
+            return &prof.cur.cls_cost[i];
+        }
+    }
+    return &prof.cur.cls_cost[PROFILE_CLASSES - 1];
+}
+
+/* Charge the time since the last mark to the object drawn innermost */
+static void profile_charge(int64_t now)
+{
+    if (prof.stack_cnt > 0) {
+        const int top = (prof.stack_cnt <= PROFILE_STACK ? prof.stack_cnt : PROFILE_STACK) - 1;
+        profile_class_cost(prof.stack[top]->class_p)->us += (uint32_t)(now - prof.mark_us);
+    }
+    prof.mark_us = now;
+}
+
+/*******************************************************************************
+* Object draw events
+*******************************************************************************/
+
+static void profile_draw_begin_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    profile_charge(esp_timer_get_time());
+    if (prof.stack_cnt < PROFILE_STACK) {
+        prof.stack[prof.stack_cnt] = obj;
+    }
+    prof.stack_cnt++;
+    profile_class_cost(obj->class_p)->calls++;
+}
+
+static void profile_draw_end_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    profile_charge(esp_timer_get_time());
+    /* Parents of the topmost redrawn object get post draw events without a begin */
+    if (prof.stack_cnt > 0 && (prof.stack_cnt > PROFILE_STACK || prof.stack[prof.stack_cnt - 1] == obj)) {
+        prof.stack_cnt--;
+    }
+}
+
+/* Objects are created any time, add the callbacks to those that don't have them yet */
+static void profile_instrument(lv_obj_t *obj)
+{
+    if (lv_obj_get_event_user_data(obj, profile_draw_begin_cb) == NULL) {
+        lv_obj_add_event_cb(obj, profile_draw_begin_cb, LV_EVENT_DRAW_MAIN_BEGIN | LV_EVENT_PREPROCESS, &prof);
+        lv_obj_add_event_cb(obj, profile_draw_end_cb, LV_EVENT_DRAW_POST_END, &prof);
+    }
+    const uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++) {
+        profile_instrument(lv_obj_get_child(obj, i));
+    }
+}
+
+static void profile_uninstrument(lv_obj_t *obj)
+{
+    lv_obj_remove_event_cb(obj, profile_draw_begin_cb);
+    lv_obj_remove_event_cb(obj, profile_draw_end_cb);
+    const uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++) {
+        profile_uninstrument(lv_obj_get_child(obj, i));
+    }
+}
+
+static void profile_for_each_root(lv_disp_t *disp, void (*fn)(lv_obj_t *obj))
+{
+    for (uint32_t i = 0; i < disp->screen_cnt; i++) {
+        fn(disp->screens[i]);
+    }
+    fn(disp->top_layer);
+    fn(disp->sys_layer);
+}
+
+/*******************************************************************************
+* Draw primitives
+*******************************************************************************/
+
+static inline void profile_prim_begin(void)
+{
+    if (prof.prim_depth++ == 0) {
+        prof.prim_start_us = esp_timer_get_time();
+    }
+}
+
+static inline void profile_prim_end(profile_prim_t prim)
+{
+    if (--prof.prim_depth == 0) {
+        prof.cur.prim[prim].us += (uint32_t)(esp_timer_get_time() - prof.prim_start_us);
+        prof.cur.prim[prim].calls++;
+    }
+}
+
+static void profile_draw_rect(lv_draw_ctx_t *draw_ctx, const lv_draw_rect_dsc_t *dsc, const lv_area_t *coords)
+{
+    profile_prim_begin();
+    prof.orig.draw_rect(draw_ctx, dsc, coords);
+    profile_prim_end(PRIM_RECT);
+}
+
+static void profile_draw_arc(lv_draw_ctx_t *draw_ctx, const lv_draw_arc_dsc_t *dsc, const lv_point_t *center,
+                             uint16_t radius, uint16_t start_angle, uint16_t end_angle)
+{
+    profile_prim_begin();
+    prof.orig.draw_arc(draw_ctx, dsc, center, radius, start_angle, end_angle);
+    profile_prim_end(PRIM_ARC);
+}
+
+static void profile_draw_img_decoded(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc,
+                                     const lv_area_t *coords, const uint8_t *map_p, lv_img_cf_t color_format)
+{
+    profile_prim_begin();
+    prof.orig.draw_img_decoded(draw_ctx, dsc, coords, map_p, color_format);
+    profile_prim_end(PRIM_IMG);
+}
+
+static void profile_draw_letter(lv_draw_ctx_t *draw_ctx, const lv_draw_label_dsc_t *dsc, const lv_point_t *pos_p,
+                                uint32_t letter)
+{
+    profile_prim_begin();
+    prof.orig.draw_letter(draw_ctx, dsc, pos_p, letter);
+    profile_prim_end(PRIM_LABEL);
+}
+
+static void profile_draw_line(lv_draw_ctx_t *draw_ctx, const lv_draw_line_dsc_t *dsc, const lv_point_t *point1,
+                              const lv_point_t *point2)
+{
+    profile_prim_begin();
+    prof.orig.draw_line(draw_ctx, dsc, point1, point2);
+    profile_prim_end(PRIM_LINE);
+}
+
+static void profile_draw_polygon(lv_draw_ctx_t *draw_ctx, const lv_draw_rect_dsc_t *draw_dsc,
+                                 const lv_point_t *points, uint16_t point_cnt)
+{
+    profile_prim_begin();
+    prof.orig.draw_polygon(draw_ctx, draw_dsc, points, point_cnt);
+    profile_prim_end(PRIM_POLYGON);
+}
+
+static void profile_draw_bg(lv_draw_ctx_t *draw_ctx, const lv_draw_rect_dsc_t *draw_dsc, const lv_area_t *coords)
+{
+    profile_prim_begin();
+    prof.orig.draw_bg(draw_ctx, draw_dsc, coords);
+    profile_prim_end(PRIM_BG);
+}
+
+/*******************************************************************************
+* Report
+*******************************************************************************/
+
+/* Per frame average */
+#define PROFILE_PER_FRAME(v, frames) ((uint32_t)(((uint64_t)(v) + (frames) / 2) / (frames)))
+#define PROFILE_PERCENT(part, all)   ((all) ? (uint32_t)((uint64_t)(part) * 100 / (all)) : 0)
+
+/* Allocations served by both lv_mem pools since start */
+static uint32_t profile_mem_allocs(void)
+{
+    lv_mem_monitor_t small, large;
+    lv_mem_monitor(&small);
+    lv_mem_monitor_large(&large);
+    return small.alloc_cnt + large.alloc_cnt;
+}
+
+static size_t profile_format(const profile_window_t *w, char *buf, size_t size)
+{
+    size_t len = 0;
+#define PROFILE_PUT(...) do { \
+        if (len < size) { \
+            int n = snprintf(buf + len, size - len, __VA_ARGS__); \
+            len += (n > 0) ? (size_t)n : 0; \
+        } \
+    } while (0)
+
+    const uint32_t frames = w->frames ? w->frames : 1;
+    const int64_t until = w->until_us ? w->until_us : esp_timer_get_time();
+    const uint32_t window_ms = (uint32_t)((until - w->since_us) / 1000);
+    PROFILE_PUT("frames %" PRIu32 " in %" PRIu32 " ms, render %" PRIu32 " us, dirty %" PRIu32 " areas %" PRIu32 " px\n",
+                w->frames, window_ms, PROFILE_PER_FRAME(w->render_us, frames),
+                PROFILE_PER_FRAME(w->dirty_areas, frames), PROFILE_PER_FRAME(w->dirty_px, frames));
+
+    /* Per frame: "<name> <us>/<calls>" */
+    PROFILE_PUT("draw");
+    for (int i = 0; i < PRIM_COUNT; i++) {
+        if (w->prim[i].calls) {
+            PROFILE_PUT(" %s %" PRIu32 "/%" PRIu32, prim_names[i],
+                        PROFILE_PER_FRAME(w->prim[i].us, frames), PROFILE_PER_FRAME(w->prim[i].calls, frames));
+        }
+    }
+    PROFILE_PUT("\nclass");
+    for (int i = 0; i < PROFILE_CLASSES; i++) {
+        if (w->cls_cost[i].calls) {
+            PROFILE_PUT(" %s %" PRIu32 "/%" PRIu32, profile_class_name(w->cls[i]),
+                        PROFILE_PER_FRAME(w->cls_cost[i].us, frames), PROFILE_PER_FRAME(w->cls_cost[i].calls, frames));
+        }
+    }
+    PROFILE_PUT("\n");
+
+    /* Since start: "<cache> <hit %> of <lookups>" */
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE || LV_TXT_SIZE_CACHE_ENTRIES
+    PROFILE_PUT("cache");
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE
+    lv_draw_sw_glyph_cache_stats_t gc;
+    lv_draw_sw_glyph_cache_get_stats(&gc);
+    PROFILE_PUT(" glyph %" PRIu32 "%% of %" PRIu32 " (%" PRIu32 " B)", PROFILE_PERCENT(gc.hits, gc.hits + gc.misses),
+                gc.hits + gc.misses, gc.bytes);
+#endif
+#if LV_TXT_SIZE_CACHE_ENTRIES
+    lv_txt_size_cache_stats_t tc;
+    lv_txt_size_cache_get_stats(&tc);
+    PROFILE_PUT(" text_size %" PRIu32 "%% of %" PRIu32, PROFILE_PERCENT(tc.hits, tc.hits + tc.misses),
+                tc.hits + tc.misses);
+#endif
+    PROFILE_PUT("\n");
+#endif
+
+#if LV_MEM_CUSTOM == 0
+    /* Pools now: "<pool> <used>/<size> B peak <max> frag <%>", allocations in the window */
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    PROFILE_PUT("mem internal %" PRIu32 "/%" PRIu32 " B peak %" PRIu32 " frag %d%%",
+                mon.total_size - mon.free_size, mon.total_size, mon.max_used, mon.frag_pct);
+    uint32_t fails = mon.fail_cnt;
+    lv_mem_monitor_large(&mon);
+    if (mon.total_size) {
+        PROFILE_PUT(" psram %" PRIu32 "/%" PRIu32 " B peak %" PRIu32 " frag %d%%",
+                    mon.total_size - mon.free_size, mon.total_size, mon.max_used, mon.frag_pct);
+        fails += mon.fail_cnt;
+    }
+    const uint32_t allocs = (w->until_us ? w->mem_allocs_until : profile_mem_allocs()) - w->mem_allocs_since;
+    PROFILE_PUT(", allocs %" PRIu32 "/frame %" PRIu32 "/s, %" PRIu32 " didn't fit\n",
+                PROFILE_PER_FRAME(allocs, frames), window_ms ? (uint32_t)((uint64_t)allocs * 1000 / window_ms) : 0,
+                fails);
+#endif
+#undef PROFILE_PUT
+
+    return (len < size) ? len : (size ? size - 1 : 0);
+}
+
+static void profile_close_window(int64_t now)
+{
+    static char report[PROFILE_REPORT_SIZE];
+
+    prof.cur.until_us = now;
+    prof.cur.mem_allocs_until = profile_mem_allocs();
+    prof.last = prof.cur;
+    memset(&prof.cur, 0, sizeof(prof.cur));
+    prof.cur.since_us = now;
+    prof.cur.mem_allocs_since = prof.last.mem_allocs_until;
+
+    char *save = NULL;
+    profile_format(&prof.last, report, sizeof(report));
+    for (char *line = strtok_r(report, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        ESP_LOGI(TAG, "%s", line);
+    }
+}
+
+/*******************************************************************************
+* Overlay
+*******************************************************************************/
+
+static void profile_fill(lv_color_t *buf, lv_coord_t stride, lv_coord_t x1, lv_coord_t y1, lv_coord_t x2, lv_coord_t y2)
+{
+    const lv_color_t color = lv_color_make(0xFF, 0x00, 0xFF);
+    for (lv_coord_t y = y1; y <= y2; y++) {
+        for (lv_coord_t x = x1; x <= x2; x++) {
+            buf[y * stride + x] = color;
+        }
+    }
+}
+
+static void profile_draw_overlay(lv_disp_drv_t *drv, lv_color_t *color_map)
+{
+    const lv_coord_t w = PROFILE_OVERLAY_WIDTH - 1;
+    for (int i = 0; i < prof.dirty_cnt; i++) {
+        const lv_area_t *a = &prof.dirty[i];
+        if (lv_area_get_width(a) <= 2 * PROFILE_OVERLAY_WIDTH || lv_area_get_height(a) <= 2 * PROFILE_OVERLAY_WIDTH) {
+            profile_fill(color_map, drv->hor_res, a->x1, a->y1, a->x2, a->y2);
+            continue;
+        }
+        profile_fill(color_map, drv->hor_res, a->x1, a->y1, a->x2, a->y1 + w);
+        profile_fill(color_map, drv->hor_res, a->x1, a->y2 - w, a->x2, a->y2);
+        profile_fill(color_map, drv->hor_res, a->x1, a->y1 + w + 1, a->x1 + w, a->y2 - w - 1);
+        profile_fill(color_map, drv->hor_res, a->x2 - w, a->y1 + w + 1, a->x2, a->y2 - w - 1);
+    }
+}
+
+/*******************************************************************************
+* Public API
+*******************************************************************************/
+
+void lvgl_port_profile_attach(lv_disp_t *disp)
+{
+    lv_draw_ctx_t *draw_ctx = disp->driver->draw_ctx;
+
+    prof.disp = disp;
+    prof.orig = *draw_ctx;
+    if (draw_ctx->draw_rect) {
+        draw_ctx->draw_rect = profile_draw_rect;
+    }
+    if (draw_ctx->draw_arc) {
+        draw_ctx->draw_arc = profile_draw_arc;
+    }
+    if (draw_ctx->draw_img_decoded) {
+        draw_ctx->draw_img_decoded = profile_draw_img_decoded;
+    }
+    if (draw_ctx->draw_letter) {
+        draw_ctx->draw_letter = profile_draw_letter;
+    }
+    if (draw_ctx->draw_line) {
+        draw_ctx->draw_line = profile_draw_line;
+    }
+    if (draw_ctx->draw_polygon) {
+        draw_ctx->draw_polygon = profile_draw_polygon;
+    }
+    if (draw_ctx->draw_bg) {
+        draw_ctx->draw_bg = profile_draw_bg;
+    }
+
+    lvgl_port_profile_enable(true, false);
+    ESP_LOGI(TAG, "Profiling display %p, report every %d ms", (void *)disp, LVGL_PORT_PROFILE_WINDOW_MS);
+}
+
+void lvgl_port_profile_enable(bool enable, bool overlay)
+{
+    if (prof.disp == NULL) {
+        return;
+    }
+    if (enable && !prof.enabled) {
+        prof.full_refresh = prof.disp->driver->full_refresh;
+        memset(&prof.cur, 0, sizeof(prof.cur));
+        prof.cur.since_us = esp_timer_get_time();
+        prof.cur.mem_allocs_since = profile_mem_allocs();
+    } else if (!enable && prof.enabled) {
+        profile_for_each_root(prof.disp, profile_uninstrument);
+    }
+    prof.enabled = enable;
+    prof.overlay = enable && overlay;
+
+    /* Keep real dirty areas between frames, frame_begin widens them to the full frame */
+    prof.disp->driver->full_refresh = enable ? 0 : prof.full_refresh;
+    /* Show the overlay change (or clear it) without waiting for the next update */
+    lv_obj_invalidate(lv_disp_get_scr_act(prof.disp));
+}
+
+void lvgl_port_profile_frame_begin(lv_disp_drv_t *drv)
+{
+    lv_disp_t *disp = prof.disp;
+    if (!prof.enabled || disp == NULL || disp->driver != drv) {
+        return;
+    }
+
+    /* Record the areas LVGL would draw, then leave only the last one, as the whole screen */
+    int last = -1;
+    prof.dirty_cnt = 0;
+    for (int i = 0; i < disp->inv_p; i++) {
+        if (disp->inv_area_joined[i]) {
+            continue;
+        }
+        if (prof.dirty_cnt < PROFILE_OVERLAY_AREAS) {
+            prof.dirty[prof.dirty_cnt++] = disp->inv_areas[i];
+        }
+        prof.cur.dirty_areas++;
+        prof.cur.dirty_px += lv_area_get_size(&disp->inv_areas[i]);
+        disp->inv_area_joined[i] = 1;
+        last = i;
+    }
+    if (last >= 0) {
+        lv_area_set(&disp->inv_areas[last], 0, 0, drv->hor_res - 1, drv->ver_res - 1);
+        disp->inv_area_joined[last] = 0;
+    }
+    drv->full_refresh = 1;
+
+    profile_for_each_root(disp, profile_instrument);
+    prof.stack_cnt = 0;
+    prof.prim_depth = 0;
+    prof.mark_us = esp_timer_get_time();
+}
+
+void lvgl_port_profile_frame_end(lv_disp_drv_t *drv, lv_color_t *color_map, uint32_t render_us)
+{
+    if (!prof.enabled || prof.disp == NULL || prof.disp->driver != drv) {
+        return;
+    }
+    drv->full_refresh = 0;
+
+    const int64_t now = esp_timer_get_time();
+    profile_charge(now);
+    prof.cur.frames++;
+    prof.cur.render_us += render_us;
+    if (prof.overlay) {
+        profile_draw_overlay(drv, color_map);
+    }
+    if (now - prof.cur.since_us >= LVGL_PORT_PROFILE_WINDOW_MS * 1000LL) {
+        profile_close_window(now);
+    }
+}
+
+void lvgl_port_profile_name_class(const lv_obj_class_t *class_p, const char *name)
+{
+    for (size_t i = 0; i < sizeof(prof.names) / sizeof(prof.names[0]); i++) {
+        if (prof.names[i].cls == NULL || prof.names[i].cls == class_p) {
+            prof.names[i].cls = class_p;
+            prof.names[i].name = name;
+            return;
+        }
+    }
+}
+
+size_t lvgl_port_profile_report(char *buf, size_t size)
+{
+    if (!prof.enabled) {
+        return (size_t)snprintf(buf, size, "profiling off\n");
+    }
+    return profile_format(prof.last.frames ? &prof.last : &prof.cur, buf, size);
+}
+
+#endif /* LVGL_PORT_PROFILE */
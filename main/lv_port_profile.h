@@ -0,0 +1,88 @@
+/* lv_port_profile.h */
+
+/**
+ * @file
+ * @brief Render cost profiler for the LVGL port
+ *
+ * Records per frame where LVGL spends its render time: exclusive time per object class (from the
+ * draw events of every object on the display) and per draw primitive (by wrapping the draw context),
+ * plus the areas that were invalidated. An optional overlay outlines the dirty areas of each frame
+ * in the frame itself, so they flash for one frame on the panel.
+ *
+ * The port renders full frames, which makes LVGL merge every invalidation into the whole screen.
+ * While profiling, invalidations are recorded as real areas and only collapsed to a full frame when
+ * rendering starts; what reaches the panel is unchanged.
+ *
+ * Everything compiles out unless LVGL_PORT_PROFILE is 1 (`idf.py -DLVGL_PORT_PROFILE=1 build`, see
+ * main/CMakeLists.txt). All functions must be called from the LVGL task or with the LVGL mutex held.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "lvgl.h"
+
+#ifndef LVGL_PORT_PROFILE
+#define LVGL_PORT_PROFILE 0
+#endif
+
+/* Counters are summed over a window of this length, then logged and kept for the report */
+#define LVGL_PORT_PROFILE_WINDOW_MS   (10 * 1000)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_PORT_PROFILE
+
+/**
+ * @brief Start profiling a display
+ *
+ * @param disp Display registered with full_refresh
+ */
+void lvgl_port_profile_attach(lv_disp_t *disp);
+
+/**
+ * @brief Switch profiling and the dirty area overlay on or off
+ *
+ * @param enable  Record costs and invalidated areas
+ * @param overlay Outline dirty areas in the frames sent to the panel (needs `enable`)
+ */
+void lvgl_port_profile_enable(bool enable, bool overlay);
+
+/**
+ * @brief Frame rendering starts; call from the display's render_start_cb
+ */
+void lvgl_port_profile_frame_begin(lv_disp_drv_t *drv);
+
+/**
+ * @brief Last area of the frame has been rendered; call from the flush callback before sending it
+ *
+ * @param drv       Display driver
+ * @param color_map Rendered frame, the overlay is drawn into it
+ * @param render_us Time from render start to this flush
+ */
+void lvgl_port_profile_frame_end(lv_disp_drv_t *drv, lv_color_t *color_map, uint32_t render_us);
+
+/**
+ * @brief Name a custom object class in the report
+ */
+void lvgl_port_profile_name_class(const lv_obj_class_t *class_p, const char *name);
+
+/**
+ * @brief Write the report of the last finished window (the current one before that)
+ *
+ * @param[out] buf  Text, one line per section
+ * @param[in]  size Size of `buf`
+ *
+ * @return Length of the report, truncated to `size - 1`
+ */
+size_t lvgl_port_profile_report(char *buf, size_t size);
+
+#endif /* LVGL_PORT_PROFILE */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,85 @@
+/* lv_port_touch_queue.h */
+
+/**
+ * @file
+ * @brief Queue of touch readings from the touch task of the LVGL port to the LVGL task
+ *
+ * One task pushes, one task pops, and neither blocks or takes a lock: each side only writes its
+ * own index and publishes it with release ordering once its slot is written or read, the other
+ * side loads it with acquire ordering. The indices run freely and wrap around, the length is a
+ * power of two. A full queue refuses the reading; the producer keeps it and tries again.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* Readings queued at most, 8 periods of the LVGL read timer */
+#define LVGL_PORT_TOUCH_QUEUE_LEN   (8)
+
+#if (LVGL_PORT_TOUCH_QUEUE_LEN & (LVGL_PORT_TOUCH_QUEUE_LEN - 1)) != 0
+#error "LVGL_PORT_TOUCH_QUEUE_LEN must be a power of two"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A reading of the touch controller */
+typedef struct {
+    int64_t  time_us;   /* esp_timer time of the reading */
+    uint16_t x;
+    uint16_t y;
+    bool     pressed;
+} lvgl_port_touch_event_t;
+
+typedef struct {
+    lvgl_port_touch_event_t events[LVGL_PORT_TOUCH_QUEUE_LEN];
+    atomic_uint head;   /* Next slot to write, only written by the producer */
+    atomic_uint tail;   /* Next slot to read, only written by the consumer */
+} lvgl_port_touch_queue_t;
+
+static inline void lvgl_port_touch_queue_init(lvgl_port_touch_queue_t *queue)
+{
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+}
+
+/* Producer: append a reading, false if the queue is full */
+static inline bool lvgl_port_touch_queue_push(lvgl_port_touch_queue_t *queue, const lvgl_port_touch_event_t *event)
+{
+    const unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    const unsigned tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head - tail >= LVGL_PORT_TOUCH_QUEUE_LEN) {
+        return false;
+    }
+    queue->events[head % LVGL_PORT_TOUCH_QUEUE_LEN] = *event;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+/* Consumer: take the oldest reading, false if the queue is empty */
+static inline bool lvgl_port_touch_queue_pop(lvgl_port_touch_queue_t *queue, lvgl_port_touch_event_t *event)
+{
+    const unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    const unsigned head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *event = queue->events[tail % LVGL_PORT_TOUCH_QUEUE_LEN];
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+/* Consumer: whether a pop would fail */
+static inline bool lvgl_port_touch_queue_empty(lvgl_port_touch_queue_t *queue)
+{
+    return atomic_load_explicit(&queue->head, memory_order_acquire) ==
+           atomic_load_explicit(&queue->tail, memory_order_relaxed);
+}
+
+#ifdef __cplusplus
+}
+#endif
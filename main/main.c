@@ -13,6 +13,12 @@
 #include "esp_heap_caps.h"
 #include "ui.h"
 #include "config_server.h"
+#include "config_storage.h"
+#include "blend_bench.h"
+#include "mem_budget.h"
+#include "esp_lcd_axs15231b.h"
+#include "esp_netif.h"
+#include "dns_server.h"
 #include "esp_timer.h"
 
 static const char *TAG = "VICTRON_LVGL_APP";
@@ -60,6 +66,9 @@ void setup(void) {
         heap_caps_get_free_size(MALLOC_CAP_SPIRAM)
     );
 
+    /* --- NVS, the display reads its bus settings from it --- */
+    ESP_ERROR_CHECK(config_storage_init());
+
     /* --- Display init --- */
     logSection("Display init");
     bsp_display_cfg_t cfg = {
@@ -75,11 +84,20 @@ void setup(void) {
         .rotate        = LV_DISP_ROT_NONE,
 #endif
     };
+    if (MEM_BUDGET_LVGL_STACK != MEM_PLACE_INTERNAL) {
+        cfg.lvgl_port_cfg.task_stack_caps = mem_budget_caps(MEM_BUDGET_LVGL_STACK);
+    }
     bsp_display_start_with_config(&cfg);
+    mem_budget_add_task("LVGL task", cfg.lvgl_port_cfg.task_stack);
+    mem_budget_add_task(AXS15231B_TRANS_TASK_NAME, AXS15231B_TRANS_TASK_STACK);
+    mem_budget_add_task(LVGL_PORT_TOUCH_TASK_NAME, LVGL_PORT_TOUCH_TASK_STACK);
     bsp_display_brightness_set(5);
 
     /* --- Lock LVGL port and initialize UI --- */
     lvgl_port_lock(0);
+#if BLEND_BENCH
+    blend_bench_log();
+#endif
     ui_init();
 
     /* --- Start Wi-Fi AP & config server --- */
@@ -101,6 +119,14 @@ void setup(void) {
     esp_timer_create(&reboot_timer_args, &reboot_timer);
     esp_timer_start_periodic(reboot_timer, REBOOT_INTERVAL_US);
 
+    /* --- Memory budget once everything is up; GET /memory for a fresh one --- */
+    mem_budget_add_task("nimble_host", CONFIG_BT_NIMBLE_HOST_TASK_STACK_SIZE);
+    mem_budget_add_task("tiT", CONFIG_LWIP_TCPIP_TASK_STACK_SIZE);
+    mem_budget_add_task(DNS_SERVER_TASK_NAME, DNS_SERVER_TASK_STACK);
+    mem_budget_add_task("esp_timer", CONFIG_ESP_TIMER_TASK_STACK_SIZE);
+    mem_budget_add_task("sys_evt", CONFIG_ESP_SYSTEM_EVENT_TASK_STACK_SIZE);
+    mem_budget_log();
+
     /* --- Setup complete --- */
     logSection("Setup complete");
 }
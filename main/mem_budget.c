@@ -0,0 +1,227 @@
+/* mem_budget.c */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl.h"
+#include "lv_port.h"
+
+static const char *TAG = "mem_budget";
+
+#define MEM_BUDGET_REPORT_SIZE  (1536)
+
+typedef struct {
+    const char *name;
+    const void *ptr;
+    size_t size;
+    mem_place_t place;
+    bool owned;                 /* From mem_budget_alloc(), which checks the placement */
+} mem_budget_buf_t;
+
+typedef struct {
+    const char *name;
+    uint32_t stack_size;
+} mem_budget_task_t;
+
+static struct {
+    portMUX_TYPE lock;
+    mem_budget_buf_t bufs[MEM_BUDGET_MAX_BUFFERS];
+    uint32_t buf_cnt;
+    uint32_t bufs_unlisted;     /* Table full */
+    size_t bytes_unlisted;
+    mem_budget_task_t tasks[MEM_BUDGET_MAX_TASKS];
+    uint32_t task_cnt;
+} budget = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static const char *const place_names[] = { "internal", "psram", "dma" };
+
+/*******************************************************************************
+* Buffers and tasks
+*******************************************************************************/
+
+uint32_t mem_budget_caps(mem_place_t place)
+{
+    switch (place) {
+    case MEM_PLACE_PSRAM:
+        return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    case MEM_PLACE_DMA:
+        return MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    case MEM_PLACE_INTERNAL:
+    default:
+        return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    }
+}
+
+static void mem_budget_record(const char *name, const void *ptr, size_t size, mem_place_t place, bool owned)
+{
+    taskENTER_CRITICAL(&budget.lock);
+    if (budget.buf_cnt < MEM_BUDGET_MAX_BUFFERS) {
+        budget.bufs[budget.buf_cnt++] = (mem_budget_buf_t) {
+            .name = name, .ptr = ptr, .size = size, .place = place, .owned = owned,
+        };
+    } else {
+        budget.bufs_unlisted++;
+        budget.bytes_unlisted += size;
+    }
+    taskEXIT_CRITICAL(&budget.lock);
+}
+
+void *mem_budget_alloc(const char *name, size_t size, mem_place_t place)
+{
+    void *ptr = heap_caps_malloc(size, mem_budget_caps(place));
+    if (ptr == NULL && place == MEM_PLACE_INTERNAL) {
+        ptr = heap_caps_malloc(size, mem_budget_caps(MEM_PLACE_PSRAM));
+        if (ptr) {
+            ESP_LOGW(TAG, "%s: %u bytes not in %s", name, (unsigned)size, place_names[place]);
+        }
+    }
+    if (ptr == NULL) {
+        ESP_LOGE(TAG, "%s: no memory for %u bytes", name, (unsigned)size);
+        return NULL;
+    }
+    mem_budget_record(name, ptr, size, place, true);
+    return ptr;
+}
+
+void mem_budget_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    mem_budget_remove(ptr);
+    heap_caps_free(ptr);
+}
+
+void mem_budget_remove(const void *ptr)
+{
+    taskENTER_CRITICAL(&budget.lock);
+    for (uint32_t i = 0; i < budget.buf_cnt; i++) {
+        if (budget.bufs[i].ptr == ptr) {
+            budget.bufs[i] = budget.bufs[--budget.buf_cnt];
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&budget.lock);
+}
+
+void mem_budget_add(const char *name, const void *ptr, size_t size)
+{
+    if (ptr) {
+        mem_budget_record(name, ptr, size, esp_ptr_external_ram(ptr) ? MEM_PLACE_PSRAM : MEM_PLACE_INTERNAL, false);
+    }
+}
+
+void mem_budget_add_task(const char *name, uint32_t stack_size)
+{
+    taskENTER_CRITICAL(&budget.lock);
+    if (budget.task_cnt < MEM_BUDGET_MAX_TASKS) {
+        budget.tasks[budget.task_cnt++] = (mem_budget_task_t) { .name = name, .stack_size = stack_size };
+    }
+    taskEXIT_CRITICAL(&budget.lock);
+}
+
+/*******************************************************************************
+* Report
+*******************************************************************************/
+
+size_t mem_budget_report(char *buf, size_t size)
+{
+    size_t len = 0;
+#define MEM_BUDGET_PUT(...) do { \
+        if (len < size) { \
+            int n = snprintf(buf + len, size - len, __VA_ARGS__); \
+            len += (n > 0) ? (size_t)n : 0; \
+        } \
+    } while (0)
+
+    /* Heaps: "<heap> free <now> min <lowest since boot> largest <block> of <total>" */
+    static const struct {
+        const char *name;
+        uint32_t caps;
+    } heaps[] = {
+        { "internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT },
+        { "dma", MALLOC_CAP_DMA },
+        { "psram", MALLOC_CAP_SPIRAM },
+    };
+    for (size_t i = 0; i < sizeof(heaps) / sizeof(heaps[0]); i++) {
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, heaps[i].caps);
+        MEM_BUDGET_PUT("heap %-8s free %u min %u largest %u of %u\n", heaps[i].name,
+                       (unsigned)info.total_free_bytes, (unsigned)info.minimum_free_bytes,
+                       (unsigned)info.largest_free_block, (unsigned)(info.total_free_bytes + info.total_allocated_bytes));
+    }
+
+#if LV_MEM_CUSTOM == 0
+    /* LVGL's own pools (lv_conf.h), inside the heaps above */
+    lv_mem_monitor_t mon, large;
+    lvgl_port_lock(0);
+    lv_mem_monitor(&mon);
+    lv_mem_monitor_large(&large);
+    lvgl_port_unlock();
+    MEM_BUDGET_PUT("lvgl pool internal %" PRIu32 "/%" PRIu32 " B peak %" PRIu32 " frag %d%%",
+                   mon.total_size - mon.free_size, mon.total_size, mon.max_used, mon.frag_pct);
+    if (large.total_size) {
+        MEM_BUDGET_PUT(", psram %" PRIu32 "/%" PRIu32 " B peak %" PRIu32 " frag %d%%",
+                       large.total_size - large.free_size, large.total_size, large.max_used, large.frag_pct);
+    }
+    MEM_BUDGET_PUT("\n");
+#endif
+
+    /* Buffers: "<name> <bytes> B <memory it is in>", and what it should have been in */
+    mem_budget_buf_t bufs[MEM_BUDGET_MAX_BUFFERS];
+    taskENTER_CRITICAL(&budget.lock);
+    const uint32_t buf_cnt = budget.buf_cnt;
+    const uint32_t unlisted = budget.bufs_unlisted;
+    const size_t unlisted_bytes = budget.bytes_unlisted;
+    memcpy(bufs, budget.bufs, buf_cnt * sizeof(mem_budget_buf_t));
+    taskEXIT_CRITICAL(&budget.lock);
+    size_t total[2] = { 0, 0 };
+    for (uint32_t i = 0; i < buf_cnt; i++) {
+        const bool psram = esp_ptr_external_ram(bufs[i].ptr);
+        total[psram] += bufs[i].size;
+        MEM_BUDGET_PUT("buf  %-16s %7u B %s", bufs[i].name, (unsigned)bufs[i].size, psram ? "psram" : "internal");
+        if (bufs[i].owned && psram != (bufs[i].place == MEM_PLACE_PSRAM)) {
+            MEM_BUDGET_PUT(" (wanted %s)", place_names[bufs[i].place]);
+        }
+        MEM_BUDGET_PUT("\n");
+    }
+    if (unlisted) {
+        MEM_BUDGET_PUT("buf  %" PRIu32 " more, %u B\n", unlisted, (unsigned)unlisted_bytes);
+    }
+    MEM_BUDGET_PUT("buf  total %u B internal, %u B psram\n", (unsigned)total[0], (unsigned)total[1]);
+
+    /* Task stacks: "<name> <size> B <memory>, <bytes never used>" */
+    for (uint32_t i = 0; i < budget.task_cnt; i++) {
+        const mem_budget_task_t *t = &budget.tasks[i];
+        TaskHandle_t task = xTaskGetHandle(t->name);
+        if (task == NULL) {
+            MEM_BUDGET_PUT("task %-16s %7" PRIu32 " B not running\n", t->name, t->stack_size);
+            continue;
+        }
+        const bool psram = esp_ptr_external_ram(pxTaskGetStackStart(task));
+        MEM_BUDGET_PUT("task %-16s %7" PRIu32 " B %s, %u B never used\n", t->name, t->stack_size,
+                       psram ? "psram" : "internal", (unsigned)uxTaskGetStackHighWaterMark(task));
+    }
+#undef MEM_BUDGET_PUT
+
+    return (len < size) ? len : (size ? size - 1 : 0);
+}
+
+void mem_budget_log(void)
+{
+    static char report[MEM_BUDGET_REPORT_SIZE];
+    mem_budget_report(report, sizeof(report));
+
+    char *save = NULL;
+    for (char *line = strtok_r(report, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        ESP_LOGI(TAG, "%s", line);
+    }
+}
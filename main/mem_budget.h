@@ -0,0 +1,123 @@
+/* mem_budget.h */
+
+/**
+ * @file
+ * @brief Where the large buffers and task stacks live, and how much memory is left
+ *
+ * Wi-Fi, NimBLE, lwIP, httpd, LVGL's pool and the DMA transport buffers share 512 KB of internal
+ * RAM; the full-frame buffer and the caches sit in the 8 MB of slower PSRAM. Large buffers are
+ * allocated through mem_budget_alloc() with a placement and recorded with the memory they ended
+ * up in. Buffers allocated elsewhere and task stacks are registered. mem_budget_report() lists
+ * them all. It also shows the free, minimum free and largest free block of the internal,
+ * DMA-capable and PSRAM heaps, LVGL's pools and the stack high water marks.
+ *
+ * The MEM_BUDGET_* placements below are the policy. Override them at build time, e.g.
+ * `idf.py -DMEM_BUDGET_TREND=INTERNAL build` (see main/CMakeLists.txt). A task whose stack is in
+ * PSRAM must not write flash (NVS) itself, as PSRAM is unreachable while the flash cache is
+ * off; the LVGL task and httpd both save settings, so their stacks stay internal by default.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Placement of a buffer or task stack
+ */
+typedef enum {
+    MEM_PLACE_INTERNAL = 0, /*!< Internal RAM, PSRAM if that is full */
+    MEM_PLACE_PSRAM,        /*!< PSRAM only, so large buffers never eat the internal RAM */
+    MEM_PLACE_DMA,          /*!< DMA-capable internal RAM only */
+} mem_place_t;
+
+/* Live tab background snapshot, ~300 KB, only copied from when the tab is drawn */
+#ifndef MEM_BUDGET_BG_CACHE
+#define MEM_BUDGET_BG_CACHE     MEM_PLACE_PSRAM
+#endif
+/* Trend chart points, read when the chart is drawn */
+#ifndef MEM_BUDGET_TREND
+#define MEM_BUDGET_TREND        MEM_PLACE_PSRAM
+#endif
+/* Digit glyph atlases, copied from on every value change */
+#ifndef MEM_BUDGET_DIGITS
+#define MEM_BUDGET_DIGITS       MEM_PLACE_INTERNAL
+#endif
+/* Stack of the LVGL task */
+#ifndef MEM_BUDGET_LVGL_STACK
+#define MEM_BUDGET_LVGL_STACK   MEM_PLACE_INTERNAL
+#endif
+/* Stack of the httpd task of the config server */
+#ifndef MEM_BUDGET_HTTPD_STACK
+#define MEM_BUDGET_HTTPD_STACK  MEM_PLACE_INTERNAL
+#endif
+
+/* Entries of the table; further buffers and tasks are counted, not listed */
+#define MEM_BUDGET_MAX_BUFFERS  (16)
+#define MEM_BUDGET_MAX_TASKS    (16)
+
+/**
+ * @brief Heap capabilities of a placement, for heap_caps_malloc() and xTaskCreateWithCaps()
+ */
+uint32_t mem_budget_caps(mem_place_t place);
+
+/**
+ * @brief Allocate a buffer where `place` says and record it
+ *
+ * @param name  Name in the report, kept by reference
+ * @param size  Bytes
+ * @param place Placement
+ *
+ * @return The buffer, NULL if there is no room
+ */
+void *mem_budget_alloc(const char *name, size_t size, mem_place_t place);
+
+/**
+ * @brief Free a buffer of mem_budget_alloc() and remove it from the table; NULL is ignored
+ */
+void mem_budget_free(void *ptr);
+
+/**
+ * @brief Record a buffer allocated elsewhere; the memory it is in is read from its address
+ *
+ * @param name Name in the report, kept by reference
+ * @param ptr  Buffer
+ * @param size Bytes
+ */
+void mem_budget_add(const char *name, const void *ptr, size_t size);
+
+/**
+ * @brief Remove a buffer of mem_budget_add() from the table, before it is freed
+ */
+void mem_budget_remove(const void *ptr);
+
+/**
+ * @brief Record a task to report its stack, by its FreeRTOS name
+ *
+ * @param name       Task name; tasks not running (yet) are reported as such
+ * @param stack_size Stack size in bytes the task was created with
+ */
+void mem_budget_add_task(const char *name, uint32_t stack_size);
+
+/**
+ * @brief Write the report: heaps, LVGL's pools, buffers and task stacks, one item per line
+ *
+ * @param buf  Destination
+ * @param size Size of `buf`
+ *
+ * @return Length of the report, truncated to `size - 1`
+ */
+size_t mem_budget_report(char *buf, size_t size);
+
+/**
+ * @brief Log the report line by line
+ */
+void mem_budget_log(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,317 @@
+/* panel_bench.c */
+#include "panel_bench.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_axs15231b.h"
+#include "config_storage.h"
+#include "display.h"
+#include "esp_bsp.h"
+
+static const char *TAG = "PANEL_BENCH";
+
+// Native orientation, the panel isn't rotated
+#define BENCH_W             EXAMPLE_LCD_QSPI_H_RES
+#define BENCH_H             EXAMPLE_LCD_QSPI_V_RES
+#define BENCH_FRAME_BYTES   (BENCH_W * BENCH_H * 2)
+#define BENCH_READ_W        32
+#define BENCH_READ_H        2
+#define BENCH_SPIN          256     // idle loop iterations between looks at the queue
+#define BENCH_CALIBRATE_US  20000
+
+// The sweep. panel_bench_load() only takes settings from these
+static const uint32_t pclk_hz[] = { 20 * 1000 * 1000, 40 * 1000 * 1000, 80 * 1000 * 1000 };
+static const uint32_t max_transfer_sz[] = { 4096, 16384, BENCH_FRAME_BYTES };
+static const uint32_t trans_size[] = { BENCH_W * BENCH_H / 40, BENCH_W * BENCH_H / 20, BENCH_W * BENCH_H / 10 };
+
+#define BENCH_COUNT(a)      (sizeof(a) / sizeof((a)[0]))
+#define BENCH_RUNS          (BENCH_COUNT(pclk_hz) * BENCH_COUNT(max_transfer_sz) * BENCH_COUNT(trans_size))
+
+typedef enum {
+    READBACK_NONE,          // the controller doesn't return what was written
+    READBACK_OK,
+    READBACK_BAD,
+} readback_t;
+
+static const char *const readback_names[] = { "n/a", "ok", "WRONG" };
+
+typedef struct {
+    panel_bench_config_t cfg;
+    esp_err_t err;          // bringing the bus up or queueing failed
+    uint32_t failed;        // rectangles the driver couldn't send
+    int64_t us;
+    uint32_t cpu_pct;
+    readback_t readback;
+} bench_result_t;
+
+// Written by the driver's transfer task only
+typedef struct {
+    volatile uint32_t done;
+    volatile uint32_t failed;
+} bench_run_t;
+
+static volatile uint32_t spin_sink;
+
+// Eight colour bars over a checkerboard of complementary bit patterns, so every data line toggles from one pixel to
+// the next; the second buffer is the inverse of the first
+static void bench_fill(uint16_t *buf0, uint16_t *buf1, uint32_t px) {
+    static const uint16_t bars[8] = { 0xFFFF, 0xFFE0, 0x07FF, 0x07E0, 0xF81F, 0xF800, 0x001F, 0x0000 };
+    for (uint32_t i = 0; i < px; i++) {
+        const uint32_t x = i % BENCH_W, y = i / BENCH_W;
+        buf0[i] = bars[x * 8 / BENCH_W] ^ (((x + y) & 1) ? 0xAAAA : 0x5555);
+        buf1[i] = (uint16_t)~buf0[i];
+    }
+}
+
+static inline void bench_spin(void) {
+    for (int i = 0; i < BENCH_SPIN; i++) {
+        spin_sink++;
+    }
+}
+
+// Idle loops per microsecond with the bus quiet
+static double bench_calibrate(void) {
+    vTaskDelay(1);
+    uint32_t spins = 0;
+    const int64_t start = esp_timer_get_time();
+    int64_t now;
+    do {
+        bench_spin();
+        spins++;
+    } while ((now = esp_timer_get_time()) - start < BENCH_CALIBRATE_US);
+    return (double)spins / (double)(now - start);
+}
+
+static void bench_done(esp_lcd_panel_handle_t panel, esp_err_t status, void *user_ctx) {
+    bench_run_t *run = (bench_run_t *)user_ctx;
+    if (status != ESP_OK) {
+        run->failed++;
+    }
+    run->done++;
+}
+
+static esp_err_t bench_bus_new(uint32_t pclk, uint32_t xfer, esp_lcd_panel_handle_t *panel, esp_lcd_panel_io_handle_t *io) {
+    // No TE: frames go out as fast as the bus takes them
+    const bsp_display_config_t cfg = {
+        .max_transfer_sz = (int)xfer,
+        .pclk_hz = pclk,
+        .tear_cfg = BSP_SYNC_TASK_CONFIG(GPIO_NUM_NC, GPIO_INTR_DISABLE),
+    };
+    ESP_RETURN_ON_ERROR(bsp_display_new(&cfg, panel, io), TAG, "bus at %" PRIu32 " Hz failed", pclk);
+    const esp_err_t ret = esp_lcd_panel_disp_on_off(*panel, false);
+    if (ret != ESP_OK) {
+        bsp_display_del(*panel, *io);
+    }
+    return ret;
+}
+
+// The top left corner against `sent`, a buffer of full rows
+static readback_t bench_readback(esp_lcd_panel_handle_t panel, const uint16_t *sent, uint16_t *read) {
+    if (esp_lcd_axs15231b_read_ram(panel, 0, 0, BENCH_READ_W, BENCH_READ_H, read) != ESP_OK) {
+        return READBACK_BAD;
+    }
+    for (int y = 0; y < BENCH_READ_H; y++) {
+        for (int x = 0; x < BENCH_READ_W; x++) {
+            if (read[y * BENCH_READ_W + x] != sent[y * BENCH_W + x]) {
+                return READBACK_BAD;
+            }
+        }
+    }
+    return READBACK_OK;
+}
+
+// Whether the controller returns what was written, at the default settings and for both patterns
+static bool bench_probe(const panel_bench_config_t *cfg, uint16_t *const bufs[2], uint16_t *read) {
+    esp_lcd_panel_handle_t panel = NULL;
+    esp_lcd_panel_io_handle_t io = NULL;
+    if (bench_bus_new(cfg->pclk_hz, cfg->max_transfer_sz, &panel, &io) != ESP_OK) {
+        return false;
+    }
+    bool ok = true;
+    for (int i = 0; i < 2 && ok; i++) {
+        ok = esp_lcd_panel_draw_bitmap(panel, 0, 0, BENCH_W, BENCH_READ_H, bufs[i]) == ESP_OK &&
+             bench_readback(panel, bufs[i], read) == READBACK_OK;
+    }
+    bsp_display_del(panel, io);
+    return ok;
+}
+
+// PANEL_BENCH_FRAMES frames in bands of the transport buffer size, the two patterns alternating. Spins instead of
+// waiting while the queue is full, what's left of the spinning is the CPU the transfers left over
+static void bench_frames(esp_lcd_panel_handle_t panel, uint16_t *const bufs[2], double idle_rate, bench_result_t *res) {
+    const int rows = res->cfg.trans_size / BENCH_W;
+    bench_run_t run = { 0 };
+    uint32_t submitted = 0;
+    uint32_t spins = 0;
+
+    // The corner read back at the end has to come from this run: start from the other pattern
+    esp_lcd_panel_draw_bitmap(panel, 0, 0, BENCH_W, rows, bufs[PANEL_BENCH_FRAMES & 1]);
+
+    const int64_t start = esp_timer_get_time();
+    for (int f = 0; f < PANEL_BENCH_FRAMES && res->err == ESP_OK; f++) {
+        for (int y = 0, b = 0; y < BENCH_H && res->err == ESP_OK; y += rows, b++) {
+            const int y_end = (y + rows < BENCH_H) ? y + rows : BENCH_H;
+            esp_err_t err;
+            while ((err = esp_lcd_axs15231b_draw_bitmap_async(panel, 0, y, BENCH_W, y_end, bufs[(b + f) & 1],
+                                                               bench_done, &run, 0)) == ESP_ERR_TIMEOUT) {
+                bench_spin();
+                spins++;
+            }
+            if (err == ESP_OK) {
+                submitted++;
+            } else {
+                res->err = err;
+            }
+        }
+    }
+    while (run.done < submitted) {
+        bench_spin();
+        spins++;
+    }
+    res->us = esp_timer_get_time() - start;
+    res->failed = run.failed;
+
+    const double idle_us = spins / idle_rate;
+    res->cpu_pct = (res->us <= 0 || idle_us >= res->us) ? 0 : (uint32_t)(100.0 - idle_us * 100.0 / res->us);
+}
+
+static void bench_log(const bench_result_t *r) {
+    if (r->err != ESP_OK || r->us <= 0) {
+        ESP_LOGW(TAG, "%2" PRIu32 " MHz %6" PRIu32 " B %5" PRIu32 " px: %s", r->cfg.pclk_hz / 1000000,
+                 r->cfg.max_transfer_sz, r->cfg.trans_size, esp_err_to_name(r->err));
+        return;
+    }
+    const double bytes = (double)PANEL_BENCH_FRAMES * BENCH_FRAME_BYTES;
+    ESP_LOGI(TAG, "%2" PRIu32 " MHz %6" PRIu32 " B %5" PRIu32 " px: %5.1f MB/s %5.1f fps, CPU %3" PRIu32 "%%, "
+             "%" PRIu32 " failed, readback %s", r->cfg.pclk_hz / 1000000, r->cfg.max_transfer_sz, r->cfg.trans_size,
+             bytes / (double)r->us, PANEL_BENCH_FRAMES * 1e6 / (double)r->us, r->cpu_pct, r->failed,
+             readback_names[r->readback]);
+}
+
+static bool bench_usable(const bench_result_t *r, const panel_bench_config_t *def, bool readback) {
+    return r->err == ESP_OK && r->us > 0 && r->failed == 0 && r->readback != READBACK_BAD &&
+           (readback || r->cfg.pclk_hz <= def->pclk_hz);
+}
+
+// Faster by more than PANEL_BENCH_TIE_PCT, else the smaller transport buffer, else the slower clock
+static bool bench_better(const bench_result_t *a, const bench_result_t *b) {
+    if (a->us * (100 + PANEL_BENCH_TIE_PCT) < b->us * 100) {
+        return true;
+    }
+    if (b->us * (100 + PANEL_BENCH_TIE_PCT) < a->us * 100) {
+        return false;
+    }
+    if (a->cfg.trans_size != b->cfg.trans_size) {
+        return a->cfg.trans_size < b->cfg.trans_size;
+    }
+    return a->cfg.pclk_hz < b->cfg.pclk_hz;
+}
+
+esp_err_t panel_bench_run(panel_bench_config_t *cfg) {
+    const uint32_t max_px = trans_size[BENCH_COUNT(trans_size) - 1];
+    uint16_t *bufs[2] = {
+        heap_caps_malloc(max_px * sizeof(uint16_t), MALLOC_CAP_DMA),
+        heap_caps_malloc(max_px * sizeof(uint16_t), MALLOC_CAP_DMA),
+    };
+    uint16_t *read = heap_caps_malloc(BENCH_READ_W * BENCH_READ_H * sizeof(uint16_t), MALLOC_CAP_DMA);
+    bench_result_t *res = calloc(BENCH_RUNS, sizeof(bench_result_t));
+    esp_err_t ret = ESP_OK;
+    if (bufs[0] == NULL || bufs[1] == NULL || read == NULL || res == NULL) {
+        ESP_LOGW(TAG, "no memory for 2x%" PRIu32 " px of patterns", max_px);
+        ret = ESP_ERR_NO_MEM;
+        goto out;
+    }
+    bench_fill(bufs[0], bufs[1], max_px);
+
+    const bool readback = bench_probe(cfg, bufs, read);
+    if (readback) {
+        ESP_LOGI(TAG, "Readback works, the last frame of each run is checked");
+    } else {
+        ESP_LOGW(TAG, "No readback, clocks above %" PRIu32 " MHz won't be picked", cfg->pclk_hz / 1000000);
+    }
+    const double idle_rate = bench_calibrate();
+
+    size_t n = 0;
+    for (size_t p = 0; p < BENCH_COUNT(pclk_hz); p++) {
+        for (size_t x = 0; x < BENCH_COUNT(max_transfer_sz); x++) {
+            esp_lcd_panel_handle_t panel = NULL;
+            esp_lcd_panel_io_handle_t io = NULL;
+            const esp_err_t err = bench_bus_new(pclk_hz[p], max_transfer_sz[x], &panel, &io);
+            for (size_t t = 0; t < BENCH_COUNT(trans_size); t++) {
+                bench_result_t *r = &res[n++];
+                r->cfg = (panel_bench_config_t) {
+                    .pclk_hz = pclk_hz[p],
+                    .max_transfer_sz = max_transfer_sz[x],
+                    .trans_size = trans_size[t],
+                };
+                r->err = err;
+                if (err == ESP_OK) {
+                    bench_frames(panel, bufs, idle_rate, r);
+                    r->readback = readback ? bench_readback(panel, bufs[(PANEL_BENCH_FRAMES - 1) & 1], read)
+                                           : READBACK_NONE;
+                }
+                bench_log(r);
+                // The spinning kept the idle task out
+                vTaskDelay(1);
+            }
+            if (err == ESP_OK) {
+                bsp_display_del(panel, io);
+            }
+        }
+    }
+
+    const bench_result_t *best = NULL;
+    for (size_t i = 0; i < n; i++) {
+        if (bench_usable(&res[i], cfg, readback) && (best == NULL || bench_better(&res[i], best))) {
+            best = &res[i];
+        }
+    }
+    if (best == NULL) {
+        ESP_LOGW(TAG, "Nothing ran without errors, keeping the defaults");
+        goto out;
+    }
+    *cfg = best->cfg;
+    ret = save_display_bus(cfg->pclk_hz, cfg->max_transfer_sz, cfg->trans_size);
+    ESP_LOGI(TAG, "Best: %" PRIu32 " MHz, %" PRIu32 " B transactions, %" PRIu32 " px transport buffers, %.1f fps%s",
+             cfg->pclk_hz / 1000000, cfg->max_transfer_sz, cfg->trans_size, PANEL_BENCH_FRAMES * 1e6 / (double)best->us,
+             ret == ESP_OK ? ", saved for the next boots" : ", saving failed");
+
+out:
+    heap_caps_free(bufs[0]);
+    heap_caps_free(bufs[1]);
+    heap_caps_free(read);
+    free(res);
+    return ret;
+}
+
+static bool bench_known(uint32_t v, const uint32_t *set, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (set[i] == v) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t panel_bench_load(panel_bench_config_t *cfg) {
+    panel_bench_config_t saved;
+    esp_err_t err = load_display_bus(&saved.pclk_hz, &saved.max_transfer_sz, &saved.trans_size);
+    if (err != ESP_OK) {
+        return err;
+    }
+    ESP_RETURN_ON_FALSE(bench_known(saved.pclk_hz, pclk_hz, BENCH_COUNT(pclk_hz)) &&
+                        bench_known(saved.max_transfer_sz, max_transfer_sz, BENCH_COUNT(max_transfer_sz)) &&
+                        bench_known(saved.trans_size, trans_size, BENCH_COUNT(trans_size)),
+                        ESP_ERR_INVALID_STATE, TAG, "saved bus settings unknown, keeping the defaults");
+    *cfg = saved;
+    ESP_LOGI(TAG, "Bus settings of the benchmark: %" PRIu32 " MHz, %" PRIu32 " B transactions, %" PRIu32
+             " px transport buffers", cfg->pclk_hz / 1000000, cfg->max_transfer_sz, cfg->trans_size);
+    return ESP_OK;
+}
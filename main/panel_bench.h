@@ -0,0 +1,62 @@
+/* panel_bench.h */
+
+/**
+ * @file
+ * @brief Throughput of the display bus, and the bus settings it picks
+ *
+ * Sweeps the QSPI clock, the SPI transaction size (the bus's max_transfer_sz, which the panel IO
+ * splits colour data into) and the LVGL transport buffer size (the rectangles queued to the panel
+ * driver). For each combination it pushes PANEL_BENCH_FRAMES full frames of test patterns in bands
+ * of the transport buffer size, two buffers in flight like the LVGL port, and logs MB/s, frames
+ * per second and the CPU the transfers took from a task of the caller's priority on its core.
+ * Where the controller reads its frame memory back (RAMRD), the top left corner of the last frame
+ * is compared with what was sent.
+ *
+ * The fastest combination without errors is saved to NVS and used from the next boot on; within
+ * PANEL_BENCH_TIE_PCT of it the smaller transport buffer and then the slower clock win. Without
+ * readback the panel can't tell whether it kept up, so clocks above the default are logged but
+ * not picked.
+ *
+ * Runs at startup instead of the saved settings when PANEL_BENCH is 1
+ * (`idf.py -DPANEL_BENCH=1 build`, see main/CMakeLists.txt), before the display is created; it
+ * takes a few seconds. NVS has to be initialised.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifndef PANEL_BENCH
+#define PANEL_BENCH 0
+#endif
+
+#define PANEL_BENCH_FRAMES      20
+#define PANEL_BENCH_TIE_PCT     2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t pclk_hz;           // QSPI clock
+    uint32_t max_transfer_sz;   // largest SPI transaction, bytes
+    uint32_t trans_size;        // LVGL transport buffer, pixels
+} panel_bench_config_t;
+
+/**
+ * Sweep the bus settings, log the results and save the best.
+ * @param cfg  In: the defaults, for the readback probe and kept if nothing runs without errors. Out: the best
+ * @return ESP_ERR_NO_MEM if the pattern buffers could not be allocated, else the error of saving to NVS
+ */
+esp_err_t panel_bench_run(panel_bench_config_t *cfg);
+
+/**
+ * Replace `cfg` with the settings saved by panel_bench_run(), if there are any the sweep could have picked.
+ * @return ESP_ERR_NVS_NOT_FOUND if the benchmark never ran, ESP_ERR_INVALID_STATE if the saved settings are unknown
+ */
+esp_err_t panel_bench_load(panel_bench_config_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
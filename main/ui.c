@@ -1,36 +1,104 @@
 /* ui.c */
 #include "ui.h"
+#include "ui_vm.h"
+#include "ui_bg_cache.h"
+#include "ui_digits.h"
+#include "ui_trend.h"
+#include "ui_status.h"
+#include "ui_theme.h"
 #include <stdlib.h>
 #include <inttypes.h>
 #include <lvgl.h>
 #include "display.h"
 #include "esp_bsp.h"
 #include "lv_port.h"
+#include "lv_port_profile.h"
 #include "esp_log.h"
 #include "victron_ble.h"
 #include "nvs_flash.h"
 #include "config_storage.h"
 #include "config_server.h"
 #include "esp_wifi.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include <stdio.h>
 
 // NVS namespace for Wi-Fi
 #define WIFI_NAMESPACE "wifi"
 
-// Font Awesome symbols (declared in main.c)
-LV_FONT_DECLARE(font_awesome_solar_panel_40);
-LV_FONT_DECLARE(font_awesome_bolt_40);
+// Draw the static part of the Live tab from a cached image (0 to compare draw times)
+#ifndef UI_LIVE_BG_CACHE
+#define UI_LIVE_BG_CACHE 1
+#endif
+
+// Draw the big Live tab values from a pre-blended glyph atlas (0 to use plain labels)
+#ifndef UI_DIGIT_ATLAS
+#define UI_DIGIT_ATLAS 1
+#endif
+
+// Build the Info tab and keyboard on first use and free them after a while on the Live tab
+// (0 builds everything in ui_init, to compare boot time and heap)
+#ifndef UI_LAZY_INFO
+#define UI_LAZY_INFO 1
+#endif
+#define UI_INFO_IDLE_FREE_MS (5 * 60 * 1000)
+
+// Time dimmed by the screensaver before the panel is put to sleep and rendering stops
+// (0 stays dimmed). Data keeps being collected, a touch wakes the display.
+#ifndef UI_SCREENSAVER_DEEP_MS
+#define UI_SCREENSAVER_DEEP_MS (10 * 60 * 1000)
+#endif
+
+// Panel data reaches the visible tab at once, a dimmed display every UI_UPDATE_DIMMED_MS and
+// hidden tabs only when they are shown again. Samples in between replace each other.
+#define UI_UPDATE_DIMMED_MS  (5 * 1000)
+#define UI_UPDATE_REPORT_MS  (60 * 1000)
 
 static const char *TAG_UI = "UI_MODULE";
 
 // LVGL objects & styles
-static lv_obj_t *tabview, *tab_live, *tab_info, *kb;
-static lv_style_t style_title, style_val, style_big, style_medium;
+// Tab order in the tabview
+enum { UI_TAB_LIVE = 0, UI_TAB_TREND, UI_TAB_INFO };
+
+static lv_obj_t *tabview, *tab_live, *tab_trend, *tab_info, *kb;
 static lv_obj_t *lbl_battV, *lbl_battA, *lbl_loadA;
 static lv_obj_t *lbl_solar, *lbl_yield, *lbl_state, *lbl_error;
 static lv_obj_t *solar_symbol, *bolt_symbol;
 static lv_obj_t *ta_mac, *ta_key, *lbl_load_watt;
-static lv_obj_t *spinner; // Spinner for Live tab
+static lv_obj_t *status_ind; // Connection status on the Live tab
+
+// Last rendered text per displayed value
+static ui_vm_field_t vm_battV, vm_battA, vm_loadA, vm_solar, vm_yield;
+static ui_vm_field_t vm_state, vm_error, vm_load_watt, vm_mac;
+static ui_vm_stats_t vm_last_stats;
+
+// Views fed from panel data, each remembers the sample it shows
+enum { UI_VIEW_LIVE = 1 << 0, UI_VIEW_INFO = 1 << 1, UI_VIEW_ALL = UI_VIEW_LIVE | UI_VIEW_INFO };
+static victronPanelData_t panel_latest;
+static uint32_t panel_seq;                  // samples received
+static uint32_t live_seq, info_seq;         // sample shown by each view
+static uint32_t shown_seq;                  // latest sample that reached any view
+static ui_update_counts_t update_counts;
+static lv_timer_t *update_timer;
+static uint32_t update_report_tick;
+
+#if UI_LIVE_BG_CACHE
+// Live tab widgets drawn every frame, everything else comes from the cached background
+static lv_obj_t *live_dynamic[8];
+#endif
+
+// Info tab state
+static bool info_built = false;
+#if UI_LAZY_INFO
+static lv_timer_t *info_idle_timer;
+#endif
+
+// Time and heap taken by a piece of UI construction
+typedef struct {
+    int64_t start_us;
+    size_t free_internal;
+    size_t free_psram;
+} ui_cost_t;
 
 // Global brightness variable
 uint8_t brightness = 100;
@@ -45,6 +113,7 @@ static uint8_t screensaver_brightness;
 static uint16_t screensaver_timeout;
 static lv_timer_t *screensaver_timer = NULL;
 static bool screensaver_active = false;
+static bool screensaver_deep = false;      // panel asleep, see UI_SCREENSAVER_DEEP_MS
 
 // Forward declarations
 static const char *err_str(uint8_t e);
@@ -67,76 +136,118 @@ static void spinbox_ss_time_increment_event_cb(lv_event_t *e);
 static void spinbox_ss_time_decrement_event_cb(lv_event_t *e);
 // Forward declarations (already present, just for clarity)
 static void tabview_touch_event_cb(lv_event_t *e);
+static void tab_shown_event_cb(lv_event_t *e);
+static void update_timer_cb(lv_timer_t *timer);
+static void info_tab_build(void);
+#if UI_LAZY_INFO
+static void tabview_changed_event_cb(lv_event_t *e);
+static void info_idle_timer_cb(lv_timer_t *timer);
+#endif
+
+static void ui_cost_begin(ui_cost_t *c) {
+    c->start_us = esp_timer_get_time();
+    c->free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    c->free_psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+}
+
+// Log elapsed time and heap taken (negative: released) since ui_cost_begin()
+static void ui_cost_end(const ui_cost_t *c, const char *what) {
+    int32_t internal = (int32_t)(c->free_internal - heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    int32_t psram = (int32_t)(c->free_psram - heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    ESP_LOGI(TAG_UI, "%s: %" PRId64 " us, heap %" PRId32 " B internal, %" PRId32 " B PSRAM",
+             what, esp_timer_get_time() - c->start_us, internal, psram);
+}
+
+// Logs once the first frame has been rendered and handed to the panel
+static void first_frame_timer_cb(lv_timer_t *timer) {
+    int64_t us = lvgl_port_get_first_frame_us(lv_disp_get_default());
+    if (us == 0) {
+        return;
+    }
+    ESP_LOGI(TAG_UI, "First frame %" PRId64 " ms after boot (lazy Info tab: %d), free heap %u B internal, %u B PSRAM",
+             us / 1000, UI_LAZY_INFO, (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    lv_timer_del(timer);
+}
+
+// On-screen keyboard, created the first time a text area is focused
+static lv_obj_t *kb_get(void) {
+    if (kb == NULL) {
+        kb = lv_keyboard_create(lv_layer_top());
+        lv_obj_set_size(kb, LV_HOR_RES, LV_VER_RES/2);
+        lv_obj_align(kb, LV_ALIGN_BOTTOM_MID, 0, 0);
+        lv_obj_add_flag(kb, LV_OBJ_FLAG_HIDDEN);
+    }
+    return kb;
+}
+
+// Widget for a big numeric value; `txt` must be a literal
+static lv_obj_t *value_create(lv_obj_t *parent, const char *txt) {
+#if UI_DIGIT_ATLAS
+    // Styled by the theme on creation, the atlas is picked for the font and colour in effect
+    lv_obj_t *v = ui_digits_create(parent);
+    ui_digits_set_text_static(v, txt);
+    // The background cache later stops the boxes drawing their background, which the
+    // widget would otherwise no longer find to blend onto
+    ui_digits_keep_bg_color(v);
+#else
+    lv_obj_t *v = lv_label_create(parent);
+    lv_obj_add_style(v, UI_STYLE(ui_style_val), 0);
+    lv_label_set_text(v, txt);
+#endif
+    return v;
+}
 
 void ui_init(void) {
+    ui_cost_t cost;
+    ui_cost_begin(&cost);
+
     // Initialize NVS
     nvs_flash_init();
     load_brightness(&brightness); // use the global variable
-    // Load defaults from storage
-    char default_ssid[33]; size_t ssid_len = sizeof(default_ssid);
-    char default_pass[65]; size_t pass_len = sizeof(default_pass);
-    uint8_t ap_enabled;
-    if (load_wifi_config(default_ssid, &ssid_len, default_pass, &pass_len, &ap_enabled) != ESP_OK) {
-        strncpy(default_ssid, "VictronConfig", sizeof(default_ssid));
-        default_ssid[sizeof(default_ssid)-1] = '\0';
-        default_pass[0] = '\0';
-        ap_enabled = 1;
-    }
+    bsp_display_brightness_set(brightness); // set display brightness
 
     load_screensaver_settings(&screensaver_enabled, &screensaver_brightness, &screensaver_timeout);
 
-    // Initialize theme
-#if LV_USE_THEME_DEFAULT
-    lv_theme_default_init(NULL,
-        lv_palette_main(LV_PALETTE_BLUE),
-        lv_palette_main(LV_PALETTE_RED),
-        LV_THEME_DEFAULT_DARK,
-        &lv_font_montserrat_14
-    );
+    // Default dark theme plus the UI styles, assigned by widget class
+    ui_theme_init();
+#if LVGL_PORT_PROFILE
+    lvgl_port_profile_name_class(&ui_digits_class, "digits");
 #endif
 
     // Create tabs
     tabview  = lv_tabview_create(lv_scr_act(), LV_DIR_TOP, 40);
     tab_live = lv_tabview_add_tab(tabview, "Live");
+    tab_trend = lv_tabview_add_tab(tabview, "Trend");
     tab_info = lv_tabview_add_tab(tabview, "Info");
+    lv_obj_add_flag(tab_info, UI_THEME_TITLES);
 
     // Add wake event callbacks to tabs
     lv_obj_add_event_cb(tab_live, tabview_touch_event_cb, LV_EVENT_PRESSED, NULL);
     lv_obj_add_event_cb(tab_live, tabview_touch_event_cb, LV_EVENT_CLICKED, NULL);
     lv_obj_add_event_cb(tab_live, tabview_touch_event_cb, LV_EVENT_GESTURE, NULL);
 
+    lv_obj_add_event_cb(tab_trend, tabview_touch_event_cb, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(tab_trend, tabview_touch_event_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(tab_trend, tabview_touch_event_cb, LV_EVENT_GESTURE, NULL);
+
     lv_obj_add_event_cb(tab_info, tabview_touch_event_cb, LV_EVENT_PRESSED, NULL);
     lv_obj_add_event_cb(tab_info, tabview_touch_event_cb, LV_EVENT_CLICKED, NULL);
     lv_obj_add_event_cb(tab_info, tabview_touch_event_cb, LV_EVENT_GESTURE, NULL);
 
-    // Keyboard for textareas
-    kb = lv_keyboard_create(lv_layer_top());
-    lv_obj_set_size(kb, LV_HOR_RES, LV_VER_RES/2);
-    lv_obj_align(kb, LV_ALIGN_BOTTOM_MID, 0, 0);
-    lv_obj_add_flag(kb, LV_OBJ_FLAG_HIDDEN);
-
-    lv_obj_add_flag(kb, LV_OBJ_FLAG_HIDDEN);
-
-    // Styles
-    lv_style_init(&style_title);
-    lv_style_set_text_font(&style_title, &lv_font_montserrat_16);
-    lv_style_set_text_color(&style_title, lv_color_white());
-
-    lv_style_init(&style_medium);
-    lv_style_set_text_font(&style_medium, &lv_font_montserrat_24);
-    lv_style_set_text_color(&style_medium, lv_color_white());
-
-    lv_style_init(&style_big);
-    lv_style_set_text_font(&style_big, &lv_font_montserrat_40);
-    lv_style_set_text_color(&style_big, lv_color_white());
-
-    lv_style_init(&style_val);
-#if LV_FONT_MONTSERRAT_30
-    lv_style_set_text_font(&style_val, &lv_font_montserrat_30);
-#else
-    lv_style_set_text_font(&style_val, LV_FONT_DEFAULT);
+    // Views skipped while hidden catch up when shown (button or swipe)
+    lv_obj_add_event_cb(tabview, tab_shown_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    lv_obj_add_event_cb(lv_tabview_get_content(tabview), tab_shown_event_cb, LV_EVENT_SCROLL_BEGIN, NULL);
+    update_timer = lv_timer_create(update_timer_cb, UI_UPDATE_DIMMED_MS, NULL);
+    lv_timer_pause(update_timer);
+
+#if UI_LAZY_INFO
+    // Info tab contents are built when the tab is first shown (button or swipe)
+    lv_obj_add_event_cb(tabview, tabview_changed_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    lv_obj_add_event_cb(lv_tabview_get_content(tabview), tabview_changed_event_cb, LV_EVENT_SCROLL_BEGIN, NULL);
+    info_idle_timer = lv_timer_create(info_idle_timer_cb, UI_INFO_IDLE_FREE_MS, NULL);
+    lv_timer_pause(info_idle_timer);
 #endif
-    lv_style_set_text_color(&style_val, lv_color_white());
 
     // Live tab layout
     lv_obj_t *row = lv_obj_create(tab_live);
@@ -145,19 +256,16 @@ void ui_init(void) {
     lv_obj_set_flex_align(row, LV_FLEX_ALIGN_SPACE_EVENLY,
                            LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
     lv_obj_clear_flag(row, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(row, UI_THEME_BOXES);
 
     #define NEW_BOX(name, txt, ptr) do { \
         lv_obj_t *b = lv_obj_create(row); \
         lv_obj_set_size(b, lv_pct(30), 80); \
-        lv_obj_set_style_pad_all(b, 8, 0); \
-        lv_obj_set_style_bg_opa(b, LV_OPA_TRANSP, 0); \
+        lv_obj_add_flag(b, UI_THEME_TITLES); \
         lv_obj_t *h = lv_label_create(b); \
         lv_label_set_text(h, name); \
-        lv_obj_add_style(h, &style_title, 0); \
         lv_obj_align(h, LV_ALIGN_TOP_MID, 0, 0); \
-        *(ptr) = lv_label_create(b); \
-        lv_label_set_text(*(ptr), txt); \
-        lv_obj_add_style(*(ptr), &style_val, 0); \
+        *(ptr) = value_create(b, txt); \
         lv_obj_align(*(ptr), LV_ALIGN_CENTER, 0, 10); \
     } while(0)
 
@@ -165,45 +273,112 @@ void ui_init(void) {
     NEW_BOX("Batt A", "0.0 A",  &lbl_battA);
     NEW_BOX("Load A", "0.0 A", &lbl_loadA);
 
-    // --- Spinner in center of Live tab ---
-    spinner = lv_spinner_create(tab_live, 1000, 60); // 1s, 60deg/step
-    lv_obj_set_size(spinner, 40, 40);
-    lv_obj_align(spinner, LV_ALIGN_CENTER, 0, 0);
+    // Connection status in the center of the Live tab, animated only while there is no data
+    status_ind = ui_status_create(tab_live);
+    lv_obj_add_style(status_ind, UI_STYLE(ui_style_medium), 0);
+    lv_obj_align(status_ind, LV_ALIGN_CENTER, 0, 0);
 
     lbl_state = lv_label_create(tab_live);
-    lv_obj_add_style(lbl_state, &style_big, 0);
+    lv_obj_add_style(lbl_state, UI_STYLE(ui_style_big), 0);
     lv_label_set_text(lbl_state, "State");
     lv_obj_align(lbl_state, LV_ALIGN_CENTER, 0, 50);
 
     // Icons and labels
     solar_symbol = lv_label_create(tab_live);
-    lv_obj_set_style_text_font(solar_symbol, &font_awesome_solar_panel_40, 0);
+    lv_obj_add_style(solar_symbol, UI_STYLE(ui_style_icon_solar), 0);
     lv_label_set_text(solar_symbol, "\xEF\x96\xBA");
     lv_obj_align(solar_symbol, LV_ALIGN_BOTTOM_LEFT, 25, -55);
 
     bolt_symbol = lv_label_create(tab_live);
-    lv_obj_set_style_text_font(bolt_symbol, &font_awesome_bolt_40, 0);
+    lv_obj_add_style(bolt_symbol, UI_STYLE(ui_style_icon_bolt), 0);
     lv_label_set_text(bolt_symbol, "\xEF\x83\xA7");
     lv_obj_align(bolt_symbol, LV_ALIGN_BOTTOM_RIGHT, -28, -55);
 
     lbl_solar = lv_label_create(tab_live);
-    lv_obj_add_style(lbl_solar, &style_title, 0);
+    lv_obj_add_style(lbl_solar, UI_STYLE(ui_style_title), 0);
     lv_label_set_text(lbl_solar, "");
     lv_obj_align(lbl_solar, LV_ALIGN_BOTTOM_LEFT, 32, -8);
 
     lbl_yield = lv_label_create(tab_live);
-    lv_obj_add_style(lbl_yield, &style_title, 0);
+    lv_obj_add_style(lbl_yield, UI_STYLE(ui_style_title), 0);
     lv_label_set_text(lbl_yield, "");
     lv_obj_align(lbl_yield, LV_ALIGN_BOTTOM_MID, 0, -8);
 
     lbl_load_watt = lv_label_create(tab_live);
-    lv_obj_add_style(lbl_load_watt, &style_title, 0);
+    lv_obj_add_style(lbl_load_watt, UI_STYLE(ui_style_title), 0);
     lv_label_set_text(lbl_load_watt, "");
     lv_obj_align(lbl_load_watt, LV_ALIGN_BOTTOM_RIGHT, -31, -8);
 
+#if UI_LIVE_BG_CACHE
+    live_dynamic[0] = lbl_battV;
+    live_dynamic[1] = lbl_battA;
+    live_dynamic[2] = lbl_loadA;
+    live_dynamic[3] = status_ind;
+    live_dynamic[4] = lbl_state;
+    live_dynamic[5] = lbl_solar;
+    live_dynamic[6] = lbl_yield;
+    live_dynamic[7] = lbl_load_watt;
+    ui_bg_cache_init(tab_live, live_dynamic, sizeof(live_dynamic) / sizeof(live_dynamic[0]));
+#endif
+
+    // Trend tab: always built, it records history while hidden
+    ui_trend_create(tab_trend);
+
+    // Screensaver timer setup
+    screensaver_timer = lv_timer_create(screensaver_timer_cb, screensaver_timeout * 1000, NULL);
+    if (screensaver_enabled) {
+        lv_timer_reset(screensaver_timer);
+        lv_timer_resume(screensaver_timer);
+    } else {
+        lv_timer_pause(screensaver_timer); // Start paused if not enabled
+    }
+
+    // Touch event: wake/reset screensaver timer
+    lv_obj_add_event_cb(lv_scr_act(), tabview_touch_event_cb, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(lv_scr_act(), tabview_touch_event_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(lv_scr_act(), tabview_touch_event_cb, LV_EVENT_GESTURE, NULL);
+
+    lv_obj_add_event_cb(tabview, tabview_touch_event_cb, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(tabview, tabview_touch_event_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(tabview, tabview_touch_event_cb, LV_EVENT_GESTURE, NULL);
+
+    ui_vm_bind(&vm_battV, lbl_battV);
+    ui_vm_bind(&vm_battA, lbl_battA);
+    ui_vm_bind(&vm_loadA, lbl_loadA);
+    ui_vm_bind(&vm_solar, lbl_solar);
+    ui_vm_bind(&vm_yield, lbl_yield);
+    ui_vm_bind(&vm_state, lbl_state);
+    ui_vm_bind(&vm_load_watt, lbl_load_watt);
+
+#if !UI_LAZY_INFO
+    info_tab_build();
+#endif
+    ui_cost_end(&cost, "ui_init");
+    lv_timer_create(first_frame_timer_cb, 10, NULL);
+
+    lvgl_port_unlock();
+}
+// Create the Info tab contents. Everything is reloaded from storage, so it can be rebuilt any time.
+static void info_tab_build(void) {
+    if (info_built) {
+        return;
+    }
+    ui_cost_t cost;
+    ui_cost_begin(&cost);
+
+    // Load defaults from storage
+    char default_ssid[33]; size_t ssid_len = sizeof(default_ssid);
+    char default_pass[65]; size_t pass_len = sizeof(default_pass);
+    uint8_t ap_enabled;
+    if (load_wifi_config(default_ssid, &ssid_len, default_pass, &pass_len, &ap_enabled) != ESP_OK) {
+        strncpy(default_ssid, "VictronConfig", sizeof(default_ssid));
+        default_ssid[sizeof(default_ssid)-1] = '\0';
+        default_pass[0] = '\0';
+        ap_enabled = 1;
+    }
+
     // Wi-Fi SSID
     lv_obj_t *lbl_ssid = lv_label_create(tab_info);
-    lv_obj_add_style(lbl_ssid, &style_title, 0);
     lv_label_set_text(lbl_ssid, "AP SSID:");
     lv_obj_align(lbl_ssid, LV_ALIGN_TOP_LEFT, 8, 15);
 
@@ -220,7 +395,6 @@ void ui_init(void) {
 
     // Wi-Fi Password
     lv_obj_t *lbl_pass = lv_label_create(tab_info);
-    lv_obj_add_style(lbl_pass, &style_title, 0);
     lv_label_set_text(lbl_pass, "AP Password:");
     lv_obj_align(lbl_pass, LV_ALIGN_TOP_LEFT, 8, 90);
 
@@ -239,18 +413,15 @@ void ui_init(void) {
     // Enable AP checkbox
     cb_ap_enable = lv_checkbox_create(tab_info);
     lv_checkbox_set_text(cb_ap_enable, "Enable AP");
-    lv_obj_add_style(cb_ap_enable, &style_medium,0);
     if (ap_enabled) lv_obj_add_state(cb_ap_enable, LV_STATE_CHECKED);
     lv_obj_align(cb_ap_enable, LV_ALIGN_TOP_LEFT, 8, 180);
 
     // Info tab: error, MAC, AES Key
     lbl_error = lv_label_create(tab_info);
-    lv_obj_add_style(lbl_error, &style_title, 0);
     lv_label_set_text(lbl_error, "Err: 0");
     lv_obj_align(lbl_error, LV_ALIGN_TOP_LEFT, 400, 180);
 
     lv_obj_t *lmac = lv_label_create(tab_info);
-    lv_obj_add_style(lmac, &style_title, 0);
     lv_label_set_text(lmac, "MAC Address:");
     lv_obj_align(lmac, LV_ALIGN_TOP_LEFT, 8, 250);
 
@@ -265,7 +436,6 @@ void ui_init(void) {
     lv_obj_add_event_cb(ta_mac, ta_event_cb, LV_EVENT_READY, NULL);
 
     lv_obj_t *lkey = lv_label_create(tab_info);
-    lv_obj_add_style(lkey, &style_title, 0);
     lv_label_set_text(lkey, "AES Key:");
     lv_obj_align(lkey, LV_ALIGN_TOP_LEFT, 8, 320);
 
@@ -310,7 +480,6 @@ void ui_init(void) {
 
     // Brightness slider label
     lv_obj_t *lbl_brightness = lv_label_create(tab_info);
-    lv_obj_add_style(lbl_brightness, &style_title, 0);
     lv_label_set_text(lbl_brightness, "Brightness:");
     lv_obj_align(lbl_brightness, LV_ALIGN_TOP_LEFT, 8, 450); // moved down by 50px
 
@@ -320,9 +489,7 @@ void ui_init(void) {
     lv_obj_align(slider, LV_ALIGN_TOP_LEFT, 8, 500); // moved down by 50px
     lv_slider_set_range(slider, 1, 100);
     lv_slider_set_value(slider, brightness, LV_ANIM_OFF); // set loaded value
-    bsp_display_brightness_set(brightness); // set display brightness
     lv_obj_add_event_cb(slider, brightness_slider_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
-    lv_obj_add_style(slider,&style_medium,0);
     // Add extra space at the bottom
     lv_obj_t *spacer = lv_obj_create(tab_info);
     lv_obj_set_size(spacer, 10, 40);
@@ -337,11 +504,9 @@ void ui_init(void) {
     if (screensaver_enabled) lv_obj_add_state(cb_screensaver, LV_STATE_CHECKED); // reflect default
     lv_obj_align(cb_screensaver, LV_ALIGN_TOP_LEFT, 8, 600);
     lv_obj_add_event_cb(cb_screensaver, cb_screensaver_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
-    lv_obj_add_style(cb_screensaver, &style_medium,0);
 
     // Screensaver Brightness Slider
     lv_obj_t *lbl_ss_brightness = lv_label_create(tab_info);
-    lv_obj_add_style(lbl_ss_brightness, &style_title, 0);
     lv_label_set_text(lbl_ss_brightness, "Screensaver Brightness:");
     lv_obj_align(lbl_ss_brightness, LV_ALIGN_TOP_LEFT, 8, 650);
     
@@ -351,11 +516,9 @@ void ui_init(void) {
     lv_slider_set_range(slider_ss_brightness, 1, 100);
     lv_slider_set_value(slider_ss_brightness, screensaver_brightness, LV_ANIM_OFF);
     lv_obj_add_event_cb(slider_ss_brightness, slider_ss_brightness_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
-    lv_obj_add_style(slider_ss_brightness,&style_medium,0);
 
     // Screensaver Timeout Spinbox
     lv_obj_t *lbl_ss_time = lv_label_create(tab_info);
-    lv_obj_add_style(lbl_ss_time, &style_title, 0);
     lv_label_set_text(lbl_ss_time, "Screensaver Timeout (s):");
     lv_obj_align(lbl_ss_time, LV_ALIGN_TOP_LEFT, 8, 730);
 
@@ -384,55 +547,166 @@ void ui_init(void) {
     lv_obj_set_style_bg_img_src(btn_inc, LV_SYMBOL_PLUS, 0);
     lv_obj_add_event_cb(btn_inc, spinbox_ss_time_increment_event_cb, LV_EVENT_ALL, NULL);
 
-    // Screensaver timer setup
-    screensaver_timer = lv_timer_create(screensaver_timer_cb, screensaver_timeout * 1000, NULL);
-    if (screensaver_enabled) {
-        lv_timer_reset(screensaver_timer);
-        lv_timer_resume(screensaver_timer);
-    } else {
-        lv_timer_pause(screensaver_timer); // Start paused if not enabled
+
+    // Shows the latest values received while the tab did not exist
+    ui_vm_bind(&vm_error, lbl_error);
+    ui_vm_bind(&vm_mac, ta_mac);
+
+    info_built = true;
+    ui_cost_end(&cost, "Info tab build");
+}
+
+#if UI_LAZY_INFO
+// Delete the Info tab contents and the keyboard; they come back on the next visit
+static void info_tab_free(void) {
+    ui_cost_t cost;
+    ui_cost_begin(&cost);
+
+    ui_vm_bind(&vm_error, NULL);
+    ui_vm_bind(&vm_mac, NULL);
+    if (kb) {
+        lv_obj_del(kb);
+        kb = NULL;
     }
+    lv_obj_clean(tab_info);
+    lv_obj_scroll_to_y(tab_info, 0, LV_ANIM_OFF);
+    ta_ssid = ta_password = cb_ap_enable = NULL;
+    lbl_error = ta_mac = ta_key = NULL;
+    cb_screensaver = slider_ss_brightness = spinbox_ss_time = NULL;
+
+    info_built = false;
+    ui_cost_end(&cost, "Info tab free");
+}
 
-    // Touch event: wake/reset screensaver timer
-    lv_obj_add_event_cb(lv_scr_act(), tabview_touch_event_cb, LV_EVENT_PRESSED, NULL);
-    lv_obj_add_event_cb(lv_scr_act(), tabview_touch_event_cb, LV_EVENT_CLICKED, NULL);
-    lv_obj_add_event_cb(lv_scr_act(), tabview_touch_event_cb, LV_EVENT_GESTURE, NULL);
+static void tabview_changed_event_cb(lv_event_t *e) {
+    if (lv_event_get_code(e) == LV_EVENT_SCROLL_BEGIN) {
+        // A swipe shows part of the Info tab before the active tab changes
+        info_tab_build();
+        return;
+    }
+    if (lv_tabview_get_tab_act(tabview) == UI_TAB_INFO) {
+        info_tab_build();
+        lv_timer_pause(info_idle_timer);
+    } else if (info_built) {
+        lv_timer_reset(info_idle_timer);
+        lv_timer_resume(info_idle_timer);
+    }
+}
 
-    lv_obj_add_event_cb(tabview, tabview_touch_event_cb, LV_EVENT_PRESSED, NULL);
-    lv_obj_add_event_cb(tabview, tabview_touch_event_cb, LV_EVENT_CLICKED, NULL);
-    lv_obj_add_event_cb(tabview, tabview_touch_event_cb, LV_EVENT_GESTURE, NULL);
+static void info_idle_timer_cb(lv_timer_t *timer) {
+    lv_timer_pause(timer);
+    if (lv_tabview_get_tab_act(tabview) != UI_TAB_INFO) {
+        info_tab_free();
+    }
+}
+#endif
 
-    lvgl_port_unlock();
+// Tabs whose panel data widgets can be seen right now
+static uint32_t visible_views(void) {
+    if (screensaver_deep) {
+        return 0;
+    }
+    switch (lv_tabview_get_tab_act(tabview)) {
+        case UI_TAB_LIVE: return UI_VIEW_LIVE;
+        case UI_TAB_INFO: return UI_VIEW_INFO;
+        default:          return 0;
+    }
 }
 
-void ui_on_panel_data(const victronPanelData_t *d) {
-    lvgl_port_lock(0);
+// Put the latest sample on the given views, unless they already show it
+static void update_apply(uint32_t views) {
+    const victronPanelData_t *d = &panel_latest;
+    bool applied = false;
+
+    if (panel_seq == 0) {
+        return;
+    }
+    // Only widgets whose text changed get invalidated
+    ui_vm_begin();
+    if ((views & UI_VIEW_LIVE) && live_seq != panel_seq) {
+        int32_t battV    = d->batteryVoltage;   // 10 mV
+        int32_t battA    = d->batteryCurrent;   // 100 mA
+        int32_t loadA    = ((d->outputCurrentHi & 1) << 8) | d->outputCurrentLo;   // 100 mA
+        int32_t solarW   = d->inputPower;
+        int32_t yieldWh  = (int32_t)d->todayYield * 10;
+        int32_t loadWatt = (loadA * battV) / 1000;
+
+        ui_vm_label_fixed(&vm_battV, NULL, battV, 2, " V");
+        ui_vm_label_fixed(&vm_battA, NULL, battA, 1, " A");
+        ui_vm_label_fixed(&vm_loadA, NULL, loadA, 1, " A");
+        ui_vm_label_fixed(&vm_solar, NULL, solarW, 0, " W");
+        ui_vm_label_fixed(&vm_yield, "Yield: ", yieldWh, 0, " Wh");
+        ui_vm_label_text(&vm_state, charger_state_str(d->deviceState));
+        ui_vm_label_fixed(&vm_load_watt, NULL, loadWatt, 0, " W");
+        live_seq = panel_seq;
+        applied = true;
+    }
+    if ((views & UI_VIEW_INFO) && info_seq != panel_seq) {
+        ui_vm_label_text(&vm_error, err_str(d->errorCode));
+        info_seq = panel_seq;
+        applied = true;
+    }
+    if (!applied) {
+        return;
+    }
+    ui_vm_end(&vm_last_stats);
+
+    if (shown_seq != panel_seq) {
+        shown_seq = panel_seq;
+        update_counts.applied++;
+    }
+}
+
+static void update_timer_cb(lv_timer_t *timer) {
+    lv_timer_pause(timer);
+    update_apply(visible_views());
+
+    if (lv_tick_elaps(update_report_tick) >= UI_UPDATE_REPORT_MS) {
+        update_report_tick = lv_tick_get();
+        ESP_LOGI(TAG_UI, "Panel data: %" PRIu32 " received, %" PRIu32 " applied, %" PRIu32 " skipped",
+                 update_counts.received, update_counts.applied, update_counts.received - update_counts.applied);
+    }
+}
 
-    int battVraw = d->batteryVoltage;
-    int battV_i  = battVraw / 100;
-    int battV_f  = battVraw % 100;
+static void tab_shown_event_cb(lv_event_t *e) {
+    // A swipe shows the neighbouring tabs before the active one changes
+    update_apply(lv_event_get_code(e) == LV_EVENT_SCROLL_BEGIN ? UI_VIEW_ALL : visible_views());
+}
 
-    int battAraw = d->batteryCurrent;
-    int battA_i  = battAraw / 10;
-    int battA_f  = abs(battAraw % 10);
+void ui_on_panel_data(const victronPanelData_t *d) {
+    lvgl_port_lock(0);
 
-    int loadRaw = ((d->outputCurrentHi & 1) << 8) | d->outputCurrentLo;
-    int load_i = loadRaw / 10;
-    int load_f = loadRaw % 10;
+    panel_latest = *d;
+    panel_seq++;
+    update_counts.received++;
+
+    // History and connection status follow every sample, whatever is shown
+    ui_trend_add_sample(d->inputPower, d->batteryVoltage);
+    ui_status_data_received();
+
+    if (!screensaver_active) {
+        lv_timer_resume(update_timer);
+        lv_timer_ready(update_timer);
+    } else if (!screensaver_deep && update_timer->paused) {
+        // Dimmed: the first sample starts the wait, later ones only replace it
+        lv_timer_reset(update_timer);
+        lv_timer_resume(update_timer);
+    }
 
-    uint32_t solarW   = d->inputPower;
-    uint32_t yieldWh  = (uint32_t)(d->todayYield * 0.01f * 1000.0f);
-    uint32_t loadWatt = (loadRaw * battVraw) / 1000;
+    lvgl_port_unlock();
+}
 
-    lv_label_set_text_fmt(lbl_battV, "%d.%02d V", battV_i, battV_f);
-    lv_label_set_text_fmt(lbl_battA, "%d.%1d A", battA_i, battA_f);
-    lv_label_set_text_fmt(lbl_loadA, "%d.%1d A", load_i, load_f);
-    lv_label_set_text_fmt(lbl_solar, "%lu W", solarW);
-    lv_label_set_text_fmt(lbl_yield, "Yield: %lu Wh", yieldWh);
-    lv_label_set_text_fmt(lbl_state, "%s", charger_state_str(d->deviceState));
-    lv_label_set_text_fmt(lbl_error, "%s", err_str(d->errorCode));
-    lv_label_set_text_fmt(lbl_load_watt, "%lu W", loadWatt);
+void ui_get_update_stats(ui_vm_stats_t *stats) {
+    lvgl_port_lock(0);
+    *stats = vm_last_stats;
+    lvgl_port_unlock();
+}
 
+void ui_get_update_counts(ui_update_counts_t *counts) {
+    lvgl_port_lock(0);
+    counts->received = update_counts.received;
+    counts->applied = update_counts.applied;
+    counts->skipped = update_counts.received - update_counts.applied;
     lvgl_port_unlock();
 }
 
@@ -495,10 +769,10 @@ static void ta_event_cb(lv_event_t *e) {
     lv_obj_t *ta = lv_event_get_target(e);
     lv_event_code_t code = lv_event_get_code(e);
     if (code == LV_EVENT_FOCUSED) {
-        lv_keyboard_set_textarea(kb, ta);
+        lv_keyboard_set_textarea(kb_get(), ta);
         lv_obj_move_foreground(kb);
         lv_obj_clear_flag(kb, LV_OBJ_FLAG_HIDDEN);
-    } else if (code == LV_EVENT_DEFOCUSED || code == LV_EVENT_CANCEL || code == LV_EVENT_READY) {
+    } else if (kb && (code == LV_EVENT_DEFOCUSED || code == LV_EVENT_CANCEL || code == LV_EVENT_READY)) {
         lv_keyboard_set_textarea(kb, NULL);
         lv_obj_add_flag(kb, LV_OBJ_FLAG_HIDDEN);
     }
@@ -591,7 +865,9 @@ void ui_set_ble_mac(const uint8_t *mac) {
              "%02X:%02X:%02X:%02X:%02X:%02X",
              mac[5], mac[4], mac[3], mac[2], mac[1], mac[0]);
     lvgl_port_lock(0);
-    lv_textarea_set_text(ta_mac, mac_str);
+    ui_vm_begin();
+    ui_vm_textarea(&vm_mac, mac_str);
+    ui_vm_end(NULL);
     lvgl_port_unlock();
 }
 
@@ -612,20 +888,41 @@ static void screensaver_enable(bool enable) {
     }
 }
 
+#if UI_SCREENSAVER_DEEP_MS
+// Called by the BSP while waking up, before the fresh frame is rendered
+static void screensaver_deep_wake_cb(void *arg) {
+    screensaver_deep = false;
+    screensaver_wake();
+}
+#endif
+
 static void screensaver_timer_cb(lv_timer_t *timer) {
-    if (screensaver_enabled && !screensaver_active) {
+    if (!screensaver_enabled) {
+        return;
+    }
+    if (!screensaver_active) {
         bsp_display_brightness_set(screensaver_brightness);
         screensaver_active = true;
+#if UI_SCREENSAVER_DEEP_MS
+        lv_timer_set_period(timer, UI_SCREENSAVER_DEEP_MS);
+    } else if (!screensaver_deep && bsp_display_sleep(screensaver_deep_wake_cb, NULL) == ESP_OK) {
+        screensaver_deep = true;
+        lv_timer_pause(timer);
+#endif
     }
 }
 
 static void screensaver_wake(void) {
     if (screensaver_enabled) {
-        lv_timer_reset(screensaver_timer);
         if (screensaver_active) {
             bsp_display_brightness_set(brightness); // uses up-to-date value
             screensaver_active = false;
+            lv_timer_set_period(screensaver_timer, screensaver_timeout * 1000);
+            lv_timer_resume(screensaver_timer);
+            // Back to full rate, show what arrived while dimmed
+            update_apply(visible_views());
         }
+        lv_timer_reset(screensaver_timer);
     }
 }
 
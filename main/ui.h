@@ -5,11 +5,21 @@
 #include <stdint.h>
 #include <lvgl.h>
 #include "victron_ble.h"
+#include "ui_vm.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * How much of the incoming panel data reached the screen.
+ */
+typedef struct {
+    uint32_t received;  // samples from the BLE callback
+    uint32_t applied;   // samples put on a visible view
+    uint32_t skipped;   // samples replaced by a newer one before they could be shown
+} ui_update_counts_t;
+
 /**
  * Initialize all LVGL UI elements, including Live and Info tabs.
  */
@@ -22,6 +32,19 @@ void ui_init(void);
 void ui_on_panel_data(const victronPanelData_t *d);
 void ui_set_ble_mac(const uint8_t *mac);
 
+/**
+ * Widgets and area touched by the last panel data update.
+ * @param stats Receives the counts.
+ */
+void ui_get_update_stats(ui_vm_stats_t *stats);
+
+/**
+ * Panel data received, applied and skipped since boot. Samples reach the visible
+ * tab at once, a dimmed display at a reduced rate, and hidden tabs when shown.
+ * @param counts Receives the counts.
+ */
+void ui_get_update_counts(ui_update_counts_t *counts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,177 @@
+/* ui_bg_cache.c */
+#include "ui_bg_cache.h"
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include "mem_budget.h"
+#include "esp_log.h"
+
+static const char *TAG_BG = "UI_BG_CACHE";
+
+static lv_obj_t *cache_parent;
+static lv_obj_t *const *cache_dynamic;
+static size_t cache_dynamic_cnt;
+static lv_obj_t *cache_img;
+static lv_img_dsc_t cache_dsc;
+static void *cache_buf;
+static uint32_t cache_buf_size;
+static bool cache_building;
+static bool cache_rebuild_pending;
+// Zero opacity skips drawing the object but, unlike LV_OBJ_FLAG_HIDDEN, keeps it in layouts
+static lv_style_t style_invisible;
+static lv_style_t style_see_through;
+
+static void ui_bg_cache_rebuild(void);
+
+static bool is_dynamic(const lv_obj_t *obj) {
+    for (size_t i = 0; i < cache_dynamic_cnt; i++) {
+        if (cache_dynamic[i] == obj) return true;
+    }
+    return false;
+}
+
+// True if obj is dynamic or holds a dynamic widget somewhere below it
+static bool has_dynamic(lv_obj_t *obj) {
+    if (is_dynamic(obj)) return true;
+    uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++) {
+        if (has_dynamic(lv_obj_get_child(obj, i))) return true;
+    }
+    return false;
+}
+
+// Hide purely static subtrees, make containers of dynamic widgets see-through
+static void apply(lv_obj_t *obj, bool cached) {
+    uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++) {
+        lv_obj_t *child = lv_obj_get_child(obj, i);
+        if (child == cache_img || is_dynamic(child)) {
+            continue;
+        }
+        if (has_dynamic(child)) {
+            if (cached) {
+                lv_obj_add_style(child, &style_see_through, 0);
+            } else {
+                lv_obj_remove_style(child, &style_see_through, 0);
+            }
+            apply(child, cached);
+        } else if (cached) {
+            lv_obj_add_style(child, &style_invisible, 0);
+        } else {
+            lv_obj_remove_style(child, &style_invisible, 0);
+        }
+    }
+}
+
+static void show_dynamic(bool show) {
+    for (size_t i = 0; i < cache_dynamic_cnt; i++) {
+        if (show) {
+            lv_obj_remove_style(cache_dynamic[i], &style_invisible, 0);
+        } else {
+            lv_obj_add_style(cache_dynamic[i], &style_invisible, 0);
+        }
+    }
+}
+
+// Background the snapshot is taken on: the first opaque ancestor's colour
+static lv_color_t backdrop_color(lv_obj_t *obj) {
+    for (; obj; obj = lv_obj_get_parent(obj)) {
+        if (lv_obj_get_style_bg_opa(obj, LV_PART_MAIN) >= LV_OPA_COVER) {
+            return lv_obj_get_style_bg_color(obj, LV_PART_MAIN);
+        }
+    }
+    return lv_color_black();
+}
+
+static void rebuild_async_cb(void *arg) {
+    cache_rebuild_pending = false;
+    ui_bg_cache_rebuild();
+}
+
+static void parent_event_cb(lv_event_t *e) {
+    ui_bg_cache_invalidate();
+}
+
+static void ui_bg_cache_rebuild(void) {
+    if (cache_parent == NULL) return;
+    cache_building = true;
+
+    // Restore the live tree so layout and snapshot see every widget
+    apply(cache_parent, false);
+    lv_obj_add_flag(cache_img, LV_OBJ_FLAG_HIDDEN);
+    show_dynamic(false);
+    lv_obj_update_layout(cache_parent);
+
+    uint32_t size = lv_snapshot_buf_size_needed(cache_parent, LV_IMG_CF_TRUE_COLOR);
+    if (size > cache_buf_size) {
+        mem_budget_free(cache_buf);
+        cache_buf = mem_budget_alloc("bg cache", size, MEM_BUDGET_BG_CACHE);
+        cache_buf_size = cache_buf ? size : 0;
+    }
+
+    lv_res_t res = LV_RES_INV;
+    if (cache_buf) {
+        res = lv_snapshot_take_to_buf(cache_parent, LV_IMG_CF_TRUE_COLOR, &cache_dsc, cache_buf, cache_buf_size);
+    }
+    show_dynamic(true);
+
+    if (res != LV_RES_OK) {
+        // Keep drawing the widgets directly
+        ESP_LOGW(TAG_BG, "Snapshot failed (%" PRIu32 " bytes), background not cached", size);
+        cache_building = false;
+        return;
+    }
+
+    lv_img_set_src(cache_img, &cache_dsc);
+    lv_img_cache_invalidate_src(&cache_dsc);
+    lv_obj_clear_flag(cache_img, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_move_background(cache_img);
+
+    // Snapshot starts at the parent's outer corner, children are placed in its content area
+    lv_obj_set_pos(cache_img, 0, 0);
+    lv_obj_update_layout(cache_img);
+    lv_coord_t ext = _lv_obj_get_ext_draw_size(cache_parent);
+    lv_obj_set_pos(cache_img, cache_parent->coords.x1 - ext - cache_img->coords.x1,
+                   cache_parent->coords.y1 - ext - cache_img->coords.y1);
+
+    apply(cache_parent, true);
+    lv_obj_invalidate(cache_parent);
+    cache_building = false;
+
+    ESP_LOGI(TAG_BG, "Background cached: %dx%d, %" PRIu32 " bytes", (int)cache_dsc.header.w, (int)cache_dsc.header.h, size);
+}
+
+void ui_bg_cache_init(lv_obj_t *parent, lv_obj_t *const *dynamic, size_t count) {
+    cache_parent = parent;
+    cache_dynamic = dynamic;
+    cache_dynamic_cnt = count;
+
+    lv_style_init(&style_invisible);
+    lv_style_set_opa(&style_invisible, LV_OPA_TRANSP);
+
+    lv_style_init(&style_see_through);
+    lv_style_set_bg_opa(&style_see_through, LV_OPA_TRANSP);
+    lv_style_set_border_opa(&style_see_through, LV_OPA_TRANSP);
+    lv_style_set_shadow_opa(&style_see_through, LV_OPA_TRANSP);
+    lv_style_set_outline_opa(&style_see_through, LV_OPA_TRANSP);
+
+    // An opaque parent gives the snapshot the same backdrop the screen has
+    lv_obj_set_style_bg_color(parent, backdrop_color(parent), 0);
+    lv_obj_set_style_bg_opa(parent, LV_OPA_COVER, 0);
+
+    cache_img = lv_img_create(parent);
+    lv_obj_add_flag(cache_img, LV_OBJ_FLAG_FLOATING | LV_OBJ_FLAG_HIDDEN);
+    lv_obj_clear_flag(cache_img, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_add_event_cb(parent, parent_event_cb, LV_EVENT_SIZE_CHANGED, NULL);
+    lv_obj_add_event_cb(parent, parent_event_cb, LV_EVENT_STYLE_CHANGED, NULL);
+
+    ui_bg_cache_rebuild();
+}
+
+void ui_bg_cache_invalidate(void) {
+    if (cache_parent && !cache_building && !cache_rebuild_pending) {
+        cache_rebuild_pending = true;
+        lv_async_call(rebuild_async_cb, NULL);
+    }
+}
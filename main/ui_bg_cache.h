@@ -0,0 +1,34 @@
+/* ui_bg_cache.h */
+#ifndef UI_BG_CACHE_H
+#define UI_BG_CACHE_H
+
+#include <stddef.h>
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Render everything on `parent` except the listed dynamic widgets once into an
+ * RGB565 image and show that instead. Static widgets stop drawing (they keep their
+ * place in layouts) and containers of dynamic widgets drop their background/border,
+ * so a refresh blits the image and only draws the dynamic widgets on top.
+ * Call with the LVGL lock held, after the tab has been populated.
+ * @param parent  Container to cache (e.g. a tabview page).
+ * @param dynamic Widgets that change at runtime, they stay live.
+ * @param count   Number of entries in `dynamic`.
+ */
+void ui_bg_cache_init(lv_obj_t *parent, lv_obj_t *const *dynamic, size_t count);
+
+/**
+ * Rebuild the cached image on the next LVGL timer run, e.g. after a theme change.
+ * Size changes of the cached container are picked up automatically.
+ */
+void ui_bg_cache_invalidate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_BG_CACHE_H */
@@ -0,0 +1,330 @@
+/* ui_digits.c */
+#include "ui_digits.h"
+#include <stdbool.h>
+#include <string.h>
+#include "mem_budget.h"
+#include "esp_log.h"
+
+static const char *TAG_DIGITS = "UI_DIGITS";
+
+#define MY_CLASS        &ui_digits_class
+#define GLYPH_CNT       (sizeof(UI_DIGITS_CHARSET) - 1)
+// Font/colour combinations kept at once
+#define ATLAS_MAX       4
+
+typedef struct {
+    const lv_font_t *font;
+    lv_color_t fg;
+    lv_color_t bg;
+    uint16_t refs;
+    lv_coord_t h;
+    lv_coord_t w[GLYPH_CNT];
+    lv_color_t *px;
+    lv_img_dsc_t img[GLYPH_CNT];    // one opaque image per glyph, packed in `px`
+} ui_digits_atlas_t;
+
+typedef struct {
+    lv_obj_t obj;
+    ui_digits_atlas_t *atlas;
+    const char *text;
+    lv_color_t bg;
+    bool bg_set;
+    lv_obj_t *bg_obj;               // ancestor whose background colour is kept, see ui_digits_keep_bg_color()
+} ui_digits_t;
+
+static ui_digits_atlas_t atlases[ATLAS_MAX];
+
+static void ui_digits_constructor(const lv_obj_class_t *class_p, lv_obj_t *obj);
+static void ui_digits_destructor(const lv_obj_class_t *class_p, lv_obj_t *obj);
+static void ui_digits_event(const lv_obj_class_t *class_p, lv_event_t *e);
+
+const lv_obj_class_t ui_digits_class = {
+    .constructor_cb = ui_digits_constructor,
+    .destructor_cb = ui_digits_destructor,
+    .event_cb = ui_digits_event,
+    .width_def = LV_SIZE_CONTENT,
+    .height_def = LV_SIZE_CONTENT,
+    .instance_size = sizeof(ui_digits_t),
+    .base_class = &lv_obj_class,
+};
+
+static int glyph_index(char c) {
+    const char *p = strchr(UI_DIGITS_CHARSET, c);
+    return (p && c) ? (int)(p - UI_DIGITS_CHARSET) : -1;
+}
+
+static bool is_digit_glyph(int i) {
+    return i >= 0 && i <= 9;
+}
+
+// Cell width of a glyph: digits share the widest digit's advance
+static lv_coord_t cell_width(const lv_font_t *font, int i) {
+    if (!is_digit_glyph(i)) {
+        return lv_font_get_glyph_width(font, UI_DIGITS_CHARSET[i], 0);
+    }
+    lv_coord_t digit_w = 0;
+    for (int d = 0; d <= 9; d++) {
+        lv_coord_t w = lv_font_get_glyph_width(font, UI_DIGITS_CHARSET[d], 0);
+        if (w > digit_w) digit_w = w;
+    }
+    return digit_w;
+}
+
+// Render every glyph of the charset onto `bg` through a throwaway canvas
+static bool atlas_build(ui_digits_atlas_t *a, const lv_font_t *font, lv_color_t fg, lv_color_t bg) {
+    size_t px_cnt = 0;
+    a->h = lv_font_get_line_height(font);
+    for (int i = 0; i < (int)GLYPH_CNT; i++) {
+        a->w[i] = cell_width(font, i);
+        px_cnt += a->w[i] * a->h;
+    }
+
+    // Small enough for internal RAM, which is the faster copy source
+    a->px = mem_budget_alloc("digits atlas", px_cnt * sizeof(lv_color_t), MEM_BUDGET_DIGITS);
+    if (a->px == NULL) {
+        return false;
+    }
+
+    lv_obj_t *canvas = lv_canvas_create(lv_layer_sys());
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = font;
+    dsc.color = fg;
+
+    lv_color_t *p = a->px;
+    for (int i = 0; i < (int)GLYPH_CNT; i++) {
+        char txt[2] = { UI_DIGITS_CHARSET[i], '\0' };
+        lv_coord_t adv = lv_font_get_glyph_width(font, txt[0], 0);
+
+        lv_canvas_set_buffer(canvas, p, a->w[i], a->h, LV_IMG_CF_TRUE_COLOR);
+        lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+        lv_canvas_draw_text(canvas, (a->w[i] - adv) / 2, 0, a->w[i], &dsc, txt);
+
+        memset(&a->img[i], 0, sizeof(lv_img_dsc_t));
+        a->img[i].header.always_zero = 0;
+        a->img[i].header.cf = LV_IMG_CF_TRUE_COLOR;
+        a->img[i].header.w = a->w[i];
+        a->img[i].header.h = a->h;
+        a->img[i].data_size = a->w[i] * a->h * sizeof(lv_color_t);
+        a->img[i].data = (const uint8_t *)p;
+        p += a->w[i] * a->h;
+    }
+    lv_obj_del(canvas);
+
+    a->font = font;
+    a->fg = fg;
+    a->bg = bg;
+    a->refs = 0;
+    ESP_LOGI(TAG_DIGITS, "Atlas %dpx high, %u bytes", (int)a->h, (unsigned)(px_cnt * sizeof(lv_color_t)));
+    return true;
+}
+
+static bool atlas_matches(const ui_digits_atlas_t *a, const lv_font_t *font, lv_color_t fg, lv_color_t bg) {
+    return a->font == font && lv_color_to32(a->fg) == lv_color_to32(fg) && lv_color_to32(a->bg) == lv_color_to32(bg);
+}
+
+static ui_digits_atlas_t *atlas_get(const lv_font_t *font, lv_color_t fg, lv_color_t bg) {
+    for (int i = 0; i < ATLAS_MAX; i++) {
+        if (atlases[i].font && atlas_matches(&atlases[i], font, fg, bg)) {
+            return &atlases[i];
+        }
+    }
+    for (int i = 0; i < ATLAS_MAX; i++) {
+        if (atlases[i].font == NULL) {
+            return atlas_build(&atlases[i], font, fg, bg) ? &atlases[i] : NULL;
+        }
+    }
+    ESP_LOGW(TAG_DIGITS, "Atlas slots exhausted, drawing glyphs directly");
+    return NULL;
+}
+
+static void atlas_release(ui_digits_atlas_t *a) {
+    if (a && --a->refs == 0) {
+        mem_budget_free(a->px);
+        memset(a, 0, sizeof(ui_digits_atlas_t));
+    }
+}
+
+static lv_obj_t *backdrop_obj(lv_obj_t *obj) {
+    for (obj = lv_obj_get_parent(obj); obj; obj = lv_obj_get_parent(obj)) {
+        if (lv_obj_get_style_bg_opa(obj, LV_PART_MAIN) >= LV_OPA_COVER) {
+            return obj;
+        }
+    }
+    return NULL;
+}
+
+static lv_color_t backdrop_color(lv_obj_t *obj) {
+    lv_obj_t *backdrop = backdrop_obj(obj);
+    return backdrop ? lv_obj_get_style_bg_color(backdrop, LV_PART_MAIN) : lv_color_black();
+}
+
+static void current_key(lv_obj_t *obj, const lv_font_t **font, lv_color_t *fg, lv_color_t *bg) {
+    ui_digits_t *d = (ui_digits_t *)obj;
+    *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    *fg = lv_obj_get_style_text_color(obj, LV_PART_MAIN);
+    if (d->bg_obj) {
+        *bg = lv_obj_get_style_bg_color(d->bg_obj, LV_PART_MAIN);
+    } else {
+        *bg = d->bg_set ? d->bg : backdrop_color(obj);
+    }
+}
+
+// Point the widget at the atlas for its current font and colours. Not called while
+// rendering (it may create a canvas); until it runs the widget draws glyphs directly.
+static void atlas_sync(lv_obj_t *obj) {
+    ui_digits_t *d = (ui_digits_t *)obj;
+    const lv_font_t *font;
+    lv_color_t fg, bg;
+    current_key(obj, &font, &fg, &bg);
+
+    if (d->atlas && atlas_matches(d->atlas, font, fg, bg)) {
+        return;
+    }
+    atlas_release(d->atlas);
+    d->atlas = atlas_get(font, fg, bg);
+    if (d->atlas) {
+        d->atlas->refs++;
+    }
+}
+
+static lv_coord_t text_width(const lv_font_t *font, const char *text) {
+    lv_coord_t w = 0;
+    for (; *text; text++) {
+        int i = glyph_index(*text);
+        if (i >= 0) w += cell_width(font, i);
+    }
+    return w;
+}
+
+// The kept backdrop changed its style, maybe its colour
+static void backdrop_event_cb(lv_event_t *e) {
+    lv_obj_t *obj = lv_event_get_user_data(e);
+    atlas_sync(obj);
+    lv_obj_invalidate(obj);
+}
+
+static void backdrop_unbind(lv_obj_t *obj) {
+    ui_digits_t *d = (ui_digits_t *)obj;
+    if (d->bg_obj) {
+        lv_obj_remove_event_cb_with_user_data(d->bg_obj, backdrop_event_cb, obj);
+        d->bg_obj = NULL;
+    }
+}
+
+static void ui_digits_constructor(const lv_obj_class_t *class_p, lv_obj_t *obj) {
+    ui_digits_t *d = (ui_digits_t *)obj;
+    d->atlas = NULL;
+    d->text = "";
+    d->bg_set = false;
+    d->bg_obj = NULL;
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+}
+
+static void ui_digits_destructor(const lv_obj_class_t *class_p, lv_obj_t *obj) {
+    ui_digits_t *d = (ui_digits_t *)obj;
+    // Children go before their parents, the backdrop is still there
+    backdrop_unbind(obj);
+    atlas_release(d->atlas);
+    d->atlas = NULL;
+}
+
+static void draw_main(lv_event_t *e) {
+    lv_obj_t *obj = lv_event_get_target(e);
+    ui_digits_t *d = (ui_digits_t *)obj;
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    const lv_font_t *font;
+    lv_color_t fg, bg;
+    current_key(obj, &font, &fg, &bg);
+    ui_digits_atlas_t *a = (d->atlas && atlas_matches(d->atlas, font, fg, bg)) ? d->atlas : NULL;
+
+    lv_area_t area;
+    lv_obj_get_content_coords(obj, &area);
+
+    if (a == NULL) {
+        lv_draw_label_dsc_t label_dsc;
+        lv_draw_label_dsc_init(&label_dsc);
+        lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &label_dsc);
+        lv_draw_label(draw_ctx, &label_dsc, &area, d->text, NULL);
+        return;
+    }
+
+    lv_draw_img_dsc_t img_dsc;
+    lv_draw_img_dsc_init(&img_dsc);
+
+    lv_area_t cell;
+    cell.x1 = area.x1;
+    cell.y1 = area.y1;
+    cell.y2 = area.y1 + a->h - 1;
+    for (const char *c = d->text; *c; c++) {
+        int i = glyph_index(*c);
+        if (i < 0) continue;
+        cell.x2 = cell.x1 + a->w[i] - 1;
+        lv_draw_img(draw_ctx, &img_dsc, &cell, &a->img[i]);
+        cell.x1 = cell.x2 + 1;
+    }
+}
+
+static void ui_digits_event(const lv_obj_class_t *class_p, lv_event_t *e) {
+    lv_res_t res = lv_obj_event_base(MY_CLASS, e);
+    if (res != LV_RES_OK) return;
+
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t *obj = lv_event_get_target(e);
+
+    if (code == LV_EVENT_GET_SELF_SIZE) {
+        lv_point_t *p = lv_event_get_param(e);
+        const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+        p->x = LV_MAX(p->x, text_width(font, ((ui_digits_t *)obj)->text));
+        p->y = LV_MAX(p->y, lv_font_get_line_height(font));
+    } else if (code == LV_EVENT_STYLE_CHANGED) {
+        // A new font or colour needs its atlas. Before the first text the theme's styles are still
+        // coming in one by one, that text picks the atlas.
+        if (((ui_digits_t *)obj)->text[0]) {
+            atlas_sync(obj);
+        }
+        lv_obj_refresh_self_size(obj);
+    } else if (code == LV_EVENT_DRAW_MAIN) {
+        draw_main(e);
+    }
+}
+
+lv_obj_t *ui_digits_create(lv_obj_t *parent) {
+    lv_obj_t *obj = lv_obj_class_create_obj(MY_CLASS, parent);
+    lv_obj_class_init_obj(obj);
+    return obj;
+}
+
+void ui_digits_set_text_static(lv_obj_t *obj, const char *text) {
+    ui_digits_t *d = (ui_digits_t *)obj;
+    d->text = text ? text : "";
+    atlas_sync(obj);
+    lv_obj_refresh_self_size(obj);
+    lv_obj_invalidate(obj);
+}
+
+void ui_digits_set_bg_color(lv_obj_t *obj, lv_color_t color) {
+    ui_digits_t *d = (ui_digits_t *)obj;
+    backdrop_unbind(obj);
+    d->bg = color;
+    d->bg_set = true;
+    atlas_sync(obj);
+    lv_obj_invalidate(obj);
+}
+
+void ui_digits_keep_bg_color(lv_obj_t *obj) {
+    ui_digits_t *d = (ui_digits_t *)obj;
+    lv_obj_t *backdrop = backdrop_obj(obj);
+    if (backdrop == NULL) {
+        ui_digits_set_bg_color(obj, lv_color_black());
+        return;
+    }
+    backdrop_unbind(obj);
+    d->bg_obj = backdrop;
+    d->bg_set = false;
+    lv_obj_add_event_cb(backdrop, backdrop_event_cb, LV_EVENT_STYLE_CHANGED, obj);
+    atlas_sync(obj);
+    lv_obj_invalidate(obj);
+}
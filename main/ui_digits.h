@@ -0,0 +1,47 @@
+/* ui_digits.h */
+#ifndef UI_DIGITS_H
+#define UI_DIGITS_H
+
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Characters the atlas holds, anything else is skipped when drawing
+#define UI_DIGITS_CHARSET "0123456789.-VAW "
+
+extern const lv_obj_class_t ui_digits_class;
+
+/**
+ * Create a numeric text widget. Glyphs are rasterised once per font and colour pair
+ * into an RGB565 atlas, already blended onto the background, so drawing a value is a
+ * few rectangular copies. Font and colour come from the text_font/text_color style.
+ * Digits share one cell width so the widget doesn't change size with the value.
+ */
+lv_obj_t *ui_digits_create(lv_obj_t *parent);
+
+/**
+ * Show `text` without copying it; the buffer must stay valid while shown.
+ * Call again after changing the buffer contents.
+ */
+void ui_digits_set_text_static(lv_obj_t *obj, const char *text);
+
+/**
+ * Colour the glyphs are blended onto. Defaults to the background of the first
+ * opaque ancestor, set it explicitly if the widget sits on something else.
+ */
+void ui_digits_set_bg_color(lv_obj_t *obj, lv_color_t color);
+
+/**
+ * Keep blending onto the background of the container the widget sits on now, also after
+ * its containers stop drawing theirs (as ui_bg_cache does with containers of dynamic
+ * widgets). The colour is read again when that container's style changes.
+ */
+void ui_digits_keep_bg_color(lv_obj_t *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_DIGITS_H */
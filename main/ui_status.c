@@ -0,0 +1,91 @@
+/* ui_status.c */
+#include "ui_status.h"
+#include "esp_log.h"
+
+static const char *TAG_STATUS = "UI_STATUS";
+
+static lv_obj_t *status_obj, *status_icon, *status_spinner;
+static lv_timer_t *stale_timer;
+static ui_status_t status = UI_STATUS_WAITING;
+
+// The spinner only exists while it spins: a hidden one would keep its animations,
+// and with them the LVGL task, running
+static void spinner_show(bool show, lv_color_t color) {
+    if (!show) {
+        if (status_spinner) {
+            lv_obj_del(status_spinner);
+            status_spinner = NULL;
+        }
+        return;
+    }
+    if (status_spinner == NULL) {
+        status_spinner = lv_spinner_create(status_obj, 1000, 60);
+        lv_obj_set_size(status_spinner, lv_pct(100), lv_pct(100));
+        lv_obj_center(status_spinner);
+        lv_obj_set_style_arc_width(status_spinner, 4, LV_PART_MAIN);
+        lv_obj_set_style_arc_width(status_spinner, 4, LV_PART_INDICATOR);
+        lv_obj_move_background(status_spinner);
+    }
+    lv_obj_set_style_arc_color(status_spinner, color, LV_PART_INDICATOR);
+}
+
+static void status_set(ui_status_t s) {
+    status = s;
+    switch (s) {
+        case UI_STATUS_WAITING:
+            spinner_show(true, lv_theme_get_color_primary(status_obj));
+            lv_obj_add_flag(status_icon, LV_OBJ_FLAG_HIDDEN);
+            break;
+        case UI_STATUS_LIVE:
+            spinner_show(false, lv_color_black());
+            lv_obj_set_style_text_color(status_icon, lv_palette_main(LV_PALETTE_GREEN), 0);
+            lv_obj_clear_flag(status_icon, LV_OBJ_FLAG_HIDDEN);
+            break;
+        case UI_STATUS_STALE:
+            spinner_show(true, lv_palette_main(LV_PALETTE_ORANGE));
+            lv_obj_set_style_text_color(status_icon, lv_palette_main(LV_PALETTE_GREY), 0);
+            lv_obj_clear_flag(status_icon, LV_OBJ_FLAG_HIDDEN);
+            break;
+    }
+}
+
+static void stale_timer_cb(lv_timer_t *timer) {
+    lv_timer_pause(timer);
+    ESP_LOGW(TAG_STATUS, "No data for %d s", UI_STATUS_STALE_MS / 1000);
+    status_set(UI_STATUS_STALE);
+}
+
+lv_obj_t *ui_status_create(lv_obj_t *parent) {
+    status_obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(status_obj);
+    lv_obj_set_size(status_obj, 40, 40);
+    lv_obj_clear_flag(status_obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+
+    status_icon = lv_label_create(status_obj);
+    lv_label_set_text_static(status_icon, LV_SYMBOL_BLUETOOTH);
+    lv_obj_center(status_icon);
+
+    stale_timer = lv_timer_create(stale_timer_cb, UI_STATUS_STALE_MS, NULL);
+    lv_timer_pause(stale_timer);
+
+    status_set(UI_STATUS_WAITING);
+    return status_obj;
+}
+
+void ui_status_data_received(void) {
+    if (status_obj == NULL) {
+        return;
+    }
+    lv_timer_reset(stale_timer);
+    lv_timer_resume(stale_timer);
+    if (status != UI_STATUS_LIVE) {
+        if (status == UI_STATUS_STALE) {
+            ESP_LOGI(TAG_STATUS, "Data is back");
+        }
+        status_set(UI_STATUS_LIVE);
+    }
+}
+
+ui_status_t ui_status_get(void) {
+    return status;
+}
@@ -0,0 +1,42 @@
+/* ui_status.h */
+#ifndef UI_STATUS_H
+#define UI_STATUS_H
+
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Data older than this counts as lost and the indicator animates again
+#define UI_STATUS_STALE_MS (30 * 1000)
+
+typedef enum {
+    UI_STATUS_WAITING = 0,  // no sample yet, spinning
+    UI_STATUS_LIVE,         // data is fresh, static icon
+    UI_STATUS_STALE,        // nothing for UI_STATUS_STALE_MS, spinning in orange
+} ui_status_t;
+
+/**
+ * Create the connection status indicator. It only animates while waiting for data,
+ * so a steady stream of samples leaves the screen static between updates.
+ * The icon takes its font from the inherited text_font style.
+ * Call with the LVGL lock held.
+ */
+lv_obj_t *ui_status_create(lv_obj_t *parent);
+
+/**
+ * Report a received sample. Call with the LVGL lock held.
+ */
+void ui_status_data_received(void);
+
+/**
+ * Current indicator state.
+ */
+ui_status_t ui_status_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_STATUS_H */
@@ -0,0 +1,118 @@
+/* ui_theme.c */
+#include "ui_theme.h"
+#include "ui_digits.h"
+
+// Subset at build time to the code points used in ui*.c/ui*.h (main/CMakeLists.txt)
+LV_FONT_DECLARE(ui_font_montserrat_16);
+LV_FONT_DECLARE(ui_font_montserrat_24);
+LV_FONT_DECLARE(ui_font_montserrat_30);
+LV_FONT_DECLARE(ui_font_montserrat_40);
+// Font Awesome symbols (declared in main.c)
+LV_FONT_DECLARE(font_awesome_solar_panel_40);
+LV_FONT_DECLARE(font_awesome_bolt_40);
+
+// LV_STYLE_CONST_INIT marks a const style as holding every property group, so style lookups
+// scan it for padding, background, ... too. Declare only the groups actually set instead,
+// the same mask lv_style_set_prop() would have built, with the group clamped to 7 as in
+// _lv_style_get_prop_group().
+#define UI_STYLE_GROUP(prop) (1U << LV_MIN(((prop) & 0x1FF) >> 4, 7))
+#if LV_USE_ASSERT_STYLE
+#define UI_STYLE_SENTINEL .sentinel = LV_STYLE_SENTINEL_VALUE,
+#else
+#define UI_STYLE_SENTINEL
+#endif
+#define UI_STYLE_CONST(name, props, groups)                 \
+    const lv_style_t name = {                               \
+        UI_STYLE_SENTINEL                                   \
+        .v_p = { .const_props = props },                    \
+        .has_group = (groups),                              \
+        .prop1 = LV_STYLE_PROP_ANY,                         \
+        .prop_cnt = sizeof(props) / sizeof((props)[0]),     \
+    }
+
+#define UI_TEXT_WHITE LV_STYLE_CONST_TEXT_COLOR(LV_COLOR_MAKE(0xFF, 0xFF, 0xFF))
+#define UI_TEXT_GROUPS UI_STYLE_GROUP(LV_STYLE_TEXT_FONT)
+#define UI_BOX_GROUPS (UI_STYLE_GROUP(LV_STYLE_PAD_TOP) | UI_STYLE_GROUP(LV_STYLE_BG_OPA))
+
+// A property outside the declared groups would never be found; keep the masks below in step
+// with the properties of the styles
+#define UI_STYLE_IN_GROUPS(prop, groups) ((UI_STYLE_GROUP(prop) & (groups)) != 0)
+_Static_assert(UI_STYLE_IN_GROUPS(LV_STYLE_TEXT_FONT, UI_TEXT_GROUPS) &&
+               UI_STYLE_IN_GROUPS(LV_STYLE_TEXT_COLOR, UI_TEXT_GROUPS), "text style groups");
+_Static_assert(UI_STYLE_IN_GROUPS(LV_STYLE_PAD_TOP, UI_BOX_GROUPS) &&
+               UI_STYLE_IN_GROUPS(LV_STYLE_PAD_BOTTOM, UI_BOX_GROUPS) &&
+               UI_STYLE_IN_GROUPS(LV_STYLE_PAD_LEFT, UI_BOX_GROUPS) &&
+               UI_STYLE_IN_GROUPS(LV_STYLE_PAD_RIGHT, UI_BOX_GROUPS) &&
+               UI_STYLE_IN_GROUPS(LV_STYLE_BG_OPA, UI_BOX_GROUPS), "box style groups");
+
+static const lv_style_const_prop_t title_props[] = {
+    LV_STYLE_CONST_TEXT_FONT(&ui_font_montserrat_16), UI_TEXT_WHITE,
+};
+static const lv_style_const_prop_t medium_props[] = {
+    LV_STYLE_CONST_TEXT_FONT(&ui_font_montserrat_24), UI_TEXT_WHITE,
+};
+static const lv_style_const_prop_t big_props[] = {
+    LV_STYLE_CONST_TEXT_FONT(&ui_font_montserrat_40), UI_TEXT_WHITE,
+};
+static const lv_style_const_prop_t val_props[] = {
+    LV_STYLE_CONST_TEXT_FONT(&ui_font_montserrat_30), UI_TEXT_WHITE,
+};
+static const lv_style_const_prop_t box_props[] = {
+    LV_STYLE_CONST_PAD_TOP(8), LV_STYLE_CONST_PAD_BOTTOM(8),
+    LV_STYLE_CONST_PAD_LEFT(8), LV_STYLE_CONST_PAD_RIGHT(8),
+    LV_STYLE_CONST_BG_OPA(LV_OPA_TRANSP),
+};
+static const lv_style_const_prop_t icon_solar_props[] = {
+    LV_STYLE_CONST_TEXT_FONT(&font_awesome_solar_panel_40),
+};
+static const lv_style_const_prop_t icon_bolt_props[] = {
+    LV_STYLE_CONST_TEXT_FONT(&font_awesome_bolt_40),
+};
+
+UI_STYLE_CONST(ui_style_title, title_props, UI_TEXT_GROUPS);
+UI_STYLE_CONST(ui_style_medium, medium_props, UI_TEXT_GROUPS);
+UI_STYLE_CONST(ui_style_big, big_props, UI_TEXT_GROUPS);
+UI_STYLE_CONST(ui_style_val, val_props, UI_TEXT_GROUPS);
+UI_STYLE_CONST(ui_style_box, box_props, UI_BOX_GROUPS);
+UI_STYLE_CONST(ui_style_icon_solar, icon_solar_props, UI_TEXT_GROUPS);
+UI_STYLE_CONST(ui_style_icon_bolt, icon_bolt_props, UI_TEXT_GROUPS);
+
+static lv_theme_t ui_theme;
+
+// Runs after the default theme, so these styles take precedence over its ones
+static void ui_theme_apply(lv_theme_t *th, lv_obj_t *obj) {
+    LV_UNUSED(th);
+    lv_obj_t *parent = lv_obj_get_parent(obj);
+    if (parent == NULL) {
+        return;
+    }
+
+    if (lv_obj_check_type(obj, &ui_digits_class)) {
+        lv_obj_add_style(obj, UI_STYLE(ui_style_val), 0);
+    } else if (lv_obj_check_type(obj, &lv_checkbox_class) || lv_obj_check_type(obj, &lv_slider_class)) {
+        lv_obj_add_style(obj, UI_STYLE(ui_style_medium), 0);
+    } else if (lv_obj_check_type(obj, &lv_label_class) && lv_obj_has_flag(parent, UI_THEME_TITLES)) {
+        lv_obj_add_style(obj, UI_STYLE(ui_style_title), 0);
+    } else if (lv_obj_check_type(obj, &lv_obj_class) && lv_obj_has_flag(parent, UI_THEME_BOXES)) {
+        lv_obj_add_style(obj, UI_STYLE(ui_style_box), 0);
+    }
+}
+
+void ui_theme_init(void) {
+    lv_disp_t *disp = lv_disp_get_default();
+#if LV_USE_THEME_DEFAULT
+    lv_theme_t *base = lv_theme_default_init(disp,
+        lv_palette_main(LV_PALETTE_BLUE),
+        lv_palette_main(LV_PALETTE_RED),
+        LV_THEME_DEFAULT_DARK,
+        &lv_font_montserrat_14
+    );
+#else
+    lv_theme_t *base = lv_disp_get_theme(disp);
+#endif
+
+    ui_theme = *base;
+    lv_theme_set_parent(&ui_theme, base);
+    lv_theme_set_apply_cb(&ui_theme, ui_theme_apply);
+    lv_disp_set_theme(disp, &ui_theme);
+}
@@ -0,0 +1,39 @@
+/* ui_theme.h */
+#ifndef UI_THEME_H
+#define UI_THEME_H
+
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Container flags read by the theme when a child is created; set them before adding children
+#define UI_THEME_TITLES LV_OBJ_FLAG_USER_1  // direct child labels get ui_style_title
+#define UI_THEME_BOXES  LV_OBJ_FLAG_USER_2  // direct child plain objects get ui_style_box
+
+// Flash-resident styles. LVGL takes non-const pointers but never writes to a const style,
+// add them with UI_STYLE(), e.g. lv_obj_add_style(obj, UI_STYLE(ui_style_big), 0)
+#define UI_STYLE(s) ((lv_style_t *)&(s))
+
+extern const lv_style_t ui_style_title;     // 16 px white, captions
+extern const lv_style_t ui_style_medium;    // 24 px white
+extern const lv_style_t ui_style_big;       // 40 px white, charger state
+extern const lv_style_t ui_style_val;       // 30 px white, Live values
+extern const lv_style_t ui_style_box;       // transparent, 8 px padding
+extern const lv_style_t ui_style_icon_solar;
+extern const lv_style_t ui_style_icon_bolt;
+
+/**
+ * Install the default dark theme on the default display with a small child theme
+ * on top that assigns the styles above by widget class: Live values (ui_digits),
+ * checkboxes and sliders always, labels and boxes under containers flagged with
+ * UI_THEME_TITLES / UI_THEME_BOXES. Call with the LVGL lock held, before creating widgets.
+ */
+void ui_theme_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_THEME_H */
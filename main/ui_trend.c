@@ -0,0 +1,208 @@
+/* ui_trend.c */
+#include "ui_trend.h"
+#include "ui_vm.h"
+#include <stdbool.h>
+#include <inttypes.h>
+#include "mem_budget.h"
+#include "esp_log.h"
+
+static const char *TAG_TREND = "UI_TREND";
+
+// One history as chart points; `head` is the next slot to overwrite and is kept empty,
+// which draws the gap between newest and oldest in circular mode
+typedef struct {
+    lv_coord_t *power;      // W
+    lv_coord_t *volt;       // 10 mV
+    uint16_t len;
+    uint16_t head;
+} trend_ring_t;
+
+static trend_ring_t ring_hour, ring_day;
+static trend_ring_t *shown;
+static lv_obj_t *chart;
+static lv_chart_series_t *ser_power, *ser_volt;
+static lv_coord_t power_max, volt_min, volt_max;    // current axis ranges
+
+// Readings since the last hour point, hour points since the last day point
+static int32_t acc_power, acc_volt, acc_cnt;
+static int32_t day_power, day_volt, day_cnt, day_ticks;
+
+static lv_coord_t to_point(int32_t v) {
+    // LV_CHART_POINT_NONE is LV_COORD_MAX, keep real values below it
+    if (v >= LV_CHART_POINT_NONE) return LV_CHART_POINT_NONE - 1;
+    if (v < 0) return 0;
+    return (lv_coord_t)v;
+}
+
+// Axis ranges covering the shown history, rounded so they rarely change
+static void update_ranges(void) {
+    int32_t pmax = 0, vmin = INT32_MAX, vmax = INT32_MIN;
+    for (uint16_t i = 0; i < shown->len; i++) {
+        if (shown->power[i] != LV_CHART_POINT_NONE && shown->power[i] > pmax) pmax = shown->power[i];
+        if (shown->volt[i] != LV_CHART_POINT_NONE) {
+            if (shown->volt[i] < vmin) vmin = shown->volt[i];
+            if (shown->volt[i] > vmax) vmax = shown->volt[i];
+        }
+    }
+    pmax = LV_MAX(100, (pmax + 99) / 100 * 100);
+    if (vmin > vmax) {
+        vmin = 1000;
+        vmax = 1500;
+    }
+    vmin = vmin / 100 * 100;
+    vmax = to_point(LV_MAX(vmin + 200, (vmax + 99) / 100 * 100));
+
+    // Either call invalidates the whole chart, only do it when a bound moves
+    if (pmax != power_max) {
+        power_max = (lv_coord_t)pmax;
+        lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, power_max);
+    }
+    if (vmin != volt_min || vmax != volt_max) {
+        volt_min = (lv_coord_t)vmin;
+        volt_max = (lv_coord_t)vmax;
+        lv_chart_set_range(chart, LV_CHART_AXIS_SECONDARY_Y, volt_min, volt_max);
+    }
+}
+
+static void ring_push(trend_ring_t *r, lv_coord_t power, lv_coord_t volt) {
+    if (r == shown) {
+        // Circular mode writes at the series start point (== head) and invalidates
+        // only the columns on either side of it, not the whole chart
+        lv_chart_set_next_value(chart, ser_power, power);
+        lv_chart_set_next_value(chart, ser_volt, volt);
+    } else {
+        r->power[r->head] = power;
+        r->volt[r->head] = volt;
+    }
+    r->head = (r->head + 1) % r->len;
+    r->power[r->head] = LV_CHART_POINT_NONE;
+    r->volt[r->head] = LV_CHART_POINT_NONE;
+
+    if (r == shown && power != LV_CHART_POINT_NONE &&
+        (power > power_max || volt < volt_min || volt > volt_max)) {
+        update_ranges();
+    }
+}
+
+static void trend_timer_cb(lv_timer_t *timer) {
+    lv_coord_t power = LV_CHART_POINT_NONE, volt = LV_CHART_POINT_NONE;
+    if (acc_cnt) {
+        power = to_point(acc_power / acc_cnt);
+        volt = to_point(acc_volt / acc_cnt);
+        day_power += power;
+        day_volt += volt;
+        day_cnt++;
+    }
+    acc_power = acc_volt = acc_cnt = 0;
+    ring_push(&ring_hour, power, volt);
+
+    if (++day_ticks == UI_TREND_DAY_EVERY) {
+        power = volt = LV_CHART_POINT_NONE;
+        if (day_cnt) {
+            power = (lv_coord_t)(day_power / day_cnt);
+            volt = (lv_coord_t)(day_volt / day_cnt);
+        }
+        day_power = day_volt = day_cnt = day_ticks = 0;
+        ring_push(&ring_day, power, volt);
+    }
+}
+
+// Voltage axis labels in volts, without printf
+static void chart_draw_event_cb(lv_event_t *e) {
+    lv_obj_draw_part_dsc_t *dsc = lv_event_get_draw_part_dsc(e);
+    if (dsc->part == LV_PART_TICKS && dsc->id == LV_CHART_AXIS_SECONDARY_Y && dsc->text) {
+        ui_vm_format_fixed(dsc->text, dsc->text_length, NULL, dsc->value / 10, 1, NULL);
+    }
+}
+
+static void view_event_cb(lv_event_t *e) {
+    lv_obj_t *sel = lv_event_get_target(e);
+    ui_trend_set_view(lv_btnmatrix_get_selected_btn(sel) == 1 ? UI_TREND_VIEW_DAY : UI_TREND_VIEW_HOUR);
+}
+
+void ui_trend_create(lv_obj_t *parent) {
+    const size_t cnt = 2 * (UI_TREND_HOUR_POINTS + UI_TREND_DAY_POINTS);
+    lv_coord_t *buf = mem_budget_alloc("trend points", cnt * sizeof(lv_coord_t), MEM_BUDGET_TREND);
+    if (buf == NULL) {
+        ESP_LOGE(TAG_TREND, "No memory for %u trend points", (unsigned)cnt);
+        return;
+    }
+    for (size_t i = 0; i < cnt; i++) {
+        buf[i] = LV_CHART_POINT_NONE;
+    }
+    ring_hour.power = buf;
+    ring_hour.volt = buf + UI_TREND_HOUR_POINTS;
+    ring_hour.len = UI_TREND_HOUR_POINTS;
+    ring_day.power = buf + 2 * UI_TREND_HOUR_POINTS;
+    ring_day.volt = ring_day.power + UI_TREND_DAY_POINTS;
+    ring_day.len = UI_TREND_DAY_POINTS;
+
+    lv_obj_t *lbl_power = lv_label_create(parent);
+    lv_label_set_text(lbl_power, "Solar W");
+    lv_obj_set_style_text_color(lbl_power, lv_palette_main(LV_PALETTE_ORANGE), 0);
+    lv_obj_align(lbl_power, LV_ALIGN_TOP_LEFT, 0, 8);
+
+    lv_obj_t *lbl_volt = lv_label_create(parent);
+    lv_label_set_text(lbl_volt, "Battery V");
+    lv_obj_set_style_text_color(lbl_volt, lv_palette_main(LV_PALETTE_LIGHT_BLUE), 0);
+    lv_obj_align(lbl_volt, LV_ALIGN_TOP_LEFT, 90, 8);
+
+    static const char *view_map[] = {"1 h", "24 h", ""};
+    lv_obj_t *sel = lv_btnmatrix_create(parent);
+    lv_btnmatrix_set_map(sel, view_map);
+    lv_btnmatrix_set_btn_ctrl_all(sel, LV_BTNMATRIX_CTRL_CHECKABLE);
+    lv_btnmatrix_set_one_checked(sel, true);
+    lv_btnmatrix_set_btn_ctrl(sel, 0, LV_BTNMATRIX_CTRL_CHECKED);
+    lv_obj_set_size(sel, 160, 40);
+    lv_obj_align(sel, LV_ALIGN_TOP_RIGHT, 0, 0);
+    lv_obj_add_event_cb(sel, view_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+
+    // Axis labels are drawn outside the chart, leave room on both sides
+    chart = lv_chart_create(parent);
+    lv_obj_set_size(chart, lv_pct(80), 170);
+    lv_obj_align(chart, LV_ALIGN_BOTTOM_MID, 0, -4);
+    lv_obj_clear_flag(chart, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_style_size(chart, 0, LV_PART_INDICATOR);
+    lv_obj_set_style_line_width(chart, 2, LV_PART_ITEMS);
+    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+    lv_chart_set_div_line_count(chart, 5, 5);
+    lv_chart_set_point_count(chart, UI_TREND_HOUR_POINTS);
+    lv_chart_set_axis_tick(chart, LV_CHART_AXIS_PRIMARY_Y, 6, 3, 5, 2, true, 40);
+    lv_chart_set_axis_tick(chart, LV_CHART_AXIS_SECONDARY_Y, 6, 3, 5, 2, true, 40);
+    lv_obj_add_event_cb(chart, chart_draw_event_cb, LV_EVENT_DRAW_PART_BEGIN, NULL);
+
+    ser_power = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_ORANGE), LV_CHART_AXIS_PRIMARY_Y);
+    ser_volt = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_LIGHT_BLUE), LV_CHART_AXIS_SECONDARY_Y);
+
+    ui_trend_set_view(UI_TREND_VIEW_HOUR);
+    lv_timer_create(trend_timer_cb, UI_TREND_PERIOD_MS, NULL);
+
+    ESP_LOGI(TAG_TREND, "Trend history: %u points, %u bytes", (unsigned)cnt, (unsigned)(cnt * sizeof(lv_coord_t)));
+}
+
+void ui_trend_add_sample(int32_t power_w, int32_t batt_10mv) {
+    if (chart == NULL) {
+        return;
+    }
+    acc_power += power_w;
+    acc_volt += batt_10mv;
+    acc_cnt++;
+}
+
+void ui_trend_set_view(ui_trend_view_t view) {
+    trend_ring_t *r = (view == UI_TREND_VIEW_DAY) ? &ring_day : &ring_hour;
+    if (chart == NULL || r == shown) {
+        return;
+    }
+    shown = r;
+
+    // The series point straight into the rings; external arrays are never reallocated,
+    // the point count only sets how many of them the chart walks
+    lv_chart_set_point_count(chart, r->len);
+    lv_chart_set_ext_y_array(chart, ser_power, r->power);
+    lv_chart_set_ext_y_array(chart, ser_volt, r->volt);
+    lv_chart_set_x_start_point(chart, ser_power, r->head);
+    lv_chart_set_x_start_point(chart, ser_volt, r->head);
+    update_ranges();
+}
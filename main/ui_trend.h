@@ -0,0 +1,49 @@
+/* ui_trend.h */
+#ifndef UI_TREND_H
+#define UI_TREND_H
+
+#include <stdint.h>
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sampling cadence of the short view; the long view averages UI_TREND_DAY_EVERY of its points
+#define UI_TREND_PERIOD_MS   10000
+#define UI_TREND_HOUR_POINTS 360    // 1 h at 10 s
+#define UI_TREND_DAY_EVERY   30     // 5 min per point
+#define UI_TREND_DAY_POINTS  288    // 24 h at 5 min
+
+typedef enum {
+    UI_TREND_VIEW_HOUR = 0,
+    UI_TREND_VIEW_DAY,
+} ui_trend_view_t;
+
+/**
+ * Create the trend chart (solar power and battery voltage) and its view
+ * selector on `parent`. Both histories live in one PSRAM block allocated here
+ * and are fed on a fixed UI_TREND_PERIOD_MS cadence, whether or not the page is shown.
+ * Call with the LVGL lock held.
+ */
+void ui_trend_create(lv_obj_t *parent);
+
+/**
+ * Add one decoded reading; readings are averaged per chart point.
+ * Call with the LVGL lock held.
+ * @param power_w   Solar power in W.
+ * @param batt_10mv Battery voltage in 10 mV.
+ */
+void ui_trend_add_sample(int32_t power_w, int32_t batt_10mv);
+
+/**
+ * Show the last hour or the last day. Only the chart's view of the
+ * histories changes, nothing is reallocated or copied.
+ */
+void ui_trend_set_view(ui_trend_view_t view);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_TREND_H */
@@ -0,0 +1,130 @@
+/* ui_vm.c */
+#include "ui_vm.h"
+#include "ui_digits.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG_VM = "UI_VM";
+
+// Stats of the update in progress
+static ui_vm_stats_t cur;
+
+// Put f->text on the widget; it keeps pointing there, so LVGL neither copies nor frees it
+static void ui_vm_apply(ui_vm_field_t *f) {
+    if (lv_obj_check_type(f->obj, &ui_digits_class)) {
+        ui_digits_set_text_static(f->obj, f->text);
+    } else if (lv_obj_check_type(f->obj, &lv_textarea_class)) {
+        lv_textarea_set_text(f->obj, f->text);
+    } else {
+        lv_label_set_text_static(f->obj, f->text);
+    }
+}
+
+void ui_vm_bind(ui_vm_field_t *f, lv_obj_t *obj) {
+    f->obj = obj;
+    if (obj && f->valid) {
+        ui_vm_apply(f);
+    }
+}
+
+void ui_vm_begin(void) {
+    memset(&cur, 0, sizeof(cur));
+}
+
+// Store new text if it differs; account for the widget that will be redrawn.
+// Unbound fields keep the text for when their widget is created.
+static bool ui_vm_changed(ui_vm_field_t *f, const char *text) {
+    if (f->valid && strcmp(f->text, text) == 0) {
+        return false;
+    }
+    size_t n = strnlen(text, sizeof(f->text) - 1);
+    memcpy(f->text, text, n);
+    f->text[n] = '\0';
+    f->valid = true;
+    if (f->obj == NULL) {
+        return false;
+    }
+
+    lv_area_t a;
+    lv_obj_get_coords(f->obj, &a);
+    cur.objects++;
+    cur.area_px += lv_area_get_size(&a);
+    return true;
+}
+
+bool ui_vm_label_fmt(ui_vm_field_t *f, const char *fmt, ...) {
+    char buf[UI_VM_TEXT_LEN];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    return ui_vm_label_text(f, buf);
+}
+
+size_t ui_vm_format_fixed(char *buf, size_t len, const char *prefix, int32_t value, uint8_t decimals, const char *unit) {
+    char digits[12];
+    uint32_t mag = (value < 0) ? (0u - (uint32_t)value) : (uint32_t)value;
+    int n = 0;
+    size_t pos = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+    // Least significant digit first, at least one digit before the point
+    do {
+        digits[n++] = (char)('0' + mag % 10);
+        mag /= 10;
+    } while ((mag || n <= decimals) && n < (int)sizeof(digits));
+
+#define PUT(c) do { const char ch_ = (c); if (pos + 1 < len) { buf[pos++] = ch_; } } while (0)
+    while (prefix && *prefix) {
+        PUT(*prefix++);
+    }
+    if (value < 0) {
+        PUT('-');
+    }
+    while (n > 0) {
+        n--;
+        PUT(digits[n]);
+        if (decimals && n == decimals) {
+            PUT('.');
+        }
+    }
+    while (unit && *unit) {
+        PUT(*unit++);
+    }
+#undef PUT
+    buf[pos] = '\0';
+    return pos;
+}
+
+bool ui_vm_label_fixed(ui_vm_field_t *f, const char *prefix, int32_t value, uint8_t decimals, const char *unit) {
+    char buf[UI_VM_TEXT_LEN];
+    ui_vm_format_fixed(buf, sizeof(buf), prefix, value, decimals, unit);
+    return ui_vm_label_text(f, buf);
+}
+
+bool ui_vm_label_text(ui_vm_field_t *f, const char *text) {
+    if (!ui_vm_changed(f, text)) {
+        return false;
+    }
+    ui_vm_apply(f);
+    return true;
+}
+
+bool ui_vm_textarea(ui_vm_field_t *f, const char *text) {
+    return ui_vm_label_text(f, text);
+}
+
+void ui_vm_end(ui_vm_stats_t *stats) {
+    if (cur.objects) {
+        ESP_LOGD(TAG_VM, "update: %" PRIu32 " objects, %" PRIu32 " px", cur.objects, cur.area_px);
+    }
+    if (stats) {
+        *stats = cur;
+    }
+}
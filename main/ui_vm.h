@@ -0,0 +1,87 @@
+/* ui_vm.h */
+#ifndef UI_VM_H
+#define UI_VM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Longest text a field can hold, including the terminator
+#define UI_VM_TEXT_LEN 40
+
+/**
+ * One displayed value: the widget and the text it currently shows.
+ * Labels display `text` in place (lv_label_set_text_static), so fields must be static.
+ */
+typedef struct {
+    lv_obj_t *obj;              // NULL while the widget does not exist
+    bool valid;                 // text holds the latest value (shown if obj is set)
+    char text[UI_VM_TEXT_LEN];
+} ui_vm_field_t;
+
+/**
+ * What an update actually changed on screen.
+ */
+typedef struct {
+    uint32_t objects;   // widgets whose text changed
+    uint32_t area_px;   // pixels covered by those widgets
+} ui_vm_stats_t;
+
+/**
+ * Attach a field to its widget, or detach it with NULL before the widget is deleted.
+ * A value received earlier is put on the new widget; otherwise the next update renders.
+ */
+void ui_vm_bind(ui_vm_field_t *f, lv_obj_t *obj);
+
+/**
+ * Start collecting stats for one update. Call with the LVGL lock held.
+ */
+void ui_vm_begin(void);
+
+/**
+ * Format a label's text and apply it only if it differs from what is shown.
+ * @return true if the widget was touched.
+ */
+bool ui_vm_label_fmt(ui_vm_field_t *f, const char *fmt, ...) LV_FORMAT_ATTRIBUTE(2, 3);
+
+/**
+ * Show a fixed-point number on a label without printf or heap work,
+ * e.g. value 1234 with 2 decimals and unit " V" shows "12.34 V".
+ * @param prefix Optional text before the number.
+ * @return true if the widget was touched.
+ */
+bool ui_vm_label_fixed(ui_vm_field_t *f, const char *prefix, int32_t value, uint8_t decimals, const char *unit);
+
+/**
+ * Show a string on a label without copying it to the heap.
+ * @return true if the widget was touched.
+ */
+bool ui_vm_label_text(ui_vm_field_t *f, const char *text);
+
+/**
+ * Same as ui_vm_label_text() for a text area.
+ */
+bool ui_vm_textarea(ui_vm_field_t *f, const char *text);
+
+/**
+ * Format a fixed-point number, truncating to fit `len`.
+ * @return Length of the written string.
+ */
+size_t ui_vm_format_fixed(char *buf, size_t len, const char *prefix, int32_t value, uint8_t decimals, const char *unit);
+
+/**
+ * Finish the update started by ui_vm_begin().
+ * @param stats Optional, receives what this update changed.
+ */
+void ui_vm_end(ui_vm_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_VM_H */
@@ -0,0 +1,395 @@
+#!/usr/bin/env python3
+"""Subset LVGL C fonts to the code points the UI actually uses.
+
+Reads fonts in the format written by lv_font_conv (uncompressed bitmaps,
+format0/sparse tiny cmaps, class kerning), keeps only the glyphs whose code
+points appear in string literals of the given sources (plus --always), and
+writes a new C font per input. Nothing is re-rasterised, so the result is
+pixel-identical to the source font.
+
+Example:
+    font_subset.py --scan main/ui.c --always "0123456789" \
+        --font lvgl/src/font/lv_font_montserrat_30.c:ui_font_montserrat_30 \
+        --out-dir build/fonts
+"""
+
+import argparse
+import os
+import re
+import sys
+
+# ---------------------------------------------------------------------------
+# Code point collection
+# ---------------------------------------------------------------------------
+
+STRING_RE = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+ESCAPE_RE = re.compile(r'\\(x[0-9a-fA-F]{1,2}|[0-7]{1,3}|u[0-9a-fA-F]{4}|U[0-9a-fA-F]{8}|.)')
+SYMBOL_DEF_RE = re.compile(r'#define\s+(LV_SYMBOL_\w+)\s+"([^"]*)"')
+SIMPLE_ESCAPES = {'n': 10, 't': 9, 'r': 13, '0': 0, '\\': 92, '"': 34, "'": 39, 'a': 7, 'b': 8, 'f': 12, 'v': 11}
+
+
+def c_string_bytes(body):
+    """Decode the body of a C string literal into raw bytes."""
+    out = bytearray()
+    pos = 0
+    for m in ESCAPE_RE.finditer(body):
+        out += body[pos:m.start()].encode('utf-8')
+        esc = m.group(1)
+        if esc[0] == 'x':
+            out.append(int(esc[1:], 16))
+        elif esc[0] in '01234567' and len(esc) > 1 or esc[0] in '1234567':
+            out.append(int(esc, 8) & 0xFF)
+        elif esc[0] in 'uU':
+            out += chr(int(esc[1:], 16)).encode('utf-8')
+        else:
+            out.append(SIMPLE_ESCAPES.get(esc, ord(esc)))
+        pos = m.end()
+    out += body[pos:].encode('utf-8')
+    return bytes(out)
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', ' ', text, flags=re.S)
+    return re.sub(r'//[^\n]*', ' ', text)
+
+
+def load_symbols(path):
+    symbols = {}
+    if path:
+        with open(path, encoding='utf-8') as f:
+            for name, body in SYMBOL_DEF_RE.findall(f.read()):
+                symbols[name] = c_string_bytes(body).decode('utf-8', 'replace')
+    return symbols
+
+
+def scan_sources(paths, symbols):
+    """Code points of all string literals and LV_SYMBOL_* uses in `paths`."""
+    cps = set()
+    for path in paths:
+        with open(path, encoding='utf-8', errors='replace') as f:
+            text = strip_comments(f.read())
+        for body in STRING_RE.findall(text):
+            # Adjacent literals like "\xEF" "\x96" still decode, bytes are joined per literal
+            cps.update(ord(c) for c in c_string_bytes(body).decode('utf-8', 'ignore'))
+        for name, chars in symbols.items():
+            if re.search(r'\b' + name + r'\b', text):
+                cps.update(ord(c) for c in chars)
+    return {cp for cp in cps if cp >= 0x20}
+
+
+# ---------------------------------------------------------------------------
+# LVGL font parsing
+# ---------------------------------------------------------------------------
+
+def _array(text, name):
+    m = re.search(r'\b' + name + r'\[\]\s*=\s*\{(.*?)\};', text, re.S)
+    if not m:
+        return None
+    body = re.sub(r'/\*.*?\*/', ' ', m.group(1), flags=re.S)
+    return [int(v, 0) for v in re.findall(r'-?0x[0-9a-fA-F]+|-?\d+', body)]
+
+
+def _field(text, name, default=None):
+    m = re.search(r'\.' + name + r'\s*=\s*(-?\w+)', text)
+    if not m:
+        return default
+    value = m.group(1)
+    try:
+        return int(value, 0)
+    except ValueError:
+        return value
+
+
+class Font:
+    def __init__(self, path):
+        with open(path, encoding='utf-8') as f:
+            text = f.read()
+        self.path = path
+        self.bitmap = bytes(_array(text, 'glyph_bitmap'))
+        self.glyphs = []
+        for m in re.finditer(r'\{\.bitmap_index = (\d+), \.adv_w = (\d+), \.box_w = (\d+), \.box_h = (\d+), '
+                             r'\.ofs_x = (-?\d+), \.ofs_y = (-?\d+)\}', text):
+            self.glyphs.append(tuple(int(v) for v in m.groups()))
+
+        dsc = text[text.index('lv_font_fmt_txt_dsc_t font_dsc'):]
+        self.bpp = _field(dsc, 'bpp')
+        self.kern_scale = _field(dsc, 'kern_scale', 16)
+        if _field(dsc, 'bitmap_format', 0) != 0:
+            sys.exit(f'{path}: compressed bitmaps are not supported')
+
+        pub = text[text.index('const lv_font_t'):]
+        self.line_height = _field(pub, 'line_height')
+        self.base_line = _field(pub, 'base_line')
+        self.underline_position = _field(pub, 'underline_position', 0)
+        self.underline_thickness = _field(pub, 'underline_thickness', 0)
+
+        self.cmap = {}
+        cmaps = text[text.index('lv_font_fmt_txt_cmap_t cmaps[]'):]
+        cmaps = cmaps[:cmaps.index('};')]
+        for entry in re.findall(r'\{(.*?)\}', cmaps, re.S):
+            start = _field(entry, 'range_start')
+            length = _field(entry, 'range_length')
+            gid = _field(entry, 'glyph_id_start')
+            kind = _field(entry, 'type')
+            if kind == 'LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY':
+                for i in range(length):
+                    self.cmap[start + i] = gid + i
+            elif kind == 'LV_FONT_FMT_TXT_CMAP_SPARSE_TINY':
+                for i, ofs in enumerate(_array(text, _field(entry, 'unicode_list'))):
+                    self.cmap[start + ofs] = gid + i
+            else:
+                sys.exit(f'{path}: cmap type {kind} is not supported')
+
+        self.kern = None
+        if 'lv_font_fmt_txt_kern_classes_t kern_classes' in text:
+            self.kern = {
+                'left': _array(text, 'kern_left_class_mapping'),
+                'right': _array(text, 'kern_right_class_mapping'),
+                'values': _array(text, 'kern_class_values'),
+                'left_cnt': _field(text, 'left_class_cnt'),
+                'right_cnt': _field(text, 'right_class_cnt'),
+            }
+        elif 'kern_pairs' in text:
+            print(f'{path}: pair kerning is not supported, dropped', file=sys.stderr)
+
+    def glyph_bitmap(self, gid):
+        index, _, box_w, box_h, _, _ = self.glyphs[gid]
+        return self.bitmap[index:index + (box_w * box_h * self.bpp + 7) // 8]
+
+
+# ---------------------------------------------------------------------------
+# Subsetting and output
+# ---------------------------------------------------------------------------
+
+def plan_cmaps(cps, min_run=3):
+    """Contiguous runs become O(1) format0 maps, the rest goes into one sparse map."""
+    runs, sparse = [], []
+    i = 0
+    while i < len(cps):
+        j = i
+        while j + 1 < len(cps) and cps[j + 1] == cps[j] + 1:
+            j += 1
+        if j - i + 1 >= min_run:
+            runs.append(cps[i:j + 1])
+        else:
+            sparse += cps[i:j + 1]
+        i = j + 1
+    return runs, sparse
+
+
+def _c_list(values, per_line, fmt=str, indent='    '):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ', '.join(fmt(v) for v in values[i:i + per_line]))
+    return ',\n'.join(lines)
+
+
+def write_subset(font, name, wanted, out_path, source_label):
+    cps = sorted(cp for cp in wanted if cp in font.cmap)
+    runs, sparse = plan_cmaps(cps)
+    # LVGL 8 accepts `rcp == range_length` in format0 maps, so the code point right after a run
+    # resolves to the next glyph id. Each run is followed by an empty glyph to absorb that lookup.
+    order = []
+    for run in runs:
+        order += run + [None]
+    order += sparse
+    old_ids = [font.cmap[cp] if cp is not None else None for cp in order]
+
+    bitmap = bytearray()
+    glyph_dsc = [(0, 0, 0, 0, 0, 0)]
+    for gid in old_ids:
+        if gid is None:
+            glyph_dsc.append((0, 0, 0, 0, 0, 0))
+            continue
+        _, adv_w, box_w, box_h, ofs_x, ofs_y = font.glyphs[gid]
+        glyph_dsc.append((len(bitmap), adv_w, box_w, box_h, ofs_x, ofs_y))
+        bitmap += font.glyph_bitmap(gid)
+    if not bitmap:
+        bitmap = bytearray(1)
+
+    guard = name.upper()
+    o = []
+    o.append('/*******************************************************************************')
+    o.append(f' * Size: {font.line_height} px line height')
+    o.append(f' * Bpp: {font.bpp}')
+    o.append(f' * Subset of {source_label} generated by tools/font_subset.py, do not edit')
+    o.append(' ******************************************************************************/')
+    o.append('')
+    o.append('#ifdef LV_LVGL_H_INCLUDE_SIMPLE')
+    o.append('#include "lvgl.h"')
+    o.append('#else')
+    o.append('#include "lvgl/lvgl.h"')
+    o.append('#endif')
+    o.append('')
+    o.append(f'#ifndef {guard}')
+    o.append(f'#define {guard} 1')
+    o.append('#endif')
+    o.append('')
+    o.append(f'#if {guard}')
+    o.append('')
+    o.append('/*-----------------\n *    BITMAPS\n *----------------*/')
+    o.append('')
+    o.append('/*Store the image of the glyphs*/')
+    o.append('static LV_ATTRIBUTE_LARGE_CONST const uint8_t glyph_bitmap[] = {')
+    o.append(_c_list(list(bitmap), 8, lambda v: f'0x{v:x}'))
+    o.append('};')
+    o.append('')
+    o.append('/*---------------------\n *  GLYPH DESCRIPTION\n *--------------------*/')
+    o.append('')
+    o.append('static const lv_font_fmt_txt_glyph_dsc_t glyph_dsc[] = {')
+    rows = []
+    for i, (index, adv_w, box_w, box_h, ofs_x, ofs_y) in enumerate(glyph_dsc):
+        row = (f'    {{.bitmap_index = {index}, .adv_w = {adv_w}, .box_w = {box_w}, .box_h = {box_h}, '
+               f'.ofs_x = {ofs_x}, .ofs_y = {ofs_y}}}')
+        if i == 0:
+            row += ' /* id = 0 reserved */'
+        elif order[i - 1] is None:
+            row += ' /* end of range */'
+        else:
+            row += f' /* U+{order[i - 1]:04X} */'
+        rows.append(row)
+    o.append(',\n'.join(rows))
+    o.append('};')
+    o.append('')
+    o.append('/*---------------------\n *  CHARACTER MAPPING\n *--------------------*/')
+    o.append('')
+
+    cmap_entries = []
+    gid = 1
+    for run in runs:
+        cmap_entries.append(
+            f'        .range_start = {run[0]}, .range_length = {len(run)}, .glyph_id_start = {gid},\n'
+            f'        .unicode_list = NULL, .glyph_id_ofs_list = NULL, .list_length = 0, '
+            f'.type = LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY')
+        gid += len(run) + 1
+    if sparse:
+        o.append('static const uint16_t unicode_list_0[] = {')
+        o.append(_c_list([cp - sparse[0] for cp in sparse], 8, lambda v: f'0x{v:x}'))
+        o.append('};')
+        o.append('')
+        cmap_entries.append(
+            f'        .range_start = {sparse[0]}, .range_length = {sparse[-1] - sparse[0] + 1}, '
+            f'.glyph_id_start = {gid},\n'
+            f'        .unicode_list = unicode_list_0, .glyph_id_ofs_list = NULL, .list_length = {len(sparse)}, '
+            f'.type = LV_FONT_FMT_TXT_CMAP_SPARSE_TINY')
+    o.append('/*Collect the unicode lists and glyph_id offsets*/')
+    o.append('static const lv_font_fmt_txt_cmap_t cmaps[] = {')
+    o.append(',\n'.join('    {\n' + e + '\n    }' for e in cmap_entries))
+    o.append('};')
+    o.append('')
+
+    kern_used = False
+    if font.kern:
+        k = font.kern
+        left = [k['left'][g] if g is not None else 0 for g in old_ids]
+        right = [k['right'][g] if g is not None else 0 for g in old_ids]
+        # Renumber the classes still in use, 0 stays "no kerning"
+        lmap = {c: i + 1 for i, c in enumerate(sorted({c for c in left if c}))}
+        rmap = {c: i + 1 for i, c in enumerate(sorted({c for c in right if c}))}
+        if lmap and rmap:
+            kern_used = True
+            values = []
+            for lc in sorted(lmap):
+                for rc in sorted(rmap):
+                    values.append(k['values'][(lc - 1) * k['right_cnt'] + (rc - 1)])
+            o.append('/*-----------------\n *    KERNING\n *----------------*/')
+            o.append('')
+            o.append('/*Map glyph_ids to kern left classes*/')
+            o.append('static const uint8_t kern_left_class_mapping[] = {')
+            o.append(_c_list([0] + [lmap.get(c, 0) for c in left], 8))
+            o.append('};')
+            o.append('')
+            o.append('/*Map glyph_ids to kern right classes*/')
+            o.append('static const uint8_t kern_right_class_mapping[] = {')
+            o.append(_c_list([0] + [rmap.get(c, 0) for c in right], 8))
+            o.append('};')
+            o.append('')
+            o.append('/*Kern values between classes*/')
+            o.append('static const int8_t kern_class_values[] = {')
+            o.append(_c_list(values, 8))
+            o.append('};')
+            o.append('')
+            o.append('/*Collect the kern class\' data in one place*/')
+            o.append('static const lv_font_fmt_txt_kern_classes_t kern_classes = {')
+            o.append('    .class_pair_values   = kern_class_values,')
+            o.append('    .left_class_mapping  = kern_left_class_mapping,')
+            o.append('    .right_class_mapping = kern_right_class_mapping,')
+            o.append(f'    .left_class_cnt      = {len(lmap)},')
+            o.append(f'    .right_class_cnt     = {len(rmap)},')
+            o.append('};')
+            o.append('')
+
+    o.append('/*--------------------\n *  ALL CUSTOM DATA\n *--------------------*/')
+    o.append('')
+    o.append('/*Store all the custom data of the font*/')
+    o.append('static lv_font_fmt_txt_glyph_cache_t cache;')
+    o.append('static const lv_font_fmt_txt_dsc_t font_dsc = {')
+    o.append('    .glyph_bitmap = glyph_bitmap,')
+    o.append('    .glyph_dsc = glyph_dsc,')
+    o.append('    .cmaps = cmaps,')
+    o.append(f'    .kern_dsc = {"&kern_classes" if kern_used else "NULL"},')
+    o.append(f'    .kern_scale = {font.kern_scale},')
+    o.append(f'    .cmap_num = {len(cmap_entries)},')
+    o.append(f'    .bpp = {font.bpp},')
+    o.append(f'    .kern_classes = {1 if kern_used else 0},')
+    o.append('    .bitmap_format = 0,')
+    o.append('    .cache = &cache')
+    o.append('};')
+    o.append('')
+    o.append('/*-----------------\n *  PUBLIC FONT\n *----------------*/')
+    o.append('')
+    o.append('/*Initialize a public general font descriptor*/')
+    o.append(f'const lv_font_t {name} = {{')
+    o.append('    .get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt,    /*Function pointer to get glyph\'s data*/')
+    o.append('    .get_glyph_bitmap = lv_font_get_bitmap_fmt_txt,    /*Function pointer to get glyph\'s bitmap*/')
+    o.append(f'    .line_height = {font.line_height},          /*The maximum line height required by the font*/')
+    o.append(f'    .base_line = {font.base_line},             /*Baseline measured from the bottom of the line*/')
+    o.append('    .subpx = LV_FONT_SUBPX_NONE,')
+    o.append(f'    .underline_position = {font.underline_position},')
+    o.append(f'    .underline_thickness = {font.underline_thickness},')
+    o.append('    .dsc = &font_dsc           /*The custom font data. Will be accessed by `get_glyph_bitmap/dsc` */')
+    o.append('};')
+    o.append('')
+    o.append(f'#endif /*#if {guard}*/')
+    o.append('')
+
+    with open(out_path, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(o))
+
+    missing = sorted(cp for cp in wanted if cp not in font.cmap)
+    return len(cps), len(bitmap), missing
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--scan', nargs='+', required=True, help='sources whose string literals are shown')
+    parser.add_argument('--symbols', help='lv_symbol_def.h, to resolve LV_SYMBOL_* uses')
+    parser.add_argument('--always', default='', help='characters to keep regardless of the scan')
+    parser.add_argument('--font', action='append', required=True, metavar='SRC.c:NAME',
+                        help='source font and the name of the subset font')
+    parser.add_argument('--out-dir', required=True)
+    args = parser.parse_args()
+
+    wanted = scan_sources(args.scan, load_symbols(args.symbols))
+    wanted.update(ord(c) for c in args.always)
+    os.makedirs(args.out_dir, exist_ok=True)
+
+    total_before = total_after = 0
+    print(f'font_subset: {len(wanted)} code points used by {len(args.scan)} sources')
+    print(f'  {"font":<28}{"glyphs":>16}{"bitmap bytes":>24}')
+    for spec in args.font:
+        src, name = spec.rsplit(':', 1)
+        font = Font(src)
+        glyphs, size, missing = write_subset(font, name, wanted, os.path.join(args.out_dir, name + '.c'),
+                                             os.path.basename(src))
+        before = len(font.bitmap)
+        total_before += before
+        total_after += size
+        print(f'  {name:<28}{len(font.glyphs) - 1:>7} -> {glyphs:<6}{before:>12} -> {size:<10}')
+        if missing:
+            print(f'    not in source font: {" ".join(f"U+{cp:04X}" for cp in missing[:16])}')
+    print(f'  {"total":<28}{"":>16}{total_before:>12} -> {total_after:<10}')
+
+
+if __name__ == '__main__':
+    main()
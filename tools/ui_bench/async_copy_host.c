@@ -0,0 +1,95 @@
+/* async_copy_host.c */
+// Stand-in for main/async_copy.c with the same API. A copy is only made when it (or a later one)
+// is waited for, or when the queue is full, so whatever reads a destination or changes a source
+// before waiting for its copy gets different pixels than the firmware would.
+#include <stdlib.h>
+#include <string.h>
+#include "async_copy.h"
+
+// Same as the PSRAM cache lines on the device, so the CPU does the edges of rows here as well
+#define ASYNC_COPY_HOST_ALIGN   ASYNC_COPY_ALIGN_MAX
+
+typedef struct {
+    void *dst;
+    const void *src;
+    size_t n;
+} async_copy_job_t;
+
+struct async_copy_s {
+    size_t backlog;
+    uint32_t started;
+    uint32_t done;
+    async_copy_job_t *jobs;         // copy `seq` at [seq % backlog]
+};
+
+static inline bool seq_done(uint32_t done, uint32_t seq) {
+    return (int32_t)(done - seq) >= 0;
+}
+
+// The "DMA": copies in order up to `seq`
+static void async_copy_run(async_copy_t *ac, uint32_t seq) {
+    while (!seq_done(ac->done, seq)) {
+        const async_copy_job_t *job = &ac->jobs[(ac->done + 1) % ac->backlog];
+        memcpy(job->dst, job->src, job->n);
+        ac->done++;
+    }
+}
+
+esp_err_t async_copy_new(size_t backlog, async_copy_t **ret) {
+    if (backlog == 0 || ret == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    async_copy_t *ac = calloc(1, sizeof(async_copy_t));
+    if (ac != NULL) {
+        ac->jobs = calloc(backlog, sizeof(async_copy_job_t));
+    }
+    if (ac == NULL || ac->jobs == NULL) {
+        free(ac);
+        return ESP_ERR_NO_MEM;
+    }
+    ac->backlog = backlog;
+    *ret = ac;
+    return ESP_OK;
+}
+
+void async_copy_del(async_copy_t *ac) {
+    if (ac != NULL) {
+        async_copy_run(ac, ac->started);
+        free(ac->jobs);
+        free(ac);
+    }
+}
+
+size_t async_copy_align(const void *ptr) {
+    return ASYNC_COPY_HOST_ALIGN;
+}
+
+bool async_copy_can(const void *dst, const void *src, size_t n) {
+    return n > 0 && (uintptr_t)dst % ASYNC_COPY_HOST_ALIGN == 0 && (uintptr_t)src % ASYNC_COPY_HOST_ALIGN == 0 &&
+           n % ASYNC_COPY_HOST_ALIGN == 0;
+}
+
+esp_err_t async_copy_start(async_copy_t *ac, void *dst, const void *src, size_t n, uint32_t *seq) {
+    if (!async_copy_can(dst, src, n)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ac->started - ac->done >= ac->backlog) {
+        async_copy_run(ac, ac->started - ac->backlog + 1);
+    }
+    ac->started++;
+    ac->jobs[ac->started % ac->backlog] = (async_copy_job_t) { .dst = dst, .src = src, .n = n };
+    *seq = ac->started;
+    return ESP_OK;
+}
+
+bool async_copy_is_done(async_copy_t *ac, uint32_t seq) {
+    return seq_done(ac->done, seq);
+}
+
+void async_copy_wait(async_copy_t *ac, uint32_t seq) {
+    async_copy_run(ac, seq);
+}
+
+uint32_t async_copy_last(const async_copy_t *ac) {
+    return ac->started;
+}
@@ -0,0 +1,219 @@
+/* bench_host.c */
+// Host side of the UI benchmarks: what the firmware gets from the LVGL port, the clock and
+// heap_caps, plus a display that renders into a framebuffer in memory.
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include "bench_host.h"
+#include "lv_port.h"
+#include "lv_port_profile.h"
+#include "lv_port_draw_async.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+#define BENCH_HEAP_SIZE (320 * 1024)    // reported as free by heap_caps_get_free_size()
+
+bench_heap_t bench_heap;
+bench_frames_t bench_frames;
+
+static bool heap_on;
+static bool clock_simulated;
+static uint64_t start_ns;
+static int64_t skipped_us;
+static int64_t first_frame_us;
+static uint64_t frame_start_ns;
+static uint32_t frame_px;
+static uint32_t frame_areas;
+static uint32_t frames_cap;
+static lv_color_t *framebuffer;
+
+/* ---- Heap ---- */
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static void heap_add(void *ptr) {
+    if (ptr != NULL && heap_on) {
+        size_t n = malloc_usable_size(ptr);
+        bench_heap.live += n;
+        bench_heap.alloc_bytes += n;
+        bench_heap.allocs++;
+        if (bench_heap.live > bench_heap.peak) {
+            bench_heap.peak = bench_heap.live;
+        }
+    }
+}
+
+static void heap_remove(void *ptr) {
+    if (ptr != NULL && heap_on) {
+        size_t n = malloc_usable_size(ptr);
+        bench_heap.live = n < bench_heap.live ? bench_heap.live - n : 0;
+    }
+}
+
+void *__wrap_malloc(size_t size) {
+    void *p = __real_malloc(size);
+    heap_add(p);
+    return p;
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    void *p = __real_calloc(n, size);
+    heap_add(p);
+    return p;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    heap_remove(ptr);
+    void *p = __real_realloc(ptr, size);
+    heap_add(p != NULL ? p : ptr);
+    return p;
+}
+
+void __wrap_free(void *ptr) {
+    heap_remove(ptr);
+    __real_free(ptr);
+}
+
+// The host has one heap; PSRAM and internal RAM requests come from it alike
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+    return malloc(size);
+}
+
+void heap_caps_free(void *ptr) {
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    return bench_heap.live < BENCH_HEAP_SIZE ? BENCH_HEAP_SIZE - bench_heap.live : 0;
+}
+
+/* ---- Clock ---- */
+
+uint64_t bench_real_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int64_t esp_timer_get_time(void) {
+    if (clock_simulated) {
+        return skipped_us;
+    }
+    return (int64_t)((bench_real_ns() - start_ns) / 1000) + skipped_us;
+}
+
+void bench_sleep(uint32_t ms) {
+    skipped_us += (int64_t)ms * 1000;
+}
+
+/* ---- LVGL port ---- */
+
+bool lvgl_port_lock(uint32_t timeout_ms) {
+    return true;
+}
+
+void lvgl_port_unlock(void) {
+}
+
+int64_t lvgl_port_get_first_frame_us(lv_disp_t *disp) {
+    return first_frame_us;
+}
+
+/* ---- Display ---- */
+
+static void bench_render_start(lv_disp_drv_t *drv) {
+    // The areas LVGL is about to render (in direct mode every flush covers the whole buffer)
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    frame_px = 0;
+    frame_areas = 0;
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (!disp->inv_area_joined[i]) {
+            frame_px += lv_area_get_size(&disp->inv_areas[i]);
+            frame_areas++;
+        }
+    }
+#if LVGL_PORT_PROFILE
+    lvgl_port_profile_frame_begin(drv);
+#endif
+    frame_start_ns = bench_real_ns();
+}
+
+static void bench_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map) {
+#if LVGL_PORT_DRAW_ASYNC
+    lvgl_port_draw_async_finish(drv->draw_ctx);
+#endif
+    if (lv_disp_flush_is_last(drv)) {
+        uint32_t us = (uint32_t)((bench_real_ns() - frame_start_ns) / 1000);
+#if LVGL_PORT_PROFILE
+        lvgl_port_profile_frame_end(drv, color_map, us);
+#endif
+        bench_frames_t *f = &bench_frames;
+        if (f->frames == frames_cap) {
+            frames_cap = frames_cap ? frames_cap * 2 : 1024;
+            f->render_us = __real_realloc(f->render_us, frames_cap * sizeof(uint32_t));
+        }
+        f->render_us[f->frames++] = us;
+        f->us += us;
+        f->px += frame_px;
+        f->areas += frame_areas;
+        if (frame_px > f->px_max) {
+            f->px_max = frame_px;
+        }
+        if (first_frame_us == 0) {
+            first_frame_us = esp_timer_get_time();
+        }
+    }
+    lv_disp_flush_ready(drv);
+}
+
+lv_disp_t *bench_init(bool simulated, bool partial) {
+    static lv_disp_draw_buf_t draw_buf;
+    static lv_disp_drv_t drv;
+
+    clock_simulated = simulated;
+    start_ns = bench_real_ns();
+    heap_on = true;
+    lv_init();
+
+    // One buffer the size of the screen, rendered in place, so it always holds the whole
+    // screen like the panel's memory; aligned to cache lines like the port's
+    framebuffer = aligned_alloc(ASYNC_COPY_ALIGN_MAX, BENCH_HRES * BENCH_VRES * sizeof(lv_color_t));
+    memset(framebuffer, 0, BENCH_HRES * BENCH_VRES * sizeof(lv_color_t));
+    lv_disp_draw_buf_init(&draw_buf, framebuffer, NULL, BENCH_HRES * BENCH_VRES);
+    lv_disp_drv_init(&drv);
+    drv.hor_res = BENCH_HRES;
+    drv.ver_res = BENCH_VRES;
+    drv.draw_buf = &draw_buf;
+    drv.flush_cb = bench_flush;
+    drv.render_start_cb = bench_render_start;
+    drv.full_refresh = !partial;
+    drv.direct_mode = partial;
+#if LVGL_PORT_DRAW_ASYNC
+    // The port's draw context, large fills and copies go to the stand-in of async_copy_host.c
+    drv.draw_ctx_init = lvgl_port_draw_async_init_ctx;
+    drv.draw_ctx_deinit = lvgl_port_draw_async_deinit_ctx;
+    drv.draw_ctx_size = sizeof(lvgl_port_draw_async_ctx_t);
+#endif
+    lv_disp_t *disp = lv_disp_drv_register(&drv);
+
+#if LVGL_PORT_PROFILE
+    lvgl_port_profile_attach(disp);
+    lvgl_port_profile_enable(true, false);
+#endif
+    return disp;
+}
+
+const lv_color_t *bench_framebuffer(void) {
+    return framebuffer;
+}
+
+// ui.c keeps its widgets to itself; the tab view is the first child of the screen
+void bench_show_tab(int tab) {
+    lv_obj_t *tabview = lv_obj_get_child(lv_scr_act(), 0);
+    lv_tabview_set_act(tabview, tab, LV_ANIM_OFF);
+    lv_event_send(tabview, LV_EVENT_VALUE_CHANGED, NULL);
+}
@@ -0,0 +1,67 @@
+/* bench_host.h */
+#ifndef BENCH_HOST_H
+#define BENCH_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <lvgl.h>
+
+#define BENCH_HRES 480
+#define BENCH_VRES 320
+
+/**
+ * Heap use of LVGL and the UI, tracked by wrapping malloc and friends (-Wl,--wrap).
+ */
+typedef struct {
+    size_t live;            // bytes allocated now
+    size_t peak;            // highest `live`, reset it to start a new peak
+    uint32_t allocs;        // allocations so far
+    uint64_t alloc_bytes;   // bytes of those allocations
+} bench_heap_t;
+
+/**
+ * What the display rendered so far. Per-frame render times are in `render_us`.
+ */
+typedef struct {
+    uint32_t frames;
+    uint64_t px;            // rendered pixels
+    uint64_t areas;         // flushed areas
+    uint32_t px_max;        // most pixels in one frame, reset it to start a new maximum
+    uint64_t us;            // summed render time
+    uint32_t *render_us;    // render time of each frame, from render start to the last flush
+} bench_frames_t;
+
+extern bench_heap_t bench_heap;
+extern bench_frames_t bench_frames;
+
+/**
+ * Start the clock and heap tracking, initialise LVGL and register the display.
+ * @param simulated Time only moves by bench_sleep(), so rendering is repeatable; otherwise the
+ *                  clock runs in real time plus the time skipped by bench_sleep()
+ * @param partial   Render only invalidated areas instead of full frames like the port
+ */
+lv_disp_t *bench_init(bool simulated, bool partial);
+
+/**
+ * Advance the clock as if the LVGL task slept for `ms`.
+ */
+void bench_sleep(uint32_t ms);
+
+/**
+ * Real time in nanoseconds, for timing the run itself.
+ */
+uint64_t bench_real_ns(void);
+
+/**
+ * The screen as the panel would show it, BENCH_HRES x BENCH_VRES lv_color_t
+ * (RGB565, byte-swapped like /screenshot).
+ */
+const lv_color_t *bench_framebuffer(void);
+
+/**
+ * Show a tab of the UI, as a tap on its button does.
+ */
+void bench_show_tab(int tab);
+
+#endif /* BENCH_HOST_H */
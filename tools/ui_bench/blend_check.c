@@ -0,0 +1,199 @@
+/* blend_check.c */
+// Checks the RGB565 blend kernels (LV_DRAW_SW_RGB565_SWAR, see lv_draw_sw_blend_rgb565.c) against
+// the generic loops of lv_draw_sw_blend.c, built a second time without them as blend_ref_basic().
+// Random areas, strides, colors, opacities, masks and backgrounds are blended by both; any pixel
+// that differs fails the run. Then both are timed on the cases of main/blend_bench.c.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <lvgl.h>
+#include "bench_host.h"
+#include "blend_bench.h"
+
+#define CHECK_MAX_W     72
+#define CHECK_MAX_H     12
+#define CHECK_BUF_PX    (CHECK_MAX_W * CHECK_MAX_H)
+#define BENCH_ROUNDS    50
+
+// lv_draw_sw_blend.c with LV_DRAW_SW_RGB565_SWAR 0 (CMakeLists.txt)
+void blend_ref_basic(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc);
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rnd(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % n;
+}
+
+static lv_coord_t rnd_range(lv_coord_t lo, lv_coord_t hi) {
+    return lo + (lv_coord_t)rnd((uint32_t)(hi - lo + 1));
+}
+
+// Backgrounds that exercise the last-color caches of the blender as well as random pixels
+static void fill_background(lv_color_t *buf, uint32_t n) {
+    uint32_t kind = rnd(4);
+    lv_color_t c = { .full = (uint16_t)rnd(0x10000) };
+    for (uint32_t i = 0; i < n; i++) {
+        switch (kind) {
+        case 0: buf[i].full = (uint16_t)rnd(0x10000); break;
+        case 1: buf[i] = c; break;
+        case 2: buf[i] = rnd(4) ? lv_color_black() : (lv_color_t){ .full = (uint16_t)rnd(0x10000) }; break;
+        default: buf[i].full = rnd(3) ? c.full : (uint16_t)rnd(0x10000); break;
+        }
+    }
+}
+
+static void fill_mask(lv_opa_t *mask, uint32_t n) {
+    uint32_t kind = rnd(4);
+    for (uint32_t i = 0; i < n; i++) {
+        switch (kind) {
+        case 0: mask[i] = (lv_opa_t)rnd(256); break;
+        case 1: mask[i] = rnd(2) ? LV_OPA_COVER : LV_OPA_TRANSP; break;
+        case 2: mask[i] = (lv_opa_t)(248 + rnd(8)); break;
+        default: {
+            // Runs like an anti-aliased edge
+            uint32_t r = rnd(8);
+            mask[i] = r < 3 ? LV_OPA_TRANSP : r < 6 ? LV_OPA_COVER : (lv_opa_t)rnd(256);
+            break;
+        }
+        }
+    }
+}
+
+static lv_opa_t random_opa(void) {
+    static const lv_opa_t opas[] = { 255, 254, 253, 252, 251, 250, 200, 128, 127, 100, 64, 31, 6 };
+    return rnd(2) ? opas[rnd(sizeof(opas))] : (lv_opa_t)(LV_OPA_MIN + 1 + rnd(255 - LV_OPA_MIN));
+}
+
+// One random blend by both; returns false and reports the case if they differ
+static bool check_one(uint32_t iter) {
+    static lv_color_t dest[CHECK_BUF_PX], ref[CHECK_BUF_PX], src[CHECK_BUF_PX];
+    static lv_opa_t mask[CHECK_BUF_PX], mask_ref[CHECK_BUF_PX];
+
+    lv_coord_t bw = rnd_range(1, CHECK_MAX_W), bh = rnd_range(1, CHECK_MAX_H);
+    lv_area_t buf_area;
+    lv_area_set(&buf_area, rnd_range(0, 30), rnd_range(0, 30), 0, 0);
+    lv_area_set_width(&buf_area, bw);
+    lv_area_set_height(&buf_area, bh);
+
+    // The blended area may stick out of the buffer, the clip area is within it
+    lv_area_t blend_area, clip_area;
+    blend_area.x1 = rnd_range(buf_area.x1 - 4, buf_area.x2);
+    blend_area.y1 = rnd_range(buf_area.y1 - 2, buf_area.y2);
+    blend_area.x2 = rnd_range(blend_area.x1, LV_MIN(blend_area.x1 + CHECK_MAX_W - 1, buf_area.x2 + 4));
+    blend_area.y2 = rnd_range(blend_area.y1, LV_MIN(blend_area.y1 + CHECK_MAX_H - 1, buf_area.y2 + 2));
+    clip_area = buf_area;
+    if (rnd(4) == 0) {
+        clip_area.x1 = rnd_range(buf_area.x1, buf_area.x2);
+        clip_area.x2 = rnd_range(clip_area.x1, buf_area.x2);
+    }
+
+    uint32_t n = (uint32_t)(bw * bh);
+    uint32_t blend_px = lv_area_get_size(&blend_area);
+    fill_background(dest, n);
+    memcpy(ref, dest, n * sizeof(lv_color_t));
+
+    lv_draw_sw_blend_dsc_t dsc = {
+        .blend_area = &blend_area,
+        .color = { .full = (uint16_t)rnd(0x10000) },
+        .mask_res = LV_DRAW_MASK_RES_FULL_COVER,
+        .mask_area = &blend_area,
+        .opa = random_opa(),
+        .blend_mode = LV_BLEND_MODE_NORMAL,
+    };
+    if (rnd(4) == 0) {
+        fill_background(src, blend_px);
+        dsc.src_buf = src;
+    }
+    if (rnd(3) != 0) {
+        fill_mask(mask, blend_px);
+        dsc.mask_buf = mask;
+        dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+    }
+    memcpy(mask_ref, mask, blend_px);
+
+    lv_draw_ctx_t draw_ctx = { .buf = dest, .buf_area = &buf_area, .clip_area = &clip_area };
+    lv_draw_sw_blend_basic(&draw_ctx, &dsc);
+
+    draw_ctx.buf = ref;
+    if (dsc.mask_buf != NULL) {
+        dsc.mask_buf = mask_ref;
+    }
+    blend_ref_basic(&draw_ctx, &dsc);
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (dest[i].full != ref[i].full) {
+            printf("FAIL #%" PRIu32 ": buf (%d,%d) %dx%d, blend (%d,%d)-(%d,%d), color %04x opa %u, %s%s: "
+                   "px %" PRIu32 " is %04x, expected %04x\n", iter, buf_area.x1, buf_area.y1, bw, bh,
+                   blend_area.x1, blend_area.y1, blend_area.x2, blend_area.y2, dsc.color.full, dsc.opa,
+                   dsc.src_buf ? "copy" : "fill", dsc.mask_buf ? " with mask" : "", i, dest[i].full, ref[i].full);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Best of BENCH_ROUNDS runs of each, a single run is over in well under a millisecond on the host
+static void bench_best(blend_bench_fn_t blend, lv_color_t *dest, blend_bench_result_t *best) {
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        blend_bench_result_t res[BLEND_BENCH_CASES];
+        if (blend_bench_run(blend, dest, res) != ESP_OK) {
+            fprintf(stderr, "no memory for the benchmark\n");
+            exit(2);
+        }
+        for (int c = 0; c < BLEND_BENCH_CASES; c++) {
+            if (r == 0 || res[c].us < best[c].us) {
+                best[c] = res[c];
+            }
+        }
+    }
+}
+
+static void bench(void) {
+    lv_color_t *dest = malloc(BLEND_BENCH_W * BLEND_BENCH_H * sizeof(lv_color_t));
+    blend_bench_result_t kernels[BLEND_BENCH_CASES], generic[BLEND_BENCH_CASES];
+    bench_best(lv_draw_sw_blend_basic, dest, kernels);
+    bench_best(blend_ref_basic, dest, generic);
+    free(dest);
+
+    printf("%-14s %12s %12s\n", "Mpx/s (host)", "generic", "kernels");
+    for (int c = 0; c < BLEND_BENCH_CASES; c++) {
+        double g = generic[c].us > 0 ? (double)generic[c].px / (double)generic[c].us : 0.0;
+        double k = kernels[c].us > 0 ? (double)kernels[c].px / (double)kernels[c].us : 0.0;
+        printf("%-14s %12.1f %12.1f  x%.2f\n", kernels[c].name, g, k, g > 0 ? k / g : 0.0);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 200000;
+    bool run_bench = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--no-bench") == 0) {
+            run_bench = false;
+        } else {
+            fprintf(stderr, "usage: %s [--iterations N] [--no-bench]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bench_init(false, false);
+    // The blender reads the driver settings of the display being refreshed
+    _lv_refr_set_disp_refreshing(lv_disp_get_default());
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (!check_one(i)) {
+            return 1;
+        }
+    }
+    printf("blend_check: %" PRIu32 " random blends identical\n", iterations);
+
+    if (run_bench) {
+        bench();
+    }
+    return 0;
+}
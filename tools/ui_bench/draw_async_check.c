@@ -0,0 +1,196 @@
+/* draw_async_check.c */
+// Checks the scheduling of main/lv_port_draw_async.c: random sequences of fills, blends and copies
+// between a frame and a layer-sized buffer go through its draw context and, as the reference,
+// straight through the software blender. The copy engine is the stand-in of async_copy_host.c,
+// which copies only when waited for, so a blend that reads or overwrites pixels of a queued copy
+// without waiting leaves different pixels. Both frames are compared whenever the context is
+// finished, as the port does before each flush.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <lvgl.h>
+#include "bench_host.h"
+#include "lv_port_draw_async.h"
+
+#define CHECK_W         BENCH_HRES
+#define CHECK_H         BENCH_VRES
+#define CHECK_LAYER_H   64
+#define CHECK_OPS       64
+
+typedef struct {
+    lv_color_t *frame;      // CHECK_W x CHECK_H
+    lv_color_t *layer;      // CHECK_W x CHECK_LAYER_H, source and target of copies
+} check_bufs_t;
+
+static uint32_t rng_state = 0x2468ace1;
+
+static uint32_t rnd(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % n;
+}
+
+static lv_coord_t rnd_range(lv_coord_t lo, lv_coord_t hi) {
+    return lo + (lv_coord_t)rnd((uint32_t)(hi - lo + 1));
+}
+
+static lv_color_t *alloc_buf(uint32_t px) {
+    lv_color_t *buf = aligned_alloc(ASYNC_COPY_ALIGN_MAX, px * sizeof(lv_color_t));
+    if (buf == NULL) {
+        fprintf(stderr, "no memory\n");
+        exit(2);
+    }
+    for (uint32_t i = 0; i < px; i++) {
+        buf[i].full = (uint16_t)rnd(0x10000);
+    }
+    return buf;
+}
+
+// An area of the target, mostly large enough for the engine: whole rows, wide or narrow rects
+static void random_area(lv_area_t *a, lv_coord_t h) {
+    switch (rnd(4)) {
+    case 0:
+        lv_area_set(a, 0, rnd_range(0, h - 1), CHECK_W - 1, 0);
+        a->y2 = rnd_range(a->y1, h - 1);
+        break;
+    case 1:
+        lv_area_set(a, rnd_range(0, 40), rnd_range(0, h / 2), 0, 0);
+        a->x2 = rnd_range(a->x1 + 260, CHECK_W - 1);
+        a->y2 = rnd_range(a->y1, h - 1);
+        break;
+    default:
+        lv_area_set(a, rnd_range(0, CHECK_W - 1), rnd_range(0, h - 1), 0, 0);
+        a->x2 = rnd_range(a->x1, LV_MIN(a->x1 + 80, CHECK_W - 1));
+        a->y2 = rnd_range(a->y1, LV_MIN(a->y1 + 30, h - 1));
+        break;
+    }
+}
+
+// One random operation on both sets of buffers
+static void random_op(lv_draw_ctx_t *async_ctx, check_bufs_t *a, lv_draw_ctx_t *ref_ctx, check_bufs_t *r) {
+    static lv_opa_t mask[CHECK_W * CHECK_H];
+    static lv_area_t frame_area = { 0, 0, CHECK_W - 1, CHECK_H - 1 };
+    static lv_area_t layer_area = { 0, 0, CHECK_W - 1, CHECK_LAYER_H - 1 };
+
+    // Into the frame mostly, sometimes into the layer
+    bool to_layer = rnd(5) == 0;
+    lv_area_t *buf_area = to_layer ? &layer_area : &frame_area;
+    lv_coord_t h = lv_area_get_height(buf_area);
+
+    lv_area_t blend_area, clip_area = *buf_area;
+    random_area(&blend_area, h);
+    lv_draw_sw_blend_dsc_t dsc = {
+        .blend_area = &blend_area,
+        .color = { .full = (uint16_t)rnd(0x10000) },
+        .mask_res = LV_DRAW_MASK_RES_FULL_COVER,
+        .mask_area = &blend_area,
+        .opa = rnd(4) ? LV_OPA_COVER : (lv_opa_t)rnd_range(LV_OPA_10, LV_OPA_90),
+        .blend_mode = LV_BLEND_MODE_NORMAL,
+    };
+
+    // Copies: the layer into the frame, or rows of the frame into the layer
+    uint32_t kind = rnd(6);
+    ptrdiff_t src_ofs = -1;
+    bool src_in_layer = false;
+    if (kind == 0 && !to_layer) {
+        lv_area_set(&blend_area, 0, rnd_range(-8, CHECK_H - CHECK_LAYER_H + 8), CHECK_W - 1, 0);
+        lv_area_set_height(&blend_area, CHECK_LAYER_H);
+        src_ofs = 0;
+        src_in_layer = true;
+    } else if (kind == 1 && to_layer) {
+        blend_area = layer_area;
+        src_ofs = (ptrdiff_t)CHECK_W * rnd_range(0, CHECK_H - CHECK_LAYER_H);
+    } else if (kind == 2) {
+        uint32_t n = lv_area_get_size(&blend_area);
+        for (uint32_t i = 0; i < n; i++) {
+            mask[i] = (lv_opa_t)(rnd(3) ? LV_OPA_COVER : rnd(256));
+        }
+        dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+    }
+    if (kind == 3) {
+        // Clipped like an object partly off its parent
+        clip_area.x1 = rnd_range(0, CHECK_W / 2);
+        clip_area.y1 = rnd_range(0, h / 2);
+    }
+
+    lv_draw_ctx_t *ctxs[2] = { async_ctx, ref_ctx };
+    check_bufs_t *bufs[2] = { a, r };
+    for (int i = 0; i < 2; i++) {
+        lv_draw_ctx_t *ctx = ctxs[i];
+        ctx->buf = to_layer ? bufs[i]->layer : bufs[i]->frame;
+        ctx->buf_area = buf_area;
+        ctx->clip_area = &clip_area;
+        if (src_ofs >= 0) {
+            dsc.src_buf = (src_in_layer ? bufs[i]->layer : bufs[i]->frame) + src_ofs;
+        }
+        // The software blender rounds the mask in place, give both the same one
+        static lv_opa_t mask_copy[CHECK_W * CHECK_H];
+        if (dsc.mask_res == LV_DRAW_MASK_RES_CHANGED) {
+            memcpy(mask_copy, mask, lv_area_get_size(&blend_area));
+            dsc.mask_buf = mask_copy;
+        }
+        lv_draw_sw_blend(ctx, &dsc);
+    }
+}
+
+static bool compare(const check_bufs_t *a, const check_bufs_t *r, uint32_t seq, uint32_t op) {
+    if (memcmp(a->frame, r->frame, CHECK_W * CHECK_H * sizeof(lv_color_t)) != 0 ||
+        memcmp(a->layer, r->layer, CHECK_W * CHECK_LAYER_H * sizeof(lv_color_t)) != 0) {
+        printf("FAIL: sequence %" PRIu32 ", after op %" PRIu32 "\n", seq, op);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t sequences = 2000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sequences") == 0 && i + 1 < argc) {
+            sequences = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--sequences N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    lv_disp_t *disp = bench_init(false, false);
+    // The blender reads the driver settings of the display being refreshed
+    _lv_refr_set_disp_refreshing(disp);
+
+    static lvgl_port_draw_async_ctx_t async_ctx;
+    static lv_draw_sw_ctx_t ref_ctx;
+    lvgl_port_draw_async_init_ctx(disp->driver, &async_ctx.base_draw.base_draw);
+    lv_draw_sw_init_ctx(disp->driver, &ref_ctx.base_draw);
+    lv_draw_ctx_t *actx = &async_ctx.base_draw.base_draw;
+
+    check_bufs_t a = { alloc_buf(CHECK_W * CHECK_H), alloc_buf(CHECK_W * CHECK_LAYER_H) };
+    check_bufs_t r = { alloc_buf(CHECK_W * CHECK_H), alloc_buf(CHECK_W * CHECK_LAYER_H) };
+    memcpy(r.frame, a.frame, CHECK_W * CHECK_H * sizeof(lv_color_t));
+    memcpy(r.layer, a.layer, CHECK_W * CHECK_LAYER_H * sizeof(lv_color_t));
+
+    uint32_t ops = 0;
+    for (uint32_t s = 0; s < sequences; s++) {
+        uint32_t n = 1 + rnd(CHECK_OPS);
+        for (uint32_t i = 0; i < n; i++, ops++) {
+            random_op(actx, &a, &ref_ctx.base_draw, &r);
+        }
+        lvgl_port_draw_async_finish(actx);
+        if (!compare(&a, &r, s, n)) {
+            return 1;
+        }
+    }
+
+    const lvgl_port_draw_async_stats_t *st = lvgl_port_draw_async_stats(actx);
+    printf("draw_async_check: %" PRIu32 " sequences, %" PRIu32 " blends identical\n", sequences, ops);
+    printf("  queued %" PRIu32 " blends as %" PRIu32 " copies (%.1f MB), CPU %" PRIu32 " blends, "
+           "%" PRIu32 " waits\n", st->blends, st->copies, (double)st->bytes / 1e6, st->cpu_blends, st->waits);
+    if (st->blends == 0) {
+        printf("FAIL: nothing was queued on the engine\n");
+        return 1;
+    }
+
+    lvgl_port_draw_async_deinit_ctx(disp->driver, actx);
+    return 0;
+}
@@ -0,0 +1,161 @@
+/* format_bench.c */
+// Compares ui_vm_format_fixed() (main/ui_vm.c) with the printf formatting it replaced. First every
+// value from -200000 to 200000 with 0 to 2 decimals, a prefix and a unit has to give the same
+// text as snprintf, also cut short by a small buffer. Then it times both on changing volt values,
+// the formatting alone and the whole label update: lv_label_set_text_fmt(), as ui.c did, against
+// ui_vm_label_fixed() on a bound field. Host times; compare them between builds, not with the device.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <lvgl.h>
+#include "bench_host.h"
+#include "ui_vm.h"
+
+#define BENCH_ROUNDS    5
+
+static volatile uint32_t sink;
+
+// What "%s%d.%0*d%s" gives for a fixed-point value, with the sign of values above -1 kept
+static void format_ref(char *buf, size_t len, const char *prefix, int32_t value, uint8_t decimals,
+                       const char *unit) {
+    int32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    const int64_t mag = value < 0 ? -(int64_t)value : value;
+    if (decimals) {
+        snprintf(buf, len, "%s%s%" PRId64 ".%0*" PRId64 "%s", prefix ? prefix : "", value < 0 ? "-" : "",
+                 mag / scale, (int)decimals, mag % scale, unit ? unit : "");
+    } else {
+        snprintf(buf, len, "%s%s%" PRId64 "%s", prefix ? prefix : "", value < 0 ? "-" : "", mag,
+                 unit ? unit : "");
+    }
+}
+
+static bool check_format(void) {
+    static const char *const prefixes[] = { NULL, "", "In " };
+    static const char *const units[] = { NULL, " V", " Wh" };
+    static const size_t lens[] = { UI_VM_TEXT_LEN, 6, 1 };
+    uint32_t cases = 0;
+    for (int32_t value = -200000; value <= 200000; value++) {
+        for (uint8_t decimals = 0; decimals <= 2; decimals++) {
+            const int k = (int)((uint32_t)value % 3);
+            const size_t len = lens[(uint32_t)value / 3 % 3];
+            char got[UI_VM_TEXT_LEN], want[UI_VM_TEXT_LEN];
+            const size_t n = ui_vm_format_fixed(got, len, prefixes[k], value, decimals, units[k]);
+            format_ref(want, len, prefixes[k], value, decimals, units[k]);
+            if (strcmp(got, want) != 0 || n != strlen(got)) {
+                printf("FAIL: value %" PRId32 ", %u decimals, buffer %zu: \"%s\" (length %zu), snprintf \"%s\"\n",
+                       value, decimals, len, got, n, want);
+                return false;
+            }
+            cases++;
+        }
+    }
+    printf("  %" PRIu32 " values formatted like snprintf\n", cases);
+    return true;
+}
+
+// Battery voltage in 10 mV, a new value on every update
+static int32_t volts(uint32_t i) {
+    return 1150 + (int32_t)(i % 350);
+}
+
+static void run_snprintf(uint32_t updates) {
+    char buf[UI_VM_TEXT_LEN];
+    for (uint32_t i = 0; i < updates; i++) {
+        const int32_t v = volts(i);
+        snprintf(buf, sizeof(buf), "%d.%02d V", (int)(v / 100), (int)(v % 100));
+        sink += (uint8_t)buf[3];
+    }
+}
+
+static void run_format_fixed(uint32_t updates) {
+    char buf[UI_VM_TEXT_LEN];
+    for (uint32_t i = 0; i < updates; i++) {
+        ui_vm_format_fixed(buf, sizeof(buf), NULL, volts(i), 2, " V");
+        sink += (uint8_t)buf[3];
+    }
+}
+
+static lv_obj_t *label;
+static ui_vm_field_t field;
+
+static void run_label_fmt(uint32_t updates) {
+    for (uint32_t i = 0; i < updates; i++) {
+        const int32_t v = volts(i);
+        lv_label_set_text_fmt(label, "%d.%02d V", (int)(v / 100), (int)(v % 100));
+    }
+}
+
+static void run_label_fixed(uint32_t updates) {
+    ui_vm_begin();
+    for (uint32_t i = 0; i < updates; i++) {
+        ui_vm_label_fixed(&field, NULL, volts(i), 2, " V");
+    }
+    ui_vm_end(NULL);
+}
+
+// Best of BENCH_ROUNDS runs, in ns per update
+static double bench_best(void (*run)(uint32_t), uint32_t updates) {
+    double best = 0.0;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        const uint64_t t0 = bench_real_ns();
+        run(updates);
+        const double ns = (double)(bench_real_ns() - t0) / updates;
+        if (r == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+static void bench(uint32_t updates) {
+    label = lv_label_create(lv_scr_act());
+    const double fmt = bench_best(run_snprintf, updates);
+    const double fixed = bench_best(run_format_fixed, updates);
+    const double label_fmt = bench_best(run_label_fmt, updates);
+    lv_obj_del(label);
+
+    // The field shows its own buffer, so the label has to be a fresh one
+    label = lv_label_create(lv_scr_act());
+    ui_vm_bind(&field, label);
+    const double label_fixed = bench_best(run_label_fixed, updates);
+    ui_vm_bind(&field, NULL);
+    lv_obj_del(label);
+
+    printf("%-14s %14s %18s\n", "ns/update", "printf", "ui_vm_format_fixed");
+    printf("%-14s %14.1f %18.1f  x%.2f\n", "format", fmt, fixed, fixed > 0 ? fmt / fixed : 0.0);
+    printf("%-14s %14.1f %18.1f  x%.2f\n", "label", label_fmt, label_fixed,
+           label_fixed > 0 ? label_fmt / label_fixed : 0.0);
+}
+
+int main(int argc, char **argv) {
+    uint32_t updates = 200000;
+    bool run_bench = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--updates") == 0 && i + 1 < argc) {
+            updates = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--no-bench") == 0) {
+            run_bench = false;
+        } else {
+            fprintf(stderr, "usage: %s [--updates N] [--no-bench]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (updates == 0) {
+        fprintf(stderr, "--updates must be at least 1\n");
+        return 2;
+    }
+
+    bench_init(false, false);
+    printf("format_bench: ui_vm_format_fixed against snprintf, then %" PRIu32 " updates of a volt label\n", updates);
+    if (!check_format()) {
+        return 1;
+    }
+    if (run_bench) {
+        bench(updates);
+    }
+    return 0;
+}
@@ -0,0 +1,362 @@
+/* frame_pacer_check.c */
+// Runs the frame pacer of main/frame_pacer.c against a synthetic TE signal, with the timing of the
+// display config (16 ms period, 13 ms scan-out, 8 ms longest wait). First fixed cases: the start,
+// wait and drop decisions for given phases and transfer estimates, starts without TE and a
+// transfer that runs into the scan-out. Then simulated runs where frames come at random times and
+// are sent as the pacer decides, with edge jitter, lost edges, a TE outage and transfers slowed
+// down by the bus. A model of the scan-out says which transfers really crossed a read sweep and
+// which started without TE; the pacer's tears and missed_vsync counters have to agree with it.
+// With partial refresh a frame is flushed as several areas through the port's lv_port_frame.h:
+// the pacer has to see each frame once, and no area of a dropped frame may be sent.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "frame_pacer.h"
+#include "lv_port_frame.h"
+
+#define SIM_PERIOD_US       16000
+#define SIM_SCAN_US         13000
+#define SIM_MAX_WAIT_US     8000
+#define SIM_XFER_US         10000
+#define SIM_SLOW_XFER_US    20000
+// Same slack as the pacer's FRAME_PACER_JITTER_US when judging a crossing
+#define SIM_TOLERANCE_US    100
+// Real edges kept for the scan-out model, more than the longest transfer spans
+#define SIM_EDGES           8
+
+static uint32_t rng_state = 0x7e57ab1e;
+
+static uint32_t rnd(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % n;
+}
+
+static const frame_pacer_config_t pacer_cfg = {
+    .period_us = SIM_PERIOD_US,
+    .scan_us = SIM_SCAN_US,
+    .max_wait_us = SIM_MAX_WAIT_US,
+};
+
+static const char *action_name(frame_pacer_action_t action) {
+    switch (action) {
+    case FRAME_PACER_START: return "start";
+    case FRAME_PACER_WAIT:  return "wait";
+    case FRAME_PACER_DROP:  return "drop";
+    }
+    return "?";
+}
+
+static bool expect_action(const char *what, frame_pacer_t *pacer, int64_t now, frame_pacer_action_t action,
+                          uint32_t wait_us) {
+    uint32_t wait = 0;
+    const frame_pacer_action_t got = frame_pacer_schedule(pacer, now, &wait);
+    if (got != action || wait != wait_us) {
+        printf("FAIL: %s: %s %" PRIu32 " us, expected %s %" PRIu32 " us\n", what, action_name(got), wait,
+               action_name(action), wait_us);
+        return false;
+    }
+    return true;
+}
+
+static bool expect_stats(const char *what, const frame_pacer_t *pacer, uint32_t missed, uint32_t tears,
+                         uint32_t dropped) {
+    frame_pacer_stats_t stats;
+    frame_pacer_get_stats(pacer, &stats);
+    if (stats.missed_vsync != missed || stats.tears != tears || stats.frames_dropped != dropped) {
+        printf("FAIL: %s: missed_vsync %" PRIu32 " tears %" PRIu32 " dropped %" PRIu32 ", expected %" PRIu32 " %" PRIu32
+               " %" PRIu32 "\n", what, stats.missed_vsync, stats.tears, stats.frames_dropped, missed, tears, dropped);
+        return false;
+    }
+    return true;
+}
+
+// Edges every period from `*te` on, each followed by a transfer of `xfer_us` started `phase_us` after it,
+// until the transfer estimate has settled
+static void settle(frame_pacer_t *pacer, int64_t *te, int32_t phase_us, int32_t xfer_us) {
+    const int32_t periods = (xfer_us + phase_us) / SIM_PERIOD_US + 1;
+    for (int i = 0; i < 48; i++) {
+        frame_pacer_on_te(pacer, *te);
+        frame_pacer_on_start(pacer, *te + phase_us);
+        for (int p = 1; p < periods; p++) {
+            frame_pacer_on_te(pacer, *te + (int64_t)p * SIM_PERIOD_US);
+        }
+        frame_pacer_on_done(pacer, *te + phase_us + xfer_us);
+        *te += (int64_t)periods * SIM_PERIOD_US;
+    }
+    frame_pacer_on_te(pacer, *te);
+}
+
+static bool check_decisions(void) {
+    frame_pacer_t pacer;
+    frame_pacer_init(&pacer, &pacer_cfg);
+
+    // No TE yet: frames go out at once and count as missed
+    if (!expect_action("no TE", &pacer, 1000, FRAME_PACER_START, 0)) {
+        return false;
+    }
+    frame_pacer_on_start(&pacer, 1000);
+    frame_pacer_on_done(&pacer, 1000 + SIM_XFER_US);
+    if (!expect_stats("no TE", &pacer, 1, 0, 0)) {
+        return false;
+    }
+
+    // Steady 10 ms transfers: tear-free from 3 ms after the edge to the end of the period, less the 0.1 ms jitter margin
+    int64_t te = 100000;
+    settle(&pacer, &te, SIM_SCAN_US - SIM_XFER_US + 100, SIM_XFER_US);
+    frame_pacer_stats_t stats;
+    frame_pacer_get_stats(&pacer, &stats);
+    if (stats.period_us != SIM_PERIOD_US || stats.transfer_us != SIM_XFER_US) {
+        printf("FAIL: estimates %" PRIu32 " us period, %" PRIu32 " us transfer\n", stats.period_us, stats.transfer_us);
+        return false;
+    }
+    if (!expect_stats("settled", &pacer, 1, 0, 0) ||
+            !expect_action("window start", &pacer, te + 3100, FRAME_PACER_START, 0) ||
+            !expect_action("mid window", &pacer, te + 8000, FRAME_PACER_START, 0) ||
+            !expect_action("window end", &pacer, te + 15999, FRAME_PACER_START, 0) ||
+            !expect_action("before window", &pacer, te + 1000, FRAME_PACER_WAIT, 2100) ||
+            !expect_action("on the edge", &pacer, te, FRAME_PACER_WAIT, 3100) ||
+            !expect_action("periods later", &pacer, te + 2 * SIM_PERIOD_US + 500, FRAME_PACER_WAIT, 2600)) {
+        return false;
+    }
+
+    // The bus slows down: a transfer started late in the window runs into the sweep after next
+    frame_pacer_on_start(&pacer, te + 15000);
+    frame_pacer_on_done(&pacer, te + 15000 + 16000);
+    te += 2 * SIM_PERIOD_US;
+    frame_pacer_on_te(&pacer, te - SIM_PERIOD_US);
+    frame_pacer_on_te(&pacer, te);
+    if (!expect_stats("slow transfer", &pacer, 1, 1, 0)) {
+        return false;
+    }
+
+    // 28 ms transfers leave a window of 0.9 ms after the edge, further than 8 ms away the frame is dropped
+    frame_pacer_init(&pacer, &pacer_cfg);
+    te = 100000;
+    settle(&pacer, &te, 0, 28000);
+    if (!expect_stats("28 ms transfers", &pacer, 0, 0, 0) ||
+            !expect_action("28 ms, in window", &pacer, te + 500, FRAME_PACER_START, 0) ||
+            !expect_action("28 ms, 8 ms to go", &pacer, te + 8000, FRAME_PACER_WAIT, 8000) ||
+            !expect_action("28 ms, too far", &pacer, te + 5000, FRAME_PACER_DROP, 0) ||
+            !expect_stats("28 ms, too far", &pacer, 0, 0, 1)) {
+        return false;
+    }
+
+    // TE lost for 4 periods: free-running, a start counts as missed; the gap doesn't skew the period
+    te += 5 * SIM_PERIOD_US;
+    if (!expect_action("TE lost", &pacer, te, FRAME_PACER_START, 0)) {
+        return false;
+    }
+    frame_pacer_on_start(&pacer, te);
+    frame_pacer_on_done(&pacer, te + 28000);
+    frame_pacer_on_te(&pacer, te + 30000);
+    frame_pacer_on_te(&pacer, te + 30000 + SIM_PERIOD_US);
+    frame_pacer_get_stats(&pacer, &stats);
+    if (!expect_stats("TE lost", &pacer, 1, 0, 1) || stats.period_us != SIM_PERIOD_US) {
+        printf("FAIL: TE lost: period %" PRIu32 " us after the gap\n", stats.period_us);
+        return false;
+    }
+    printf("  fixed cases: start, wait and drop decisions, slow transfer, TE lost\n");
+    return true;
+}
+
+typedef struct {
+    const char *name;
+    int32_t jitter_us;          // edges land within +-jitter of the nominal period
+    uint32_t lost_pct;          // edges the interrupt misses
+    int64_t outage_from_us;     // no edges seen at all in between
+    int64_t outage_to_us;
+    uint32_t slow_pct;          // transfers slowed down on the bus
+    uint32_t areas;             // most areas flushed per frame with partial refresh, 0 for full frames
+} scenario_t;
+
+static struct {
+    frame_pacer_t pacer;
+    int64_t now;
+    int64_t next_edge;
+    int64_t seen_edge;          // last edge passed to the pacer
+    int64_t edges[SIM_EDGES];   // last real edges, seen or not
+    uint32_t edge_cnt;
+    const scenario_t *sc;
+} sim;
+
+// Move the clock to `t`, passing the edges on the way to the pacer unless they are lost
+static void sim_advance(int64_t t) {
+    while (sim.next_edge <= t) {
+        const int64_t edge = sim.next_edge;
+        sim.edges[sim.edge_cnt++ % SIM_EDGES] = edge;
+        const bool outage = edge >= sim.sc->outage_from_us && edge < sim.sc->outage_to_us;
+        if (!outage && rnd(100) >= sim.sc->lost_pct) {
+            frame_pacer_on_te(&sim.pacer, edge);
+            sim.seen_edge = edge;
+        }
+        sim.next_edge += SIM_PERIOD_US;
+        if (sim.sc->jitter_us) {
+            sim.next_edge += (int32_t)rnd(2 * sim.sc->jitter_us + 1) - sim.sc->jitter_us;
+        }
+    }
+    sim.now = t;
+}
+
+// The transfer writes top to bottom in `xfer_us`, each sweep reads top to bottom in the scan time
+// from its edge: they tear when the write pointer and a read pointer cross by more than `tolerance_us`
+static bool sim_torn(int64_t start, int32_t xfer_us, int32_t tolerance_us) {
+    const uint32_t n = sim.edge_cnt < SIM_EDGES ? sim.edge_cnt : SIM_EDGES;
+    for (uint32_t i = 0; i < n; i++) {
+        const int64_t first = start - sim.edges[i];
+        const int64_t last = start + xfer_us - sim.edges[i] - SIM_SCAN_US;
+        if ((first < -tolerance_us && last > tolerance_us) || (first > tolerance_us && last < -tolerance_us)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool check_scenario(const scenario_t *sc, int64_t duration_us) {
+    memset(&sim, 0, sizeof(sim));
+    sim.sc = sc;
+    sim.now = 1000;
+    sim.next_edge = 5000;
+    frame_pacer_init(&sim.pacer, &pacer_cfg);
+
+    // The pacer judges against its period estimate and can't see the jitter of the next edge coming,
+    // so a crossing within the jitter may count either way
+    uint32_t frames = 0, starts = 0, waits = 0, drops = 0, slow = 0, unsynced = 0, torn_min = 0, torn_max = 0;
+    uint32_t areas_sent = 0, areas_skipped = 0;
+    while (sim.now < duration_us) {
+        // LVGL has the next frame ready; a dropped one is merged into it
+        sim_advance(sim.now + rnd(30000));
+        frames++;
+        const uint32_t areas = sc->areas ? 1 + rnd(sc->areas) : 1;
+        lvgl_port_frame_t frame;
+        lvgl_port_frame_begin(&frame);
+        int64_t start = 0;
+        int32_t xfer_us = 0;
+        bool synced = false, started = false;
+        for (uint32_t a = 0; a < areas; a++) {
+            // The first area is paced, the others follow it or go with it
+            const lvgl_port_area_action_t area = lvgl_port_frame_area(&frame);
+            const lvgl_port_area_action_t want = a == 0 ? LVGL_PORT_AREA_PACE
+                                                 : started ? LVGL_PORT_AREA_SEND : LVGL_PORT_AREA_SKIP;
+            if (area != want) {
+                printf("FAIL: %s: frame %" PRIu32 ": area %" PRIu32 " of %" PRIu32 ": action %d, expected %d\n", sc->name,
+                       frames, a + 1, areas, (int)area, (int)want);
+                return false;
+            }
+            if (area == LVGL_PORT_AREA_SKIP) {
+                areas_skipped++;
+                continue;
+            }
+            if (area == LVGL_PORT_AREA_PACE) {
+                uint32_t wait_us = 0;
+                const frame_pacer_action_t action = frame_pacer_schedule(&sim.pacer, sim.now, &wait_us);
+                if (action == FRAME_PACER_DROP) {
+                    lvgl_port_frame_paced(&frame, false);
+                    drops++;
+                    continue;
+                }
+                if (action == FRAME_PACER_WAIT) {
+                    if (wait_us == 0 || wait_us > SIM_MAX_WAIT_US) {
+                        printf("FAIL: %s: frame %" PRIu32 ": wait %" PRIu32 " us\n", sc->name, frames, wait_us);
+                        return false;
+                    }
+                    waits++;
+                    sim_advance(sim.now + wait_us);
+                }
+                // Without TE the pacer counts a missed vsync and can't tell a tear
+                synced = sim.seen_edge != 0 && sim.now - sim.seen_edge < 4LL * sim.pacer.period_us;
+                unsynced += !synced;
+                start = sim.now;
+                const bool is_slow = rnd(100) < sc->slow_pct;
+                xfer_us = (is_slow ? SIM_SLOW_XFER_US : SIM_XFER_US) + (int32_t)rnd(401) - 200;
+                frame_pacer_on_start(&sim.pacer, start);
+                lvgl_port_frame_paced(&frame, true);
+                started = true;
+                starts++;
+                slow += is_slow;
+            }
+            // The areas share the transfer time of the frame, back to back
+            sim_advance(start + (int64_t)xfer_us * (a + 1) / areas);
+            areas_sent++;
+        }
+        if (!started) {
+            continue;
+        }
+        frame_pacer_on_done(&sim.pacer, sim.now);
+        if (synced) {
+            torn_min += sim_torn(start, xfer_us, SIM_TOLERANCE_US + sc->jitter_us);
+            torn_max += sim_torn(start, xfer_us, SIM_TOLERANCE_US - sc->jitter_us);
+        }
+    }
+
+    frame_pacer_stats_t stats;
+    frame_pacer_get_stats(&sim.pacer, &stats);
+    printf("  %-16s %4" PRIu32 " frames: %4" PRIu32 " sent (%4" PRIu32 " waited, %3" PRIu32 " slow), %3" PRIu32
+           " dropped; missed_vsync %3" PRIu32 ", tears %3" PRIu32 ", period %" PRIu32 " us, transfer %" PRIu32 " us\n",
+           sc->name, frames, starts, waits, slow, drops, stats.missed_vsync, stats.tears, stats.period_us,
+           stats.transfer_us);
+    if (sc->areas) {
+        printf("  %-16s %5" PRIu32 " areas: %5" PRIu32 " sent, %4" PRIu32 " skipped with their dropped frame\n", "",
+               areas_sent + areas_skipped, areas_sent, areas_skipped);
+    }
+    if (stats.frames_started != starts || stats.frames_dropped != drops || starts + drops != frames) {
+        printf("FAIL: %s: pacer counted %" PRIu32 " started, %" PRIu32 " dropped\n", sc->name, stats.frames_started,
+               stats.frames_dropped);
+        return false;
+    }
+    if (stats.tears < torn_min || stats.tears > torn_max) {
+        printf("FAIL: %s: %" PRIu32 " tears counted, %" PRIu32 " to %" PRIu32 " transfers crossed the scan-out\n",
+               sc->name, stats.tears, torn_min, torn_max);
+        return false;
+    }
+    if (stats.missed_vsync != unsynced) {
+        printf("FAIL: %s: %" PRIu32 " missed vsyncs counted, %" PRIu32 " transfers started without TE\n", sc->name,
+               stats.missed_vsync, unsynced);
+        return false;
+    }
+    if (abs((int)stats.period_us - SIM_PERIOD_US) > sc->jitter_us) {
+        printf("FAIL: %s: period estimate %" PRIu32 " us\n", sc->name, stats.period_us);
+        return false;
+    }
+    // With steady transfers the pacer has to keep every synchronised frame clear of the scan-out
+    if (sc->slow_pct == 0 && torn_min != 0) {
+        printf("FAIL: %s: %" PRIu32 " transfers crossed the scan-out\n", sc->name, torn_min);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t seconds = 60;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--seconds N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("frame_pacer_check: fixed cases, then %" PRIu32 " s of synthetic TE per scenario\n", seconds);
+    if (!check_decisions()) {
+        return 1;
+    }
+    const int64_t duration_us = (int64_t)seconds * 1000000;
+    const scenario_t scenarios[] = {
+        { "steady", 0, 0, 0, 0, 0, 0 },
+        { "jitter", 50, 0, 0, 0, 0, 0 },
+        { "lost edges", 50, 5, 0, 0, 0, 0 },
+        { "TE outage", 50, 0, duration_us / 3, duration_us / 3 + 500000, 0, 0 },
+        { "slow transfers", 50, 0, 0, 0, 10, 0 },
+        { "all of them", 50, 5, duration_us / 2, duration_us / 2 + 500000, 10, 0 },
+        { "partial refresh", 50, 5, 0, 0, 10, 6 },
+    };
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        if (!check_scenario(&scenarios[i], duration_us)) {
+            return 1;
+        }
+    }
+    return 0;
+}
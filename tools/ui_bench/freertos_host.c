@@ -0,0 +1,225 @@
+/* freertos_host.c */
+// The FreeRTOS calls of the panel driver on pthreads: tasks are threads, semaphores and queues a
+// mutex and a condition variable each. A tick is a millisecond. ISR variants are the task ones, the
+// mock panel IO calls them from the checking thread.
+#include <stdbool.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+struct host_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count, max;
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *items;
+    UBaseType_t length, item_size, head, count;
+};
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+};
+
+static __thread struct host_task *current_task;
+
+// Waits on `cond` until `*count` is below `limit` (want_room) or above 0, or the ticks have passed; false on timeout
+static bool wait_until(pthread_cond_t *cond, pthread_mutex_t *lock, const UBaseType_t *count, bool want_room,
+                       UBaseType_t limit, TickType_t ticks_to_wait) {
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += ticks_to_wait / 1000;
+    until.tv_nsec += (long)(ticks_to_wait % 1000) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    while (want_room ? *count >= limit : *count == 0) {
+        if (ticks_to_wait == 0) {
+            return false;
+        }
+        if (ticks_to_wait == portMAX_DELAY) {
+            pthread_cond_wait(cond, lock);
+        } else if (pthread_cond_timedwait(cond, lock, &until) == ETIMEDOUT) {
+            return !(want_room ? *count >= limit : *count == 0);
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Semaphores
+*******************************************************************************/
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    struct host_sem *sem = calloc(1, sizeof(*sem));
+    if (sem) {
+        pthread_mutex_init(&sem->lock, NULL);
+        pthread_cond_init(&sem->cond, NULL);
+        sem->count = initial;
+        sem->max = max;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+// No owner and no priority inheritance, enough for the driver's one-at-a-time locks
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait) {
+    pthread_mutex_lock(&sem->lock);
+    const bool taken = wait_until(&sem->cond, &sem->lock, &sem->count, false, 0, ticks_to_wait);
+    if (taken) {
+        sem->count--;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    const bool given = sem->count < sem->max;
+    if (given) {
+        sem->count++;
+        pthread_cond_broadcast(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return given ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *task_woken) {
+    if (task_woken) {
+        *task_woken = pdFALSE;
+    }
+    return xSemaphoreGive(sem);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    const UBaseType_t count = sem->count;
+    pthread_mutex_unlock(&sem->lock);
+    return count;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+}
+
+/*******************************************************************************
+* Queues
+*******************************************************************************/
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct host_queue *queue = calloc(1, sizeof(*queue));
+    if (queue) {
+        queue->items = calloc(length, item_size);
+        if (queue->items == NULL) {
+            free(queue);
+            return NULL;
+        }
+        pthread_mutex_init(&queue->lock, NULL);
+        pthread_cond_init(&queue->cond, NULL);
+        queue->length = length;
+        queue->item_size = item_size;
+    }
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait) {
+    pthread_mutex_lock(&queue->lock);
+    const bool room = wait_until(&queue->cond, &queue->lock, &queue->count, true, queue->length, ticks_to_wait);
+    if (room) {
+        const UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return room ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait) {
+    pthread_mutex_lock(&queue->lock);
+    const bool got = wait_until(&queue->cond, &queue->lock, &queue->count, false, 0, ticks_to_wait);
+    if (got) {
+        memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return got ? pdTRUE : pdFALSE;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    pthread_cond_destroy(&queue->cond);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->items);
+    free(queue);
+}
+
+/*******************************************************************************
+* Tasks
+*******************************************************************************/
+
+static void *task_main(void *arg) {
+    current_task = arg;
+    current_task->fn(current_task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *created) {
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return pdFALSE;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    if (pthread_create(&task->thread, NULL, task_main, task) != 0) {
+        free(task);
+        return pdFALSE;
+    }
+    pthread_detach(task->thread);
+    if (created) {
+        *created = task;
+    }
+    return pdPASS;
+}
+
+// Only a task deleting itself, as the panel driver's does
+void vTaskDelete(TaskHandle_t task) {
+    assert(task == NULL && current_task != NULL);
+    free(current_task);
+    current_task = NULL;
+    pthread_exit(NULL);
+}
+
+// The mock panels need no settling time after reset and power commands
+void vTaskDelay(TickType_t ticks) {
+    (void)ticks;
+    sched_yield();
+}
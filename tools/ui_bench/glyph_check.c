@@ -0,0 +1,198 @@
+/* glyph_check.c */
+// Checks letters drawn from the glyph cache (LV_DRAW_SW_GLYPH_CACHE_SIZE, see
+// lv_draw_sw_glyph_cache.c) against lv_draw_sw_letter.c built a second time without it as
+// letter_ref(). Random letters of the UI fonts are drawn by both with random colors, opacities,
+// clip areas, positions partly outside of them, a radius mask and anti-aliasing off; any pixel
+// that differs fails the run. Then the text size cache is checked against measuring each time.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <lvgl.h>
+#include "bench_host.h"
+#include "src/draw/sw/lv_draw_sw.h"
+#include "src/draw/sw/lv_draw_sw_glyph_cache.h"
+
+#define CHECK_W     160
+#define CHECK_H     80
+
+#if !LV_DRAW_SW_GLYPH_CACHE_SIZE || !LV_TXT_SIZE_CACHE_ENTRIES
+#error "glyph_check needs LV_DRAW_SW_GLYPH_CACHE_SIZE and LV_TXT_SIZE_CACHE_ENTRIES in main/lv_conf.h"
+#endif
+
+// lv_draw_sw_letter.c with LV_DRAW_SW_GLYPH_CACHE_SIZE 0 (CMakeLists.txt)
+void letter_ref(lv_draw_ctx_t *draw_ctx, const lv_draw_label_dsc_t *dsc, const lv_point_t *pos_p, uint32_t letter);
+
+LV_FONT_DECLARE(ui_font_montserrat_16);
+LV_FONT_DECLARE(ui_font_montserrat_24);
+LV_FONT_DECLARE(ui_font_montserrat_30);
+LV_FONT_DECLARE(ui_font_montserrat_40);
+
+// The subsets always have these (tools/font_subset.py --always), Montserrat 14 has all of ASCII
+static const char ui_letters[] = " 0123456789.-+:%";
+
+static uint32_t rng_state = 0x13579bdf;
+
+static uint32_t rnd(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % n;
+}
+
+static lv_coord_t rnd_range(lv_coord_t lo, lv_coord_t hi) {
+    return lo + (lv_coord_t)rnd((uint32_t)(hi - lo + 1));
+}
+
+static const lv_font_t *random_font(uint32_t *letter) {
+    static const lv_font_t *const fonts[] = {
+        &lv_font_montserrat_14, &ui_font_montserrat_16, &ui_font_montserrat_24,
+        &ui_font_montserrat_30, &ui_font_montserrat_40,
+    };
+    uint32_t i = rnd(sizeof(fonts) / sizeof(fonts[0]));
+    *letter = i == 0 ? 0x20 + rnd(0x5f) : (uint32_t)ui_letters[rnd(sizeof(ui_letters) - 1)];
+    return fonts[i];
+}
+
+static bool check_letters(lv_disp_t *disp, uint32_t iterations) {
+    static lv_color_t buf[2][CHECK_W * CHECK_H];
+    static lv_draw_sw_ctx_t ctx;
+    lv_draw_sw_init_ctx(disp->driver, &ctx.base_draw);
+    lv_area_t buf_area = { 0, 0, CHECK_W - 1, CHECK_H - 1 };
+    ctx.base_draw.buf_area = &buf_area;
+
+    for (uint32_t it = 0; it < iterations; it++) {
+        lv_draw_label_dsc_t dsc;
+        lv_draw_label_dsc_init(&dsc);
+        uint32_t letter;
+        dsc.font = random_font(&letter);
+        dsc.color.full = (uint16_t)rnd(0x10000);
+        uint32_t kind = rnd(4);
+        dsc.opa = kind == 0 ? (lv_opa_t)rnd(256) : kind == 1 ? (lv_opa_t)rnd_range(LV_OPA_MAX, LV_OPA_COVER)
+                  : LV_OPA_COVER;
+
+        lv_area_t clip = buf_area;
+        if (rnd(3) == 0) {
+            lv_area_set(&clip, rnd_range(0, CHECK_W / 2), rnd_range(0, CHECK_H / 2), 0, 0);
+            clip.x2 = rnd_range(clip.x1, CHECK_W - 1);
+            clip.y2 = rnd_range(clip.y1, CHECK_H - 1);
+        }
+        lv_point_t pos = { rnd_range(-30, CHECK_W - 10), rnd_range(-30, CHECK_H - 10) };
+
+        lv_draw_mask_radius_param_t radius;
+        int16_t mask_id = LV_MASK_ID_INV;
+        if (rnd(5) == 0) {
+            lv_area_t rect = { rnd_range(0, 40), rnd_range(0, 20), rnd_range(60, CHECK_W - 1), rnd_range(30, CHECK_H - 1) };
+            lv_draw_mask_radius_init(&radius, &rect, rnd_range(0, 30), rnd(2));
+            mask_id = lv_draw_mask_add(&radius, NULL);
+        }
+        disp->driver->antialiasing = rnd(6) != 0;
+
+        for (uint32_t i = 0; i < CHECK_W * CHECK_H; i++) {
+            buf[0][i].full = (uint16_t)rnd(0x10000);
+        }
+        memcpy(buf[1], buf[0], sizeof(buf[0]));
+
+        ctx.base_draw.clip_area = &clip;
+        ctx.base_draw.buf = buf[0];
+        lv_draw_sw_letter(&ctx.base_draw, &dsc, &pos, letter);
+        ctx.base_draw.buf = buf[1];
+        letter_ref(&ctx.base_draw, &dsc, &pos, letter);
+
+        if (mask_id != LV_MASK_ID_INV) {
+            lv_draw_mask_free_param(lv_draw_mask_remove_id(mask_id));
+        }
+        if (memcmp(buf[0], buf[1], sizeof(buf[0])) != 0) {
+            printf("FAIL: letter U+%04" PRIX32 " of the %d px font, opa %d, at %d,%d: pixels differ\n",
+                   letter, dsc.font->line_height, dsc.opa, pos.x, pos.y);
+            return false;
+        }
+        // Now and then from an empty cache, so misses are drawn as well
+        if (rnd(500) == 0) {
+            lv_draw_sw_glyph_cache_clear();
+        }
+    }
+    disp->driver->antialiasing = 1;
+    lv_draw_sw_deinit_ctx(disp->driver, &ctx.base_draw);
+    return true;
+}
+
+typedef struct {
+    const lv_font_t *font;
+    const char *text;
+    lv_coord_t letter_space, line_space, max_width;
+    lv_text_flag_t flag;
+    lv_point_t size;        // measured with an empty cache
+} size_case_t;
+
+// Sizes from the cache against measuring each text with an empty one. More cases than entries,
+// so sizes are replaced as well.
+static bool check_sizes(uint32_t iterations) {
+    static const char *const texts[] = {
+        "12.34 V", "-0.5 A", "100%", "Bulk", "Absorption", "Float", "No data for 30 s",
+        "Load\noutput", "#ff0000 1.2# kWh", "", "\n", "A rather long line that wraps in narrow labels",
+        "A text that is longer than what the size cache keeps, measured each time",
+    };
+    static size_case_t cases[4 * LV_TXT_SIZE_CACHE_ENTRIES];
+    const uint32_t n = sizeof(cases) / sizeof(cases[0]);
+    for (uint32_t i = 0; i < n; i++) {
+        size_case_t *c = &cases[i];
+        uint32_t letter;
+        c->font = random_font(&letter);
+        c->text = texts[rnd(sizeof(texts) / sizeof(texts[0]))];
+        c->letter_space = rnd(4) ? 0 : rnd_range(-1, 3);
+        c->line_space = rnd(4) ? 0 : rnd_range(0, 6);
+        c->max_width = rnd(2) ? LV_COORD_MAX : rnd_range(40, 300);
+        c->flag = (lv_text_flag_t)rnd(4);
+        lv_txt_size_cache_clear();
+        lv_txt_get_size(&c->size, c->text, c->font, c->letter_space, c->line_space, c->max_width, c->flag);
+    }
+
+    lv_txt_size_cache_clear();
+    for (uint32_t it = 0; it < iterations; it++) {
+        // Mostly a few cases that fit into the cache
+        const size_case_t *c = &cases[rnd(4) ? rnd(LV_TXT_SIZE_CACHE_ENTRIES / 2) : rnd(n)];
+        lv_point_t size;
+        lv_txt_get_size(&size, c->text, c->font, c->letter_space, c->line_space, c->max_width, c->flag);
+        if (size.x != c->size.x || size.y != c->size.y) {
+            printf("FAIL: size of \"%s\": %dx%d from the cache, %dx%d measured\n", c->text, size.x, size.y,
+                   c->size.x, c->size.y);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    lv_disp_t *disp = bench_init(false, false);
+    // The blender reads the driver settings of the display being refreshed
+    _lv_refr_set_disp_refreshing(disp);
+
+    if (!check_letters(disp, iterations) || !check_sizes(iterations)) {
+        return 1;
+    }
+
+    lv_draw_sw_glyph_cache_stats_t g;
+    lv_txt_size_cache_stats_t t;
+    lv_draw_sw_glyph_cache_get_stats(&g);
+    lv_txt_size_cache_get_stats(&t);
+    printf("glyph_check: %" PRIu32 " random letters and text sizes identical\n", iterations);
+    printf("  glyphs %" PRIu32 " hits, %" PRIu32 " misses, %" PRIu32 " not cacheable; "
+           "sizes %" PRIu32 " hits, %" PRIu32 " misses, %" PRIu32 " replaced, %" PRIu32 " too long\n",
+           g.hits, g.misses, g.bypass, t.hits, t.misses, t.evictions, t.bypass);
+    if (g.hits == 0 || g.misses == 0 || t.hits == 0 || t.evictions == 0) {
+        printf("FAIL: the caches were not used\n");
+        return 1;
+    }
+    return 0;
+}
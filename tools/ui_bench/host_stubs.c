@@ -0,0 +1,104 @@
+/* host_stubs.c */
+// Platform functions the UI calls besides LVGL: settings come from fixed defaults, saving,
+// Wi-Fi and the backlight do nothing, buffers come from the tracked heap without a budget table. The screensaver is off so it does not dim during a run.
+#include <string.h>
+#include "esp_err.h"
+#include "nvs_flash.h"
+#include "esp_wifi.h"
+#include "esp_bsp.h"
+#include "config_storage.h"
+#include "config_server.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+
+const char *esp_err_to_name(esp_err_t code) {
+    return code == ESP_OK ? "ESP_OK" : "ESP_FAIL";
+}
+
+void esp_restart(void) {
+}
+
+esp_err_t nvs_flash_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+esp_err_t load_brightness(uint8_t *brightness_out) {
+    *brightness_out = 80;
+    return ESP_OK;
+}
+
+esp_err_t save_brightness(uint8_t brightness) {
+    return ESP_OK;
+}
+
+esp_err_t load_aes_key(uint8_t key_out[16]) {
+    memset(key_out, 0, 16);
+    return ESP_OK;
+}
+
+esp_err_t save_aes_key(const uint8_t key_in[16]) {
+    return ESP_OK;
+}
+
+esp_err_t load_screensaver_settings(bool *enabled, uint8_t *brightness, uint16_t *timeout) {
+    *enabled = false;
+    *brightness = 10;
+    *timeout = 60;
+    return ESP_OK;
+}
+
+esp_err_t save_screensaver_settings(bool enabled, uint8_t brightness, uint16_t timeout) {
+    return ESP_OK;
+}
+
+esp_err_t load_wifi_config(char *ssid_out, size_t *ssid_len, char *pass_out, size_t *pass_len, uint8_t *enabled_out) {
+    return ESP_ERR_NOT_FOUND;   // the UI falls back to its defaults
+}
+
+esp_err_t wifi_ap_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_stop(void) {
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_brightness_set(int brightness_percent) {
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_sleep(bsp_display_wake_cb_t wake_cb, void *user_ctx) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+uint32_t mem_budget_caps(mem_place_t place) {
+    return place == MEM_PLACE_PSRAM ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL;
+}
+
+void *mem_budget_alloc(const char *name, size_t size, mem_place_t place) {
+    return heap_caps_malloc(size, mem_budget_caps(place));
+}
+
+void mem_budget_free(void *ptr) {
+    heap_caps_free(ptr);
+}
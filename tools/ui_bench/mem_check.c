@@ -0,0 +1,182 @@
+/* mem_check.c */
+// Checks the two pools of lv_mem.c with the settings of main/lv_conf.h: random allocations,
+// reallocations and frees of small objects and large buffers, each filled with its own byte and
+// compared before it is touched again. Large sizes have to land in the large pool and small ones
+// in the internal pool until it is full, then in the large one. Both pools have to pass
+// lv_mem_test() along the way and be back at their start usage once everything is freed.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <lvgl.h>
+#include "bench_host.h"
+
+#define CHECK_SLOTS     128
+
+#if LV_MEM_CUSTOM || !LV_MEM_LARGE_SIZE
+#error "mem_check needs LV_MEM_CUSTOM 0 and LV_MEM_LARGE_SIZE in main/lv_conf.h"
+#endif
+
+typedef struct {
+    uint8_t *p;
+    uint32_t size;
+    uint8_t fill;
+} slot_t;
+
+static slot_t slots[CHECK_SLOTS];
+
+static uint32_t rng_state = 0x0badf00d;
+
+static uint32_t rnd(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % n;
+}
+
+static uint32_t pool_used(bool large) {
+    lv_mem_monitor_t mon;
+    if (large) {
+        lv_mem_monitor_large(&mon);
+    } else {
+        lv_mem_monitor(&mon);
+    }
+    return mon.total_size - mon.free_size;
+}
+
+// Mostly objects and strings, now and then a buffer for the large pool
+static uint32_t random_size(void) {
+    return rnd(32) ? 1 + rnd(400) : LV_MEM_LARGE_MIN + rnd(4 * 1024);
+}
+
+static bool slot_intact(const slot_t *s, uint32_t it) {
+    for (uint32_t i = 0; i < s->size; i++) {
+        if (s->p[i] != s->fill) {
+            printf("FAIL: op %" PRIu32 ": byte %" PRIu32 " of %" PRIu32 " overwritten\n", it, i, s->size);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void slot_fill(slot_t *s, uint32_t size) {
+    s->size = size;
+    s->fill = (uint8_t)(1 + rnd(255));
+    memset(s->p, s->fill, size);
+}
+
+// Placement: the pool a new block went to, by the usage it added
+static bool check_placement(uint32_t size, bool large) {
+    uint32_t small0 = pool_used(false), large0 = pool_used(true);
+    void *p = lv_mem_alloc(size);
+    bool ok = p != NULL && (pool_used(true) > large0) == large && (pool_used(false) > small0) == !large;
+    lv_mem_free(p);
+    if (!ok) {
+        printf("FAIL: %" PRIu32 " B not in the %s pool\n", size, large ? "large" : "internal");
+    }
+    return ok;
+}
+
+static bool check_random(uint32_t iterations) {
+    for (uint32_t it = 0; it < iterations; it++) {
+        slot_t *s = &slots[rnd(CHECK_SLOTS)];
+        if (s->p && !slot_intact(s, it)) {
+            return false;
+        }
+        uint32_t size = random_size();
+        if (s->p == NULL) {
+            s->p = lv_mem_alloc(size);
+            if (s->p) {
+                slot_fill(s, size);
+            }
+        } else if (rnd(3) == 0) {
+            lv_mem_free(s->p);
+            s->p = NULL;
+        } else {
+            uint8_t *p = lv_mem_realloc(s->p, size);
+            if (p != NULL) {        // else full, the old block is kept
+                s->p = p;
+                s->size = size < s->size ? size : s->size;
+                if (!slot_intact(s, it)) {
+                    printf("FAIL: reallocation to %" PRIu32 " B lost the content\n", size);
+                    return false;
+                }
+                slot_fill(s, size);
+            }
+        }
+        if ((it & 255) == 0 && lv_mem_test() != LV_RES_OK) {
+            printf("FAIL: op %" PRIu32 ": pools damaged\n", it);
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < CHECK_SLOTS; i++) {
+        if (slots[i].p && !slot_intact(&slots[i], iterations)) {
+            return false;
+        }
+        lv_mem_free(slots[i].p);
+        slots[i].p = NULL;
+    }
+    return true;
+}
+
+// Small objects once the internal pool is full go to the large pool
+static bool check_spill(void) {
+    uint32_t large0 = pool_used(true);
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    uint32_t fails0 = mon.fail_cnt;
+    uint32_t n = 0;
+    while (n < CHECK_SLOTS && pool_used(true) == large0) {
+        slots[n].p = lv_mem_alloc(1024);
+        if (slots[n].p == NULL) {
+            break;
+        }
+        slot_fill(&slots[n++], 1024);
+    }
+    lv_mem_monitor(&mon);
+    bool ok = n < CHECK_SLOTS && slots[n - 1].p != NULL && mon.fail_cnt > fails0;
+    for (uint32_t i = 0; i < n; i++) {
+        ok = ok && slot_intact(&slots[i], i);
+        lv_mem_free(slots[i].p);
+        slots[i].p = NULL;
+    }
+    if (!ok) {
+        printf("FAIL: small objects didn't go to the large pool when the internal one was full\n");
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 200000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bench_init(false, false);
+    uint32_t small0 = pool_used(false), large0 = pool_used(true);
+
+    if (!check_placement(64, false) || !check_placement(LV_MEM_LARGE_MIN - 1, false) ||
+        !check_placement(LV_MEM_LARGE_MIN, true) || !check_random(iterations) || !check_spill()) {
+        return 1;
+    }
+    if (pool_used(false) != small0 || pool_used(true) != large0) {
+        printf("FAIL: %" PRIu32 " B internal, %" PRIu32 " B large used after freeing all, %" PRIu32 " B and %" PRIu32
+               " B before\n", pool_used(false), pool_used(true), small0, large0);
+        return 1;
+    }
+
+    lv_mem_monitor_t small, large;
+    lv_mem_monitor(&small);
+    lv_mem_monitor_large(&large);
+    printf("mem_check: %" PRIu32 " random allocations, reallocations and frees intact\n", iterations);
+    printf("  internal %" PRIu32 " allocs, peak %" PRIu32 " B of %" PRIu32 " B, %" PRIu32 " didn't fit; "
+           "large %" PRIu32 " allocs, peak %" PRIu32 " B of %" PRIu32 " B, %" PRIu32 " didn't fit\n",
+           small.alloc_cnt, small.max_used, small.total_size, small.fail_cnt,
+           large.alloc_cnt, large.max_used, large.total_size, large.fail_cnt);
+    return 0;
+}
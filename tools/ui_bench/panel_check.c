@@ -0,0 +1,825 @@
+/* panel_check.c */
+// Checks the windows main/esp_lcd_axs15231b.c sends for esp_lcd_panel_draw_bitmap() through a mock
+// panel IO with a model of the controller behind it: CASET and RASET set the window, RAMWR writes
+// from its top left corner and RAMWRC from where the last write ended, wrapping at the right and
+// bottom edges like the frame memory does. Fixed sequences check the commands sent. Random
+// rectangles with random pixels, now and then with a failing transfer, check the frame memory
+// against a plain copy, and so do random reads back (RAMRD). Both run over QSPI and SPI, and with
+// a controller that ignores RASET (flags.no_raset), where only rectangles the write pointer can
+// reach may be drawn or read.
+//
+// The driver sends from its own task (freertos_host.c runs it on a thread). The queue check holds
+// transfers on the mock bus to fill the queue: submissions past its depth have to wait or time out,
+// callbacks have to come in order with the right status, and the statistics have to count it. The
+// async random check submits random rectangles from a ring of buffers, reusing each only after its
+// callback, and compares the frame memory whenever the queue has drained.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <pthread.h>
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_interface.h"
+#include "esp_lcd_panel_commands.h"
+#include "esp_lcd_axs15231b.h"
+
+#define PANEL_W         320
+#define PANEL_H         480
+#define LOG_MAX         16
+#define ASYNC_BUFS      4       // more than the queue depth, so the ring runs into the back-pressure
+
+#define OPCODE_WRITE_CMD    0x02
+#define OPCODE_READ_CMD     0x0B
+#define OPCODE_WRITE_COLOR  0x32
+
+typedef struct {
+    uint8_t cmd;
+    uint16_t a, b;      // CASET/RASET: first and last column or row
+    uint32_t len;       // RAMWR/RAMWRC: bytes
+} io_cmd_t;
+
+typedef struct {
+    const char *name;
+    bool qspi;
+    bool no_raset;
+} check_mode_t;
+
+struct esp_lcd_panel_io_t {
+    int unused;
+};
+
+static struct esp_lcd_panel_io_t mock_io;
+
+// The controller: window, write pointer and frame memory
+static struct {
+    bool qspi;
+    bool ignore_raset;
+    bool bad_opcode;
+    int fail_in;            // transfers until one fails, 0 for none
+    int x1, x2, y1, y2;     // window, inclusive
+    int px, py;             // write pointer
+    uint16_t mem[PANEL_H][PANEL_W];
+    io_cmd_t log[LOG_MAX];
+    int log_cnt;
+    uint32_t counts[256];
+    uint32_t bytes;
+} ctrl;
+
+static uint16_t ref[PANEL_H][PANEL_W];
+
+// The bus: a colour transfer is done at once, or when held, once bus_finish() is called for it
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool hold;
+    int pending;                // held transfers
+    esp_lcd_panel_io_color_trans_done_cb_t done_cb;
+    void *user_ctx;
+} bus = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static uint32_t rng_state = 0x2468ace1;
+
+static uint32_t rnd(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % n;
+}
+
+static int rnd_range(int lo, int hi) {
+    return lo + (int)rnd((uint32_t)(hi - lo + 1));
+}
+
+/*******************************************************************************
+* Mock panel IO
+*******************************************************************************/
+
+static int decode(int lcd_cmd, int opcode) {
+    if (!ctrl.qspi) {
+        return lcd_cmd;
+    }
+    if (((lcd_cmd >> 24) & 0xff) != opcode || (lcd_cmd & 0xff) != 0) {
+        ctrl.bad_opcode = true;
+    }
+    return (lcd_cmd >> 8) & 0xff;
+}
+
+static bool transfer_fails(void) {
+    return ctrl.fail_in && --ctrl.fail_in == 0;
+}
+
+static void record(io_cmd_t c) {
+    ctrl.counts[c.cmd]++;
+    if (ctrl.log_cnt < LOG_MAX) {
+        ctrl.log[ctrl.log_cnt] = c;
+    }
+    ctrl.log_cnt++;
+}
+
+static void write_pixels(int cmd, const uint8_t *data, size_t len) {
+    if (cmd == LCD_CMD_RAMWR) {
+        ctrl.px = ctrl.x1;
+        ctrl.py = ctrl.y1;
+    }
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        if (ctrl.px < PANEL_W && ctrl.py < PANEL_H) {
+            memcpy(&ctrl.mem[ctrl.py][ctrl.px], data + i, 2);
+        }
+        if (++ctrl.px > ctrl.x2) {
+            ctrl.px = ctrl.x1;
+            if (++ctrl.py > ctrl.y2) {
+                ctrl.py = ctrl.y1;
+            }
+        }
+    }
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size) {
+    (void)io;
+    if (transfer_fails()) {
+        return ESP_FAIL;
+    }
+    const int cmd = decode(lcd_cmd, OPCODE_WRITE_CMD);
+    const uint8_t *p = param;
+    io_cmd_t c = { .cmd = (uint8_t)cmd };
+    if ((cmd == LCD_CMD_CASET || cmd == LCD_CMD_RASET) && param_size == 4) {
+        c.a = (uint16_t)(p[0] << 8 | p[1]);
+        c.b = (uint16_t)(p[2] << 8 | p[3]);
+        if (cmd == LCD_CMD_CASET) {
+            ctrl.x1 = c.a;
+            ctrl.x2 = c.b;
+        } else if (!ctrl.ignore_raset) {
+            ctrl.y1 = c.a;
+            ctrl.y2 = c.b;
+        }
+    } else if (cmd == LCD_CMD_RAMWR || cmd == LCD_CMD_RAMWRC) {
+        // The init sequence ends with a RAMWR with parameters
+        c.len = (uint32_t)param_size;
+        write_pixels(cmd, p, param_size);
+    }
+    record(c);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size) {
+    (void)io;
+    if (transfer_fails()) {
+        return ESP_FAIL;
+    }
+    const int cmd = decode(lcd_cmd, OPCODE_WRITE_COLOR);
+    write_pixels(cmd, color, color_size);
+    record((io_cmd_t) { .cmd = (uint8_t)cmd, .len = (uint32_t)color_size });
+    ctrl.bytes += (uint32_t)color_size;
+
+    pthread_mutex_lock(&bus.lock);
+    const bool hold = bus.hold;
+    if (hold) {
+        bus.pending++;
+        pthread_cond_broadcast(&bus.cond);
+    }
+    pthread_mutex_unlock(&bus.lock);
+    if (!hold && bus.done_cb) {
+        esp_lcd_panel_io_event_data_t edata;
+        bus.done_cb(io, &edata, bus.user_ctx);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs,
+                                                    void *user_ctx) {
+    (void)io;
+    bus.done_cb = cbs->on_color_trans_done;
+    bus.user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+// The interrupt of a held transfer, once there is one
+static void bus_finish(void) {
+    pthread_mutex_lock(&bus.lock);
+    while (bus.pending == 0) {
+        pthread_cond_wait(&bus.cond, &bus.lock);
+    }
+    bus.pending--;
+    pthread_mutex_unlock(&bus.lock);
+    esp_lcd_panel_io_event_data_t edata;
+    bus.done_cb(&mock_io, &edata, bus.user_ctx);
+}
+
+static void bus_hold(bool hold) {
+    pthread_mutex_lock(&bus.lock);
+    bus.hold = hold;
+    pthread_mutex_unlock(&bus.lock);
+}
+
+static int bus_pending(void) {
+    pthread_mutex_lock(&bus.lock);
+    const int pending = bus.pending;
+    pthread_mutex_unlock(&bus.lock);
+    return pending;
+}
+
+// RAMRD reads from the top left corner of the window on, without moving the write pointer
+esp_err_t esp_lcd_panel_io_rx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, void *param, size_t param_size) {
+    (void)io;
+    memset(param, 0, param_size);
+    if (transfer_fails()) {
+        return ESP_FAIL;
+    }
+    const int cmd = decode(lcd_cmd, OPCODE_READ_CMD);
+    if (cmd == LCD_CMD_RAMRD) {
+        uint8_t *data = param;
+        int x = ctrl.x1, y = ctrl.y1;
+        for (size_t i = 0; i + 1 < param_size; i += 2) {
+            if (x < PANEL_W && y < PANEL_H) {
+                memcpy(data + i, &ctrl.mem[y][x], 2);
+            }
+            if (++x > ctrl.x2) {
+                x = ctrl.x1;
+                if (++y > ctrl.y2) {
+                    y = ctrl.y1;
+                }
+            }
+        }
+    }
+    record((io_cmd_t) { .cmd = (uint8_t)cmd, .len = (uint32_t)param_size });
+    return ESP_OK;
+}
+
+// What the driver needs besides the panel IO
+esp_err_t gpio_config(const gpio_config_t *cfg) { (void)cfg; return ESP_OK; }
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) { (void)gpio_num; (void)level; return ESP_OK; }
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) { (void)gpio_num; return ESP_OK; }
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+esp_err_t esp_lcd_touch_register_interrupt_callback(esp_lcd_touch_handle_t tp, esp_lcd_touch_interrupt_callback_t callback) {
+    (void)tp;
+    (void)callback;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel) { return panel->reset(panel); }
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel) { return panel->init(panel); }
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel) { return panel->del(panel); }
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y) {
+    return panel->mirror(panel, mirror_x, mirror_y);
+}
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes) { return panel->swap_xy(panel, swap_axes); }
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data) {
+    return panel->draw_bitmap(panel, x_start, y_start, x_end, y_end, color_data);
+}
+
+/*******************************************************************************
+* Checks
+*******************************************************************************/
+
+// A panel after power on: whole frame memory as the window, then reset and init by the driver
+static esp_lcd_panel_handle_t panel_new(const check_mode_t *mode) {
+    bus_hold(false);
+    memset(&ctrl, 0, sizeof(ctrl));
+    ctrl.qspi = mode->qspi;
+    ctrl.ignore_raset = mode->no_raset;
+    ctrl.x2 = PANEL_W - 1;
+    ctrl.y2 = PANEL_H - 1;
+
+    const axs15231b_vendor_config_t vendor_config = {
+        .flags = {
+            .use_qspi_interface = mode->qspi,
+            .no_raset = mode->no_raset,
+        },
+    };
+    const esp_lcd_panel_dev_config_t panel_config = {
+        .reset_gpio_num = -1,
+        .rgb_ele_order = LCD_RGB_ELEMENT_ORDER_RGB,
+        .bits_per_pixel = 16,
+        .vendor_config = (void *)&vendor_config,
+    };
+    esp_lcd_panel_handle_t panel = NULL;
+    if (esp_lcd_new_panel_axs15231b(&mock_io, &panel_config, &panel) != ESP_OK) {
+        return NULL;
+    }
+    esp_lcd_panel_reset(panel);
+    esp_lcd_panel_init(panel);
+    ctrl.log_cnt = 0;
+    memset(ctrl.counts, 0, sizeof(ctrl.counts));
+    ctrl.bytes = 0;
+    return panel;
+}
+
+static const char *cmd_name(uint8_t cmd) {
+    switch (cmd) {
+    case LCD_CMD_CASET: return "CASET";
+    case LCD_CMD_RASET: return "RASET";
+    case LCD_CMD_RAMWR: return "RAMWR";
+    case LCD_CMD_RAMWRC: return "RAMWRC";
+    case LCD_CMD_RAMRD: return "RAMRD";
+    case LCD_CMD_MADCTL: return "MADCTL";
+    default: return "?";
+    }
+}
+
+static void print_cmds(const char *label, const io_cmd_t *cmds, int n) {
+    printf("  %s:", label);
+    for (int i = 0; i < n && i < LOG_MAX; i++) {
+        if (cmds[i].cmd == LCD_CMD_CASET || cmds[i].cmd == LCD_CMD_RASET) {
+            printf(" %s %u-%u", cmd_name(cmds[i].cmd), cmds[i].a, cmds[i].b);
+        } else {
+            printf(" %s %" PRIu32 " B", cmd_name(cmds[i].cmd), cmds[i].len);
+        }
+    }
+    printf("%s\n", n ? "" : " nothing");
+}
+
+// Draws a rectangle of a single color and compares the return value and the commands sent
+static bool expect(const char *mode, const char *what, esp_lcd_panel_handle_t panel, int x, int y, int w, int h,
+                   esp_err_t want_ret, const io_cmd_t *want, int want_cnt) {
+    static uint16_t pixels[PANEL_W * PANEL_H];
+    for (int i = 0; i < w * h; i++) {
+        pixels[i] = (uint16_t)(y * 7 + x);
+    }
+    ctrl.log_cnt = 0;
+    esp_err_t ret = esp_lcd_panel_draw_bitmap(panel, x, y, x + w, y + h, pixels);
+    bool ok = ret == want_ret && ctrl.log_cnt == want_cnt && !ctrl.bad_opcode;
+    for (int i = 0; ok && i < want_cnt; i++) {
+        ok = ctrl.log[i].cmd == want[i].cmd && ctrl.log[i].a == want[i].a && ctrl.log[i].b == want[i].b &&
+             ctrl.log[i].len == want[i].len;
+    }
+    if (!ok) {
+        printf("FAIL: %s, %s: %dx%d at %d,%d returned %d, want %d%s\n", mode, what, w, h, x, y, ret, want_ret,
+               ctrl.bad_opcode ? ", wrong QSPI opcode" : "");
+        print_cmds("sent", ctrl.log, ctrl.log_cnt);
+        print_cmds("want", want, want_cnt);
+    }
+    return ok;
+}
+
+// Reads a rectangle back and compares the return value and the commands sent
+static bool expect_read(const char *mode, const char *what, esp_lcd_panel_handle_t panel, int x, int y, int w, int h,
+                        esp_err_t want_ret, const io_cmd_t *want, int want_cnt) {
+    static uint16_t pixels[PANEL_W * PANEL_H];
+    ctrl.log_cnt = 0;
+    esp_err_t ret = esp_lcd_axs15231b_read_ram(panel, x, y, x + w, y + h, pixels);
+    bool ok = ret == want_ret && ctrl.log_cnt == want_cnt && !ctrl.bad_opcode;
+    for (int i = 0; ok && i < want_cnt; i++) {
+        ok = ctrl.log[i].cmd == want[i].cmd && ctrl.log[i].a == want[i].a && ctrl.log[i].b == want[i].b &&
+             ctrl.log[i].len == want[i].len;
+    }
+    for (int i = 0; ok && ret == ESP_OK && i < w * h; i++) {
+        ok = pixels[i] == ctrl.mem[y + i / w][x + i % w];
+    }
+    if (!ok) {
+        printf("FAIL: %s, read %s: %dx%d at %d,%d returned %d, want %d%s\n", mode, what, w, h, x, y, ret, want_ret,
+               ctrl.bad_opcode ? ", wrong QSPI opcode" : "");
+        print_cmds("sent", ctrl.log, ctrl.log_cnt);
+        print_cmds("want", want, want_cnt);
+    }
+    return ok;
+}
+
+#define CASET(a, b)     { LCD_CMD_CASET, a, b, 0 }
+#define RASET(a, b)     { LCD_CMD_RASET, a, b, 0 }
+#define RAMWR(w, h)     { LCD_CMD_RAMWR, 0, 0, (w) * (h) * 2 }
+#define RAMWRC(w, h)    { LCD_CMD_RAMWRC, 0, 0, (w) * (h) * 2 }
+#define RAMRD(w, h)     { LCD_CMD_RAMRD, 0, 0, (w) * (h) * 2 }
+#define EXPECT(what, x, y, w, h, ret, ...) do { \
+        const io_cmd_t want_[] = { __VA_ARGS__ }; \
+        if (!expect(mode->name, what, panel, x, y, w, h, ret, want_, sizeof(want_) / sizeof(io_cmd_t))) { \
+            return false; \
+        } \
+    } while (0)
+#define EXPECT_NOTHING(what, x, y, w, h, ret) do { \
+        if (!expect(mode->name, what, panel, x, y, w, h, ret, NULL, 0)) { \
+            return false; \
+        } \
+    } while (0)
+#define READ(what, x, y, w, h, ret, ...) do { \
+        const io_cmd_t want_[] = { __VA_ARGS__ }; \
+        if (!expect_read(mode->name, what, panel, x, y, w, h, ret, want_, sizeof(want_) / sizeof(io_cmd_t))) { \
+            return false; \
+        } \
+    } while (0)
+#define READ_NOTHING(what, x, y, w, h, ret) do { \
+        if (!expect_read(mode->name, what, panel, x, y, w, h, ret, NULL, 0)) { \
+            return false; \
+        } \
+    } while (0)
+
+static bool check_sequences_raset(const check_mode_t *mode) {
+    esp_lcd_panel_handle_t panel = panel_new(mode);
+    EXPECT("first band", 0, 0, PANEL_W, 48, ESP_OK, CASET(0, PANEL_W - 1), RASET(0, 47), RAMWR(PANEL_W, 48));
+    EXPECT("band below", 0, 48, PANEL_W, 48, ESP_OK, RASET(48, 95), RAMWR(PANEL_W, 48));
+    EXPECT("same band again", 0, 48, PANEL_W, 48, ESP_OK, RAMWR(PANEL_W, 48));
+    EXPECT("rectangle", 10, 300, 40, 16, ESP_OK, CASET(10, 49), RASET(300, 315), RAMWR(40, 16));
+    EXPECT("rectangle above", 10, 20, 40, 16, ESP_OK, RASET(20, 35), RAMWR(40, 16));
+    EXPECT("below, shifted", 12, 36, 38, 8, ESP_OK, CASET(12, 49), RASET(36, 43), RAMWR(38, 8));
+    EXPECT("last pixel", PANEL_W - 1, PANEL_H - 1, 1, 1, ESP_OK,
+           CASET(PANEL_W - 1, PANEL_W - 1), RASET(PANEL_H - 1, PANEL_H - 1), RAMWR(1, 1));
+
+    // A read back keeps the window but the write pointer is no longer known
+    EXPECT("band", 0, 0, PANEL_W, 48, ESP_OK, CASET(0, PANEL_W - 1), RASET(0, 47), RAMWR(PANEL_W, 48));
+    READ("band", 0, 0, PANEL_W, 48, ESP_OK, RAMRD(PANEL_W, 48));
+    READ("rectangle", 10, 20, 40, 16, ESP_OK, CASET(10, 49), RASET(20, 35), RAMRD(40, 16));
+    EXPECT("same rectangle", 10, 20, 40, 16, ESP_OK, RAMWR(40, 16));
+
+    // MADCTL changes what columns and rows are, the window is sent again
+    esp_lcd_panel_mirror(panel, true, false);
+    EXPECT("after MADCTL", PANEL_W - 1, PANEL_H - 1, 1, 1, ESP_OK,
+           CASET(PANEL_W - 1, PANEL_W - 1), RASET(PANEL_H - 1, PANEL_H - 1), RAMWR(1, 1));
+
+    // A failed transfer leaves the window unknown
+    ctrl.fail_in = 2;
+    EXPECT("RASET fails", 0, 0, 8, 8, ESP_FAIL, CASET(0, 7));
+    EXPECT("after failure", 0, 0, 8, 8, ESP_OK, CASET(0, 7), RASET(0, 7), RAMWR(8, 8));
+    esp_lcd_panel_del(panel);
+    return true;
+}
+
+static bool check_sequences_no_raset(const check_mode_t *mode) {
+    esp_lcd_panel_handle_t panel = panel_new(mode);
+    EXPECT("first band", 0, 0, PANEL_W, 48, ESP_OK, CASET(0, PANEL_W - 1), RAMWR(PANEL_W, 48));
+    EXPECT("band below", 0, 48, PANEL_W, 48, ESP_OK, RAMWRC(PANEL_W, 48));
+    EXPECT("band below", 0, 96, PANEL_W, 100, ESP_OK, RAMWRC(PANEL_W, 100));
+    EXPECT_NOTHING("band skipped", 0, 300, PANEL_W, 48, ESP_ERR_NOT_SUPPORTED);
+    EXPECT_NOTHING("band narrower", 0, 196, 100, 48, ESP_ERR_NOT_SUPPORTED);
+    EXPECT_NOTHING("band shifted", 10, 196, PANEL_W - 10, 48, ESP_ERR_NOT_SUPPORTED);
+    EXPECT("band after refusals", 0, 196, PANEL_W, 48, ESP_OK, RAMWRC(PANEL_W, 48));
+    READ("top rows", 0, 0, PANEL_W, 8, ESP_OK, RAMRD(PANEL_W, 8));
+    READ_NOTHING("rows below", 0, 8, PANEL_W, 8, ESP_ERR_NOT_SUPPORTED);
+    EXPECT_NOTHING("band below after a read", 0, 244, PANEL_W, 48, ESP_ERR_NOT_SUPPORTED);
+    EXPECT("top band again", 0, 0, PANEL_W, 48, ESP_OK, RAMWR(PANEL_W, 48));
+    EXPECT("narrow top", 10, 0, 40, 16, ESP_OK, CASET(10, 49), RAMWR(40, 16));
+    EXPECT("narrow below", 10, 16, 40, 300, ESP_OK, RAMWRC(40, 300));
+
+    esp_lcd_panel_swap_xy(panel, false);
+    EXPECT_NOTHING("after MADCTL", 10, 316, 40, 16, ESP_ERR_NOT_SUPPORTED);
+
+    ctrl.fail_in = 2;
+    EXPECT("RAMWR fails", 0, 0, PANEL_W, 48, ESP_FAIL, CASET(0, PANEL_W - 1));
+    EXPECT_NOTHING("after failure", 0, 48, PANEL_W, 48, ESP_ERR_NOT_SUPPORTED);
+    EXPECT("top after failure", 0, 0, PANEL_W, 48, ESP_OK, CASET(0, PANEL_W - 1), RAMWR(PANEL_W, 48));
+    esp_lcd_panel_del(panel);
+    return true;
+}
+
+typedef struct {
+    int x, y, w;        // the last rectangle drawn, y below it; y -1 for none
+} band_t;
+
+// With no_raset mostly frames sent in bands from the top like the port does
+static void random_rect(band_t *band, int *x, int *y, int *w, int *h) {
+    if (band->y >= 0 && band->y < PANEL_H && rnd(8)) {
+        // right below the last one, now and then in other columns
+        *x = rnd(8) ? band->x : rnd_range(0, band->x + band->w - 1);
+        *w = rnd(8) ? band->x + band->w - *x : rnd_range(1, PANEL_W - *x);
+        *y = band->y;
+        *h = rnd_range(1, PANEL_H - band->y);
+    } else if (rnd(4) == 0) {
+        // the next frame from the top
+        *x = band->x = rnd(3) ? 0 : rnd_range(0, PANEL_W - 1);
+        *w = band->w = rnd(3) ? PANEL_W - *x : rnd_range(1, PANEL_W - *x);
+        *y = 0;
+        *h = rnd_range(1, PANEL_H);
+    } else {
+        *x = rnd_range(0, PANEL_W - 1);
+        *y = rnd_range(0, PANEL_H - 1);
+        *w = rnd_range(1, PANEL_W - *x);
+        *h = rnd_range(1, PANEL_H - *y);
+    }
+}
+
+static bool frame_matches(const check_mode_t *mode, uint32_t it) {
+    for (int r = 0; r < PANEL_H; r++) {
+        for (int c = 0; c < PANEL_W; c++) {
+            if (ctrl.mem[r][c] != ref[r][c]) {
+                printf("FAIL: %s, op %" PRIu32 ": pixel %d,%d is %04x, want %04x\n", mode->name, it, c, r,
+                       ctrl.mem[r][c], ref[r][c]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Random rectangles, now and then with a failing transfer or read back
+static bool check_random(const check_mode_t *mode, uint32_t iterations, uint32_t *refused) {
+    static uint16_t pixels[PANEL_W * PANEL_H];
+    static uint16_t readback[PANEL_W * PANEL_H];
+    esp_lcd_panel_handle_t panel = panel_new(mode);
+    memcpy(ref, ctrl.mem, sizeof(ref));
+    band_t band = { .y = -1 };
+    *refused = 0;
+
+    for (uint32_t it = 0; it < iterations; it++) {
+        int x, y, w, h;
+        random_rect(&band, &x, &y, &w, &h);
+        for (int i = 0; i < w * h; i++) {
+            pixels[i] = (uint16_t)rnd(0x10000);
+        }
+        if (rnd(64) == 0) {
+            ctrl.fail_in = rnd_range(1, 3);
+        }
+
+        ctrl.log_cnt = 0;
+        esp_err_t ret = esp_lcd_panel_draw_bitmap(panel, x, y, x + w, y + h, pixels);
+        ctrl.fail_in = 0;
+        if (ret == ESP_OK) {
+            for (int r = 0; r < h; r++) {
+                memcpy(&ref[y + r][x], &pixels[r * w], (size_t)w * 2);
+            }
+            band = (band_t) { .x = x, .y = y + h, .w = w };
+        } else if (ret == ESP_ERR_NOT_SUPPORTED) {
+            (*refused)++;
+            if (!mode->no_raset || y == 0 || ctrl.log_cnt != 0) {
+                printf("FAIL: %s, op %" PRIu32 ": %dx%d at %d,%d refused after %d commands\n", mode->name, it, w, h, x,
+                       y, ctrl.log_cnt);
+                return false;
+            }
+        } else {
+            band.y = -1;
+        }
+        if (rnd(16) == 0) {
+            random_rect(&(band_t) { .y = -1 }, &x, &y, &w, &h);
+            ret = esp_lcd_axs15231b_read_ram(panel, x, y, x + w, y + h, readback);
+            if (ret != (mode->no_raset && y != 0 ? ESP_ERR_NOT_SUPPORTED : ESP_OK)) {
+                printf("FAIL: %s, op %" PRIu32 ": read of %dx%d at %d,%d returned %d\n", mode->name, it, w, h, x, y,
+                       ret);
+                return false;
+            }
+            for (int i = 0; ret == ESP_OK && i < w * h; i++) {
+                if (readback[i] != ref[y + i / w][x + i % w]) {
+                    printf("FAIL: %s, op %" PRIu32 ": read pixel %d,%d is %04x, want %04x\n", mode->name, it,
+                           x + i % w, y + i / w, readback[i], ref[y + i / w][x + i % w]);
+                    return false;
+                }
+            }
+        }
+        if (ctrl.bad_opcode) {
+            printf("FAIL: %s, op %" PRIu32 ": wrong QSPI opcode\n", mode->name, it);
+            return false;
+        }
+        if (((it & 15) == 15 || it + 1 == iterations) && !frame_matches(mode, it)) {
+            return false;
+        }
+    }
+    esp_lcd_panel_del(panel);
+    return true;
+}
+
+// Callbacks of the queue check in the order they came, each also given to `sem`
+static struct {
+    SemaphoreHandle_t sem;
+    int ids[8];
+    esp_err_t status[8];
+    int cnt;
+} done_log;
+
+static void log_done(esp_lcd_panel_handle_t panel, esp_err_t status, void *user_ctx) {
+    (void)panel;
+    if (done_log.cnt < 8) {
+        done_log.ids[done_log.cnt] = (int)(intptr_t)user_ctx;
+        done_log.status[done_log.cnt] = status;
+    }
+    done_log.cnt++;
+    xSemaphoreGive(done_log.sem);
+}
+
+static esp_err_t submit(esp_lcd_panel_handle_t panel, int id, int y, TickType_t ticks_to_wait) {
+    static uint16_t pixels[8 * 8];
+    return esp_lcd_axs15231b_draw_bitmap_async(panel, 0, y, 8, y + 8, pixels, log_done, (void *)(intptr_t)id, ticks_to_wait);
+}
+
+static void *finish_later(void *arg) {
+    (void)arg;
+    const struct timespec ts = { .tv_nsec = 5 * 1000000L };
+    nanosleep(&ts, NULL);
+    bus_finish();
+    return NULL;
+}
+
+static bool expect_done(const check_mode_t *mode, const char *what, int id, esp_err_t status) {
+    xSemaphoreTake(done_log.sem, portMAX_DELAY);
+    const int i = done_log.cnt - 1;
+    if (i >= 8 || done_log.ids[i] != id || done_log.status[i] != status) {
+        printf("FAIL: %s, %s: callback %d for %d with %d, want %d with %d\n", mode->name, what, i + 1,
+               i < 8 ? done_log.ids[i] : -1, i < 8 ? done_log.status[i] : -1, id, status);
+        return false;
+    }
+    return true;
+}
+
+// Fills the queue with transfers held on the bus: further submissions wait or time out
+static bool check_queue(const check_mode_t *mode) {
+    esp_lcd_panel_handle_t panel = panel_new(mode);
+    done_log.cnt = 0;
+    bus_hold(true);
+
+    // depth 2: one in transfer and one queued
+    esp_err_t ret[5] = {
+        submit(panel, 1, 0, 0),
+        submit(panel, 2, 0, 0),
+        submit(panel, 3, 0, 0),
+        submit(panel, 3, 0, pdMS_TO_TICKS(10)),
+    };
+    // Only the first rectangle went out, the second waits in the queue while the bus is busy
+    const int on_bus = bus_pending();
+    if (on_bus != 1) {
+        printf("FAIL: %s, full queue: %d transfers on the bus\n", mode->name, on_bus);
+        return false;
+    }
+    pthread_t finisher;
+    pthread_create(&finisher, NULL, finish_later, NULL);
+    ret[4] = submit(panel, 3, 0, portMAX_DELAY);
+    pthread_join(finisher, NULL);
+    if (ret[0] != ESP_OK || ret[1] != ESP_OK || ret[2] != ESP_ERR_TIMEOUT || ret[3] != ESP_ERR_TIMEOUT || ret[4] != ESP_OK) {
+        printf("FAIL: %s, full queue: submissions returned %d %d %d %d %d\n", mode->name, ret[0], ret[1], ret[2], ret[3],
+               ret[4]);
+        return false;
+    }
+    if (!expect_done(mode, "full queue", 1, ESP_OK)) {
+        return false;
+    }
+    for (int id = 2; id <= 3; id++) {
+        bus_finish();
+        if (!expect_done(mode, "full queue", id, ESP_OK)) {
+            return false;
+        }
+    }
+
+    axs15231b_trans_stats_t stats;
+    esp_lcd_axs15231b_get_trans_stats(panel, &stats);
+    if (stats.queue_depth != AXS15231B_TRANS_QUEUE_DEPTH || stats.pending != 0 || stats.queued != 3 || stats.done != 3 ||
+            stats.failed != 0 || stats.occupancy_max != 2 || stats.occupancy_sum != 3 || stats.stalls != 3 ||
+            stats.timeouts != 2 || stats.stall_max_us < 9000 || stats.stall_us < stats.stall_max_us + 4000) {
+        printf("FAIL: %s, statistics: depth %" PRIu32 " pending %" PRIu32 " queued %" PRIu32 " done %" PRIu32 " failed %"
+               PRIu32 " occupancy max %" PRIu32 " sum %" PRIu64 ", %" PRIu32 " stalls %" PRIu64 " us max %" PRIu32
+               " us, %" PRIu32 " timeouts\n", mode->name, stats.queue_depth, stats.pending, stats.queued, stats.done,
+               stats.failed, stats.occupancy_max, stats.occupancy_sum, stats.stalls, stats.stall_us, stats.stall_max_us,
+               stats.timeouts);
+        return false;
+    }
+
+    // A transfer the bus never finishes: the driver gives up on it, and its late interrupt doesn't end the next one
+    if (submit(panel, 4, 0, 0) != ESP_OK || !expect_done(mode, "lost transfer", 4, ESP_ERR_TIMEOUT) || bus_pending() != 1) {
+        return false;
+    }
+    bus_finish();
+    bus_hold(false);
+    if (mode->no_raset) {
+        EXPECT("after a lost transfer", 0, 0, 8, 8, ESP_OK, CASET(0, 7), RAMWR(8, 8));
+        // refused in the task, reported to the callback
+        if (submit(panel, 5, 100, 0) != ESP_OK || !expect_done(mode, "refused", 5, ESP_ERR_NOT_SUPPORTED)) {
+            return false;
+        }
+    } else {
+        EXPECT("after a lost transfer", 0, 0, 8, 8, ESP_OK, CASET(0, 7), RASET(0, 7), RAMWR(8, 8));
+    }
+    esp_lcd_panel_del(panel);
+    return true;
+}
+
+// Submitted rectangles by buffer of the ring; callbacks have to come in submission order
+static struct {
+    SemaphoreHandle_t free;
+    bool no_raset;
+    uint16_t pixels[ASYNC_BUFS][PANEL_W * PANEL_H];
+    struct {
+        int x, y, w, h;
+        uint32_t op;
+    } rect[ASYNC_BUFS];
+    uint32_t next_done;
+    uint32_t refused;
+    bool bad;
+} async;
+
+static void async_done(esp_lcd_panel_handle_t panel, esp_err_t status, void *user_ctx) {
+    (void)panel;
+    const int i = (int)(intptr_t)user_ctx;
+    if (async.rect[i].op != async.next_done++) {
+        async.bad = true;
+    }
+    if (status == ESP_OK) {
+        for (int r = 0; r < async.rect[i].h; r++) {
+            memcpy(&ref[async.rect[i].y + r][async.rect[i].x], &async.pixels[i][r * async.rect[i].w],
+                   (size_t)async.rect[i].w * 2);
+        }
+    } else if (status == ESP_ERR_NOT_SUPPORTED && async.no_raset) {
+        async.refused++;
+    } else {
+        async.bad = true;
+    }
+    xSemaphoreGive(async.free);
+}
+
+static bool check_async_random(const check_mode_t *mode, uint32_t iterations, axs15231b_trans_stats_t *stats) {
+    esp_lcd_panel_handle_t panel = panel_new(mode);
+    memcpy(ref, ctrl.mem, sizeof(ref));
+    band_t band = { .y = -1 };
+    async.no_raset = mode->no_raset;
+    async.next_done = 0;
+    async.refused = 0;
+    async.bad = false;
+
+    for (uint32_t it = 0; it < iterations; it++) {
+        xSemaphoreTake(async.free, portMAX_DELAY);
+        const int i = (int)(it % ASYNC_BUFS);
+        int x, y, w, h;
+        random_rect(&band, &x, &y, &w, &h);
+        for (int p = 0; p < w * h; p++) {
+            async.pixels[i][p] = (uint16_t)rnd(0x10000);
+        }
+        async.rect[i].x = x;
+        async.rect[i].y = y;
+        async.rect[i].w = w;
+        async.rect[i].h = h;
+        async.rect[i].op = it;
+        band = (band_t) { .x = x, .y = y + h, .w = w };
+        if (esp_lcd_axs15231b_draw_bitmap_async(panel, x, y, x + w, y + h, async.pixels[i], async_done,
+                                                (void *)(intptr_t)i, portMAX_DELAY) != ESP_OK) {
+            printf("FAIL: %s, op %" PRIu32 ": not queued\n", mode->name, it);
+            return false;
+        }
+        if ((it & 15) != 15 && it + 1 != iterations) {
+            continue;
+        }
+        // all buffers back: the queue is empty
+        for (int b = 0; b < ASYNC_BUFS; b++) {
+            xSemaphoreTake(async.free, portMAX_DELAY);
+        }
+        if (async.bad) {
+            printf("FAIL: %s, op %" PRIu32 ": callback out of order or with a wrong status\n", mode->name, it);
+            return false;
+        }
+        if (ctrl.bad_opcode || !frame_matches(mode, it)) {
+            return false;
+        }
+        for (int b = 0; b < ASYNC_BUFS; b++) {
+            xSemaphoreGive(async.free);
+        }
+    }
+    esp_lcd_axs15231b_get_trans_stats(panel, stats);
+    if (stats->done + stats->failed != iterations || stats->failed != async.refused) {
+        printf("FAIL: %s: %" PRIu32 " sent and %" PRIu32 " failed of %" PRIu32 ", %" PRIu32 " refused\n", mode->name,
+               stats->done, stats->failed, iterations, async.refused);
+        return false;
+    }
+    esp_lcd_panel_del(panel);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 5000;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [--iterations N] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    // The driver logs each refused rectangle and failed transfer
+    if (!verbose && freopen("/dev/null", "w", stderr) == NULL) {
+        return 2;
+    }
+
+    done_log.sem = xSemaphoreCreateCounting(8, 0);
+    async.free = xSemaphoreCreateCounting(ASYNC_BUFS, ASYNC_BUFS);
+    static const check_mode_t modes[] = {
+        { "qspi", true, false },
+        { "spi", false, false },
+        { "qspi no_raset", true, true },
+    };
+    printf("panel_check: command sequences, the transfer queue and %" PRIu32 " random rectangles per mode, "
+           "waited for and queued\n", iterations);
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        const check_mode_t *mode = &modes[i];
+        uint32_t refused;
+        if (!(mode->no_raset ? check_sequences_no_raset(mode) : check_sequences_raset(mode)) ||
+                !check_random(mode, iterations, &refused)) {
+            return 1;
+        }
+        printf("  %-14s CASET %5" PRIu32 "  RASET %5" PRIu32 "  RAMWR %5" PRIu32 "  RAMWRC %5" PRIu32 "  RAMRD %4" PRIu32
+               ", %" PRIu32 " refused, %.1f MB\n", mode->name, ctrl.counts[LCD_CMD_CASET], ctrl.counts[LCD_CMD_RASET],
+               ctrl.counts[LCD_CMD_RAMWR], ctrl.counts[LCD_CMD_RAMWRC], ctrl.counts[LCD_CMD_RAMRD], refused,
+               ctrl.bytes / 1e6);
+
+        axs15231b_trans_stats_t stats;
+        if (!check_queue(mode) || !check_async_random(mode, iterations, &stats)) {
+            return 1;
+        }
+        printf("  %-14s queued: %" PRIu32 " sent, %" PRIu32 " refused, occupancy mean %.2f max %" PRIu32 " of %" PRIu32
+               ", %" PRIu32 " stalls\n", "", stats.done, stats.failed, (double)stats.occupancy_sum / stats.queued,
+               stats.occupancy_max, stats.queue_depth, stats.stalls);
+    }
+    return 0;
+}
@@ -0,0 +1,3 @@
+/* driver/i2c.h - host stub for tools/ui_bench */
+#pragma once
+#include "driver/gpio.h"
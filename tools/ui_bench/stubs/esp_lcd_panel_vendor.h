@@ -0,0 +1,18 @@
+/* esp_lcd_panel_vendor.h - host stub for tools/ui_bench */
+#pragma once
+#include "esp_lcd_types.h"
+
+typedef enum { LCD_RGB_ELEMENT_ORDER_RGB, LCD_RGB_ELEMENT_ORDER_BGR } lcd_rgb_element_order_t;
+
+typedef struct {
+    int reset_gpio_num;
+    union {
+        lcd_rgb_element_order_t color_space;
+        lcd_rgb_element_order_t rgb_ele_order;
+    };
+    uint32_t bits_per_pixel;
+    struct {
+        uint32_t reset_active_high: 1;
+    } flags;
+    void *vendor_config;
+} esp_lcd_panel_dev_config_t;
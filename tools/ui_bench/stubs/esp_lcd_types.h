@@ -0,0 +1,7 @@
+/* esp_lcd_types.h - host stub for tools/ui_bench */
+#pragma once
+#include "esp_err.h"
+
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+typedef enum { ESP_LCD_COLOR_SPACE_RGB, ESP_LCD_COLOR_SPACE_BGR } esp_lcd_color_space_t;
@@ -0,0 +1,13 @@
+/* esp_log.h - host stub for tools/ui_bench */
+#pragma once
+#include <stdio.h>
+#include "esp_err.h"
+
+// Warnings and errors go to stderr, so they stay apart from the report; info and debug are dropped.
+// Dropped messages still use their arguments, unevaluated, so they count as used and their formats are checked
+#define ESP_LOG_DROP(tag, fmt, ...) do { (void)(tag); (void)sizeof(printf(fmt, ##__VA_ARGS__)); } while (0)
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) ESP_LOG_DROP(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ESP_LOG_DROP(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) ESP_LOG_DROP(tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,6 @@
+/* esp_timer.h - host stub for tools/ui_bench */
+#pragma once
+#include <stdint.h>
+
+// Simulated time since start of the benchmark, also the LVGL tick (lv_conf.h)
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,5 @@
+/* esp_wifi.h - host stub for tools/ui_bench */
+#pragma once
+#include "esp_err.h"
+
+esp_err_t esp_wifi_stop(void);
@@ -0,0 +1,23 @@
+/* freertos/FreeRTOS.h - host stub for tools/ui_bench */
+#pragma once
+#include <stdint.h>
+#include <assert.h>
+
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE                     (0)
+#define pdTRUE                      (1)
+#define pdPASS                      (pdTRUE)
+#define portMAX_DELAY               ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(ms))
+#define portMUX_FREE_VAL            (0xB33FFFFFU)
+#define portMUX_INITIALIZER_UNLOCKED { .owner = portMUX_FREE_VAL, .count = 0 }
+#define portENTER_CRITICAL(mux)     do { (void)(mux); } while (0)
+#define portEXIT_CRITICAL(mux)      do { (void)(mux); } while (0)
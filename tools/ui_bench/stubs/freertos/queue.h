@@ -0,0 +1,11 @@
+/* freertos/queue.h - host stub for tools/ui_bench */
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+// Queues on pthreads, tools/ui_bench/freertos_host.c
+typedef struct host_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait);
+void vQueueDelete(QueueHandle_t queue);
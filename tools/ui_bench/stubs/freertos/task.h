@@ -0,0 +1,12 @@
+/* freertos/task.h - host stub for tools/ui_bench */
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+// Tasks are threads, tools/ui_bench/freertos_host.c
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *created);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
@@ -0,0 +1,2 @@
+/* hal/spi_ll.h - host stub for tools/ui_bench */
+#pragma once
@@ -0,0 +1,5 @@
+/* nvs_flash.h - host stub for tools/ui_bench */
+#pragma once
+#include "nvs.h"
+
+esp_err_t nvs_flash_init(void);
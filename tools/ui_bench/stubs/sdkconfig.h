@@ -0,0 +1,3 @@
+/* sdkconfig.h - host stub for tools/ui_bench */
+#pragma once
+#define CONFIG_IDF_TARGET "linux"
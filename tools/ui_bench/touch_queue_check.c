@@ -0,0 +1,139 @@
+/* touch_queue_check.c */
+// Checks the queue of touch readings in main/lv_port_touch_queue.h. First on one thread: empty and
+// full, and indices wrapping around. Then a producer thread pushes numbered readings as fast as it
+// can, retrying the reading a full queue refused like the touch task, while the consumer pops them;
+// every reading has to arrive once, in order and as written. Build with -fsanitize=thread to have
+// the memory ordering checked as well.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include "lv_port_touch_queue.h"
+
+static lvgl_port_touch_queue_t queue;
+static uint32_t producer_full;
+
+// Every field follows from the number, so a slot read while half written shows
+static lvgl_port_touch_event_t reading(uint32_t seq) {
+    lvgl_port_touch_event_t event = {
+        .time_us = (int64_t)seq * 1000,
+        .x = (uint16_t)seq,
+        .y = (uint16_t)~seq,
+        .pressed = (seq & 1) != 0,
+    };
+    return event;
+}
+
+static bool reading_is(const lvgl_port_touch_event_t *event, uint32_t seq) {
+    const lvgl_port_touch_event_t expect = reading(seq);
+    return event->time_us == expect.time_us && event->x == expect.x && event->y == expect.y &&
+           event->pressed == expect.pressed;
+}
+
+// Fill, overfill and drain the queue from `start` on, its indices set to `start`
+static bool check_fill(unsigned start) {
+    atomic_store(&queue.head, start);
+    atomic_store(&queue.tail, start);
+    lvgl_port_touch_event_t event;
+    if (!lvgl_port_touch_queue_empty(&queue) || lvgl_port_touch_queue_pop(&queue, &event)) {
+        printf("FAIL: start %u: empty queue popped\n", start);
+        return false;
+    }
+    for (uint32_t i = 0; i < LVGL_PORT_TOUCH_QUEUE_LEN; i++) {
+        const lvgl_port_touch_event_t in = reading(i);
+        if (!lvgl_port_touch_queue_push(&queue, &in)) {
+            printf("FAIL: start %u: push %" PRIu32 " refused\n", start, i);
+            return false;
+        }
+    }
+    const lvgl_port_touch_event_t extra = reading(LVGL_PORT_TOUCH_QUEUE_LEN);
+    if (lvgl_port_touch_queue_push(&queue, &extra)) {
+        printf("FAIL: start %u: full queue took a reading\n", start);
+        return false;
+    }
+    for (uint32_t i = 0; i < LVGL_PORT_TOUCH_QUEUE_LEN; i++) {
+        if (lvgl_port_touch_queue_empty(&queue) || !lvgl_port_touch_queue_pop(&queue, &event) || !reading_is(&event, i)) {
+            printf("FAIL: start %u: pop %" PRIu32 " wrong or missing\n", start, i);
+            return false;
+        }
+    }
+    if (!lvgl_port_touch_queue_empty(&queue)) {
+        printf("FAIL: start %u: not empty after draining\n", start);
+        return false;
+    }
+    return true;
+}
+
+static void *producer(void *arg) {
+    const uint32_t count = *(const uint32_t *)arg;
+    for (uint32_t seq = 0; seq < count; seq++) {
+        const lvgl_port_touch_event_t event = reading(seq);
+        while (!lvgl_port_touch_queue_push(&queue, &event)) {
+            producer_full++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static bool check_threads(uint32_t count) {
+    lvgl_port_touch_queue_init(&queue);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, producer, &count) != 0) {
+        printf("FAIL: no producer thread\n");
+        return false;
+    }
+    uint32_t next = 0, empty = 0;
+    bool ok = true;
+    while (next < count) {
+        lvgl_port_touch_event_t event;
+        if (!lvgl_port_touch_queue_pop(&queue, &event)) {
+            empty++;
+            sched_yield();
+            continue;
+        }
+        // Drained to the end either way, the producer waits for room
+        if (ok && !reading_is(&event, next)) {
+            printf("FAIL: reading %" PRIu32 " expected, got time %" PRId64 " x %u y %u\n", next, event.time_us,
+                   event.x, event.y);
+            ok = false;
+        }
+        next++;
+    }
+    pthread_join(thread, NULL);
+    if (ok && !lvgl_port_touch_queue_empty(&queue)) {
+        printf("FAIL: readings left after %" PRIu32 "\n", count);
+        ok = false;
+    }
+    printf("  %" PRIu32 " readings through two threads, queue full %" PRIu32 " times, empty %" PRIu32 " times\n",
+           next, producer_full, empty);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t count = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--count N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("touch_queue_check: %d slots, fill and drain, then %" PRIu32 " readings from a second thread\n",
+           LVGL_PORT_TOUCH_QUEUE_LEN, count);
+    static const unsigned starts[] = { 0, 5, UINT_MAX - 3, UINT_MAX };
+    for (size_t i = 0; i < sizeof(starts) / sizeof(starts[0]); i++) {
+        if (!check_fill(starts[i])) {
+            return 1;
+        }
+    }
+    if (!check_threads(count)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,333 @@
+/* ui_bench.c */
+// Headless render benchmark for the UI (see README "UI Benchmark"). Runs ui_init() and
+// ui_on_panel_data() against a display that renders into memory. The clock skips the time the
+// LVGL task would sleep, so minutes of panel data take a second or two while everything the UI
+// and LVGL do still takes real time.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <lvgl.h>
+#include "ui.h"
+#include "lv_port_profile.h"
+#include "src/draw/sw/lv_draw_sw_glyph_cache.h"
+#include "esp_timer.h"
+#include "bench_host.h"
+
+#define BENCH_SLEEP_MAX_MS  500     // task_max_sleep_ms of the port
+
+typedef struct {
+    uint32_t t_ms;
+    victronPanelData_t d;
+} bench_sample_t;
+
+typedef struct {
+    const char *replay;
+    uint32_t seconds;
+    uint32_t interval_ms;
+    int tab;
+    bool partial;
+    uint32_t max_p99_us;
+    double max_allocs;
+} bench_opts_t;
+
+/* ---- Panel data ---- */
+
+// A day of a 12 V system squeezed into `seconds`: sun up and down, bulk, absorption, float
+static void synth_sample(uint32_t i, uint32_t n, bench_sample_t *s, uint32_t interval_ms) {
+    static uint32_t rnd = 1;
+    static double yield_wh;
+    double day = (double)i / (n > 1 ? n - 1 : 1);
+    double sun = sin(day * M_PI);
+    rnd = rnd * 1103515245u + 12345u;
+    int noise = (int)((rnd >> 16) % 21) - 10;
+
+    int power = (int)(420.0 * sun * sun) + (sun > 0.05 ? noise : 0);
+    if (power < 0) {
+        power = 0;
+    }
+    int volt_cv = 1250 + (int)(190.0 * sun) + noise / 4;
+    int load_da = 12 + (int)((rnd >> 8) % 8);
+    int batt_da = power * 1000 / (volt_cv > 0 ? volt_cv : 1) - load_da;
+    yield_wh += power * 24.0 / n;     // each sample stands for 24 h / n
+
+    memset(s, 0, sizeof(*s));
+    s->t_ms = i * interval_ms;
+    s->d.deviceState = power == 0 ? 0 : volt_cv >= 1440 ? 4 : volt_cv >= 1380 ? 5 : 3;
+    s->d.batteryVoltage = (int16_t)volt_cv;
+    s->d.batteryCurrent = (int16_t)batt_da;
+    s->d.todayYield = (uint16_t)(yield_wh / 10);   // 10 Wh
+    s->d.inputPower = (uint16_t)power;
+    s->d.outputCurrentLo = load_da & 0xFF;
+    s->d.outputCurrentHi = (load_da >> 8) & 1;
+}
+
+// One sample per line: t_ms,deviceState,errorCode,batteryVoltage,batteryCurrent,todayYield,
+// inputPower,loadCurrent (units of victronPanelData_t). Lines not starting with a digit are skipped.
+static bench_sample_t *replay_load(const char *path, uint32_t *count) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    bench_sample_t *samples = NULL;
+    uint32_t n = 0, cap = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        unsigned t, state, err, yield, power, load;
+        int volt, curr;
+        if (line[0] < '0' || line[0] > '9') {
+            continue;
+        }
+        if (sscanf(line, "%u,%u,%u,%d,%d,%u,%u,%u", &t, &state, &err, &volt, &curr, &yield, &power, &load) != 8) {
+            fprintf(stderr, "%s: bad line: %s", path, line);
+            continue;
+        }
+        if (n == cap) {
+            cap = cap ? cap * 2 : 256;
+            samples = realloc(samples, cap * sizeof(*samples));
+        }
+        bench_sample_t *s = &samples[n++];
+        memset(s, 0, sizeof(*s));
+        s->t_ms = t;
+        s->d.deviceState = state;
+        s->d.errorCode = err;
+        s->d.batteryVoltage = volt;
+        s->d.batteryCurrent = curr;
+        s->d.todayYield = yield;
+        s->d.inputPower = power;
+        s->d.outputCurrentLo = load & 0xFF;
+        s->d.outputCurrentHi = (load >> 8) & 1;
+    }
+    fclose(f);
+    *count = n;
+    return samples;
+}
+
+/* ---- Report ---- */
+
+// Allocations from the heap and from LVGL's pools (lv_mem.c), which the heap tracking doesn't see
+static uint32_t alloc_count(void) {
+    lv_mem_monitor_t small, large;
+    lv_mem_monitor(&small);
+    lv_mem_monitor_large(&large);
+    return bench_heap.allocs + small.alloc_cnt + large.alloc_cnt;
+}
+
+static void print_pool(const char *name, const lv_mem_monitor_t *m) {
+    printf("%s %" PRIu32 " B used, peak %" PRIu32 " B of %" PRIu32 " B, frag %d%%, %" PRIu32 " allocs, %" PRIu32
+           " didn't fit\n",
+           name, m->total_size - m->free_size, m->max_used, m->total_size, m->frag_pct, m->alloc_cnt, m->fail_cnt);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint32_t percentile(const uint32_t *sorted, uint32_t n, uint32_t pct) {
+    return n ? sorted[(uint64_t)(n - 1) * pct / 100] : 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --seconds N          simulated run time (default 600, replay: up to the last sample)\n"
+        "  --interval MS        synthetic sample interval (default 1000)\n"
+        "  --replay FILE        panel data from a CSV file instead of the synthetic day\n"
+        "  --tab live|trend|info  tab shown during the run (default live)\n"
+        "  --partial            render invalidated areas only instead of full frames\n"
+        "  --max-p99-us N       fail if the 99th percentile render time is above N\n"
+        "  --max-allocs N       fail if allocations per update are above N\n", prog);
+}
+
+static const char *const tab_names[] = { "live", "trend", "info" };
+
+static bool parse_opts(int argc, char **argv, bench_opts_t *o) {
+    *o = (bench_opts_t){ .interval_ms = 1000, .max_allocs = -1 };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--partial") == 0) {
+            o->partial = true;
+            continue;
+        }
+        if (v == NULL) {
+            return false;
+        }
+        i++;
+        if (strcmp(a, "--seconds") == 0) {
+            o->seconds = strtoul(v, NULL, 10);
+        } else if (strcmp(a, "--interval") == 0) {
+            o->interval_ms = strtoul(v, NULL, 10);
+        } else if (strcmp(a, "--replay") == 0) {
+            o->replay = v;
+        } else if (strcmp(a, "--max-p99-us") == 0) {
+            o->max_p99_us = strtoul(v, NULL, 10);
+        } else if (strcmp(a, "--max-allocs") == 0) {
+            o->max_allocs = strtod(v, NULL);
+        } else if (strcmp(a, "--tab") == 0) {
+            o->tab = -1;
+            for (int t = 0; t < 3; t++) {
+                if (strcmp(v, tab_names[t]) == 0) {
+                    o->tab = t;
+                }
+            }
+            if (o->tab < 0) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return o->interval_ms > 0;
+}
+
+int main(int argc, char **argv) {
+    bench_opts_t opts;
+    if (!parse_opts(argc, argv, &opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    bench_sample_t *samples;
+    uint32_t sample_cnt;
+    bool replay = opts.replay != NULL;
+    if (replay) {
+        samples = replay_load(opts.replay, &sample_cnt);
+        if (samples == NULL || sample_cnt == 0) {
+            fprintf(stderr, "%s: no samples\n", opts.replay);
+            return 2;
+        }
+    } else {
+        if (opts.seconds == 0) {
+            opts.seconds = 600;
+        }
+        sample_cnt = (uint64_t)opts.seconds * 1000 / opts.interval_ms;
+        samples = malloc((sample_cnt + 1) * sizeof(*samples));
+        for (uint32_t i = 0; i < sample_cnt; i++) {
+            synth_sample(i, sample_cnt, &samples[i], opts.interval_ms);
+        }
+    }
+    uint32_t end_ms = opts.seconds * 1000;
+    if (replay && opts.seconds == 0) {
+        end_ms = samples[sample_cnt - 1].t_ms + 1000;
+    }
+
+    bench_init(false, opts.partial);
+    bench_heap_t *heap = &bench_heap;
+    bench_frames_t *frames = &bench_frames;
+    size_t lvgl_live = heap->live;
+    uint32_t lvgl_allocs = alloc_count();
+    ui_init();
+    if (opts.tab != 0) {
+        bench_show_tab(opts.tab);
+    }
+    lv_timer_handler();     // first frame
+    size_t init_live = heap->live;
+    size_t init_peak = heap->peak;
+    uint32_t init_allocs = alloc_count();
+    uint32_t init_frames = frames->frames;
+    uint64_t init_px = frames->px;
+    uint64_t init_areas = frames->areas;
+    uint64_t init_bytes = heap->alloc_bytes;
+    frames->px_max = 0;
+
+    // The LVGL task: run timers, sleep until the next one is due or data arrives
+    uint64_t run_start_ns = bench_real_ns();
+    uint32_t next = 0;
+    uint32_t t0_ms = esp_timer_get_time() / 1000;
+    uint32_t now_ms = 0;
+    heap->peak = heap->live;
+    while (now_ms < end_ms) {
+        while (next < sample_cnt && samples[next].t_ms <= now_ms) {
+            ui_on_panel_data(&samples[next++].d);
+        }
+        uint32_t wait = lv_timer_handler();
+        if (wait > BENCH_SLEEP_MAX_MS) {
+            wait = BENCH_SLEEP_MAX_MS;
+        }
+        now_ms = esp_timer_get_time() / 1000 - t0_ms;
+        if (next < sample_cnt && samples[next].t_ms > now_ms && samples[next].t_ms - now_ms < wait) {
+            wait = samples[next].t_ms - now_ms;
+        }
+        bench_sleep(wait);
+        now_ms += wait;
+    }
+    uint64_t run_ns = bench_real_ns() - run_start_ns;
+
+    uint32_t run_frames = frames->frames - init_frames;
+    uint32_t run_allocs = alloc_count() - init_allocs;
+    uint64_t run_bytes = heap->alloc_bytes - init_bytes;
+    size_t run_peak = heap->peak;
+    size_t end_live = heap->live;
+    ui_update_counts_t counts;
+    ui_vm_stats_t last;
+    ui_get_update_counts(&counts);
+    ui_get_update_stats(&last);
+
+    uint32_t *sorted = malloc((run_frames + 1) * sizeof(uint32_t));
+    memcpy(sorted, frames->render_us + init_frames, run_frames * sizeof(uint32_t));
+    qsort(sorted, run_frames, sizeof(uint32_t), cmp_u32);
+    uint32_t p99 = percentile(sorted, run_frames, 99);
+    double allocs_per_update = next ? (double)run_allocs / next : 0;
+
+    printf("ui_bench: %s, %" PRIu32 " s simulated in %.2f s, tab %s, %s\n",
+           replay ? opts.replay : "synthetic day", end_ms / 1000, run_ns / 1e9, tab_names[opts.tab],
+           opts.partial ? "partial frames" : "full frames");
+    printf("updates   %" PRIu32 " sent, %" PRIu32 " applied, %" PRIu32 " skipped; last changed %" PRIu32
+           " widgets, %" PRIu32 " px\n",
+           next, counts.applied, counts.skipped, last.objects, last.area_px);
+    printf("frames    %" PRIu32 " (first frame %" PRIu32 " us)\n",
+           run_frames, init_frames ? frames->render_us[0] : 0);
+    printf("render us p50 %" PRIu32 "  p90 %" PRIu32 "  p99 %" PRIu32 "  max %" PRIu32 "\n",
+           percentile(sorted, run_frames, 50), percentile(sorted, run_frames, 90), p99,
+           run_frames ? sorted[run_frames - 1] : 0);
+    printf("pixels    %" PRIu64 " per frame in %.1f areas, max %" PRIu32 "\n",
+           run_frames ? (frames->px - init_px) / run_frames : 0,
+           run_frames ? (double)(frames->areas - init_areas) / run_frames : 0, frames->px_max);
+    printf("heap      lvgl %zu B, ui_init +%zu B (%" PRIu32 " allocs, peak %zu B), run peak %zu B, end %zu B\n",
+           lvgl_live, init_live - lvgl_live, init_allocs - lvgl_allocs, init_peak, run_peak, end_live);
+    lv_mem_monitor_t pool;
+    lv_mem_monitor(&pool);
+    print_pool("lv_mem   ", &pool);
+    lv_mem_monitor_large(&pool);
+    if (pool.total_size) {
+        print_pool("  large  ", &pool);
+    }
+    printf("allocs    %.2f per update, %.2f per frame, %.0f B per update\n",
+           allocs_per_update, run_frames ? (double)run_allocs / run_frames : 0,
+           next ? (double)run_bytes / next : 0);
+#if LV_DRAW_SW_GLYPH_CACHE_SIZE
+    lv_draw_sw_glyph_cache_stats_t gc;
+    lv_draw_sw_glyph_cache_get_stats(&gc);
+    printf("glyphs    %" PRIu32 " cached in %" PRIu32 " B, %.1f%% hits, %" PRIu32 " misses, %" PRIu32 " evicted\n",
+           gc.entries, gc.bytes, gc.hits + gc.misses ? 100.0 * gc.hits / (gc.hits + gc.misses) : 0, gc.misses,
+           gc.evictions);
+#endif
+#if LV_TXT_SIZE_CACHE_ENTRIES
+    lv_txt_size_cache_stats_t tc;
+    lv_txt_size_cache_get_stats(&tc);
+    printf("text size %" PRIu32 " cached, %.1f%% hits, %" PRIu32 " misses, %" PRIu32 " replaced, %" PRIu32 " too long\n",
+           tc.entries, tc.hits + tc.misses ? 100.0 * tc.hits / (tc.hits + tc.misses) : 0, tc.misses, tc.evictions,
+           tc.bypass);
+#endif
+#if LVGL_PORT_PROFILE
+    char report[1024];
+    lvgl_port_profile_report(report, sizeof(report));
+    printf("%s", report);
+#endif
+
+    int ret = 0;
+    if (opts.max_p99_us && p99 > opts.max_p99_us) {
+        fprintf(stderr, "FAIL: p99 render time %" PRIu32 " us > %" PRIu32 " us\n", p99, opts.max_p99_us);
+        ret = 1;
+    }
+    if (opts.max_allocs >= 0 && allocs_per_update > opts.max_allocs) {
+        fprintf(stderr, "FAIL: %.2f allocations per update > %.2f\n", allocs_per_update, opts.max_allocs);
+        ret = 1;
+    }
+    return ret;
+}
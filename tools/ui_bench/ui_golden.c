@@ -0,0 +1,233 @@
+/* ui_golden.c */
+// Golden image check for the UI (see README "UI Benchmark"). Feeds a fixed sequence of panel
+// data samples on a simulated clock, so every run renders the same frames, and after each one
+// compares the screen with the stored image in golden/. Each screen also has a budget for the
+// pixels rendered and the render time of its update; going over fails like a pixel difference.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <lvgl.h>
+#include "ui.h"
+#include "bench_host.h"
+
+#ifndef UI_GOLDEN_DIR
+#define UI_GOLDEN_DIR "golden"
+#endif
+
+// Tab order of ui_init()
+#define TAB_LIVE 0
+#define TAB_INFO 2
+
+#define GOLDEN_PX       (BENCH_HRES * BENCH_VRES)
+#define GOLDEN_STEP_MS  5       // longest simulated sleep, keeps animations on the same frames
+
+typedef struct {
+    const char *name;
+    int tab;
+    bool has_data;
+    victronPanelData_t d;
+    uint32_t settle_ms;     // run this long after the sample before comparing
+    uint32_t max_px;        // pixels rendered after the sample (partial rendering only)
+    uint32_t max_us;        // their render time on the host, a coarse guard against slowdowns
+} golden_case_t;
+
+#define PANEL(state, err, volt, curr, yield, power, load) \
+    { .deviceState = (state), .errorCode = (err), .batteryVoltage = (volt), .batteryCurrent = (curr), \
+      .todayYield = (yield), .inputPower = (power), .outputCurrentLo = (load) & 0xFF, .outputCurrentHi = (load) >> 8 }
+
+// Run in this order; each screen starts from the one before
+static const golden_case_t cases[] = {
+    { "live_waiting",    TAB_LIVE, false, {0},                                    1000, 30000, 15000 },
+    { "live_bulk",       TAB_LIVE, true,  PANEL(3, 0, 1326,   84,  41, 128,  15),  500, 75000,  3000 },
+    { "live_absorption", TAB_LIVE, true,  PANEL(4, 0, 1441,  253, 234, 389,  47),  500, 56000,  3000 },
+    { "live_discharge",  TAB_LIVE, true,  PANEL(0, 0, 1218, -125, 234,   0, 125),  500, 47000,  3000 },
+    { "live_stale",      TAB_LIVE, false, {0},                                   31000, 46000, 20000 },
+    { "info_error",      TAB_INFO, true,  PANEL(2, 2, 1472,    0, 236,   0,   0),  500, 42000,  3000 },
+};
+
+typedef struct {
+    const char *golden_dir;
+    const char *out_dir;
+    bool full;
+    bool update;
+} golden_opts_t;
+
+// Run LVGL timers for `ms` of simulated time
+static void run_for(uint32_t ms) {
+    while (ms > 0) {
+        uint32_t wait = lv_timer_handler();
+        wait = LV_CLAMP(1, wait, GOLDEN_STEP_MS);
+        wait = LV_MIN(wait, ms);
+        bench_sleep(wait);
+        ms -= wait;
+    }
+}
+
+static bool golden_load(const char *path, lv_color_t *img) {
+    gzFile f = gzopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    int n = gzread(f, img, GOLDEN_PX * sizeof(lv_color_t));
+    gzclose(f);
+    return n == (int)(GOLDEN_PX * sizeof(lv_color_t));
+}
+
+static bool golden_save(const char *path, const lv_color_t *img) {
+    gzFile f = gzopen(path, "wb9");
+    if (f == NULL) {
+        return false;
+    }
+    int n = gzwrite(f, img, GOLDEN_PX * sizeof(lv_color_t));
+    return gzclose(f) == Z_OK && n == (int)(GOLDEN_PX * sizeof(lv_color_t));
+}
+
+static bool raw_save(const char *path, const lv_color_t *img) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return false;
+    }
+    size_t n = fwrite(img, sizeof(lv_color_t), GOLDEN_PX, f);
+    return fclose(f) == 0 && n == GOLDEN_PX;
+}
+
+// Pixels that differ, with their bounding box; `diff` gets them in magenta over the dimmed screen
+static uint32_t image_diff(const lv_color_t *img, const lv_color_t *ref, lv_color_t *diff, lv_area_t *box) {
+    uint32_t cnt = 0;
+    lv_area_set(box, BENCH_HRES, BENCH_VRES, -1, -1);
+    for (uint32_t i = 0; i < GOLDEN_PX; i++) {
+        if (img[i].full == ref[i].full) {
+            diff[i] = lv_color_mix(img[i], lv_color_black(), LV_OPA_30);
+            continue;
+        }
+        lv_coord_t x = i % BENCH_HRES, y = i / BENCH_HRES;
+        box->x1 = LV_MIN(box->x1, x);
+        box->y1 = LV_MIN(box->y1, y);
+        box->x2 = LV_MAX(box->x2, x);
+        box->y2 = LV_MAX(box->y2, y);
+        diff[i] = lv_color_make(0xFF, 0x00, 0xFF);
+        cnt++;
+    }
+    return cnt;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --full           render full frames like the port (default: invalidated areas only)\n"
+        "  --update         write the current screens as the new golden images\n"
+        "  --golden DIR     golden images (default " UI_GOLDEN_DIR ")\n"
+        "  --out DIR        screens and diffs of failed cases (default ui_golden_out)\n", prog);
+}
+
+static bool parse_opts(int argc, char **argv, golden_opts_t *o) {
+    *o = (golden_opts_t){ .golden_dir = UI_GOLDEN_DIR, .out_dir = "ui_golden_out" };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--full") == 0) {
+            o->full = true;
+        } else if (strcmp(argv[i], "--update") == 0) {
+            o->update = true;
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            o->golden_dir = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            o->out_dir = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    golden_opts_t opts;
+    if (!parse_opts(argc, argv, &opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    static const uint8_t mac[6] = { 0x56, 0x34, 0x12, 0xEF, 0xCD, 0xAB };
+    lv_color_t *ref = malloc(GOLDEN_PX * sizeof(lv_color_t));
+    lv_color_t *diff = malloc(GOLDEN_PX * sizeof(lv_color_t));
+    char path[512];
+    int failed = 0;
+    int tab = TAB_LIVE;
+
+    bench_init(true, !opts.full);
+    ui_init();
+    ui_set_ble_mac(mac);
+    run_for(100);
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const golden_case_t *c = &cases[i];
+        if (c->tab != tab) {
+            tab = c->tab;
+            bench_show_tab(tab);
+            run_for(100);
+        }
+
+        uint64_t px0 = bench_frames.px;
+        uint64_t us0 = bench_frames.us;
+        uint32_t frames0 = bench_frames.frames;
+        if (c->has_data) {
+            ui_on_panel_data(&c->d);
+        }
+        run_for(c->settle_ms);
+        uint32_t px = (uint32_t)(bench_frames.px - px0);
+        uint32_t us = (uint32_t)(bench_frames.us - us0);
+        uint32_t frames = bench_frames.frames - frames0;
+        const lv_color_t *img = bench_framebuffer();
+
+        snprintf(path, sizeof(path), "%s/%s.rgb565.gz", opts.golden_dir, c->name);
+        bool have_ref = golden_load(path, ref);
+        lv_area_t box;
+        uint32_t diff_px = have_ref ? image_diff(img, ref, diff, &box) : GOLDEN_PX;
+
+        if (opts.update) {
+            if (diff_px != 0 && !golden_save(path, img)) {
+                fprintf(stderr, "%s: cannot write\n", path);
+                return 2;
+            }
+            printf("%-16s %s, %" PRIu32 " frames, %" PRIu32 " px, %" PRIu32 " us\n", c->name,
+                   diff_px == 0 ? "unchanged" : "updated", frames, px, us);
+            continue;
+        }
+
+        bool ok = true;
+        printf("%-16s %" PRIu32 " frames, %" PRIu32 " px, %" PRIu32 " us", c->name, frames, px, us);
+        if (!have_ref) {
+            printf("  FAIL: no golden image %s", path);
+            ok = false;
+        } else if (diff_px != 0) {
+            printf("  FAIL: %" PRIu32 " px differ in (%d,%d)-(%d,%d)", diff_px, box.x1, box.y1, box.x2, box.y2);
+            ok = false;
+        }
+        if (!opts.full && px > c->max_px) {
+            printf("  FAIL: rendered px over budget %" PRIu32, c->max_px);
+            ok = false;
+        }
+        if (us > c->max_us) {
+            printf("  FAIL: render time over budget %" PRIu32 " us", c->max_us);
+            ok = false;
+        }
+        printf("%s\n", ok ? "  ok" : "");
+
+        if (!ok) {
+            mkdir(opts.out_dir, 0777);
+            snprintf(path, sizeof(path), "%s/%s.rgb565", opts.out_dir, c->name);
+            raw_save(path, img);
+            if (have_ref && diff_px != 0) {
+                snprintf(path, sizeof(path), "%s/%s_diff.rgb565", opts.out_dir, c->name);
+                raw_save(path, diff);
+            }
+            failed++;
+        }
+    }
+
+    if (failed) {
+        printf("%d of %zu screens failed, screens written to %s/\n", failed, sizeof(cases) / sizeof(cases[0]), opts.out_dir);
+    }
+    return failed ? 1 : 0;
+}